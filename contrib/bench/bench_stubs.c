@@ -0,0 +1,120 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/*
+ * The parts of the olsrd core the benchmarked code links against,
+ * without the scheduler, sockets and logging of the daemon.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "defs.h"
+#include "olsr.h"
+#include "olsr_cfg.h"
+#include "scheduler.h"
+#include "mid_set.h"
+
+static struct olsrd_config bench_cnf;
+struct olsrd_config *olsr_cnf = &bench_cnf;
+
+FILE *debug_handle;
+uint32_t now_times;
+
+void bench_init(int ip_version) {
+  memset(&bench_cnf, 0, sizeof(bench_cnf));
+  bench_cnf.ip_version = ip_version;
+  bench_cnf.ipsize = (ip_version == AF_INET) ? sizeof(struct in_addr) : sizeof(struct in6_addr);
+  bench_cnf.maxplen = (ip_version == AF_INET) ? 32 : 128;
+  debug_handle = stderr;
+  now_times = 1000;
+}
+
+void olsr_exit(const char *msg, int val) {
+  fprintf(stderr, "%s\n", msg);
+  exit(val);
+}
+
+/* the debug output of the core and the plugins is dropped */
+int olsr_printf(int level __attribute__ ((unused)), const char *format __attribute__ ((unused)), ...) {
+  return 0;
+}
+
+void *olsr_malloc(size_t size, const char *id) {
+  void *ptr = calloc(1, size);
+
+  if (!ptr) {
+    fprintf(stderr, "out of memory (%s)\n", id);
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+uint32_t olsr_getTimestamp(uint32_t s) {
+  return now_times + s;
+}
+
+bool olsr_isTimedOut(uint32_t s) {
+  if (s > now_times) {
+    return s - now_times > (1u << 31);
+  }
+
+  return now_times - s <= (1u << 31);
+}
+
+/* timers never run, the benchmarks call the timer callbacks themselves */
+void olsr_set_timer(struct timer_entry **timer, unsigned int rel_time __attribute__ ((unused)),
+    uint8_t jitter_pct __attribute__ ((unused)), bool periodic __attribute__ ((unused)),
+    timer_cb_func cb_func __attribute__ ((unused)), void *context __attribute__ ((unused)),
+    struct olsr_cookie_info *cookie __attribute__ ((unused))) {
+  *timer = NULL;
+}
+
+/* no MID entries: every originator is a main address */
+union olsr_ip_addr *mid_lookup_main_addr(const union olsr_ip_addr *adr __attribute__ ((unused))) {
+  return NULL;
+}
@@ -0,0 +1,250 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/*
+ * Replays a synthetic stream of messages through the duplicate set of
+ * olsrd (src/duplicate_set.c, an open addressing hash table) and through
+ * the AVL tree based duplicate set it replaced, and compares the cost
+ * per message and the duplicate decisions of both.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "defs.h"
+#include "olsr.h"
+#include "ipcalc.h"
+#include "common/avl.h"
+#include "duplicate_set.h"
+#include "scheduler.h"
+
+#define ORIGINATORS 10000
+#define MESSAGES 1000000
+
+struct message {
+  union olsr_ip_addr originator;
+  uint16_t seqno;
+};
+
+/* the duplicate set before it was a hash table */
+struct avl_dup_entry {
+  struct avl_node avl;
+  union olsr_ip_addr ip;
+  uint16_t seqnr;
+  uint16_t too_low_counter;
+  uint32_t array;
+  uint32_t valid_until;
+};
+
+static struct avl_tree avl_duplicate_set;
+
+static int avl_message_is_duplicate(union olsr_message *m) {
+  struct avl_dup_entry *entry;
+  int diff;
+  uint32_t valid_until;
+  uint16_t seqnr;
+  void *ip;
+
+  if (olsr_cnf->ip_version == AF_INET) {
+    seqnr = ntohs(m->v4.seqno);
+    ip = &m->v4.originator;
+  } else {
+    seqnr = ntohs(m->v6.seqno);
+    ip = &m->v6.originator;
+  }
+
+  /* the MID lookup of olsr_message_is_duplicate() is stubbed out for both */
+  valid_until = GET_TIMESTAMP(DUPLICATE_VTIME);
+
+  entry = (struct avl_dup_entry *) avl_find(&avl_duplicate_set, ip);
+  if (entry == NULL) {
+    entry = olsr_malloc(sizeof(struct avl_dup_entry), "New duplicate entry");
+    memcpy(&entry->ip, ip, olsr_cnf->ip_version == AF_INET ? sizeof(entry->ip.v4) : sizeof(entry->ip.v6));
+    entry->seqnr = seqnr;
+    entry->avl.key = &entry->ip;
+    avl_insert(&avl_duplicate_set, &entry->avl, 0);
+    entry->valid_until = valid_until;
+    return false;
+  }
+
+  if (valid_until > entry->valid_until) {
+    entry->valid_until = valid_until;
+  }
+
+  diff = olsr_seqno_diff(seqnr, entry->seqnr);
+  if (diff < -31) {
+    entry->too_low_counter++;
+
+    if (entry->too_low_counter > DUP_MAX_TOO_LOW) {
+      entry->too_low_counter = 0;
+      entry->seqnr = seqnr;
+      entry->array = 1;
+      return false;
+    }
+    return true;
+  }
+
+  entry->too_low_counter = 0;
+  if (diff <= 0) {
+    uint32_t bitmask = 1u << ((uint32_t) (-diff));
+
+    if ((entry->array & bitmask) != 0) {
+      return true;
+    }
+    entry->array |= bitmask;
+    return false;
+  } else if (diff < 32) {
+    entry->array <<= (uint32_t) diff;
+  } else {
+    entry->array = 0;
+  }
+  entry->array |= 1;
+  entry->seqnr = seqnr;
+  return false;
+}
+
+/**
+ * Build the stream: every message comes from a random originator, a
+ * quarter of them repeat a recent or carry an old sequence number.
+ */
+static struct message *build_stream(int ip_version) {
+  struct message *stream = olsr_malloc(sizeof(*stream) * MESSAGES, "stream");
+  uint16_t *seqno = olsr_malloc(sizeof(*seqno) * ORIGINATORS, "seqno");
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  int i;
+
+  for (i = 0; i < ORIGINATORS; i++) {
+    seqno[i] = (uint16_t) bench_rand(&state);
+  }
+
+  for (i = 0; i < MESSAGES; i++) {
+    uint64_t r = bench_rand(&state);
+    uint32_t o = (uint32_t) (r % ORIGINATORS);
+
+    if (ip_version == AF_INET) {
+      stream[i].originator.v4.s_addr = htonl(0x0a000000 + o * 7);
+    } else {
+      stream[i].originator.v6.s6_addr[0] = 0xfd;
+      stream[i].originator.v6.s6_addr[13] = (uint8_t) (o >> 16);
+      stream[i].originator.v6.s6_addr[14] = (uint8_t) (o >> 8);
+      stream[i].originator.v6.s6_addr[15] = (uint8_t) o;
+    }
+
+    if (((r >> 32) & 3) == 0) {
+      stream[i].seqno = (uint16_t) (seqno[o] - ((r >> 40) % 40));
+    } else {
+      stream[i].seqno = ++seqno[o];
+    }
+  }
+
+  free(seqno);
+  return stream;
+}
+
+static void set_message(union olsr_message *m, const struct message *msg) {
+  if (olsr_cnf->ip_version == AF_INET) {
+    m->v4.originator = msg->originator.v4.s_addr;
+    m->v4.seqno = htons(msg->seqno);
+  } else {
+    m->v6.originator = msg->originator.v6;
+    m->v6.seqno = htons(msg->seqno);
+  }
+}
+
+static void run(int ip_version) {
+  static union olsr_message m;
+  struct message *stream;
+  unsigned char *decision;
+  uint64_t start, avl_ns, hash_ns;
+  int duplicates = 0, mismatches = 0;
+  int i;
+
+  bench_init(ip_version);
+  avl_comp_default = (ip_version == AF_INET) ? NULL : avl_comp_ipv6;
+  avl_init(&avl_duplicate_set, (ip_version == AF_INET) ? avl_comp_ipv4 : avl_comp_ipv6);
+  free(duplicate_set.table);
+  memset(&duplicate_set, 0, sizeof(duplicate_set));
+  olsr_init_duplicate_set();
+
+  stream = build_stream(ip_version);
+  decision = olsr_malloc(MESSAGES, "decisions");
+
+  start = bench_ns();
+  for (i = 0; i < MESSAGES; i++) {
+    set_message(&m, &stream[i]);
+    decision[i] = (unsigned char) avl_message_is_duplicate(&m);
+  }
+  avl_ns = bench_ns() - start;
+
+  start = bench_ns();
+  for (i = 0; i < MESSAGES; i++) {
+    int dup;
+
+    set_message(&m, &stream[i]);
+    dup = olsr_message_is_duplicate(&m);
+    duplicates += dup ? 1 : 0;
+    mismatches += (dup ? 1 : 0) != decision[i];
+  }
+  hash_ns = bench_ns() - start;
+
+  printf("IPv%d: %d messages from %d originators, %d duplicates\n", ip_version == AF_INET ? 4 : 6, MESSAGES, ORIGINATORS,
+      duplicates);
+  printf("  avl tree   %6.1f ns/message\n", (double) avl_ns / MESSAGES);
+  printf("  hash table %6.1f ns/message\n", (double) hash_ns / MESSAGES);
+  if (mismatches) {
+    printf("  %d different decisions\n", mismatches);
+  }
+
+  free(decision);
+  free(stream);
+}
+
+int main(void) {
+  run(AF_INET);
+  run(AF_INET6);
+  return 0;
+}
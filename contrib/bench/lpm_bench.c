@@ -0,0 +1,225 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+/*
+ * Builds a synthetic RIB of 50k IPv4 prefixes, removes a third of them
+ * again and compares longest prefix match lookups in the Patricia trie
+ * of the RIB (src/common/lpm.c) with the alternatives the plugins had
+ * before: a probe of the AVL tree of the RIB for every prefix length,
+ * and a linear walk of all routes. Every trie result is checked against
+ * the linear walk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "defs.h"
+#include "olsr.h"
+#include "common/avl.h"
+#include "common/lpm.h"
+
+#define PREFIXES 50000
+#define LOOKUPS 1000000
+
+/* the linear walk is slow, it only sees a sample of the lookups */
+#define LINEAR_LOOKUPS 2000
+
+struct route {
+  struct avl_node node;
+  struct olsr_ip_prefix dst;
+  bool present;
+};
+
+static struct route routes[PREFIXES];
+static struct avl_tree avl;
+static struct lpm_tree lpm;
+
+/* the order of avl_comp_ipv4_prefix(): address, then prefix length */
+static int comp_prefix(const void *p1, const void *p2) {
+  const struct olsr_ip_prefix *pfx1 = p1;
+  const struct olsr_ip_prefix *pfx2 = p2;
+  uint32_t a1 = ntohl(pfx1->prefix.v4.s_addr);
+  uint32_t a2 = ntohl(pfx2->prefix.v4.s_addr);
+
+  if (a1 != a2) {
+    return a1 < a2 ? -1 : 1;
+  }
+  return (int) pfx1->prefix_len - (int) pfx2->prefix_len;
+}
+
+static uint32_t mask(uint8_t len) {
+  return len ? ~0u << (32 - len) : 0;
+}
+
+static struct route *match_avl(uint32_t addr) {
+  struct olsr_ip_prefix key;
+  int len;
+
+  memset(&key, 0, sizeof(key));
+  for (len = 32; len >= 0; len--) {
+    struct avl_node *node;
+
+    key.prefix.v4.s_addr = htonl(addr & mask((uint8_t) len));
+    key.prefix_len = (uint8_t) len;
+    node = avl_find(&avl, &key);
+    if (node) {
+      return (struct route *) node;
+    }
+  }
+  return NULL;
+}
+
+static struct route *match_linear(uint32_t addr) {
+  struct route *best = NULL;
+  int i;
+
+  for (i = 0; i < PREFIXES; i++) {
+    struct route *r = &routes[i];
+
+    if (r->present && ((addr & mask(r->dst.prefix_len)) == ntohl(r->dst.prefix.v4.s_addr))
+        && (!best || (r->dst.prefix_len > best->dst.prefix_len))) {
+      best = r;
+    }
+  }
+  return best;
+}
+
+/* a random address, most of them inside the space the prefixes come from */
+static uint32_t random_addr(uint64_t *state) {
+  uint64_t r = bench_rand(state);
+
+  return ((r >> 32) & 7) ? (0x0a000000 | (uint32_t) (r & 0x00ffffff)) : (uint32_t) r;
+}
+
+int main(void) {
+  uint64_t state = 0x2545f4914f6cdd1dull;
+  uint32_t *addrs;
+  uint64_t start, lpm_ns, avl_ns, linear_ns;
+  unsigned long found = 0;
+  int count = 0, errors = 0;
+  int i;
+
+  bench_init(AF_INET);
+  avl_init(&avl, comp_prefix);
+  lpm_init(&lpm, 32);
+
+  /* prefixes of 8 to 32 bits, mostly /24 to /32 like the HNA and host routes of a mesh */
+  for (i = 0; i < PREFIXES; i++) {
+    uint64_t r = bench_rand(&state);
+    uint8_t len = ((r >> 56) & 3) ? (uint8_t) (24 + (r >> 40) % 9) : (uint8_t) (8 + (r >> 40) % 16);
+    struct route *route = &routes[i];
+
+    route->dst.prefix.v4.s_addr = htonl((0x0a000000 | (uint32_t) (r & 0x00ffffff)) & mask(len));
+    route->dst.prefix_len = len;
+    route->node.key = &route->dst;
+    if (lpm_insert(&lpm, &route->dst.prefix, len, route) == 0) {
+      avl_insert(&avl, &route->node, AVL_DUP_NO);
+      route->present = true;
+      count++;
+    }
+  }
+
+  /* remove a third again, the trie then holds glue nodes of deleted prefixes */
+  for (i = 0; i < PREFIXES; i += 3) {
+    struct route *route = &routes[i];
+
+    if (route->present) {
+      lpm_delete(&lpm, &route->dst.prefix, route->dst.prefix_len);
+      avl_delete(&avl, &route->node);
+      route->present = false;
+      count--;
+    }
+  }
+
+  addrs = olsr_malloc(sizeof(*addrs) * LOOKUPS, "addresses");
+  for (i = 0; i < LOOKUPS; i++) {
+    addrs[i] = random_addr(&state);
+  }
+
+  start = bench_ns();
+  for (i = 0; i < LOOKUPS; i++) {
+    union olsr_ip_addr addr;
+
+    addr.v4.s_addr = htonl(addrs[i]);
+    found += lpm_match(&lpm, &addr) != NULL;
+  }
+  lpm_ns = bench_ns() - start;
+
+  start = bench_ns();
+  for (i = 0; i < LOOKUPS; i++) {
+    found -= match_avl(addrs[i]) != NULL;
+  }
+  avl_ns = bench_ns() - start;
+
+  start = bench_ns();
+  for (i = 0; i < LINEAR_LOOKUPS; i++) {
+    union olsr_ip_addr addr;
+    struct route *expect = match_linear(addrs[i]);
+
+    addr.v4.s_addr = htonl(addrs[i]);
+    errors += lpm_match(&lpm, &addr) != expect;
+  }
+  linear_ns = bench_ns() - start;
+
+  for (i = LINEAR_LOOKUPS; i < LOOKUPS; i++) {
+    union olsr_ip_addr addr;
+
+    addr.v4.s_addr = htonl(addrs[i]);
+    errors += lpm_match(&lpm, &addr) != match_avl(addrs[i]);
+  }
+
+  printf("%d prefixes (%d generated, a third deleted again), %d lookups\n", count, PREFIXES, LOOKUPS);
+  printf("  lpm trie          %9.1f ns/lookup\n", (double) lpm_ns / LOOKUPS);
+  printf("  avl per length    %9.1f ns/lookup\n", (double) avl_ns / LOOKUPS);
+  printf("  linear walk       %9.1f ns/lookup (%d lookups)\n", (double) linear_ns / LINEAR_LOOKUPS, LINEAR_LOOKUPS);
+  if (errors || found) {
+    printf("  %d wrong results\n", errors + (int) found);
+  }
+
+  free(addrs);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+/*
+ * Replays captured mDNS packets through P2pdPacketCaptured() of the p2pd
+ * plugin, the way DoP2pd() hands them over, and OLSR messages through its
+ * duplicate message filter. Every packet and message arrives twice,
+ * like on a node that hears it from two neighbours. The rate is varied so
+ * that 500, 5000 and 20000 different packets fall into the hold time of
+ * the filters.
+ *
+ * The message filter is compared with the linked list filter it replaced,
+ * which aged and scanned the whole list for every message.
+ *
+ * P2pdPacketCaptured() is static, so the plugin source is included here.
+ * Sockets, interfaces and the OLSR output buffers are stubbed out: the
+ * forwarded packets are only counted.
+ */
+
+#include "p2pd.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+#define PACKETS 1000000
+
+/* the list filter is slow, it only sees a sample of the messages */
+#define LIST_MESSAGES 20000
+
+#define PACKET_SLOT 1536
+#define PAYLOAD_LEN 64
+
+static const int windows[] = { 500, 5000, 20000 };
+
+/* the receive buffer of the replay */
+static unsigned char *rx_buffer;
+
+static unsigned long forwarded;
+
+/* stubs for the parts of the daemon and the plugin the replay does not use */
+
+struct NonOlsrInterface *nonOlsrInterfaces = NULL;
+
+static struct interface_olsr bench_if;
+struct interface_olsr *ifnet = &bench_if;
+
+int net_outbuffer_push(struct interface_olsr *ifp __attribute__ ((unused)), const void *data __attribute__ ((unused)),
+    const uint16_t size) {
+  forwarded++;
+  return size;
+}
+
+int net_output(struct interface_olsr *ifp __attribute__ ((unused))) {
+  return 0;
+}
+
+uint16_t get_msg_seqno(void) {
+  static uint16_t seqno;
+
+  return seqno++;
+}
+
+void olsr_parser_add_function(parse_function function __attribute__ ((unused)), uint32_t type __attribute__ ((unused))) {
+}
+
+int CreateNonOlsrNetworkInterfaces(struct interface_olsr *skipThisIntf __attribute__ ((unused))) {
+  return 0;
+}
+
+void CloseNonOlsrNetworkInterfaces(void) {
+}
+
+/* the duplicate message list of p2pd before the dupcache */
+
+struct list_filter_entry {
+  struct list_filter_entry *next;
+  union olsr_ip_addr address;
+  uint16_t seqno;
+  uint8_t msgtype;
+  time_t creationtime;
+};
+
+static struct list_filter_entry *list_head, *list_tail;
+
+static bool list_is_duplicate_message(union olsr_message *m) {
+  struct list_filter_entry *curr, *prev, *entry;
+  time_t now = now_times / MSEC_PER_SEC;
+
+  /* age the whole list */
+  for (prev = NULL, curr = list_head; curr; curr = prev ? prev->next : list_head) {
+    if (curr->creationtime + P2pdDuplicateTimeout < now) {
+      if (prev) {
+        prev->next = curr->next;
+      } else {
+        list_head = curr->next;
+      }
+      if (list_tail == curr) {
+        list_tail = prev;
+      }
+      free(curr);
+    } else {
+      prev = curr;
+    }
+  }
+
+  /* then scan it */
+  for (curr = list_head; curr; curr = curr->next) {
+    if (curr->address.v4.s_addr == m->v4.originator && curr->msgtype == m->v4.olsr_msgtype && curr->seqno == m->v4.seqno) {
+      return true;
+    }
+  }
+
+  entry = olsr_malloc(sizeof(*entry), "bench list filter");
+  entry->creationtime = now;
+  entry->address.v4.s_addr = m->v4.originator;
+  entry->msgtype = m->v4.olsr_msgtype;
+  entry->seqno = m->v4.seqno;
+  if (list_tail) {
+    list_tail->next = entry;
+  } else {
+    list_head = entry;
+  }
+  list_tail = entry;
+  return false;
+}
+
+static void list_free(void) {
+  while (list_head) {
+    struct list_filter_entry *next = list_head->next;
+
+    free(list_head);
+    list_head = next;
+  }
+  list_tail = NULL;
+}
+
+/*
+ * Captured mDNS packet number i, with the headroom for the encapsulation
+ * header in front of it like in the receive buffer of DoP2pd()
+ */
+static unsigned char *make_packet(unsigned char *slot, uint64_t *seed, unsigned int i) {
+  unsigned char *data = slot + ENCAP_HDR_LEN;
+  struct ip *ip = (struct ip *) ARM_NOWARN_ALIGN(data);
+  struct udphdr *udp = (struct udphdr *) ARM_NOWARN_ALIGN(data + sizeof(*ip));
+  unsigned char *payload = data + sizeof(*ip) + sizeof(*udp);
+  int j;
+
+  memset(slot, 0, PACKET_SLOT);
+  ip->ip_v = 4;
+  ip->ip_hl = sizeof(*ip) / 4;
+  ip->ip_len = htons(sizeof(*ip) + sizeof(*udp) + PAYLOAD_LEN);
+  ip->ip_ttl = 255;
+  ip->ip_p = IPPROTO_UDP;
+  ip->ip_src.s_addr = htonl(0x0a000000 | (i % 250));
+  ip->ip_dst.s_addr = htonl(0xe00000fb);
+#if defined(__GLIBC__) || defined(__BIONIC__)
+  udp->source = htons(5353);
+  udp->dest = htons(5353);
+  udp->len = htons(sizeof(*udp) + PAYLOAD_LEN);
+#else
+  udp->uh_sport = htons(5353);
+  udp->uh_dport = htons(5353);
+  udp->uh_ulen = htons(sizeof(*udp) + PAYLOAD_LEN);
+#endif
+  for (j = 0; j < PAYLOAD_LEN; j += 8) {
+    uint64_t r = bench_rand(seed);
+
+    memcpy(&payload[j], &r, 8);
+  }
+  recomputeIPv4HeaderChecksum(ip);
+  return data;
+}
+
+/* replays the packets, the hold time of the filter covers window packets */
+static void bench_captured(int window, bool use_hash) {
+  unsigned int distinct = PACKETS / 2, i;
+  uint64_t seed = 0x5eed, start_ns, ns;
+  unsigned char *data;
+
+  P2pdUseHash = use_hash;
+  now_times = 1000;
+  InitP2pd(NULL);
+  forwarded = 0;
+
+  ns = 0;
+  for (i = 0; i < distinct; i++) {
+    now_times = 1000 + (uint32_t) ((uint64_t) i * HISTORY_HOLD_TIME / window);
+    data = make_packet(rx_buffer, &seed, i);
+
+    start_ns = bench_ns();
+    P2pdPacketCaptured(data, sizeof(struct ip) + sizeof(struct udphdr) + PAYLOAD_LEN);
+    P2pdPacketCaptured(data, sizeof(struct ip) + sizeof(struct udphdr) + PAYLOAD_LEN);
+    ns += bench_ns() - start_ns;
+  }
+
+  CloseP2pd();
+
+  printf("  %-12s %7.0f kpackets/s, %lu forwarded\n", use_hash ? "hash filter" : "no filter",
+      (double) PACKETS * 1e6 / ns, forwarded);
+}
+
+static void make_message(union olsr_message *m, unsigned int i) {
+  memset(m, 0, sizeof(m->v4));
+  m->v4.olsr_msgtype = P2PD_MESSAGE_TYPE;
+  m->v4.olsr_msgsize = htons(12);
+  m->v4.originator = htonl(0x0a010000 | (i % 1000));
+  m->v4.seqno = htons((uint16_t) (i / 1000));
+}
+
+/* replays OLSR messages through the message filter, or the old list filter */
+static void bench_messages(int window, bool list, unsigned int messages) {
+  unsigned int distinct = messages / 2, warmup = list ? (unsigned int) window : 0, i;
+  union olsr_message m;
+  uint64_t start_ns = 0, ns;
+  unsigned long duplicates = 0;
+
+  P2pdUseHash = 0;
+  now_times = 1000;
+  InitP2pd(NULL);
+
+  for (i = 0; i < warmup + distinct; i++) {
+    if (i == warmup) {
+      duplicates = 0;
+      start_ns = bench_ns();
+    }
+    now_times = 1000 + (uint32_t) ((uint64_t) i * P2pdDuplicateTimeout * MSEC_PER_SEC / window);
+    make_message(&m, i);
+
+    if (list) {
+      duplicates += list_is_duplicate_message(&m);
+      duplicates += list_is_duplicate_message(&m);
+    } else {
+      duplicates += p2pd_is_duplicate_message(&m);
+      duplicates += p2pd_is_duplicate_message(&m);
+    }
+  }
+  ns = bench_ns() - start_ns;
+
+  CloseP2pd();
+  list_free();
+
+  printf("  %-12s %7.1f ns/message, %lu duplicates\n", list ? "list" : "dupcache", (double) ns / (2 * distinct), duplicates);
+}
+
+int main(void) {
+  unsigned int w;
+
+  bench_init(AF_INET);
+  bench_if.int_name = "bench0";
+  AddUdpDestPort("224.0.0.251 5353", NULL, (set_plugin_parameter_addon) { .pc = NULL });
+  rx_buffer = olsr_malloc(PACKET_SLOT, "bench packet");
+
+  for (w = 0; w < ARRAYSIZE(windows); w++) {
+    printf("P2pdPacketCaptured(), %d packets twice each, %d in the hold time\n", PACKETS / 2, windows[w]);
+    bench_captured(windows[w], false);
+    bench_captured(windows[w], true);
+  }
+
+  for (w = 0; w < ARRAYSIZE(windows); w++) {
+    printf("p2pd_is_duplicate_message(), messages twice each, %d in the hold time\n", windows[w]);
+    bench_messages(windows[w], false, PACKETS);
+    bench_messages(windows[w], true, LIST_MESSAGES);
+  }
+
+  free(rx_buffer);
+  return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+/*
+ * Signs OLSR packets with add_signature() of the secure plugin and
+ * validates them with its preprocessor secure_preprocessor(), the way
+ * the parser hands them over, for the built-in hash including the key
+ * and for keyed BLAKE2s. Every packet is then received a second time,
+ * which the replay prefilter drops before hashing. The packets come
+ * from 200 neighbours whose timestamps are already validated, so the
+ * challenge exchange does not take part.
+ *
+ * The plugin functions are static, so the plugin source is included
+ * here. Timers, sockets and the parser are stubbed out.
+ */
+
+#include "olsrd_secure.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+#define NEIGHBOURS 200
+#define PACKETS 20000
+#define ROUNDS 10
+
+/* unsigned packet sizes: a small HELLO and a full TC */
+static const int sizes[] = { 64, 1400 };
+
+static const char *algorithms[] = { SCHEME_NAME, "blake2s" };
+
+struct bench_packet {
+  uint8_t data[1500];
+  int size;
+};
+
+static struct bench_packet *packets;
+
+static struct interface_olsr bench_if;
+
+/* stubs for the parts of the daemon the benchmark does not use */
+
+int add_ptf(packet_transform_function f __attribute__ ((unused))) {
+  return 1;
+}
+
+void olsr_preprocessor_add_function(preprocessor_function f __attribute__ ((unused))) {
+}
+
+int olsr_preprocessor_remove_function(preprocessor_function f __attribute__ ((unused))) {
+  return 1;
+}
+
+struct timer_entry *olsr_start_timer(unsigned int rel_time __attribute__ ((unused)), uint8_t jitter_pct __attribute__ ((unused)),
+    bool periodic __attribute__ ((unused)), timer_cb_func cb_func __attribute__ ((unused)), void *context __attribute__ ((unused)),
+    struct olsr_cookie_info *cookie __attribute__ ((unused))) {
+  return NULL;
+}
+
+int net_outbuffer_push(struct interface_olsr *ifp __attribute__ ((unused)), const void *data __attribute__ ((unused)),
+    const uint16_t size) {
+  return size;
+}
+
+int net_output(struct interface_olsr *ifp __attribute__ ((unused))) {
+  return 0;
+}
+
+struct interface_olsr *if_ifwithaddr(const union olsr_ip_addr *addr __attribute__ ((unused))) {
+  return NULL;
+}
+
+uint16_t get_msg_seqno(void) {
+  static uint16_t seqno;
+
+  return seqno++;
+}
+
+/* the plugin state secure_plugin_init() would set up, with validated neighbours */
+static void bench_secure_init(void) {
+  int i;
+
+  olsr_hashtable_init(&timestamps, struct stamp, addr, next, prev);
+  if (dupcache_init(&replay_cache, "SECURE replay cache", REPLAY_SIG_BYTES + sizeof(uint32_t), REPLAY_HOLD_TIME, false) < 0) {
+    olsr_exit("could not initialize the replay cache", EXIT_FAILURE);
+  }
+  memcpy(aes_key, "0123456789abcdef", KEYLENGTH);
+  gettimeofday(&now, NULL);
+
+  for (i = 0; i < NEIGHBOURS; i++) {
+    struct stamp *entry = olsr_malloc(sizeof(*entry), "bench timestamp");
+
+    entry->addr.v4.s_addr = htonl(0x0a020000 | i);
+    entry->validated = 1;
+    entry->valtime = GET_TIMESTAMP(TIMESTAMP_HOLD_TIME * 1000);
+    entry->conftime = GET_TIMESTAMP(EXCHANGE_HOLD_TIME * 1000);
+    olsr_hashtable_insert(&timestamps, entry);
+  }
+}
+
+/* an OLSR packet with one message of random content, of size bytes in total */
+static void make_packet(struct bench_packet *p, uint64_t *seed, int size) {
+  struct olsr *olsr = (struct olsr *) ARM_NOWARN_ALIGN(p->data);
+  int i;
+
+  for (i = 0; i < size; i += 8) {
+    uint64_t r = bench_rand(seed);
+
+    memcpy(&p->data[i], &r, 8);
+  }
+  olsr->olsr_packlen = htons(size);
+  olsr->olsr_msg[0].olsr_msgtype = HELLO_MESSAGE;
+  olsr->olsr_msg[0].olsr_msgsize = htons(size - 4);
+  p->size = size;
+}
+
+static void bench_algorithm(const char *name, int size) {
+  uint64_t seed = 0x5eed, start_ns, sign_ns = 0, validate_ns = 0, replay_ns = 0;
+  unsigned long accepted = 0, replays_accepted = 0;
+  int round, i, length;
+
+  set_algorithm(name, NULL, (set_plugin_parameter_addon) { .pc = NULL });
+
+  for (round = 0; round < ROUNDS; round++) {
+    /* a new second, the replay cache forgets the previous round */
+    now_times += REPLAY_HOLD_TIME + MSEC_PER_SEC;
+    now.tv_sec++;
+
+    for (i = 0; i < PACKETS; i++) {
+      make_packet(&packets[i], &seed, size);
+    }
+
+    start_ns = bench_ns();
+    for (i = 0; i < PACKETS; i++) {
+      olsr_cnf->main_addr.v4.s_addr = htonl(0x0a020000 | (i % NEIGHBOURS));
+      add_signature(packets[i].data, &packets[i].size);
+    }
+    sign_ns += bench_ns() - start_ns;
+
+    start_ns = bench_ns();
+    for (i = 0; i < PACKETS; i++) {
+      length = packets[i].size;
+      accepted += secure_preprocessor((char *) packets[i].data, &bench_if, &olsr_cnf->main_addr, &length) != NULL;
+    }
+    validate_ns += bench_ns() - start_ns;
+
+    start_ns = bench_ns();
+    for (i = 0; i < PACKETS; i++) {
+      length = packets[i].size;
+      replays_accepted += secure_preprocessor((char *) packets[i].data, &bench_if, &olsr_cnf->main_addr, &length) != NULL;
+    }
+    replay_ns += bench_ns() - start_ns;
+  }
+
+  printf("  %-8s sign %7.1f ns, validate %7.1f ns (%6.0f kpackets/s), replay %5.1f ns, %lu/%d accepted, %lu replays accepted\n",
+      name, (double) sign_ns / (PACKETS * ROUNDS), (double) validate_ns / (PACKETS * ROUNDS),
+      (double) PACKETS * ROUNDS * 1e6 / validate_ns, (double) replay_ns / (PACKETS * ROUNDS), accepted, PACKETS * ROUNDS,
+      replays_accepted);
+}
+
+int main(void) {
+  unsigned int s, a;
+
+  bench_init(AF_INET);
+  bench_if.int_name = "bench0";
+  bench_if.if_index = 1;
+  bench_secure_init();
+  packets = olsr_malloc(PACKETS * sizeof(*packets), "bench packets");
+
+  for (s = 0; s < ARRAYSIZE(sizes); s++) {
+    printf("%d packets of %d bytes (%d signed) from %d neighbours, %d rounds\n", PACKETS, sizes[s],
+        sizes[s] + (int) sizeof(struct s_olsrmsg), NEIGHBOURS, ROUNDS);
+    for (a = 0; a < ARRAYSIZE(algorithms); a++) {
+      bench_algorithm(algorithms[a], sizes[s]);
+    }
+  }
+
+  secure_plugin_exit();
+  free(packets);
+  return 0;
+}
@@ -59,31 +59,33 @@
 #include <string.h> /* memset */
 #include <sys/types.h> /* u_int16_t, u_int32_t */
 #include <netinet/ip.h> /* struct iphdr */
-#include <stdlib.h> /* free() */
 
 /* OLSRD includes */
-#include "olsr.h" /* olsr_malloc */
-#include "scheduler.h" /* GET_TIMESTAMP, TIMED_OUT */
+#include "olsr.h" /* olsr_printf */
+#include "scheduler.h" /* now_times */
+#include "common/dupcache.h"
 
 /* Plugin includes */
 #include "Packet.h"
 
-static struct TDupEntry* PacketHistory[HISTORY_HASH_SIZE];
+static struct dupcache PacketHistory;
 
 #define CRC_UPTO_NBYTES 256
 
 /* -------------------------------------------------------------------------
  * Function   : GenerateCrc32Table
- * Description: Generate the table of CRC remainders for all possible bytes,
- *              according to CRC-32-IEEE 802.3
+ * Description: Generate the tables of CRC remainders for all possible bytes,
+ *              according to CRC-32-IEEE 802.3. CrcTable[0] is the classic
+ *              bytewise table, CrcTable[k] holds the remainder of a byte
+ *              followed by k zero bytes, for the slice-by-8 calculation.
  * Input      : none
  * Output     : none
  * Return     : none
- * Data Used  : none
+ * Data Used  : CrcTable
  * ------------------------------------------------------------------------- */
 #define CRC32_POLYNOMIAL 0xedb88320UL /* bit-inverse of 0x04c11db7UL */
 
-static unsigned long CrcTable[256];
+static u_int32_t CrcTable[8][256];
 
 static void GenerateCrc32Table(void)
 {
@@ -103,7 +105,17 @@ static void GenerateCrc32Table(void)
         crc = (crc >> 1);
       }
     }
-    CrcTable[i] = crc;
+    CrcTable[0][i] = crc;
+  } /* for */
+
+  for (i = 0; i < 256; i++)
+  {
+    crc = CrcTable[0][i];
+    for (j = 1; j < 8; j++)
+    {
+      crc = (crc >> 8) ^ CrcTable[0][crc & 0xFF];
+      CrcTable[j][i] = crc;
+    }
   } /* for */
 } /* GenerateCrc32Table */
 
@@ -114,16 +126,37 @@ static void GenerateCrc32Table(void)
  *              len - the number of bytes to calculate the CRC value over
  * Output     : none
  * Return     : CRC-32 value
- * Data Used  : none
+ * Data Used  : CrcTable
+ * Notes      : Processes 8 bytes per step (slice-by-8). The bytes are
+ *              combined one by one, so the result does not depend on the
+ *              byte order or alignment of the host. The value travels in
+ *              the BMF encapsulation header, which rules out the CRC-32C
+ *              instruction of SSE4.2: it uses a different polynomial.
  * ------------------------------------------------------------------------- */
 static u_int32_t CalcCrc32(unsigned char* buffer, ssize_t len)
 {
-  int i, j;
   u_int32_t crc = 0xffffffffUL;
-  for (i = 0; i < len; i++)
+
+  while (len >= 8)
   {
-    j = ((int) (crc & 0xFF) ^ *buffer++);
-    crc = (crc >> 8) ^ CrcTable[j];
+    crc ^= (u_int32_t) buffer[0] | ((u_int32_t) buffer[1] << 8) |
+      ((u_int32_t) buffer[2] << 16) | ((u_int32_t) buffer[3] << 24);
+    crc =
+      CrcTable[7][crc & 0xFF] ^
+      CrcTable[6][(crc >> 8) & 0xFF] ^
+      CrcTable[5][(crc >> 16) & 0xFF] ^
+      CrcTable[4][crc >> 24] ^
+      CrcTable[3][buffer[4]] ^
+      CrcTable[2][buffer[5]] ^
+      CrcTable[1][buffer[6]] ^
+      CrcTable[0][buffer[7]];
+    buffer += 8;
+    len -= 8;
+  }
+
+  while (len-- > 0)
+  {
+    crc = (crc >> 8) ^ CrcTable[0][(crc & 0xFF) ^ *buffer++];
   }
   return crc ^ 0xffffffffUL;
 } /* CalcCrc32 */
@@ -172,22 +205,9 @@ u_int32_t PacketCrc32(unsigned char* ipPacket, ssize_t len)
   return result;
 } /* PacketCrc32 */
 
-/* -------------------------------------------------------------------------
- * Function   : Hash
- * Description: Calculates a hash value from a 32-bit value
- * Input      : from32 - 32-bit value
- * Output     : none
- * Return     : hash value
- * Data Used  : none
- * ------------------------------------------------------------------------- */
-u_int32_t Hash(u_int32_t from32)
-{
-  return ((from32 >> N_HASH_BITS) + from32) & ((1u << N_HASH_BITS) - 1);
-} /* Hash */
-
 /* -------------------------------------------------------------------------
  * Function   : InitPacketHistory
- * Description: Initialize the packet history table and CRC-32 table
+ * Description: Initialize the packet history cache and CRC-32 tables
  * Input      : none
  * Output     : none
  * Return     : none
@@ -195,16 +215,27 @@ u_int32_t Hash(u_int32_t from32)
  * ------------------------------------------------------------------------- */
 void InitPacketHistory(void)
 {
-  unsigned int i;
-
   GenerateCrc32Table();
 
-  for(i = 0; i < HISTORY_HASH_SIZE; i++)
+  if (dupcache_init(&PacketHistory, "BMF packet history", sizeof(u_int32_t), HISTORY_HOLD_TIME, true) < 0)
   {
-    PacketHistory[i] = NULL;
+    olsr_printf(1, "BMF: could not initialize the packet history\n");
   }
 } /* InitPacketHistory */
 
+/* -------------------------------------------------------------------------
+ * Function   : ClosePacketHistory
+ * Description: Free the packet history cache
+ * Input      : none
+ * Output     : none
+ * Return     : none
+ * Data Used  : PacketHistory
+ * ------------------------------------------------------------------------- */
+void ClosePacketHistory(void)
+{
+  dupcache_free(&PacketHistory);
+} /* ClosePacketHistory */
+
 /* -------------------------------------------------------------------------
  * Function   : CheckAndMarkRecentPacket
  * Description: Check if this packet was seen recently, then record the fact
@@ -216,41 +247,10 @@ void InitPacketHistory(void)
  * ------------------------------------------------------------------------- */
 int CheckAndMarkRecentPacket(u_int32_t crc32)
 {
-  u_int32_t idx;
-  struct TDupEntry* walker;
-  struct TDupEntry* newEntry;
-
-  idx = Hash(crc32);
-  assert(idx < HISTORY_HASH_SIZE);
-
-  for (walker = PacketHistory[idx]; walker != NULL; walker = walker->next)
-  {
-    if (walker->crc32 == crc32)
-    {
-      /* Found duplicate entry */
-
-      /* Always mark as "seen recently": refresh time-out */
-      walker->timeOut = olsr_getTimestamp(HISTORY_HOLD_TIME);
-
-      return 1;
-    } /* if */
-  } /* for */
-
-  /* No duplicate entry found: create one */
-  newEntry = olsr_malloc(sizeof(struct TDupEntry), "BMF: TDupEntry");
-  if (newEntry != NULL)
-  {
-    newEntry->crc32 = crc32;
-    newEntry->timeOut = olsr_getTimestamp(HISTORY_HOLD_TIME);
-
-    /* Add new entry at the front of the list */
-    newEntry->next = PacketHistory[idx];
-    PacketHistory[idx] = newEntry;
-  }
-
-  return 0;
+  /* A hit refreshes the time-out: the packet is marked as "seen recently" */
+  return dupcache_seen(&PacketHistory, &crc32, now_times) ? 1 : 0;
 } /* CheckAndMarkRecentPacket */
-  
+
 /* -------------------------------------------------------------------------
  * Function   : PrunePacketHistory
  * Description: Prune the packet history table.
@@ -258,41 +258,10 @@ int CheckAndMarkRecentPacket(u_int32_t crc32)
  * Output     : none
  * Return     : none
  * Data Used  : PacketHistory
+ * Notes      : Expired entries are dropped a time slice at a time, so this
+ *              does not look at the entries that are still valid.
  * ------------------------------------------------------------------------- */
 void PrunePacketHistory(void* useless __attribute__((unused)))
 {
-  uint i;
-  for (i = 0; i < HISTORY_HASH_SIZE; i++)
-  {
-    if (PacketHistory[i] != NULL)
-    {
-      struct TDupEntry* nextEntry = PacketHistory[i];
-      struct TDupEntry* prevEntry = NULL;
-      while (nextEntry != NULL) 
-      {
-        struct TDupEntry* entry = nextEntry;
-        nextEntry = entry->next;
-
-        if (olsr_isTimedOut(entry->timeOut))
-        {
-          /* De-queue */
-          if (prevEntry != NULL)
-          {
-            prevEntry->next = entry->next;
-          }
-          else
-          {
-            PacketHistory[i] = entry->next;
-          } /* if */
-
-          /* De-allocate memory */
-          free(entry); 
-	      }
-	      else
-	      {
-	        prevEntry = entry;
-	      } /* if */
-      } /* while */
-    } /* if (PacketHistory[i] != NULL) */
-  } /* for (i = ...) */
+  dupcache_expire(&PacketHistory, now_times);
 } /* PrunePacketHistory */
@@ -132,6 +132,7 @@ int olsrd_plugin_init(void)
 void olsr_plugin_exit(void)
 {
   CloseBmf();
+  ClosePacketHistory();
 }
 
 static const struct olsrd_plugin_parameters plugin_parameters[] = {
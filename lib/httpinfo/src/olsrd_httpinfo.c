@@ -1061,29 +1061,26 @@ build_topo_body(struct autobuf *abuf)
 static void
 build_mid_body(struct autobuf *abuf)
 {
-  int idx;
+  struct mid_entry *entry;
   const char *colspan = resolve_ip_addresses ? " colspan=\"2\"" : "";
 
   section_title(abuf, "MID Entries");
   abuf_appendf(abuf, "<tr><th%s>Main Address</th><th>Aliases</th></tr>\n", colspan);
 
   /* MID */
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct mid_entry *entry;
-    for (entry = mid_set[idx].next; entry != &mid_set[idx]; entry = entry->next) {
-      int mid_cnt;
-      struct mid_address *alias;
-      abuf_puts(abuf, "<tr>");
-      build_ipaddr_with_link(abuf, &entry->main_addr, -1);
-      abuf_puts(abuf, "<td><select>\n<option>IP ADDRESS</option>\n");
-
-      for (mid_cnt = 0, alias = entry->aliases; alias != NULL; alias = alias->next_alias, mid_cnt++) {
-        struct ipaddr_str strbuf;
-        abuf_appendf(abuf, "<option>%s</option>\n", olsr_ip_to_string(&strbuf, &alias->alias));
-      }
-      abuf_appendf(abuf, "</select> (%d)</td></tr>\n", mid_cnt);
+  OLSR_FOR_ALL_MID_ENTRIES(entry) {
+    int mid_cnt;
+    struct mid_address *alias;
+    abuf_puts(abuf, "<tr>");
+    build_ipaddr_with_link(abuf, &entry->main_addr, -1);
+    abuf_puts(abuf, "<td><select>\n<option>IP ADDRESS</option>\n");
+
+    for (mid_cnt = 0, alias = entry->aliases; alias != NULL; alias = alias->next_alias, mid_cnt++) {
+      struct ipaddr_str strbuf;
+      abuf_appendf(abuf, "<option>%s</option>\n", olsr_ip_to_string(&strbuf, &alias->alias));
     }
-  }
+    abuf_appendf(abuf, "</select> (%d)</td></tr>\n", mid_cnt);
+  } OLSR_FOR_ALL_MID_ENTRIES_END(entry);
 
   abuf_puts(abuf, "</table>\n");
 }
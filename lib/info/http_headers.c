@@ -57,7 +57,7 @@ void http_header_build_result(unsigned int status, struct autobuf *abuf) {
   abuf_puts(abuf, "\r\n");
 }
 
-void http_header_build(const char *plugin_name, unsigned int status, const char *mime, struct autobuf *abuf, int *contentLengthIndex) {
+void http_header_build(const char *plugin_name, unsigned int status, const char *mime, const char *etag, bool keep_alive, bool chunked, struct autobuf *abuf, int *contentLengthIndex) {
   assert(plugin_name);
   assert(abuf);
   assert(contentLengthIndex);
@@ -80,7 +80,7 @@ void http_header_build(const char *plugin_name, unsigned int status, const char
   abuf_appendf(abuf, "Server: OLSRD %s\r\n", plugin_name);
 
   /* connection-type */
-  abuf_puts(abuf, "Connection: close\r\n");
+  abuf_puts(abuf, keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
 
   /* MIME type */
   if (mime != NULL) {
@@ -94,11 +94,23 @@ void http_header_build(const char *plugin_name, unsigned int status, const char
   abuf_puts(abuf, "Access-Control-Allow-Headers: Accept, Origin, X-Requested-With\r\n");
   abuf_puts(abuf, "Access-Control-Max-Age: 1728000\r\n");
 
-  /* Content length */
-  abuf_puts(abuf, "Content-Length: ");
-  *contentLengthIndex = abuf->len;
-  abuf_puts(abuf, "            "); /* 12 spaces reserved for the length (max. 1TB-1), to be filled at the end */
-  abuf_puts(abuf, "\r\n");
+  /* Content length, a 304 reply has no body and a chunked body carries its own length */
+  if (chunked) {
+    abuf_puts(abuf, "Transfer-Encoding: chunked\r\n");
+    *contentLengthIndex = -1;
+  } else if (status != INFO_HTTP_NOT_MODIFIED) {
+    abuf_puts(abuf, "Content-Length: ");
+    *contentLengthIndex = abuf->len;
+    abuf_puts(abuf, "            "); /* 12 spaces reserved for the length (max. 1TB-1), to be filled at the end */
+    abuf_puts(abuf, "\r\n");
+  } else {
+    *contentLengthIndex = -1;
+  }
+
+  /* Entity tag, to validate cached replies with */
+  if (etag && *etag) {
+    abuf_appendf(abuf, "ETag: %s\r\n", etag);
+  }
 
   /* Cache-control
    * No caching dynamic pages
@@ -114,6 +126,11 @@ void http_header_adjust_content_length(struct autobuf *abuf, int contentLengthIn
 
   assert(abuf);
 
+  if (contentLengthIndex < 0) {
+    /* there is no Content-Length header */
+    return;
+  }
+
   memset(buf, 0, sizeof(buf));
   snprintf(buf, sizeof(buf), "%d", contentLength);
   buf[sizeof(buf) - 1] = '\0';
@@ -46,6 +46,8 @@
 #ifndef _OLSRD_LIB_INFO_HTTP_HEADERS_H_
 #define _OLSRD_LIB_INFO_HTTP_HEADERS_H_
 
+#include <stdbool.h>
+
 #include "common/autobuf.h"
 
 #define INFO_HTTP_VERSION "HTTP/1.1"
@@ -53,6 +55,7 @@
 /* Response types */
 #define INFO_HTTP_OK                       (200)
 #define INFO_HTTP_NOCONTENT                (204)
+#define INFO_HTTP_NOT_MODIFIED             (304)
 #define INFO_HTTP_FORBIDDEN                (403)
 #define INFO_HTTP_NOTFOUND                 (404)
 #define INFO_HTTP_REQUEST_TIMEOUT          (408)
@@ -62,7 +65,7 @@
 
 void http_header_build_result(unsigned int status, struct autobuf *abuf);
 
-void http_header_build(const char * plugin_name, unsigned int status, const char *mime, struct autobuf *abuf, int *contentLengthIndex);
+void http_header_build(const char * plugin_name, unsigned int status, const char *mime, const char *etag, bool keep_alive, bool chunked, struct autobuf *abuf, int *contentLengthIndex);
 
 void http_header_adjust_content_length(struct autobuf *abuf, int contentLengthIndex, int contentLength);
 
@@ -71,6 +74,9 @@ static INLINE const char * httpStatusToReply(unsigned int status) {
     case INFO_HTTP_NOCONTENT:
       return "204 No Content";
 
+    case INFO_HTTP_NOT_MODIFIED:
+      return "304 Not Modified";
+
     case INFO_HTTP_FORBIDDEN:
       return "403 Forbidden";
 
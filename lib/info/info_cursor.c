@@ -0,0 +1,259 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#include "info_cursor.h"
+
+#include <string.h>
+
+#include "ipcalc.h"
+#include "routing_table.h"
+#include "tc_set.h"
+
+#define HASH_NEXT(table, elem) (*(char **)(void *)((char *)(elem) + (table)->next_offset))
+#define HASH_PREV(table, elem) (*(char **)(void *)((char *)(elem) + (table)->prev_offset))
+#define HASH_KEY(table, elem) ((union olsr_ip_addr *)(void *)((char *)(elem) + (table)->key_offset))
+
+/**
+ * @param cursor the cursor
+ * @return the first route to print on a page
+ */
+struct rt_entry * info_cursor_rt(struct info_cursor *cursor) {
+  if (!cursor->paused) {
+    return rt_tree2rt(avl_walk_first(&routingtree));
+  }
+
+  return rt_tree2rt(avl_find_greaterequal(&routingtree, &cursor->key));
+}
+
+struct rt_entry * info_cursor_rt_next(struct rt_entry *rt) {
+  return rt_tree2rt(avl_walk_next(&rt->rt_tree_node));
+}
+
+/**
+ * End a page before a route.
+ *
+ * @param cursor the cursor
+ * @param rt the route the next page starts with
+ */
+void info_cursor_rt_suspend(struct info_cursor *cursor, struct rt_entry *rt) {
+  cursor->key = rt->rt_dst;
+  cursor->paused = true;
+}
+
+/**
+ * @param tc a topology entry, or NULL
+ * @return the first edge of tc, or of the entries after it when it has none
+ */
+static struct tc_edge_entry * tc_first_edge(struct tc_entry *tc) {
+  for (; tc; tc = vertex_tree2tc(avl_walk_next(&tc->vertex_node))) {
+    struct avl_node *node = avl_walk_first(&tc->edge_tree);
+    if (node) {
+      return edge_tree2tc_edge(node);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @param cursor the cursor
+ * @return the first topology edge to print on a page
+ */
+struct tc_edge_entry * info_cursor_tc_edge(struct info_cursor *cursor) {
+  struct tc_entry *tc;
+
+  if (!cursor->paused) {
+    return tc_first_edge(vertex_tree2tc(avl_walk_first(&tc_tree)));
+  }
+
+  tc = vertex_tree2tc(avl_find_greaterequal(&tc_tree, &cursor->key.prefix));
+  if (tc && ipequal(&tc->addr, &cursor->key.prefix)) {
+    struct avl_node *node = avl_find_greaterequal(&tc->edge_tree, &cursor->key2);
+    if (node) {
+      return edge_tree2tc_edge(node);
+    }
+
+    tc = vertex_tree2tc(avl_walk_next(&tc->vertex_node));
+  }
+
+  return tc_first_edge(tc);
+}
+
+struct tc_edge_entry * info_cursor_tc_edge_next(struct tc_edge_entry *tc_edge) {
+  struct avl_node *node = avl_walk_next(&tc_edge->edge_node);
+
+  if (node) {
+    return edge_tree2tc_edge(node);
+  }
+
+  return tc_first_edge(vertex_tree2tc(avl_walk_next(&tc_edge->tc->vertex_node)));
+}
+
+/**
+ * End a page before a topology edge.
+ *
+ * @param cursor the cursor
+ * @param tc_edge the edge the next page starts with
+ */
+void info_cursor_tc_edge_suspend(struct info_cursor *cursor, struct tc_edge_entry *tc_edge) {
+  memset(&cursor->key, 0, sizeof(cursor->key));
+  cursor->key.prefix = tc_edge->tc->addr;
+  cursor->key2 = tc_edge->T_dest_addr;
+  cursor->paused = true;
+}
+
+/**
+ * @param cursor the cursor, its bucket is set to the bucket of the element
+ * @param table the hash table
+ * @param idx the bucket to start at
+ * @return the first element in the buckets from idx on
+ */
+static void * hash_first_from(struct info_cursor *cursor, struct olsr_hashtable *table, uint32_t idx) {
+  for (; idx < olsr_hashtable_buckets(table); idx++) {
+    char *head = olsr_hashtable_bucket(table, idx);
+    if (HASH_NEXT(table, head) != head) {
+      cursor->bucket = idx;
+      return HASH_NEXT(table, head);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @param table the hash table
+ * @param head the sentinel of a bucket
+ * @param key an address
+ * @return the element with the address in the bucket, NULL when there is none
+ */
+static char * hash_find(struct olsr_hashtable *table, char *head, union olsr_ip_addr *key) {
+  char *elem;
+
+  for (elem = HASH_NEXT(table, head); elem != head; elem = HASH_NEXT(table, elem)) {
+    if (ipequal(HASH_KEY(table, elem), key)) {
+      return elem;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Hash tables are resumed at the bucket and the address of the next
+ * element, or after the element before it when it was removed meanwhile.
+ * Only when both were removed the rest of their bucket is skipped. When
+ * the table was resized meanwhile the buckets are not the same anymore,
+ * the walk then ends: the rest of the table is not printed.
+ *
+ * @param cursor the cursor
+ * @param table the hash table
+ * @return the first element to print on a page
+ */
+void * info_cursor_hash(struct info_cursor *cursor, struct olsr_hashtable *table) {
+  char *head;
+  char *elem;
+
+  if (!cursor->paused) {
+    return hash_first_from(cursor, table, 0);
+  }
+
+  if ((cursor->size != table->size) //
+      || (cursor->rehashing != (table->old_buckets != NULL)) //
+      || (cursor->rehashing && (cursor->rehash_pos != table->rehash_pos)) //
+      || (cursor->bucket >= olsr_hashtable_buckets(table))) {
+    return NULL;
+  }
+
+  head = olsr_hashtable_bucket(table, cursor->bucket);
+  elem = hash_find(table, head, &cursor->key.prefix);
+  if (elem) {
+    return elem;
+  }
+
+  if (!cursor->bucket_started) {
+    /* nothing of the bucket is printed yet */
+    return hash_first_from(cursor, table, cursor->bucket);
+  }
+
+  elem = hash_find(table, head, &cursor->key2);
+  if (elem && (HASH_NEXT(table, elem) != head)) {
+    return HASH_NEXT(table, elem);
+  }
+
+  return hash_first_from(cursor, table, cursor->bucket + 1);
+}
+
+void * info_cursor_hash_next(struct info_cursor *cursor, struct olsr_hashtable *table, void *elem) {
+  char *head = olsr_hashtable_bucket(table, cursor->bucket);
+  char *next = HASH_NEXT(table, elem);
+
+  if (next != head) {
+    return next;
+  }
+
+  return hash_first_from(cursor, table, cursor->bucket + 1);
+}
+
+/**
+ * End a page before an element of a hash table.
+ *
+ * @param cursor the cursor
+ * @param table the hash table
+ * @param elem the element the next page starts with
+ */
+void info_cursor_hash_suspend(struct info_cursor *cursor, struct olsr_hashtable *table, void *elem) {
+  char *prev = HASH_PREV(table, elem);
+
+  memset(&cursor->key, 0, sizeof(cursor->key));
+  cursor->key.prefix = *HASH_KEY(table, elem);
+  cursor->bucket_started = prev != olsr_hashtable_bucket(table, cursor->bucket);
+  if (cursor->bucket_started) {
+    cursor->key2 = *HASH_KEY(table, prev);
+  }
+  cursor->size = table->size;
+  cursor->rehashing = table->old_buckets != NULL;
+  cursor->rehash_pos = table->rehash_pos;
+  cursor->paused = true;
+}
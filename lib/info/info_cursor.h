@@ -0,0 +1,112 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#ifndef _OLSRD_LIB_INFO_INFO_CURSOR_H_
+#define _OLSRD_LIB_INFO_INFO_CURSOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "olsr_types.h"
+#include "hashing.h"
+#include "json_helpers.h"
+
+struct rt_entry;
+struct tc_edge_entry;
+
+/*
+ * The position of a paged printer in the table it prints. A section is
+ * printed in pages: the printer stops before the row that would start
+ * beyond its budget and remembers the key of that row. The next page
+ * resumes at that key, so entries that were added or removed in between
+ * are printed or not, but no entry is printed twice. Zero it to start.
+ */
+struct info_cursor {
+    bool started; /* the start of the section is printed */
+    bool paused; /* a page ended, the next one resumes at the key below */
+    bool done; /* the end of the section is printed */
+
+    /* the key of the next row */
+    struct olsr_ip_prefix key;
+    union olsr_ip_addr key2; /* the destination of a topology edge, or the row before key in its bucket */
+
+    /* hash tables: the bucket of the next row, and the layout of the table */
+    uint32_t bucket;
+    bool bucket_started; /* rows of that bucket are printed */
+    uint32_t size;
+    uint32_t rehash_pos;
+    bool rehashing;
+
+    /* the state of a JSON printer between pages */
+    struct json_session json;
+};
+
+/**
+ * Print a complete section with its paged printer.
+ *
+ * @param printer the paged printer of the section
+ * @param abuf the buffer to print into
+ */
+static INLINE void info_cursor_print_all(void (*printer)(struct autobuf *abuf, struct info_cursor *cursor, size_t budget), struct autobuf *abuf) {
+  struct info_cursor cursor;
+
+  memset(&cursor, 0, sizeof(cursor));
+  printer(abuf, &cursor, SIZE_MAX);
+}
+
+struct rt_entry * info_cursor_rt(struct info_cursor *cursor);
+struct rt_entry * info_cursor_rt_next(struct rt_entry *rt);
+void info_cursor_rt_suspend(struct info_cursor *cursor, struct rt_entry *rt);
+
+struct tc_edge_entry * info_cursor_tc_edge(struct info_cursor *cursor);
+struct tc_edge_entry * info_cursor_tc_edge_next(struct tc_edge_entry *tc_edge);
+void info_cursor_tc_edge_suspend(struct info_cursor *cursor, struct tc_edge_entry *tc_edge);
+
+void * info_cursor_hash(struct info_cursor *cursor, struct olsr_hashtable *table);
+void * info_cursor_hash_next(struct info_cursor *cursor, struct olsr_hashtable *table, void *elem);
+void info_cursor_hash_suspend(struct info_cursor *cursor, struct olsr_hashtable *table, void *elem);
+
+#endif /* _OLSRD_LIB_INFO_INFO_CURSOR_H_ */
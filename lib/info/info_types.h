@@ -53,7 +53,9 @@
 #include "common/autobuf.h"
 
 #define CACHE_TIMEOUT_DEFAULT 1000
-#define REQUEST_TIMEOUT_DEFAULT 20
+#define REQUEST_TIMEOUT_DEFAULT 1000
+#define KEEP_ALIVE_TIMEOUT_DEFAULT 5000
+#define MAX_CLIENTS_DEFAULT 8
 
 typedef struct {
     union olsr_ip_addr accept_ip;
@@ -64,8 +66,8 @@ typedef struct {
     bool ipv6_only;
     long cache_timeout;
     long request_timeout;
-    long request_timeout_sec; /* derived */
-    long request_timeout_usec; /* derived */
+    long keep_alive_timeout;
+    int max_clients;
 } info_plugin_config_t;
 
 #define INFO_PLUGIN_CONFIG_PLUGIN_PARAMETERS(config) \
@@ -76,7 +78,9 @@ typedef struct {
   { .name = "allowlocalhost", .set_plugin_parameter = &set_plugin_boolean, .data = &config.allow_localhost }, \
   { .name = "ipv6only", .set_plugin_parameter = &set_plugin_boolean, .data = &config.ipv6_only },\
   { .name = "cachetimeout", .set_plugin_parameter = &set_plugin_long, .data = &config.cache_timeout },\
-  { .name = "requesttimeout", .set_plugin_parameter = &set_plugin_long, .data = &config.request_timeout }
+  { .name = "requesttimeout", .set_plugin_parameter = &set_plugin_long, .data = &config.request_timeout }, \
+  { .name = "keepalivetimeout", .set_plugin_parameter = &set_plugin_long, .data = &config.keep_alive_timeout }, \
+  { .name = "maxclients", .set_plugin_parameter = &set_plugin_int, .data = &config.max_clients }
 
 /* these provide all of the runtime status info */
 #define SIW_NEIGHBORS                    (1ULL <<  0)
@@ -120,8 +124,13 @@ typedef struct {
 #define SIW_POPROUTING_TC_MULT           (1ULL << 23)
 #define SIW_POPROUTING                   (SIW_POPROUTING_HELLO | SIW_POPROUTING_TC | SIW_POPROUTING_HELLO_MULT | SIW_POPROUTING_TC_MULT)
 
+/* these provide internal statistics of olsrd */
+#define SIW_COOKIES                      (1ULL << 24)
+#define SIW_PARSER                       (1ULL << 25)
+#define SIW_STATISTICS                   (SIW_COOKIES | SIW_PARSER)
+
 /* everything */
-#define SIW_EVERYTHING                   ((SIW_POPROUTING_TC_MULT << 1) - 1)
+#define SIW_EVERYTHING                   ((SIW_PARSER << 1) - 1)
 
 /* command prefixes */
 #define SIW_PREFIX_HTTP                  "/http"
@@ -138,6 +147,11 @@ typedef void (*output_start_end)(struct autobuf *abuf);
 typedef void (*printer_error)(struct autobuf *abuf, unsigned int status, const char * req, bool http_headers);
 typedef void (*printer_generic)(struct autobuf *abuf);
 
+struct info_cursor;
+
+/* prints a section from the position of the cursor on, until the buffer holds budget bytes */
+typedef void (*printer_paged)(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
+
 typedef struct {
     bool supportsCompositeCommands;
     init_plugin init;
@@ -158,6 +172,12 @@ typedef struct {
     printer_generic sgw;
     printer_generic pudPosition;
 
+    /* optional, for the sections that can be large: print them in pages */
+    printer_paged routesPaged;
+    printer_paged topologyPaged;
+    printer_paged hnaPaged;
+    printer_paged midPaged;
+
     printer_generic version;
     printer_generic olsrd_conf;
     printer_generic interfaces;
@@ -175,11 +195,22 @@ typedef struct {
     printer_generic helloTimer;
     printer_generic tcTimerMult;
     printer_generic helloTimerMult;
+
+    printer_generic cookies;
+    printer_generic parser;
 } info_plugin_functions_t;
 
+/* a reference counted buffer, shared by the cache and the replies that are streamed from it */
+struct info_blob {
+    unsigned int refcount;
+    struct autobuf buf;
+};
+
 struct info_cache_entry_t {
     long long timestamp;
-    struct autobuf buf;
+    unsigned long long generation; /* of the core data the entry was rendered from */
+    unsigned int renders; /* the number of times the entry was rendered */
+    struct info_blob *blob;
 };
 
 struct info_cache_t {
@@ -315,6 +346,8 @@ static INLINE void info_plugin_config_init(info_plugin_config_t *config, unsigne
   config->ipv6_only = false;
   config->cache_timeout = CACHE_TIMEOUT_DEFAULT;
   config->request_timeout = REQUEST_TIMEOUT_DEFAULT;
+  config->keep_alive_timeout = KEEP_ALIVE_TIMEOUT_DEFAULT;
+  config->max_clients = MAX_CLIENTS_DEFAULT;
 }
 
 #endif /* _OLSRD_LIB_INFO_INFO_TYPES_H_ */
@@ -48,39 +48,123 @@
 #include <assert.h>
 #include <ctype.h>
 #include <stdbool.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#endif /* _WIN32 */
 
 #include "olsrd_info.h"
 #include "olsr.h"
+#include "routing_table.h"
+#include "common/list.h"
 #include "scheduler.h"
 #include "ipcalc.h"
 #include "http_headers.h"
+#include "info_cursor.h"
 
 #ifdef _WIN32
 #define close(x) closesocket(x)
 #endif /* _WIN32 */
 
-#define MAX_CLIENTS 8
+/* the maximum length of a request line, and of any HTTP header line */
+#define REQUEST_BUFFER_SIZE 1024
+
+/* the time (in milliseconds) a reply may make no progress before it is abandoned */
+#define WRITE_STALL_TIMEOUT 30000
+
+/* the maximum length of an entity tag, including its terminating byte */
+#define ETAG_SIZE 64
+
+/* the size of the ring through which a reply body is streamed */
+#define STREAM_RING_SIZE 16384
+
+/* the room for the framing of a chunk: its length (in hex) and two line terminators */
+#define CHUNK_OVERHEAD 16
+
+typedef struct {
+  unsigned long long siw;
+  printer_generic func;
+  printer_paged paged; /* prints the section in pages, when set */
+} SiwLookupTableEntry;
 
 /*
- * There is the problem that writing to a network socket can block,
- * and the olsrd scheduler does not care about write events.
+ * Every accepted connection is a small state machine that is driven by
+ * the olsrd scheduler: it is registered as a (pollrate) socket, the
+ * socket is polled for reading while a request is being received and
+ * for writing while the reply is being sent. Nothing ever blocks, so
+ * slow or many clients can not delay the routing work of olsrd.
  *
- * There was a case that olsrd just froze for minutes when people used
- * jsoninfo/txtinfo with large topologies over bad WiFi.
+ * HTTP/1.1 (and HTTP/1.0 keep-alive) connections are kept open after
+ * the reply, and pipelined requests are answered in order.
  *
- * This is the solution that was chosen at that time, unwilling to
- * rewrite the whole scheduler:
- * A timer was added and each time it expires each non-empty buffer
- * in this structure will try to write data into a "non-blocking"
- * socket until all data is sent, so that no blocking occurs.
+ * Replies in the normal, netjson and poprouting formats are streamed to
+ * HTTP/1.1 and plain clients: the sections are rendered one at a time,
+ * when the ring of the connection has drained, and are sent to HTTP/1.1
+ * clients with chunked transfer encoding. A connection then holds no
+ * more than its ring and references to the rendered sections, which are
+ * shared with the cache. Sections with a paged printer (the tables that
+ * grow with the network) are not rendered completely when they are not
+ * cached: they are rendered a page of about the size of the ring at a
+ * time, resuming the walk of their table at the cursor of the
+ * connection. Other replies are built completely first.
  */
-typedef struct {
-  int socket[MAX_CLIENTS];
-  char *buffer[MAX_CLIENTS];
-  size_t size[MAX_CLIENTS];
-  size_t written[MAX_CLIENTS];
-  int count;
-} info_plugin_outbuffer_t;
+typedef enum {
+  INFO_CONNECTION_REQUEST, /* waiting for a request line */
+  INFO_CONNECTION_HEADERS, /* reading the headers of an HTTP request */
+  INFO_CONNECTION_REPLY /* sending a reply */
+} info_connection_state_t;
+
+struct info_connection {
+  struct list_node node;
+  int socket;
+  bool host_denied;
+  info_connection_state_t state;
+  struct timer_entry *timer;
+
+  /* number of requests that were answered on this connection */
+  unsigned int requests;
+
+  /* the peer will not send any more data */
+  bool eof;
+
+  /* received data that has not been processed yet */
+  char rx[REQUEST_BUFFER_SIZE];
+  size_t rx_len;
+
+  /* the (sanitised) request that is being received */
+  char request_buffer[REQUEST_BUFFER_SIZE];
+  char *req;
+  size_t req_len;
+  bool add_headers;
+  bool http11;
+  bool keep_alive;
+  char if_none_match[REQUEST_BUFFER_SIZE];
+
+  /* the reply (or the headers of a streamed reply) that is being sent */
+  struct autobuf reply;
+  size_t written;
+
+  /* the body of a streamed reply */
+  bool streaming; /* there are more parts to queue */
+  bool chunked;
+  bool stream_end; /* the output end is queued */
+  SiwLookupTableEntry *stream_funcs;
+  unsigned int stream_funcs_size;
+  unsigned int stream_index;
+  unsigned int stream_what;
+  struct info_blob *stream_part; /* the part that is being queued */
+  size_t stream_offset;
+  struct info_blob *stream_next; /* the part to queue after that */
+  printer_paged stream_pager; /* renders the pages of the current section, NULL when it is rendered completely */
+  struct info_cursor stream_cursor;
+  char ring[STREAM_RING_SIZE];
+  size_t ring_start;
+  size_t ring_len;
+
+  /* the socket events that are polled for */
+  unsigned int poll_flags;
+};
+
+LISTNODE2STRUCT(list2connection, struct info_connection, node);
 
 static const char * name;
 
@@ -90,12 +174,23 @@ static info_plugin_config_t *config = NULL;
 
 static int ipc_socket = -1;
 
-static info_plugin_outbuffer_t outbuffer;
+static struct list_node connections;
 
-static struct timer_entry *writetimer_entry = NULL;
+static int connection_count = 0;
 
 static struct info_cache_t info_cache;
 
+/* makes the entity tags of different olsrd runs differ */
+static unsigned long etag_salt = 0;
+
+/* the sections of the different output formats, in output order */
+static SiwLookupTableEntry funcsNormal[16];
+static SiwLookupTableEntry funcsNetjson[5];
+static SiwLookupTableEntry funcsPoprouting[4];
+
+/* receives the output of the output_start and output_end calls that only set up the printers */
+static struct autobuf stream_scratch;
+
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
 static char * skipMultipleSlashes(char * requ, size_t* len) {
@@ -153,7 +248,10 @@ static unsigned long long SIW_ENTRIES_ALL[] = {
     SIW_POPROUTING_HELLO,
     SIW_POPROUTING_TC, //
     SIW_POPROUTING_HELLO_MULT,
-    SIW_POPROUTING_TC_MULT //
+    SIW_POPROUTING_TC_MULT, //
+    //
+    SIW_COOKIES, //
+    SIW_PARSER //
     };
 
 long cache_timeout_generic(info_plugin_config_t *plugin_config, unsigned long long siw) {
@@ -193,6 +291,26 @@ long cache_timeout_generic(info_plugin_config_t *plugin_config, unsigned long lo
   }
 }
 
+static struct info_blob * info_blob_new(void) {
+  struct info_blob *blob = olsr_malloc(sizeof(*blob), "info blob");
+
+  blob->refcount = 1;
+  abuf_init(&blob->buf, AUTOBUFCHUNK);
+  return blob;
+}
+
+static INLINE struct info_blob * info_blob_get(struct info_blob *blob) {
+  blob->refcount++;
+  return blob;
+}
+
+static void info_blob_put(struct info_blob *blob) {
+  if (blob && !--blob->refcount) {
+    abuf_free(&blob->buf);
+    free(blob);
+  }
+}
+
 static void info_plugin_cache_init(bool init) {
   unsigned int i;
 
@@ -209,28 +327,129 @@ static void info_plugin_cache_init(bool init) {
 
     if (init) {
       entry->timestamp = 0;
-      abuf_init(&entry->buf, 0);
+      entry->generation = 0;
+      entry->renders = 0;
+      entry->blob = NULL;
     } else {
-      abuf_free(&entry->buf);
+      info_blob_put(entry->blob);
+      entry->blob = NULL;
       entry->timestamp = 0;
     }
   }
 }
 
-static INLINE void info_plugin_cache_init_entry(struct info_cache_entry_t * entry) {
-  if (!entry->buf.buf) {
-    entry->timestamp = 0;
-    abuf_init(&entry->buf, AUTOBUFCHUNK);
-    assert(!entry->timestamp);
-    assert(!entry->buf.len);
-    assert(entry->buf.size == AUTOBUFCHUNK);
-    assert(entry->buf.buf);
+/**
+ * Determine the generation of the core data that a section is rendered
+ * from. The generation changes only when that data changes.
+ *
+ * @param siw the section
+ * @param generation (out) the generation
+ * @return false when the section is not tracked by generation, its cache
+ * entry then expires after the cache timeout
+ */
+static bool info_cache_generation(unsigned long long siw, unsigned long long *generation) {
+  unsigned long long links = olsr_generations[OLSR_GEN_LINKS];
+  unsigned long long neighbors = olsr_generations[OLSR_GEN_NEIGHBORS];
+  unsigned long long topology = olsr_generations[OLSR_GEN_TOPOLOGY];
+  unsigned long long hna = olsr_generations[OLSR_GEN_HNA];
+  unsigned long long mid = olsr_generations[OLSR_GEN_MID];
+  unsigned long long routes = routingtree_version;
+
+  /* all counters only ever increase, so does their sum */
+  switch (siw) {
+    case SIW_NEIGHBORS:
+    case SIW_2HOP:
+      /* includes the link counts */
+      *generation = neighbors + links;
+      return true;
+
+    case SIW_LINKS:
+      *generation = links;
+      return true;
+
+    case SIW_ROUTES:
+    case SIW_NETJSON_NETWORK_ROUTES:
+      *generation = routes;
+      return true;
+
+    case SIW_HNA:
+      *generation = hna;
+      return true;
+
+    case SIW_MID:
+      *generation = mid;
+      return true;
+
+    case SIW_TOPOLOGY:
+      /* includes the path costs and hop counts of the routing tree */
+      *generation = topology + routes;
+      return true;
+
+    case SIW_NETJSON_NETWORK_GRAPH:
+      *generation = links + neighbors + topology + mid;
+      return true;
+
+    case SIW_NETJSON_NETWORK_COLLECTION:
+      *generation = links + neighbors + topology + mid + routes;
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * Determine whether a section prints times relative to now (validity,
+ * hello or loss timers). Such a section goes stale after the cache
+ * timeout even when its data did not change.
+ *
+ * @param siw the section
+ * @return true when the section prints relative times
+ */
+static bool info_cache_timed(unsigned long long siw) {
+  return (siw & (SIW_LINKS | SIW_TOPOLOGY | SIW_HNA | SIW_MID)) != 0;
+}
+
+/**
+ * Lookup the cache entry of a section and determine whether it must be
+ * (re-)rendered before it is used.
+ *
+ * @param siw the section
+ * @param now the current time
+ * @param stale (out) true when the entry must be rendered
+ * @param generation (out) the generation to store in the entry when it
+ * is rendered
+ * @return the cache entry, or NULL when the section is not cached
+ */
+static struct info_cache_entry_t * info_cache_lookup(unsigned long long siw, long long now, bool *stale, unsigned long long *generation) {
+  struct info_cache_entry_t *entry;
+  long cache_timeout;
+  bool tracked;
+
+  if (!functions->cache_timeout) {
+    return NULL;
+  }
+
+  cache_timeout = functions->cache_timeout(config, siw);
+  entry = (cache_timeout <= 0) ? NULL : info_cache_get_entry(&info_cache, siw);
+  if (!entry) {
+    return NULL;
+  }
+
+  *generation = 0;
+  tracked = info_cache_generation(siw, generation);
+
+  if (!entry->timestamp) {
+    /* never rendered before */
+    *stale = true;
+  } else if (tracked) {
+    /* re-render when the data changed, or when the printed timers ran on */
+    *stale = (*generation != entry->generation) || (info_cache_timed(siw) && (llabs(now - entry->timestamp) >= cache_timeout));
   } else {
-    assert(entry->timestamp >= 0);
-    assert(entry->buf.len >= 0);
-    assert(entry->buf.size >= AUTOBUFCHUNK);
-    assert(entry->buf.buf);
+    *stale = (llabs(now - entry->timestamp) >= cache_timeout);
   }
+
+  return entry;
 }
 
 static unsigned int determine_single_action(char *requ) {
@@ -340,93 +559,190 @@ static void send_status_no_retries(const char * req, bool add_headers, int the_s
   abuf_free(&abuf);
 }
 
-static void write_data(void *unused __attribute__((unused))) {
-  fd_set set;
-  int result, i, max;
-  struct timeval tv;
+static void info_plugin_tables_init(void) {
+  SiwLookupTableEntry normal[] = {
+    { SIW_NEIGHBORS   , functions->neighbors   , NULL                     }, //
+    { SIW_LINKS       , functions->links       , NULL                     }, //
+    { SIW_ROUTES      , functions->routes      , functions->routesPaged   }, //
+    { SIW_HNA         , functions->hna         , functions->hnaPaged      }, //
+    { SIW_MID         , functions->mid         , functions->midPaged      }, //
+    { SIW_TOPOLOGY    , functions->topology    , functions->topologyPaged }, //
+    { SIW_GATEWAYS    , functions->gateways    , NULL                     }, //
+    { SIW_INTERFACES  , functions->interfaces  , NULL                     }, //
+    { SIW_2HOP        , functions->twohop      , NULL                     }, //
+    { SIW_SGW         , functions->sgw         , NULL                     }, //
+    { SIW_PUD_POSITION, functions->pudPosition , NULL                     }, //
+    //
+    { SIW_VERSION     , functions->version     , NULL                     }, //
+    { SIW_CONFIG      , functions->config      , NULL                     }, //
+    { SIW_PLUGINS     , functions->plugins     , NULL                     }, //
+    //
+    { SIW_COOKIES     , functions->cookies     , NULL                     }, //
+    { SIW_PARSER      , functions->parser      , NULL                     } //
+  };
+  SiwLookupTableEntry netjson[] = {
+    { SIW_NETJSON_NETWORK_ROUTES      , functions->networkRoutes      , NULL }, //
+    { SIW_NETJSON_NETWORK_GRAPH       , functions->networkGraph       , NULL }, //
+    { SIW_NETJSON_DEVICE_CONFIGURATION, functions->deviceConfiguration, NULL }, //
+    { SIW_NETJSON_DEVICE_MONITORING   , functions->deviceMonitoring   , NULL }, //
+    { SIW_NETJSON_NETWORK_COLLECTION  , functions->networkCollection  , NULL } //
+  };
+  SiwLookupTableEntry poprouting[] = {
+    { SIW_POPROUTING_TC               , functions->tcTimer           , NULL }, //
+    { SIW_POPROUTING_HELLO            , functions->helloTimer        , NULL }, //
+    { SIW_POPROUTING_TC_MULT          , functions->tcTimerMult       , NULL }, //
+    { SIW_POPROUTING_HELLO_MULT       , functions->helloTimerMult    , NULL } //
+  };
+
+  assert(sizeof(normal) == sizeof(funcsNormal));
+  assert(sizeof(netjson) == sizeof(funcsNetjson));
+  assert(sizeof(poprouting) == sizeof(funcsPoprouting));
+
+  memcpy(funcsNormal, normal, sizeof(funcsNormal));
+  memcpy(funcsNetjson, netjson, sizeof(funcsNetjson));
+  memcpy(funcsPoprouting, poprouting, sizeof(funcsPoprouting));
+}
 
-  if (outbuffer.count <= 0) {
-    /* exit early if there is nothing to send */
-    return;
+/**
+ * Determine the sections that can serve a request.
+ *
+ * @param send_what the requested information
+ * @param funcsSize (out) the number of sections
+ * @return the sections, or NULL when the request is not served from sections
+ */
+static SiwLookupTableEntry * info_lookup_table(unsigned int send_what, unsigned int *funcsSize) {
+  if (send_what & (SIW_ALL | SIW_STATISTICS)) {
+    // only add if normal format
+    *funcsSize = ARRAY_SIZE(funcsNormal);
+    return funcsNormal;
   }
 
-  FD_ZERO(&set);
-  max = 0;
-  for (i = 0; i < MAX_CLIENTS; i++) {
-    if (outbuffer.socket[i] < 0) {
-      continue;
-    }
+  if (send_what & SIW_NETJSON) {
+    *funcsSize = ARRAY_SIZE(funcsNetjson);
+    return funcsNetjson;
+  }
 
-    /* And we cast here since we get a warning on Win32 */
-    FD_SET((unsigned int ) (outbuffer.socket[i]), &set);
+  if (send_what & SIW_POPROUTING) {
+    *funcsSize = ARRAY_SIZE(funcsPoprouting);
+    return funcsPoprouting;
+  }
 
-    if (outbuffer.socket[i] > max) {
-      max = outbuffer.socket[i];
-    }
+  *funcsSize = 0;
+  return NULL;
+}
+
+/**
+ * Render a section into its cache entry. A new buffer is used when the
+ * current one is still referenced by a streamed reply.
+ *
+ * @param cache_entry the cache entry
+ * @param func the printer of the section
+ * @param now the current time
+ * @param generation the generation of the data the section is rendered from
+ */
+static void info_cache_render(struct info_cache_entry_t *cache_entry, printer_generic func, long long now, unsigned long long generation) {
+  if (!cache_entry->blob || (cache_entry->blob->refcount > 1)) {
+    info_blob_put(cache_entry->blob);
+    cache_entry->blob = info_blob_new();
+  } else {
+    cache_entry->blob->buf.buf[0] = '\0';
+    cache_entry->blob->buf.len = 0;
   }
 
-  tv.tv_sec = 0;
-  tv.tv_usec = 0;
+  cache_entry->timestamp = now;
+  cache_entry->generation = generation;
+  cache_entry->renders++;
+  func(&cache_entry->blob->buf);
+}
 
-  result = select(max + 1, NULL, &set, NULL, &tv);
-  if (result <= 0) {
-    /* exit early if any of the sockets is not ready for writing */
-    return;
+/**
+ * Make sure that a cache entry holds its section: re-render it when it is
+ * stale, render it again (without counting that as a render) when it is
+ * up to date but its section was only streamed in pages.
+ *
+ * @param cache_entry the cache entry
+ * @param func the printer of the section
+ * @param now the current time
+ * @param stale true when the entry is stale
+ * @param generation the generation of the data the section is rendered from
+ */
+static void info_cache_fill(struct info_cache_entry_t *cache_entry, printer_generic func, long long now, bool stale, unsigned long long generation) {
+  if (stale) {
+    info_cache_render(cache_entry, func, now, generation);
+  } else if (!cache_entry->blob) {
+    cache_entry->blob = info_blob_new();
+    func(&cache_entry->blob->buf);
   }
+}
 
-  for (i = 0; i < MAX_CLIENTS; i++) {
-    if (outbuffer.socket[i] < 0) {
-      continue;
-    }
+/**
+ * Render a section, through its cache entry when it is cached.
+ *
+ * @param siw the section
+ * @param func the printer of the section
+ * @param now the current time
+ * @return a reference to the rendered section, to be released with info_blob_put
+ */
+static struct info_blob * info_render_section(unsigned long long siw, printer_generic func, long long now) {
+  bool stale = false;
+  unsigned long long generation = 0;
+  struct info_cache_entry_t *cache_entry = info_cache_lookup(siw, now, &stale, &generation);
+  struct info_blob *blob;
 
-    result = send(outbuffer.socket[i], outbuffer.buffer[i] + outbuffer.written[i], outbuffer.size[i] - outbuffer.written[i],
-#ifdef _WIN32
-    0
-#else
-    MSG_DONTWAIT
-#endif
-    );
-    if (result > 0) {
-      outbuffer.written[i] += result;
-    }
+  if (!cache_entry) {
+    blob = info_blob_new();
+    func(&blob->buf);
+    return blob;
+  }
 
-#if EWOULDBLOCK == EAGAIN
-    if ((result < 0) && (errno == EAGAIN)) {
-#else
-    if ((result < 0) && ((errno == EWOULDBLOCK) || (errno == EAGAIN))) {
-#endif
-      continue;
-    }
+  info_cache_fill(cache_entry, func, now, stale, generation);
+
+  return info_blob_get(cache_entry->blob);
+}
+
+/**
+ * Build the (weak) entity tag of the reply to a request, from the render
+ * counts of the cache entries of the requested sections. It changes
+ * whenever one of them is re-rendered, entries that are stale now are
+ * counted as rendered since they will be before they are sent.
+ *
+ * @param send_what the requested information
+ * @param funcs the sections that can be requested
+ * @param funcsSize the number of sections in funcs
+ * @param now the current time
+ * @param etag (out) the entity tag, ETAG_SIZE bytes
+ * @return false when a requested section is not cached, the reply then has
+ * no entity tag
+ */
+static bool info_cache_etag(unsigned int send_what, SiwLookupTableEntry *funcs, unsigned int funcsSize, long long now, char *etag) {
+  unsigned int i;
+  unsigned int what = send_what;
+  unsigned long long renders = 0;
+
+  for (i = 0; (i < funcsSize) && what; i++) {
+    unsigned long long siw = funcs[i].siw;
+    if ((what & siw) && funcs[i].func) {
+      bool stale = false;
+      unsigned long long generation = 0;
+      struct info_cache_entry_t *cache_entry = info_cache_lookup(siw, now, &stale, &generation);
 
-    if ((result < 0) || (outbuffer.written[i] >= outbuffer.size[i])) {
-      /* close this socket and cleanup*/
-      close(outbuffer.socket[i]);
-      outbuffer.socket[i] = -1;
-      free(outbuffer.buffer[i]);
-      outbuffer.buffer[i] = NULL;
-      outbuffer.size[i] = 0;
-      outbuffer.written[i] = 0;
+      if (!cache_entry) {
+        return false;
+      }
 
-      outbuffer.count--;
+      renders += cache_entry->renders + (stale ? 1 : 0);
     }
+    what &= ~siw;
   }
 
-  if (!outbuffer.count) {
-    olsr_stop_timer(writetimer_entry);
-    writetimer_entry = NULL;
-  }
+  snprintf(etag, ETAG_SIZE, "W/\"%lx-%x-%llx\"", etag_salt, send_what, renders);
+  return true;
 }
 
-typedef struct {
-  unsigned long long siw;
-  printer_generic func;
-} SiwLookupTableEntry;
-
-static void send_info_from_table(struct autobuf *abuf, unsigned int send_what, SiwLookupTableEntry *funcs, unsigned int funcsSize, unsigned int *outputLength) {
+static void send_info_from_table(struct autobuf *abuf, unsigned int send_what, SiwLookupTableEntry *funcs, unsigned int funcsSize, long long now, unsigned int *outputLength) {
   unsigned int i;
   unsigned int preLength;
   unsigned int what = send_what;
-  cache_timeout_func cache_timeout_f = functions->cache_timeout;
 
   if (functions->output_start) {
     functions->output_start(abuf);
@@ -439,33 +755,16 @@ static void send_info_from_table(struct autobuf *abuf, unsigned int send_what, S
     if (what & siw) {
       printer_generic func = funcs[i].func;
       if (func) {
-        long cache_timeout = 0;
-        struct info_cache_entry_t *cache_entry = NULL;
-
-        if (cache_timeout_f) {
-          cache_timeout = cache_timeout_f(config, siw);
-          cache_entry = (cache_timeout <= 0) ? NULL : info_cache_get_entry(&info_cache, siw);
-        }
+        bool stale = false;
+        unsigned long long generation = 0;
+        struct info_cache_entry_t *cache_entry = info_cache_lookup(siw, now, &stale, &generation);
 
         if (!cache_entry) {
             func(abuf);
         } else {
-          long long now;
-          long long age;
-
-          info_plugin_cache_init_entry(cache_entry);
-
-          now = olsr_times();
-          age = llabs(now - cache_entry->timestamp);
-          if (!cache_entry->timestamp || (age >= cache_timeout)) {
-            /* cache is never used before or cache is too old */
-            cache_entry->buf.buf[0] = '\0';
-            cache_entry->buf.len = 0;
-            cache_entry->timestamp = now;
-            func(&cache_entry->buf);
-          }
-
-          abuf_concat(abuf, &cache_entry->buf);
+          info_cache_fill(cache_entry, func, now, stale, generation);
+
+          abuf_concat(abuf, &cache_entry->blob->buf);
         }
       }
     }
@@ -479,132 +778,389 @@ static void send_info_from_table(struct autobuf *abuf, unsigned int send_what, S
   }
 }
 
-static void send_info(const char * req, bool add_headers, unsigned int send_what, int the_socket, unsigned int status) {
-  struct autobuf abuf;
+/**
+ * Check whether an If-None-Match request header matches an entity tag.
+ *
+ * @param if_none_match the value of the header
+ * @param etag the entity tag
+ * @return true when it matches
+ */
+static bool etag_matches(const char *if_none_match, const char *etag) {
+  const char *value = etag;
+
+  if (!*if_none_match || !*etag) {
+    return false;
+  }
+
+  if (!strcmp(if_none_match, "*")) {
+    return true;
+  }
+
+  /* weak comparison: ignore the W/ prefix, on both sides */
+  if (!strncmp(value, "W/", 2)) {
+    value += 2;
+  }
+
+  return strstr(if_none_match, value) != NULL;
+}
+
+/**
+ * Call output_start or output_end of the plugin for their side effects only:
+ * the printers of the sections expect to be called in between (the JSON
+ * printers keep their nesting state there).
+ *
+ * @param open true to call output_start, false to call output_end
+ */
+static void stream_frame(bool open) {
+  output_start_end func = open ? functions->output_start : functions->output_end;
+
+  if (func) {
+    func(&stream_scratch);
+    stream_scratch.len = 0;
+    stream_scratch.buf[0] = '\0';
+  }
+}
+
+/**
+ * Release the state of a streamed reply.
+ *
+ * @param conn the connection
+ */
+static void stream_reset(struct info_connection *conn) {
+  info_blob_put(conn->stream_part);
+  info_blob_put(conn->stream_next);
+  conn->stream_part = NULL;
+  conn->stream_next = NULL;
+  conn->stream_pager = NULL;
+  conn->stream_offset = 0;
+  conn->streaming = false;
+  conn->chunked = false;
+  conn->stream_end = false;
+  conn->ring_start = 0;
+  conn->ring_len = 0;
+}
+
+/**
+ * Render the next page of the section that is streamed in pages.
+ *
+ * @param conn the connection
+ * @return the page
+ */
+static struct info_blob * stream_page(struct info_connection *conn) {
+  struct info_blob *page = info_blob_new();
+
+  conn->stream_pager(&page->buf, &conn->stream_cursor, STREAM_RING_SIZE);
+  if (conn->stream_cursor.done) {
+    conn->stream_pager = NULL;
+  }
+
+  return page;
+}
+
+/**
+ * Render a section of a streamed reply, or the first page of it. A section
+ * with a paged printer is only rendered completely when it is cached and up
+ * to date, otherwise its pages are rendered as the ring drains. Its cache
+ * entry is then brought up to date without keeping the section, so that
+ * the entity tag of the reply remains valid.
+ *
+ * @param conn the connection
+ * @param entry the section
+ * @param now the current time
+ * @return the section or its first page, to be released with info_blob_put
+ */
+static struct info_blob * stream_section(struct info_connection *conn, SiwLookupTableEntry *entry, long long now) {
+  bool stale = false;
+  unsigned long long generation = 0;
+  struct info_cache_entry_t *cache_entry;
+
+  if (!entry->paged) {
+    return info_render_section(entry->siw, entry->func, now);
+  }
+
+  cache_entry = info_cache_lookup(entry->siw, now, &stale, &generation);
+  if (cache_entry) {
+    if (!stale && cache_entry->blob) {
+      return info_blob_get(cache_entry->blob);
+    }
+
+    if (stale) {
+      info_blob_put(cache_entry->blob);
+      cache_entry->blob = NULL;
+      cache_entry->timestamp = now;
+      cache_entry->generation = generation;
+      cache_entry->renders++;
+    }
+  }
+
+  memset(&conn->stream_cursor, 0, sizeof(conn->stream_cursor));
+  conn->stream_pager = entry->paged;
+  return stream_page(conn);
+}
+
+/**
+ * Start streaming the body of a reply. Its start and its first section
+ * that is not empty are rendered right away, the other sections when
+ * the ring has room for them.
+ *
+ * @param conn the connection
+ * @param send_what the requested information
+ * @param funcs the sections that can be requested
+ * @param funcsSize the number of sections in funcs
+ * @param now the current time
+ * @return false when all requested sections are empty, nothing is
+ * streamed then
+ */
+static bool stream_start(struct info_connection *conn, unsigned int send_what, SiwLookupTableEntry *funcs, unsigned int funcsSize, long long now) {
+  struct info_blob *start = info_blob_new();
+
+  conn->stream_funcs = funcs;
+  conn->stream_funcs_size = funcsSize;
+  conn->stream_index = 0;
+  conn->stream_what = send_what;
+  conn->stream_end = false;
+  conn->stream_pager = NULL;
+
+  if (functions->output_start) {
+    functions->output_start(&start->buf);
+  }
+
+  while (conn->stream_index < funcsSize) {
+    SiwLookupTableEntry *entry = &funcs[conn->stream_index++];
+
+    if ((send_what & entry->siw) && entry->func) {
+      struct info_blob *part = stream_section(conn, entry, now);
+
+      if (part->buf.len || conn->stream_pager) {
+        conn->stream_next = part;
+        break;
+      }
+      info_blob_put(part);
+    }
+  }
+
+  /* the output end is rendered after the last section (a section that is
+   * rendered in pages is not complete yet, its printer resumes its state) */
+  if (!conn->stream_pager) {
+    stream_frame(false);
+  }
+
+  if (!conn->stream_next) {
+    info_blob_put(start);
+    return false;
+  }
+
+  conn->stream_part = start;
+  conn->stream_offset = 0;
+  conn->streaming = true;
+  conn->chunked = conn->add_headers;
+  return true;
+}
+
+/**
+ * Move on to the next part of a streamed reply: the next page of the
+ * current section, the next requested section, and the output end after
+ * the last one.
+ *
+ * @param conn the connection
+ * @return false when there are no more parts
+ */
+static bool stream_next_part(struct info_connection *conn) {
+  info_blob_put(conn->stream_part);
+  conn->stream_part = NULL;
+  conn->stream_offset = 0;
+
+  if (conn->stream_next) {
+    conn->stream_part = conn->stream_next;
+    conn->stream_next = NULL;
+    return true;
+  }
+
+  if (conn->stream_pager) {
+    /* the printer restores its state from the cursor */
+    conn->stream_part = stream_page(conn);
+    return true;
+  }
+
+  while (conn->stream_index < conn->stream_funcs_size) {
+    SiwLookupTableEntry *entry = &conn->stream_funcs[conn->stream_index++];
+
+    if ((conn->stream_what & entry->siw) && entry->func) {
+      stream_frame(true);
+      conn->stream_part = stream_section(conn, entry, olsr_times());
+      if (!conn->stream_pager) {
+        stream_frame(false);
+      }
+      return true;
+    }
+  }
+
+  if (!conn->stream_end) {
+    conn->stream_end = true;
+    conn->stream_part = info_blob_new();
+    stream_frame(true);
+    if (functions->output_end) {
+      functions->output_end(&conn->stream_part->buf);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+static void ring_put(struct info_connection *conn, const char *data, size_t len) {
+  assert(len <= (STREAM_RING_SIZE - conn->ring_len));
+
+  while (len) {
+    size_t tail = (conn->ring_start + conn->ring_len) % STREAM_RING_SIZE;
+    size_t n = MIN(len, STREAM_RING_SIZE - tail);
+
+    memcpy(&conn->ring[tail], data, n);
+    conn->ring_len += n;
+    data += n;
+    len -= n;
+  }
+}
+
+/**
+ * Queue as much of a streamed reply in the ring of its connection as fits,
+ * in chunks when chunked transfer encoding is used.
+ *
+ * @param conn the connection
+ */
+static void stream_fill(struct info_connection *conn) {
+  size_t overhead = conn->chunked ? CHUNK_OVERHEAD : 0;
+
+  while (conn->streaming && ((STREAM_RING_SIZE - conn->ring_len) > overhead)) {
+    size_t len;
+
+    if (!conn->stream_part || (conn->stream_offset >= (size_t) conn->stream_part->buf.len)) {
+      if (!stream_next_part(conn)) {
+        /* the last chunk */
+        if (conn->chunked) {
+          ring_put(conn, "0\r\n\r\n", 5);
+        }
+        conn->streaming = false;
+      }
+      continue;
+    }
+
+    len = MIN(STREAM_RING_SIZE - conn->ring_len - overhead, conn->stream_part->buf.len - conn->stream_offset);
+
+    if (conn->chunked) {
+      char size[CHUNK_OVERHEAD];
+      int size_len = snprintf(size, sizeof(size), "%lx\r\n", (unsigned long) len);
+      ring_put(conn, size, size_len);
+    }
+
+    ring_put(conn, &conn->stream_part->buf.buf[conn->stream_offset], len);
+    conn->stream_offset += len;
+
+    if (conn->chunked) {
+      ring_put(conn, "\r\n", 2);
+    }
+  }
+}
+
+/**
+ * Build the reply to the current request of a connection, or its headers
+ * and the start of its body when it is streamed.
+ *
+ * @param conn the connection, keep_alive is reset when the reply does not
+ * allow to keep the connection open
+ * @param send_what the requested information
+ * @param status the HTTP status of the reply
+ */
+static void build_info(struct info_connection *conn, unsigned int send_what, unsigned int status) {
+  struct autobuf *abuf = &conn->reply;
   unsigned int outputLength = 0;
-  unsigned int send_index = 0;
-  bool first_reply = false;
 
   const char *content_type = functions->determine_mime_type ? functions->determine_mime_type(send_what) : "text/plain; charset=utf-8";
   int contentLengthIndex = 0;
   int headerLength = 0;
 
-  assert(outbuffer.count <= MAX_CLIENTS);
+  unsigned int funcsSize = 0;
+  SiwLookupTableEntry *funcs = (status == INFO_HTTP_OK) ? info_lookup_table(send_what, &funcsSize) : NULL;
+  long long now = olsr_times();
+  char etag[ETAG_SIZE];
 
-  abuf_init(&abuf, AUTOBUFCHUNK);
+  etag[0] = '\0';
 
-  if (add_headers) {
-    http_header_build(name, status, content_type, &abuf, &contentLengthIndex);
-    headerLength = abuf.len;
+  abuf_init(abuf, AUTOBUFCHUNK);
+
+  if (funcs && conn->add_headers && info_cache_etag(send_what, funcs, funcsSize, now, etag) && etag_matches(conn->if_none_match, etag)) {
+    /* the client has this reply already */
+    status = INFO_HTTP_NOT_MODIFIED;
+    content_type = NULL;
+  }
+
+  /* stream the body when the client does not need to know its length in advance */
+  if (funcs && (status == INFO_HTTP_OK) && (!conn->add_headers || conn->http11)) {
+    if (stream_start(conn, send_what, funcs, funcsSize, now)) {
+      if (conn->add_headers) {
+        /* queue the headers in the ring, to send them together with the first chunk */
+        http_header_build(name, status, content_type, etag, conn->keep_alive, true, abuf, &contentLengthIndex);
+        if (abuf->len <= (STREAM_RING_SIZE / 2)) {
+          ring_put(conn, abuf->buf, abuf->len);
+          abuf->len = 0;
+          abuf->buf[0] = '\0';
+        }
+      }
+      return;
+    }
+
+    status = INFO_HTTP_NOCONTENT;
+    conn->keep_alive = false;
+  }
+
+  if (conn->add_headers) {
+    http_header_build(name, status, content_type, (status == INFO_HTTP_NOCONTENT) ? NULL : etag, conn->keep_alive, false, abuf, &contentLengthIndex);
+    headerLength = abuf->len;
+  }
+
+  if (status == INFO_HTTP_NOT_MODIFIED) {
+    /* no body */
+    return;
   }
 
   if (status == INFO_HTTP_OK) {
     /* OK */
 
-    // only add if normal format
-    if (send_what & SIW_ALL) {
-      SiwLookupTableEntry funcs[] = {
-        { SIW_NEIGHBORS   , functions->neighbors   }, //
-        { SIW_LINKS       , functions->links       }, //
-        { SIW_ROUTES      , functions->routes      }, //
-        { SIW_HNA         , functions->hna         }, //
-        { SIW_MID         , functions->mid         }, //
-        { SIW_TOPOLOGY    , functions->topology    }, //
-        { SIW_GATEWAYS    , functions->gateways    }, //
-        { SIW_INTERFACES  , functions->interfaces  }, //
-        { SIW_2HOP        , functions->twohop      }, //
-        { SIW_SGW         , functions->sgw         }, //
-        { SIW_PUD_POSITION, functions->pudPosition }, //
-        //
-        { SIW_VERSION     , functions->version     }, //
-        { SIW_CONFIG      , functions->config      }, //
-        { SIW_PLUGINS     , functions->plugins     } //
-      };
-
-      send_info_from_table(&abuf, send_what, funcs, ARRAY_SIZE(funcs), &outputLength);
-    } else if (send_what & SIW_NETJSON) {
-      SiwLookupTableEntry funcs[] = {
-        { SIW_NETJSON_NETWORK_ROUTES      , functions->networkRoutes      }, //
-        { SIW_NETJSON_NETWORK_GRAPH       , functions->networkGraph       }, //
-        { SIW_NETJSON_DEVICE_CONFIGURATION, functions->deviceConfiguration}, //
-        { SIW_NETJSON_DEVICE_MONITORING   , functions->deviceMonitoring   }, //
-        { SIW_NETJSON_NETWORK_COLLECTION  , functions->networkCollection  } //
-      };
-
-      send_info_from_table(&abuf, send_what, funcs, ARRAY_SIZE(funcs), &outputLength);
-    } else if(send_what & SIW_POPROUTING){
-      SiwLookupTableEntry funcs[] = {
-        { SIW_POPROUTING_TC               , functions->tcTimer           }, //
-        { SIW_POPROUTING_HELLO            , functions->helloTimer        }, //
-        { SIW_POPROUTING_TC_MULT          , functions->tcTimerMult       }, //
-        { SIW_POPROUTING_HELLO_MULT       , functions->helloTimerMult    } //
-      };
-      
-      send_info_from_table(&abuf, send_what, funcs, ARRAY_SIZE(funcs), &outputLength);
+    if (funcs) {
+      send_info_from_table(abuf, send_what, funcs, funcsSize, now, &outputLength);
     } else if ((send_what & SIW_OLSRD_CONF) && functions->olsrd_conf) {
       /* this outputs the olsrd.conf text directly, not normal format */
-      unsigned int preLength = abuf.len;
-      functions->olsrd_conf(&abuf);
-      outputLength = abuf.len - preLength;
+      unsigned int preLength = abuf->len;
+      functions->olsrd_conf(abuf);
+      outputLength = abuf->len - preLength;
     }
 
-    if (!abuf.len || !outputLength) {
+    if (!abuf->len || !outputLength) {
       status = INFO_HTTP_NOCONTENT;
-      abuf.buf[0] = '\0';
-      abuf.len = 0;
-      if (add_headers) {
-        http_header_build(name, status, content_type, &abuf, &contentLengthIndex);
-        headerLength = abuf.len;
+      abuf->buf[0] = '\0';
+      abuf->len = 0;
+
+      /* the newline below is not allowed in a 204 reply on a persistent connection */
+      conn->keep_alive = false;
+
+      if (conn->add_headers) {
+        http_header_build(name, status, content_type, NULL, conn->keep_alive, false, abuf, &contentLengthIndex);
+        headerLength = abuf->len;
       }
     }
   }
 
   if (status != INFO_HTTP_OK) {
     if (functions->output_error) {
-      functions->output_error(&abuf, status, req, add_headers);
+      functions->output_error(abuf, status, conn->req, conn->add_headers);
     } else if (status == INFO_HTTP_NOCONTENT) {
       /* wget can't handle output of zero length */
-      abuf_puts(&abuf, "\n");
+      abuf_puts(abuf, "\n");
     }
   }
 
-  if (add_headers) {
-    http_header_adjust_content_length(&abuf, contentLengthIndex, abuf.len - headerLength);
-  }
-
-  /*
-   * Determine the last available outbuffer slot.
-   * Search from the end towards the start to avoid starvation of
-   * older replies that are still in-flight (since the send function
-   * iterates from the start towards the end).
-   */
-  send_index = MAX_CLIENTS;
-  while (send_index) {
-    send_index--;
-    if (!outbuffer.buffer[send_index]) {
-      break;
-    }
-  }
-  assert(send_index < MAX_CLIENTS);
-  assert(!outbuffer.buffer[send_index]);
-
-  /* avoid a memcpy: just move the abuf.buf pointer and clear abuf */
-  outbuffer.buffer[send_index] = abuf.buf;
-  outbuffer.size[send_index] = abuf.len;
-  outbuffer.written[send_index] = 0;
-  outbuffer.socket[send_index] = the_socket;
-  abuf.buf = NULL;
-  abuf.len = 0;
-  abuf.size = 0;
-
-  first_reply = !outbuffer.count;
-
-  outbuffer.count++;
-
-  write_data(NULL);
-
-  if (first_reply && outbuffer.buffer[send_index]) {
-    writetimer_entry = olsr_start_timer(10, 0, OLSR_TIMER_PERIODIC, &write_data, NULL, 0);
+  if (conn->add_headers) {
+    http_header_adjust_content_length(abuf, contentLengthIndex, abuf->len - headerLength);
   }
 }
 
@@ -759,152 +1315,522 @@ static void drain_request(int ipc_connection) {
   } while ((r > 0) && (r <= (ssize_t) sizeof(drain_buffer)));
 }
 
-static void ipc_action(int fd, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused))) {
+static void connection_action(int fd, void *data, unsigned int flags);
+
+static void connection_timeout(void *context);
+
+/**
+ * Set the socket events a connection waits for.
+ *
+ * @param conn the connection
+ * @param flags SP_PR_READ, SP_PR_WRITE or 0
+ */
+static void connection_poll(struct info_connection *conn, unsigned int flags) {
+  unsigned int enable = flags & ~conn->poll_flags;
+  unsigned int disable = conn->poll_flags & ~flags;
+
+  if (disable) {
+    disable_olsr_socket(conn->socket, &connection_action, NULL, disable);
+  }
+  if (enable) {
+    enable_olsr_socket(conn->socket, &connection_action, NULL, enable);
+  }
+  conn->poll_flags = flags;
+}
+
+/**
+ * (Re)start the timer of a connection.
+ *
+ * @param conn the connection
+ * @param timeout the timeout in milliseconds
+ */
+static void connection_set_timer(struct info_connection *conn, long timeout) {
+  if (conn->timer) {
+    olsr_change_timer(conn->timer, timeout, 0, OLSR_TIMER_ONESHOT);
+  } else {
+    conn->timer = olsr_start_timer(timeout, 0, OLSR_TIMER_ONESHOT, &connection_timeout, conn, NULL);
+  }
+}
+
+static void connection_close(struct info_connection *conn) {
+  olsr_stop_timer(conn->timer);
+  conn->timer = NULL;
+
+  remove_olsr_socket(conn->socket, &connection_action, NULL);
+
+  /* read until the end for graceful connection termination */
+  drain_request(conn->socket);
+  close(conn->socket);
+
+  abuf_free(&conn->reply);
+  stream_reset(conn);
+
+  list_remove(&conn->node);
+  connection_count--;
+  free(conn);
+}
+
+/**
+ * Send as much of the reply as the socket accepts.
+ *
+ * @param conn the connection
+ * @return false when the connection was closed
+ */
+static bool connection_write(struct info_connection *conn) {
+  bool progress = !conn->written;
+
+  for (;;) {
+    bool from_reply = conn->written < (size_t) conn->reply.len;
+    const char *data;
+    size_t len;
+    ssize_t result;
+
+    if (from_reply) {
+      data = conn->reply.buf + conn->written;
+      len = conn->reply.len - conn->written;
+    } else {
+      /* the body of a streamed reply */
+      if (conn->streaming && (conn->ring_len <= (STREAM_RING_SIZE / 2))) {
+        stream_fill(conn);
+      }
+      if (!conn->ring_len) {
+        break;
+      }
+      data = &conn->ring[conn->ring_start];
+      len = MIN(conn->ring_len, STREAM_RING_SIZE - conn->ring_start);
+    }
+
+    result = send(conn->socket, data, len,
+#ifdef _WIN32
+        0
+#else
+        MSG_DONTWAIT
+#endif
+        );
+
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+#if EWOULDBLOCK == EAGAIN
+      if (errno == EAGAIN) {
+#else
+      if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
+#endif
+        /* wait until the socket can take more data */
+        connection_poll(conn, SP_PR_WRITE);
+        if (progress) {
+          connection_set_timer(conn, WRITE_STALL_TIMEOUT);
+        }
+        return true;
+      }
+
 #ifndef NODEBUG
-  char addr[INET6_ADDRSTRLEN];
+      olsr_printf(1, "(%s) send()=%s\n", name, strerror(errno));
 #endif /* NODEBUG */
+      connection_close(conn);
+      return false;
+    }
 
-  int ipc_connection = -1;
-  union olsr_sockaddr sock_addr;
-  socklen_t sock_addr_len = sizeof(sock_addr);
-  bool hostDenied = false;
-  struct timeval timeout;
-  fd_set read_fds;
-  char req_buffer[1024]; /* maximum size is the size of an IP packet */
-  char * req = req_buffer;
-  ssize_t rx_count = 0;
+    progress = true;
+    if (from_reply) {
+      conn->written += result;
+    } else {
+      conn->ring_len -= result;
+      conn->ring_start = conn->ring_len ? ((conn->ring_start + result) % STREAM_RING_SIZE) : 0;
+    }
+  }
+
+  /* the reply was sent completely */
+  abuf_free(&conn->reply);
+  conn->written = 0;
+  stream_reset(conn);
+
+  if (!conn->keep_alive) {
+    connection_close(conn);
+    return false;
+  }
+
+  /* wait for the next request */
+  conn->state = INFO_CONNECTION_REQUEST;
+  connection_poll(conn, conn->eof ? 0 : SP_PR_READ);
+  connection_set_timer(conn, config->keep_alive_timeout);
+  return true;
+}
+
+/**
+ * Build the reply to the current request of a connection and start
+ * sending it.
+ *
+ * @param conn the connection
+ * @param send_what the requested information
+ * @param status the HTTP status of the reply
+ * @return false when the connection was closed
+ */
+static bool connection_reply(struct info_connection *conn, unsigned int send_what, unsigned int status) {
+  conn->keep_alive = conn->keep_alive //
+      && conn->add_headers /* the end of the reply must be marked (Content-Length or chunked) */ //
+      && (config->keep_alive_timeout > 0) //
+      && (!conn->eof || conn->rx_len) //
+      && ((status == INFO_HTTP_OK) || (status == INFO_HTTP_NOTFOUND));
+
+  build_info(conn, send_what, status);
+
+  conn->written = 0;
+  conn->requests++;
+  conn->state = INFO_CONNECTION_REPLY;
+
+  return connection_write(conn);
+}
+
+/**
+ * Reply to a request that could not be received (completely).
+ *
+ * @param conn the connection
+ * @param status the HTTP status of the reply
+ * @return false when the connection was closed
+ */
+static bool connection_reply_error(struct info_connection *conn, unsigned int status) {
+  conn->request_buffer[0] = '\0';
+  conn->req = conn->request_buffer;
+  conn->req_len = 0;
+  conn->add_headers = config->http_headers;
+  conn->http11 = false;
+  conn->keep_alive = false;
+  conn->if_none_match[0] = '\0';
+  conn->rx_len = 0;
+
+  return connection_reply(conn, 0, status);
+}
+
+/**
+ * Reply to the request that was received completely.
+ *
+ * @param conn the connection
+ * @return false when the connection was closed
+ */
+static bool connection_dispatch(struct info_connection *conn) {
   unsigned int send_what = 0;
   unsigned int http_status = INFO_HTTP_OK;
-  bool add_headers = config->http_headers;
-  int r = 0;
 
-  *req = '\0';
+  if (conn->host_denied) {
+    http_status = INFO_HTTP_FORBIDDEN;
+  } else if (!conn->req_len //
+      || ((conn->req_len == 1) && (*conn->req == '/'))) {
+    /* empty or '/' */
+    send_what = SIW_EVERYTHING;
+  } else {
+    send_what = determine_action(conn->req);
+    if (!send_what) {
+      http_status = INFO_HTTP_NOTFOUND;
+    }
+  }
 
-  if ((ipc_connection = accept(fd, (struct sockaddr *)&sock_addr, &sock_addr_len)) < 0) {
-#ifndef NODEBUG
-    olsr_printf(1, "(%s) accept()=%s\n", name, strerror(errno));
-#endif /* NODEBUG */
-    /* the caller will retry later */
+  return connection_reply(conn, send_what, http_status);
+}
+
+/**
+ * Sanitise a request line into the request buffer of a connection.
+ *
+ * @param conn the connection
+ * @param line the request line, without its line terminator
+ * @param len the length of the request line
+ * @return true when the line is the start of an HTTP request, which
+ * is followed by headers
+ */
+static bool connection_parse_request_line(struct info_connection *conn, const char *line, size_t len) {
+  char * req = conn->request_buffer;
+  bool http = false;
+  bool http11 = false;
+
+  memcpy(req, line, len);
+  req[len] = '\0';
+
+  conn->add_headers = config->http_headers;
+  conn->if_none_match[0] = '\0';
+
+  req = cutAtFirstEOL(req, &len);
+
+  req = stripTrailingWhitespace(req, &len);
+  req = skipLeadingWhitespace(req, &len);
+
+  /* detect http requests */
+  http11 = len && (req[len - 1] == '1');
+  req = parseRequest(req, &len, &conn->add_headers);
+  http = conn->add_headers;
+
+  req = stripTrailingWhitespace(req, &len);
+  req = stripTrailingSlashes(req, &len);
+  req = skipLeadingWhitespace(req, &len);
+  req = skipMultipleSlashes(req, &len);
+
+  req = checkCommandPrefixes(req, &len, &conn->add_headers);
+
+  req = skipMultipleSlashes(req, &len);
+
+  conn->req = req;
+  conn->req_len = len;
+
+  /* HTTP/1.1 connections are persistent unless closed explicitly, HTTP/1.0 ones only on request */
+  conn->http11 = http && http11;
+  conn->keep_alive = conn->http11;
+
+  return http;
+}
+
+/**
+ * Process an HTTP header line of a request, only the Connection and
+ * If-None-Match headers are of interest.
+ *
+ * @param conn the connection
+ * @param line the header line (zero terminated), without its line terminator
+ * @param len the length of the header line
+ */
+static void connection_parse_header(struct info_connection *conn, char *line, size_t len) {
+  static const char header[] = "Connection:";
+  static const char headerIfNoneMatch[] = "If-None-Match:";
+  char * value;
+
+  if ((len >= (sizeof(headerIfNoneMatch) - 1)) && !strncasecmp(line, headerIfNoneMatch, sizeof(headerIfNoneMatch) - 1)) {
+    len -= sizeof(headerIfNoneMatch) - 1;
+    value = skipLeadingWhitespace(&line[sizeof(headerIfNoneMatch) - 1], &len);
+    value = stripTrailingWhitespace(value, &len);
+    memcpy(conn->if_none_match, value, len);
+    conn->if_none_match[len] = '\0';
     return;
   }
 
-#ifdef _WIN32
-  /* set the connection socket to non-blocking */
-  {
-    u_long iMode = 1;
-    ioctlsocket(ipc_connection, FIONBIO, &iMode);
+  if ((len < (sizeof(header) - 1)) || strncasecmp(line, header, sizeof(header) - 1)) {
+    return;
   }
-#endif
 
-  /* Wait at most this much time for the request to arrive on the connection */
-  timeout.tv_sec = (outbuffer.count >= MAX_CLIENTS) ? 0 : config->request_timeout_sec;
-  timeout.tv_usec = (outbuffer.count >= MAX_CLIENTS) ? 0 : config->request_timeout_usec;
+  len -= sizeof(header) - 1;
+  value = skipLeadingWhitespace(&line[sizeof(header) - 1], &len);
 
-  FD_ZERO(&read_fds);
-#ifndef _WIN32
-  FD_SET(ipc_connection, &read_fds);
-#else
-  FD_SET((unsigned int ) ipc_connection, &read_fds); /* Win32 needs the cast here */
-#endif
+  if (!strncasecmp(value, "close", 5)) {
+    conn->keep_alive = false;
+  } else if (!strncasecmp(value, "keep-alive", 10)) {
+    conn->keep_alive = true;
+  }
+}
+
+/**
+ * Process the received data of a connection: parse the request lines
+ * and headers, and reply to every complete request, in order.
+ *
+ * @param conn the connection
+ * @return false when the connection was closed
+ */
+static bool connection_process_input(struct info_connection *conn) {
+  while (conn->state != INFO_CONNECTION_REPLY) {
+    char * line = conn->rx;
+    char * eol = memchr(conn->rx, '\n', conn->rx_len);
+    size_t len;
+    size_t consumed;
+
+    if (eol) {
+      len = eol - conn->rx;
+      consumed = len + 1;
+    } else if (conn->rx_len >= sizeof(conn->rx)) {
+      if (conn->state == INFO_CONNECTION_HEADERS) {
+        /* skip header lines that are too long, they are not of interest */
+        conn->rx_len = 0;
+        continue;
+      }
 
-  /* On success, select() and pselect() return the number of file descriptors
-   * contained in the three returned descriptor sets (that is, the total number
-   * of bits that are set in readfds, writefds, exceptfds) which may be zero if
-   * the timeout expires before anything interesting happens. On error, -1 is
-   * returned, and errno is set to indicate the error; the file descriptor sets
-   * are unmodified, and timeout becomes undefined.
-   */
-
-  r = select(ipc_connection + 1, &read_fds, NULL, NULL, &timeout);
-  if (r < 0) {
-    /* ipc_connection is not ready for reading */
 #ifndef NODEBUG
-    olsr_printf(1, "(%s) select()=%s\n", name, strerror(errno));
+      olsr_printf(1, "(%s) request > %ld\n", name, (long int) sizeof(conn->rx));
 #endif /* NODEBUG */
-    drain_request(ipc_connection);
-    if (outbuffer.count >= MAX_CLIENTS) {
-      send_status_no_retries(req, add_headers, ipc_connection, INFO_HTTP_INTERNAL_SERVER_ERROR);
+      return connection_reply_error(conn, INFO_HTTP_REQUEST_ENTITY_TOO_LARGE);
+    } else if (!conn->eof) {
+      /* wait for more data */
+      return true;
+    } else if (conn->state == INFO_CONNECTION_HEADERS) {
+      /* the headers were cut short, reply anyway */
+      conn->rx_len = 0;
+      if (!connection_dispatch(conn)) {
+        return false;
+      }
+      continue;
+    } else if (conn->rx_len) {
+      /* the last request line is not terminated */
+      len = conn->rx_len;
+      consumed = len;
+    } else if (conn->requests) {
+      /* all requests were answered */
+      connection_close(conn);
+      return false;
     } else {
-      send_info(req, add_headers, send_what, ipc_connection, INFO_HTTP_INTERNAL_SERVER_ERROR);
+      /* the connection was closed without a request */
+      len = 0;
+      consumed = 0;
+    }
+
+    line[len] = '\0';
+
+    if (conn->state == INFO_CONNECTION_REQUEST) {
+      size_t l = len;
+      bool http;
+
+      if (conn->requests && !*skipLeadingWhitespace(line, &l)) {
+        /* skip empty lines between requests */
+        memmove(conn->rx, &conn->rx[consumed], conn->rx_len - consumed);
+        conn->rx_len -= consumed;
+        continue;
+      }
+
+      http = connection_parse_request_line(conn, line, len);
+
+      memmove(conn->rx, &conn->rx[consumed], conn->rx_len - consumed);
+      conn->rx_len -= consumed;
+
+      if (http) {
+        conn->state = INFO_CONNECTION_HEADERS;
+        continue;
+      }
+    } else {
+      line = stripTrailingWhitespace(line, &len);
+
+      if (len) {
+        connection_parse_header(conn, line, len);
+      }
+
+      memmove(conn->rx, &conn->rx[consumed], conn->rx_len - consumed);
+      conn->rx_len -= consumed;
+
+      if (len) {
+        continue;
+      }
+    }
+
+    /* the request was received completely */
+    if (!connection_dispatch(conn)) {
+      return false;
     }
-    return;
   }
 
-  if (!r) {
-    /* ipc_connection is not ready for reading within the timeout */
+  return true;
+}
+
+static void connection_timeout(void *context) {
+  struct info_connection *conn = context;
+
+  /* one-shot timers are stopped by the scheduler after the callback */
+  conn->timer = NULL;
+
+  if (conn->state == INFO_CONNECTION_REPLY) {
 #ifndef NODEBUG
-    olsr_printf(1, "(%s) select() timeout\n", name);
+    olsr_printf(1, "(%s) send() timeout\n", name);
 #endif /* NODEBUG */
-    drain_request(ipc_connection);
-    if (outbuffer.count >= MAX_CLIENTS) {
-      send_status_no_retries(req, add_headers, ipc_connection, INFO_HTTP_REQUEST_TIMEOUT);
+    connection_close(conn);
+    return;
+  }
+
+  if ((conn->state == INFO_CONNECTION_REQUEST) && !conn->rx_len) {
+    if (conn->requests) {
+      /* idle persistent connection */
+      connection_close(conn);
     } else {
-      send_info(req, add_headers, send_what, ipc_connection, INFO_HTTP_REQUEST_TIMEOUT);
+#ifndef NODEBUG
+      olsr_printf(1, "(%s) request timeout\n", name);
+#endif /* NODEBUG */
+      connection_reply_error(conn, INFO_HTTP_REQUEST_TIMEOUT);
     }
     return;
   }
 
-#ifdef _WIN32
-  rx_count = recv(ipc_connection, req, sizeof(req_buffer), MSG_PEEK);
-  if (rx_count > 0) {
-    rx_count = recv(ipc_connection, req, sizeof(req_buffer), 0);
+  /* reply to what was received so far, as if the connection was closed */
+  conn->eof = true;
+  connection_poll(conn, 0);
+  connection_process_input(conn);
+}
+
+static void connection_action(int fd, void *data, unsigned int flags) {
+  struct info_connection *conn = data;
+
+  if (conn->state == INFO_CONNECTION_REPLY) {
+    if (!(flags & SP_PR_WRITE) || !connection_write(conn) || (conn->state == INFO_CONNECTION_REPLY)) {
+      return;
+    }
+
+    /* continue with pipelined requests */
+    connection_process_input(conn);
+    return;
+  }
+
+  if (!(flags & SP_PR_READ)) {
+    return;
   }
+
+  if (conn->rx_len < sizeof(conn->rx)) {
+    ssize_t rx_count;
+
+#ifdef _WIN32
+    rx_count = recv(fd, &conn->rx[conn->rx_len], sizeof(conn->rx) - conn->rx_len, 0);
 #else
-  rx_count = recv(ipc_connection, req, sizeof(req_buffer), MSG_DONTWAIT);
+    rx_count = recv(fd, &conn->rx[conn->rx_len], sizeof(conn->rx) - conn->rx_len, MSG_DONTWAIT);
 #endif
 
-  /* Upon successful completion, recv() shall return the length of the message
-   * in bytes. If no messages are available to be received and the peer has
-   * performed an orderly shutdown, recv() shall return 0. Otherwise, −1 shall
-   * be returned and errno set to indicate the error.
-   */
+    if (rx_count < 0) {
+#if EWOULDBLOCK == EAGAIN
+      if ((errno == EAGAIN) || (errno == EINTR)) {
+#else
+      if ((errno == EWOULDBLOCK) || (errno == EAGAIN) || (errno == EINTR)) {
+#endif
+        return;
+      }
 
-  /* ensure proper request termination */
-  if (rx_count <= 0) {
-    *req = '\0';
-  } else if (rx_count < (ssize_t) sizeof(req_buffer)) {
-    req[rx_count] = '\0';
-  } else {
-    req[sizeof(req_buffer) - 1] = '\0';
-  }
+#ifndef NODEBUG
+      olsr_printf(1, "(%s) recv()=%s\n", name, strerror(errno));
+#endif /* NODEBUG */
+      connection_close(conn);
+      return;
+    }
 
-  /* sanitise the request */
-  if (rx_count > 0) {
-    req = cutAtFirstEOL(req, (size_t*) &rx_count);
+    if (!rx_count) {
+      /* the peer will not send any more data */
+      conn->eof = true;
+      connection_poll(conn, 0);
+    }
 
-    req = stripTrailingWhitespace(req, (size_t*) &rx_count);
-    req = skipLeadingWhitespace(req, (size_t*) &rx_count);
+    conn->rx_len += rx_count;
+  }
 
-    /* detect http requests */
-    req = parseRequest(req, (size_t*) &rx_count, &add_headers);
+  connection_process_input(conn);
+}
 
-    req = stripTrailingWhitespace(req, (size_t*) &rx_count);
-    req = stripTrailingSlashes(req, (size_t*) &rx_count);
-    req = skipLeadingWhitespace(req, (size_t*) &rx_count);
-    req = skipMultipleSlashes(req, (size_t*) &rx_count);
+static void connection_open(int ipc_connection, union olsr_sockaddr *sock_addr) {
+#ifndef NODEBUG
+  char addr[INET6_ADDRSTRLEN];
+#endif /* NODEBUG */
 
-    req = checkCommandPrefixes(req, (size_t*) &rx_count, &add_headers);
+  struct info_connection *conn;
 
-    req = skipMultipleSlashes(req, (size_t*) &rx_count);
+#ifdef _WIN32
+  /* set the connection socket to non-blocking */
+  {
+    u_long iMode = 1;
+    ioctlsocket(ipc_connection, FIONBIO, &iMode);
   }
+#endif
 
-  if (outbuffer.count >= MAX_CLIENTS) {
-    /* limit the number of replies that are in-flight */
-    drain_request(ipc_connection);
-    send_status_no_retries(req, add_headers, ipc_connection, INFO_HTTP_SERVICE_UNAVAILABLE);
-    return;
-  }
+  conn = olsr_malloc(sizeof(*conn), "info connection");
+  conn->socket = ipc_connection;
+  conn->state = INFO_CONNECTION_REQUEST;
+  conn->req = conn->request_buffer;
+  conn->add_headers = config->http_headers;
 
   if (olsr_cnf->ip_version == AF_INET) {
-    hostDenied = //
+    conn->host_denied = //
         (ntohl(config->accept_ip.v4.s_addr) != INADDR_ANY) //
-        && !ip4equal(&sock_addr.in4.sin_addr, &config->accept_ip.v4) //
+        && !ip4equal(&sock_addr->in4.sin_addr, &config->accept_ip.v4) //
         && (!config->allow_localhost //
-            || (ntohl(sock_addr.in4.sin_addr.s_addr) != INADDR_LOOPBACK));
+            || (ntohl(sock_addr->in4.sin_addr.s_addr) != INADDR_LOOPBACK));
   } else {
-    hostDenied = //
+    conn->host_denied = //
         !ip6equal(&config->accept_ip.v6, &in6addr_any) //
-        && !ip6equal(&sock_addr.in6.sin6_addr, &config->accept_ip.v6) //
+        && !ip6equal(&sock_addr->in6.sin6_addr, &config->accept_ip.v6) //
         && (!config->allow_localhost //
             || !ip6equal(&config->accept_ip.v6, &in6addr_loopback));
   }
@@ -912,77 +1838,63 @@ static void ipc_action(int fd, void *data __attribute__ ((unused)), unsigned int
 #ifndef NODEBUG
   if (!inet_ntop( //
       olsr_cnf->ip_version, //
-      (olsr_cnf->ip_version == AF_INET) ? (void *) &sock_addr.in4.sin_addr : (void *) &sock_addr.in6.sin6_addr, //
+      (olsr_cnf->ip_version == AF_INET) ? (void *) &sock_addr->in4.sin_addr : (void *) &sock_addr->in6.sin6_addr, //
       addr, //
       sizeof(addr))) {
     addr[0] = '\0';
   }
-#endif /* NODEBUG */
 
-  if (hostDenied) {
-#ifndef NODEBUG
+  if (conn->host_denied) {
     olsr_printf(1, "(%s) Connect from host %s is not allowed!\n", name, addr);
-#endif /* NODEBUG */
-    drain_request(ipc_connection);
-    send_info(req, add_headers, send_what, ipc_connection, INFO_HTTP_FORBIDDEN);
-    return;
+  } else {
+    olsr_printf(1, "(%s) Connect from host %s is allowed\n", name, addr);
   }
-
-#ifndef NODEBUG
-  olsr_printf(1, "(%s) Connect from host %s is allowed\n", name, addr);
 #endif /* NODEBUG */
 
-  if (rx_count < 0) {
-#ifndef NODEBUG
-    olsr_printf(1, "(%s) rx_count < 0\n", name);
-#endif /* NODEBUG */
-    drain_request(ipc_connection);
-    send_info(req, add_headers, send_what, ipc_connection, INFO_HTTP_INTERNAL_SERVER_ERROR);
-    return;
-  }
+  list_node_init(&conn->node);
+  list_add_before(&connections, &conn->node);
+  connection_count++;
 
-  /* rx_count >= 0 */
+  add_olsr_socket(ipc_connection, &connection_action, NULL, conn, SP_PR_READ);
+  conn->poll_flags = SP_PR_READ;
+  connection_set_timer(conn, config->request_timeout);
 
-  if (!rx_count) {
-#ifndef NODEBUG
-    olsr_printf(1, "(%s) rx_count == 0\n", name);
-#endif /* NODEBUG */
-    drain_request(ipc_connection);
-    send_info(req, add_headers, SIW_EVERYTHING, ipc_connection, INFO_HTTP_OK);
-    return;
-  }
+  /* the request usually arrives right behind the connection */
+  connection_action(ipc_connection, conn, SP_PR_READ);
+}
+
+static void ipc_action(int fd, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused))) {
+  int i;
 
-  /* rx_count > 0 */
+  /* accept the pending connections, a few at a time */
+  for (i = 0; i <= config->max_clients; i++) {
+    union olsr_sockaddr sock_addr;
+    socklen_t sock_addr_len = sizeof(sock_addr);
+    int ipc_connection = accept(fd, (struct sockaddr *)&sock_addr, &sock_addr_len);
 
-  if (rx_count >= (ssize_t) sizeof(req_buffer)) {
+    if (ipc_connection < 0) {
 #ifndef NODEBUG
-    olsr_printf(1, "(%s) rx_count > %ld\n", name, (long int) sizeof(req_buffer));
+#if EWOULDBLOCK == EAGAIN
+      if (errno != EAGAIN) {
+#else
+      if ((errno != EWOULDBLOCK) && (errno != EAGAIN)) {
+#endif
+        olsr_printf(1, "(%s) accept()=%s\n", name, strerror(errno));
+      }
 #endif /* NODEBUG */
+      /* the caller will retry later */
+      return;
+    }
 
-    /* input was much too long: read until the end for graceful connection termination
-     * because wget can't handle the premature connection termination that is allowed
-     * by the INFO_HTTP_REQUEST_ENTITY_TOO_LARGE HTTP status code
-     */
-    drain_request(ipc_connection);
-    send_info(req, add_headers, send_what, ipc_connection, INFO_HTTP_REQUEST_ENTITY_TOO_LARGE);
-    return;
-  }
-
-  /* 0 < rx_count < sizeof(requ) */
-
-  if (!rx_count //
-      || ((rx_count == 1) && (*req == '/'))) {
-    /* empty or '/' */
-    send_what = SIW_EVERYTHING;
-  } else {
-    send_what = determine_action(req);
-  }
+    if (connection_count >= config->max_clients) {
+      /* limit the number of connections */
+      drain_request(ipc_connection);
+      send_status_no_retries("", config->http_headers, ipc_connection, INFO_HTTP_SERVICE_UNAVAILABLE);
+      continue;
+    }
 
-  if (!send_what) {
-    http_status = INFO_HTTP_NOTFOUND;
+    connection_open(ipc_connection, &sock_addr);
   }
-
-  send_info(req, add_headers, send_what, ipc_connection, http_status);
 }
 
 static int plugin_ipc_init(void) {
@@ -1049,13 +1961,28 @@ static int plugin_ipc_init(void) {
   }
 
   /* show that we are willing to listen */
-  if (listen(ipc_socket, 1) == -1) {
+  if (listen(ipc_socket, config->max_clients) == -1) {
 #ifndef NODEBUG
     olsr_printf(1, "(%s) listen()=%s\n", name, strerror(errno));
 #endif /* NODEBUG */
     goto error_out;
   }
 
+  /* never block in accept() */
+#ifdef _WIN32
+  {
+    u_long iMode = 1;
+    ioctlsocket(ipc_socket, FIONBIO, &iMode);
+  }
+#else
+  if (fcntl(ipc_socket, F_SETFL, fcntl(ipc_socket, F_GETFL) | O_NONBLOCK) == -1) {
+#ifndef NODEBUG
+    olsr_printf(1, "(%s) fcntl()=%s\n", name, strerror(errno));
+#endif /* NODEBUG */
+    goto error_out;
+  }
+#endif
+
   /* Register with olsrd */
   add_olsr_socket(ipc_socket, &ipc_action, NULL, NULL, SP_PR_READ);
 
@@ -1082,13 +2009,16 @@ static void info_sanitise_config(info_plugin_config_t *cfg) {
     cfg->request_timeout = 0;
   }
 
-  cfg->request_timeout_sec = cfg->request_timeout / 1000;
-  cfg->request_timeout_usec = (cfg->request_timeout % 1000) * 1000;
+  if (cfg->keep_alive_timeout < 0) {
+    cfg->keep_alive_timeout = 0;
+  }
+
+  if (cfg->max_clients < 1) {
+    cfg->max_clients = 1;
+  }
 }
 
 int info_plugin_init(const char * plugin_name, info_plugin_functions_t *plugin_functions, info_plugin_config_t *plugin_config) {
-  int i;
-
   assert(plugin_name);
   assert(plugin_functions);
   assert(plugin_config);
@@ -1099,10 +2029,8 @@ int info_plugin_init(const char * plugin_name, info_plugin_functions_t *plugin_f
 
   info_sanitise_config(config);
 
-  memset(&outbuffer, 0, sizeof(outbuffer));
-  for (i = 0; i < MAX_CLIENTS; ++i) {
-    outbuffer.socket[i] = -1;
-  }
+  list_head_init(&connections);
+  connection_count = 0;
 
   ipc_socket = -1;
 
@@ -1110,31 +2038,32 @@ int info_plugin_init(const char * plugin_name, info_plugin_functions_t *plugin_f
     functions->init(name);
   }
 
+  info_plugin_tables_init();
   info_plugin_cache_init(true);
+  abuf_init(&stream_scratch, AUTOBUFCHUNK);
+  etag_salt = (unsigned long) time(NULL);
 
   return plugin_ipc_init();
 }
 
 void info_plugin_exit(void) {
-  int i;
-
   if (ipc_socket != -1) {
     close(ipc_socket);
     ipc_socket = -1;
   }
-  for (i = 0; i < MAX_CLIENTS; ++i) {
-    if (outbuffer.buffer[i]) {
-      free(outbuffer.buffer[i]);
-      outbuffer.buffer[i] = NULL;
-    }
-    outbuffer.size[i] = 0;
-    outbuffer.written[i] = 0;
-    if (outbuffer.socket[i]) {
-      close(outbuffer.socket[i]);
-      outbuffer.socket[i] = -1;
-    }
+
+  /* the timers are flushed already at this point */
+  while (!list_is_empty(&connections)) {
+    struct info_connection *conn = list2connection(connections.next);
+
+    close(conn->socket);
+    abuf_free(&conn->reply);
+    stream_reset(conn);
+    list_remove(&conn->node);
+    free(conn);
   }
-  outbuffer.count = 0;
+  connection_count = 0;
 
   info_plugin_cache_init(false);
+  abuf_free(&stream_scratch);
 }
@@ -55,6 +55,8 @@
 #include "neighbor_table.h"
 #include "mpr_selector_set.h"
 #include "mid_set.h"
+#include "olsr_cookie.h"
+#include "parser.h"
 #include "routing_table.h"
 #include "lq_plugin.h"
 #include "gateway.h"
@@ -63,6 +65,7 @@
 #include "info/info_types.h"
 #include "info/http_headers.h"
 #include "info/json_helpers.h"
+#include "info/info_cursor.h"
 #include "gateway_default_handler.h"
 #include "egressTypes.h"
 #include "nmealib/info.h"
@@ -121,7 +124,7 @@ void plugin_init(const char *plugin_name) {
 }
 
 unsigned long long get_supported_commands_mask(void) {
-  return SIW_ALL | SIW_OLSRD_CONF;
+  return SIW_ALL | SIW_OLSRD_CONF | SIW_STATISTICS;
 }
 
 bool isCommand(const char *str, unsigned long long siw) {
@@ -203,6 +206,14 @@ bool isCommand(const char *str, unsigned long long siw) {
       cmd = "/neighbours";
       break;
 
+    case SIW_COOKIES:
+      cmd = "/cookies";
+      break;
+
+    case SIW_PARSER:
+      cmd = "/parser";
+      break;
+
     default:
       return false;
   }
@@ -555,13 +566,46 @@ void ipc_print_links(struct autobuf *abuf) {
   abuf_json_mark_object(&json_session, false, true, abuf, NULL);
 }
 
-void ipc_print_routes(struct autobuf *abuf) {
+/**
+ * Start or continue a section that is printed in pages.
+ *
+ * @param cursor the cursor of the section
+ * @return false when the section starts, its start must be printed then
+ */
+static bool json_page_resume(struct info_cursor *cursor) {
+  if (!cursor->started) {
+    cursor->started = true;
+    return false;
+  }
+
+  json_session = cursor->json;
+  return true;
+}
+
+/**
+ * End a page of a section that is printed in pages.
+ *
+ * @param cursor the cursor of the section
+ */
+static void json_page_suspend(struct info_cursor *cursor) {
+  cursor->json = json_session;
+}
+
+void ipc_print_routes_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
   struct rt_entry *rt;
 
-  abuf_json_mark_object(&json_session, true, true, abuf, "routes");
+  if (!json_page_resume(cursor)) {
+    abuf_json_mark_object(&json_session, true, true, abuf, "routes");
+  }
 
   /* Walk the route table */
-  OLSR_FOR_ALL_RT_ENTRIES(rt) {
+  for (rt = info_cursor_rt(cursor); rt; rt = info_cursor_rt_next(rt)) {
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_rt_suspend(cursor, rt);
+      json_page_suspend(cursor);
+      return;
+    }
+
     if (rt->rt_best) {
       abuf_json_mark_array_entry(&json_session, true, abuf);
       abuf_json_ip_address(&json_session, abuf, "destination", &rt->rt_dst.prefix);
@@ -573,88 +617,114 @@ void ipc_print_routes(struct autobuf *abuf) {
       abuf_json_string(&json_session, abuf, "networkInterface", if_ifwithindex_name(rt->rt_best->rtp_nexthop.iif_index));
       abuf_json_mark_array_entry(&json_session, false, abuf);
     }
-  } OLSR_FOR_ALL_RT_ENTRIES_END(rt);
+  }
 
   abuf_json_mark_object(&json_session, false, true, abuf, NULL);
+  cursor->done = true;
 }
 
-void ipc_print_topology(struct autobuf *abuf) {
-  struct tc_entry *tc;
+void ipc_print_routes(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_routes_paged, abuf);
+}
+
+void ipc_print_topology_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
+  struct tc_edge_entry *tc_edge;
 
-  abuf_json_mark_object(&json_session, true, true, abuf, "topology");
+  if (!json_page_resume(cursor)) {
+    abuf_json_mark_object(&json_session, true, true, abuf, "topology");
+  }
 
   /* Topology */
-  OLSR_FOR_ALL_TC_ENTRIES(tc) {
-    struct tc_edge_entry *tc_edge;
-    OLSR_FOR_ALL_TC_EDGE_ENTRIES(tc, tc_edge) {
-      if (tc_edge->edge_inv) {
-        struct lqtextbuffer lqbuffer;
-        const char* lqString = get_tc_edge_entry_text(tc_edge, '\t', &lqbuffer);
-        char * nlqString = strrchr(lqString, '\t');
-
-        if (nlqString) {
-          *nlqString = '\0';
-          nlqString++;
-        }
+  for (tc_edge = info_cursor_tc_edge(cursor); tc_edge; tc_edge = info_cursor_tc_edge_next(tc_edge)) {
+    struct tc_entry *tc = tc_edge->tc;
 
-        abuf_json_mark_array_entry(&json_session, true, abuf);
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_tc_edge_suspend(cursor, tc_edge);
+      json_page_suspend(cursor);
+      return;
+    }
 
-        // vertex_node
-        abuf_json_ip_address(&json_session, abuf, "lastHopIP", &tc->addr);
-        // cand_tree_node
-        abuf_json_float(&json_session, abuf, "pathCost", get_linkcost_scaled(tc->path_cost, true));
-        // path_list_node
-        // edge_tree
-        // prefix_tree
-        // next_hop
-        // edge_gc_timer
-        abuf_json_int(&json_session, abuf, "validityTime", tc->validity_timer ? (tc->validity_timer->timer_clock - now_times) : 0);
-        abuf_json_int(&json_session, abuf, "refCount", tc->refcount);
-        abuf_json_int(&json_session, abuf, "msgSeq", tc->msg_seq);
-        abuf_json_int(&json_session, abuf, "msgHops", tc->msg_hops);
-        abuf_json_int(&json_session, abuf, "hops", tc->hops);
-        abuf_json_int(&json_session, abuf, "ansn", tc->ansn);
-        abuf_json_int(&json_session, abuf, "tcIgnored", tc->ignored);
-
-        abuf_json_int(&json_session, abuf, "errSeq", tc->err_seq);
-        abuf_json_boolean(&json_session, abuf, "errSeqValid", tc->err_seq_valid);
-
-        // edge_node
-        abuf_json_ip_address(&json_session, abuf, "destinationIP", &tc_edge->T_dest_addr);
-        // tc
-        abuf_json_float(&json_session, abuf, "tcEdgeCost", get_linkcost_scaled(tc_edge->cost, true));
-        abuf_json_int(&json_session, abuf, "ansnEdge", tc_edge->ansn);
-        abuf_json_float(&json_session, abuf, "linkQuality", atof(lqString));
-        abuf_json_float(&json_session, abuf, "neighborLinkQuality", nlqString ? atof(nlqString) : 0.0);
+    if (tc_edge->edge_inv) {
+      struct lqtextbuffer lqbuffer;
+      const char* lqString = get_tc_edge_entry_text(tc_edge, '\t', &lqbuffer);
+      char * nlqString = strrchr(lqString, '\t');
 
-        abuf_json_mark_array_entry(&json_session, false, abuf);
+      if (nlqString) {
+        *nlqString = '\0';
+        nlqString++;
       }
-    } OLSR_FOR_ALL_TC_EDGE_ENTRIES_END(tc, tc_edge);
-  } OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+
+      abuf_json_mark_array_entry(&json_session, true, abuf);
+
+      // vertex_node
+      abuf_json_ip_address(&json_session, abuf, "lastHopIP", &tc->addr);
+      // cand_heap_node
+      abuf_json_float(&json_session, abuf, "pathCost", get_linkcost_scaled(tc->path_cost, true));
+      // path_list_node
+      // edge_tree
+      // prefix_tree
+      // next_hop
+      // edge_gc_timer
+      abuf_json_int(&json_session, abuf, "validityTime", tc->validity_timer ? (tc->validity_timer->timer_clock - now_times) : 0);
+      abuf_json_int(&json_session, abuf, "refCount", tc->refcount);
+      abuf_json_int(&json_session, abuf, "msgSeq", tc->msg_seq);
+      abuf_json_int(&json_session, abuf, "msgHops", tc->msg_hops);
+      abuf_json_int(&json_session, abuf, "hops", tc->hops);
+      abuf_json_int(&json_session, abuf, "ansn", tc->ansn);
+      abuf_json_int(&json_session, abuf, "tcIgnored", tc->ignored);
+
+      abuf_json_int(&json_session, abuf, "errSeq", tc->err_seq);
+      abuf_json_boolean(&json_session, abuf, "errSeqValid", tc->err_seq_valid);
+
+      // edge_node
+      abuf_json_ip_address(&json_session, abuf, "destinationIP", &tc_edge->T_dest_addr);
+      // tc
+      abuf_json_float(&json_session, abuf, "tcEdgeCost", get_linkcost_scaled(tc_edge->cost, true));
+      abuf_json_int(&json_session, abuf, "ansnEdge", tc_edge->ansn);
+      abuf_json_float(&json_session, abuf, "linkQuality", atof(lqString));
+      abuf_json_float(&json_session, abuf, "neighborLinkQuality", nlqString ? atof(nlqString) : 0.0);
+
+      abuf_json_mark_array_entry(&json_session, false, abuf);
+    }
+  }
 
   abuf_json_mark_object(&json_session, false, true, abuf, NULL);
+  cursor->done = true;
 }
 
-void ipc_print_hna(struct autobuf *abuf) {
-  struct ip_prefix_list *hna;
+void ipc_print_topology(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_topology_paged, abuf);
+}
+
+void ipc_print_hna_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
   struct hna_entry *tmp_hna;
 
-  abuf_json_mark_object(&json_session, true, true, abuf, "hna");
-
-  /* Announced HNA entries */
-  for (hna = olsr_cnf->hna_entries; hna != NULL ; hna = hna->next) {
-    print_hna_array_entry( //
-        &json_session, //
-        abuf, //
-        &olsr_cnf->main_addr, //
-        &hna->net.prefix, //
-        hna->net.prefix_len, //
-        0);
+  if (!json_page_resume(cursor)) {
+    struct ip_prefix_list *hna;
+
+    abuf_json_mark_object(&json_session, true, true, abuf, "hna");
+
+    /* Announced HNA entries */
+    for (hna = olsr_cnf->hna_entries; hna != NULL ; hna = hna->next) {
+      print_hna_array_entry( //
+          &json_session, //
+          abuf, //
+          &olsr_cnf->main_addr, //
+          &hna->net.prefix, //
+          hna->net.prefix_len, //
+          0);
+    }
   }
 
-  OLSR_FOR_ALL_HNA_ENTRIES(tmp_hna) {
+  for (tmp_hna = info_cursor_hash(cursor, &hna_set); tmp_hna; tmp_hna = info_cursor_hash_next(cursor, &hna_set, tmp_hna)) {
     struct hna_net *tmp_net;
 
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_hash_suspend(cursor, &hna_set, tmp_hna);
+      json_page_suspend(cursor);
+      return;
+    }
+
     /* Check all networks */
     for (tmp_net = tmp_hna->networks.next; tmp_net != &tmp_hna->networks; tmp_net = tmp_net->next) {
       print_hna_array_entry( //
@@ -665,48 +735,60 @@ void ipc_print_hna(struct autobuf *abuf) {
           tmp_net->hna_prefix.prefix_len, //
           tmp_net->hna_net_timer ? (tmp_net->hna_net_timer->timer_clock - now_times) : 0);
     }
-  } OLSR_FOR_ALL_HNA_ENTRIES_END(tmp_hna);
+  }
 
   abuf_json_mark_object(&json_session, false, true, abuf, NULL);
+  cursor->done = true;
 }
 
-void ipc_print_mid(struct autobuf *abuf) {
-  int idx;
+void ipc_print_hna(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_hna_paged, abuf);
+}
+
+void ipc_print_mid_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
+  struct mid_entry *entry;
 
-  abuf_json_mark_object(&json_session, true, true, abuf, "mid");
+  if (!json_page_resume(cursor)) {
+    abuf_json_mark_object(&json_session, true, true, abuf, "mid");
+  }
 
   /* MID */
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct mid_entry * entry = mid_set[idx].next;
+  for (entry = info_cursor_hash(cursor, &mid_set); entry; entry = info_cursor_hash_next(cursor, &mid_set, entry)) {
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_hash_suspend(cursor, &mid_set, entry);
+      json_page_suspend(cursor);
+      return;
+    }
 
-    while (entry != &mid_set[idx]) {
-      abuf_json_mark_array_entry(&json_session, true, abuf);
+    abuf_json_mark_array_entry(&json_session, true, abuf);
 
-      abuf_json_mark_object(&json_session, true, false, abuf, "main");
-      abuf_json_ip_address(&json_session, abuf, "ipAddress", &entry->main_addr);
-      abuf_json_int(&json_session, abuf, "validityTime", entry->mid_timer ? (entry->mid_timer->timer_clock - now_times) : 0);
-      abuf_json_mark_object(&json_session, false, false, abuf, NULL); // main
+    abuf_json_mark_object(&json_session, true, false, abuf, "main");
+    abuf_json_ip_address(&json_session, abuf, "ipAddress", &entry->main_addr);
+    abuf_json_int(&json_session, abuf, "validityTime", entry->mid_timer ? (entry->mid_timer->timer_clock - now_times) : 0);
+    abuf_json_mark_object(&json_session, false, false, abuf, NULL); // main
 
-      {
-        struct mid_address * alias = entry->aliases;
+    {
+      struct mid_address * alias = entry->aliases;
 
-        abuf_json_mark_object(&json_session, true, true, abuf, "aliases");
-        while (alias) {
-          abuf_json_mark_array_entry(&json_session, true, abuf);
-          abuf_json_ip_address(&json_session, abuf, "ipAddress", &alias->alias);
-          abuf_json_int(&json_session, abuf, "validityTime", alias->vtime - now_times);
-          abuf_json_mark_array_entry(&json_session, false, abuf);
+      abuf_json_mark_object(&json_session, true, true, abuf, "aliases");
+      while (alias) {
+        abuf_json_mark_array_entry(&json_session, true, abuf);
+        abuf_json_ip_address(&json_session, abuf, "ipAddress", &alias->alias);
+        abuf_json_int(&json_session, abuf, "validityTime", alias->vtime - now_times);
+        abuf_json_mark_array_entry(&json_session, false, abuf);
 
-          alias = alias->next_alias;
-        }
-        abuf_json_mark_object(&json_session, false, true, abuf, NULL); // aliases
+        alias = alias->next_alias;
       }
-      abuf_json_mark_array_entry(&json_session, false, abuf); // entry
-
-      entry = entry->next;
+      abuf_json_mark_object(&json_session, false, true, abuf, NULL); // aliases
     }
+    abuf_json_mark_array_entry(&json_session, false, abuf); // entry
   }
   abuf_json_mark_object(&json_session, false, true, abuf, NULL); // mid
+  cursor->done = true;
+}
+
+void ipc_print_mid(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_mid_paged, abuf);
 }
 
 #ifdef __linux__
@@ -1211,6 +1293,7 @@ void ipc_print_config(struct autobuf *abuf) {
   // interfaces: later
   abuf_json_float(&json_session, abuf, "pollrate", olsr_cnf->pollrate);
   abuf_json_float(&json_session, abuf, "nicChgsPollInt", olsr_cnf->nic_chgs_pollrate);
+  abuf_json_int(&json_session, abuf, "inputBudget", olsr_cnf->input_budget);
   abuf_json_boolean(&json_session, abuf, "clearScreen", olsr_cnf->clear_screen);
   abuf_json_int(&json_session, abuf, "tcRedundancy", olsr_cnf->tc_redundancy);
   abuf_json_int(&json_session, abuf, "mprCoverage", olsr_cnf->mpr_coverage);
@@ -1392,3 +1475,51 @@ void ipc_print_plugins(struct autobuf *abuf) {
   }
   abuf_json_mark_object(&json_session, false, true, abuf, NULL);
 }
+
+void ipc_print_cookies(struct autobuf *abuf) {
+  olsr_cookie_t id;
+
+  abuf_json_mark_object(&json_session, true, true, abuf, "cookies");
+  for (id = 1; id < COOKIE_ID_MAX; id++) {
+    struct olsr_cookie_info *ci = olsr_cookie_get(id);
+    if (!ci) {
+      continue;
+    }
+
+    abuf_json_mark_array_entry(&json_session, true, abuf);
+    abuf_json_string(&json_session, abuf, "name", ci->ci_name ? ci->ci_name : "");
+    abuf_json_string(&json_session, abuf, "type", (ci->ci_type == OLSR_COOKIE_TYPE_MEMORY) ? "memory" : "timer");
+    abuf_json_int(&json_session, abuf, "size", ci->ci_size);
+    abuf_json_int(&json_session, abuf, "usage", ci->ci_usage);
+    abuf_json_int(&json_session, abuf, "changes", ci->ci_changes);
+    abuf_json_int(&json_session, abuf, "free", ci->ci_free);
+    abuf_json_int(&json_session, abuf, "slabs", ci->ci_slabs);
+    abuf_json_int(&json_session, abuf, "slabBytes", (long long) (ci->ci_slabs * ci->ci_slab_size));
+    abuf_json_int(&json_session, abuf, "timerWalks", ci->ci_timer_walks);
+    abuf_json_int(&json_session, abuf, "timerFires", ci->ci_timer_fires);
+    abuf_json_mark_array_entry(&json_session, false, abuf);
+  }
+  abuf_json_mark_object(&json_session, false, true, abuf, NULL);
+}
+
+void ipc_print_parser(struct autobuf *abuf) {
+  int type;
+
+  abuf_json_mark_object(&json_session, true, true, abuf, "parser");
+  for (type = 0; type < PARSER_TYPES; type++) {
+    const struct parser_type_stats *stats = olsr_parser_get_stats(type);
+    if (!stats->messages && !stats->handlers) {
+      continue;
+    }
+
+    abuf_json_mark_array_entry(&json_session, true, abuf);
+    abuf_json_int(&json_session, abuf, "type", type);
+    abuf_json_string(&json_session, abuf, "name", olsr_msgtype_to_string(type));
+    abuf_json_int(&json_session, abuf, "handlers", stats->handlers);
+    abuf_json_int(&json_session, abuf, "messages", stats->messages);
+    abuf_json_int(&json_session, abuf, "bytes", stats->bytes);
+    abuf_json_int(&json_session, abuf, "handlerTime", stats->handler_ns / 1000);
+    abuf_json_mark_array_entry(&json_session, false, abuf);
+  }
+  abuf_json_mark_object(&json_session, false, true, abuf, NULL);
+}
@@ -51,6 +51,8 @@
 
 #include "common/autobuf.h"
 
+struct info_cursor;
+
 extern struct timeval start_time;
 
 void plugin_init(const char * plugin_name);
@@ -67,9 +69,13 @@ void output_error(struct autobuf *abuf, unsigned int status, const char * req, b
 void ipc_print_neighbors(struct autobuf *abuf);
 void ipc_print_links(struct autobuf *abuf);
 void ipc_print_routes(struct autobuf *abuf);
+void ipc_print_routes_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_topology(struct autobuf *abuf);
+void ipc_print_topology_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_hna(struct autobuf *abuf);
+void ipc_print_hna_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_mid(struct autobuf *abuf);
+void ipc_print_mid_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_gateways(struct autobuf *abuf);
 void ipc_print_sgw(struct autobuf *abuf);
 void ipc_print_pud_position(struct autobuf *abuf);
@@ -79,5 +85,7 @@ void ipc_print_interfaces(struct autobuf *abuf);
 void ipc_print_twohop(struct autobuf *abuf);
 void ipc_print_config(struct autobuf *abuf);
 void ipc_print_plugins(struct autobuf *abuf);
+void ipc_print_cookies(struct autobuf *abuf);
+void ipc_print_parser(struct autobuf *abuf);
 
 #endif /* LIB_JSONINFO_SRC_OLSRD_JSONINFO_H_ */
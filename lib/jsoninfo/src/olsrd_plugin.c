@@ -114,6 +114,10 @@ int olsrd_plugin_init(void) {
   functions.topology = ipc_print_topology;
   functions.hna = ipc_print_hna;
   functions.mid = ipc_print_mid;
+  functions.routesPaged = ipc_print_routes_paged;
+  functions.topologyPaged = ipc_print_topology_paged;
+  functions.hnaPaged = ipc_print_hna_paged;
+  functions.midPaged = ipc_print_mid_paged;
   functions.gateways = ipc_print_gateways;
   functions.sgw = ipc_print_sgw;
   functions.pudPosition = ipc_print_pud_position;
@@ -123,6 +127,8 @@ int olsrd_plugin_init(void) {
   functions.twohop = ipc_print_twohop;
   functions.config = ipc_print_config;
   functions.plugins = ipc_print_plugins;
+  functions.cookies = ipc_print_cookies;
+  functions.parser = ipc_print_parser;
 
   return info_plugin_init(PLUGIN_NAME, &functions, &config);
 }
@@ -101,6 +101,7 @@ mapwrite_work(FILE * fmap)
   struct olsr_if *ifs;
   union olsr_ip_addr ip;
   struct ipaddr_str strbuf1, strbuf2;
+  struct mid_entry *mid;
   struct tc_entry *tc;
   struct tc_edge_entry *tc_edge;
 
@@ -127,21 +128,17 @@ mapwrite_work(FILE * fmap)
     }
   }
 
-  for (hash = 0; hash < HASHSIZE; hash++) {
-    struct mid_entry *entry = mid_set[hash].next;
-    while (entry != &mid_set[hash]) {
-      struct mid_address *alias = entry->aliases;
-      while (alias) {
-        if (0 >
-            fprintf(fmap, "Mid('%s','%s');\n", olsr_ip_to_string(&strbuf1, &entry->main_addr),
-                    olsr_ip_to_string(&strbuf2, &alias->alias))) {
-          return;
-        }
-        alias = alias->next_alias;
+  OLSR_FOR_ALL_MID_ENTRIES(mid) {
+    struct mid_address *alias = mid->aliases;
+    while (alias) {
+      if (0 >
+          fprintf(fmap, "Mid('%s','%s');\n", olsr_ip_to_string(&strbuf1, &mid->main_addr),
+                  olsr_ip_to_string(&strbuf2, &alias->alias))) {
+        return;
       }
-      entry = entry->next;
+      alias = alias->next_alias;
     }
-  }
+  } OLSR_FOR_ALL_MID_ENTRIES_END(mid);
   lookup_defhna_latlon(&ip);
   sprintf(my_latlon_str, "%f,%f,%d", (double)my_lat, (double)my_lon, get_isdefhna_latlon());
   if (0 >
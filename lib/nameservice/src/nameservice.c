@@ -1268,40 +1268,46 @@ write_services_file(bool writemacs)
   }
 }
 
+/* an upstream nameserver and the route used to reach it */
+struct nameserver_route {
+  struct rt_entry *route;
+  union olsr_ip_addr ip;
+};
+
 /**
- * Sort the nameserver pointer array.
+ * Sort the nameserver array.
  *
  * fresh entries are at the beginning of the array and
  * the best entry is at the end of the array.
  */
 static void
-select_best_nameserver(struct rt_entry **rt)
+select_best_nameserver(struct nameserver_route *ns)
 {
   int nameserver_idx;
-  struct rt_entry *rt1, *rt2;
+  struct nameserver_route ns1, ns2;
 
   for (nameserver_idx = 0; nameserver_idx < NAMESERVER_COUNT; nameserver_idx++) {
 
-    rt1 = rt[nameserver_idx];
-    rt2 = rt[nameserver_idx + 1];
+    ns1 = ns[nameserver_idx];
+    ns2 = ns[nameserver_idx + 1];
 
     /*
-     * compare the next two pointers in the array.
-     * if the second pointer is NULL then percolate it up.
+     * compare the next two entries in the array.
+     * if the second entry is empty then percolate it up.
      */
-    if (!rt2 || olsr_cmp_rt(rt1, rt2)) {
+    if (!ns2.route || olsr_cmp_rt(ns1.route, ns2.route)) {
 #ifndef NODEBUG
       struct ipaddr_str strbuf;
       struct lqtextbuffer lqbuffer;
 #endif /* NODEBUG */
       /*
-       * first is better, swap the pointers.
+       * first is better, swap the entries.
        */
-      OLSR_PRINTF(6, "NAME PLUGIN: nameserver %s, cost %s\n", olsr_ip_to_string(&strbuf, &rt1->rt_dst.prefix),
-                  get_linkcost_text(rt1->rt_best->rtp_metric.cost, true, &lqbuffer));
+      OLSR_PRINTF(6, "NAME PLUGIN: nameserver %s, cost %s\n", olsr_ip_to_string(&strbuf, &ns1.ip),
+                  get_linkcost_text(ns1.route->rt_best->rtp_metric.cost, true, &lqbuffer));
 
-      rt[nameserver_idx] = rt2;
-      rt[nameserver_idx + 1] = rt1;
+      ns[nameserver_idx] = ns2;
+      ns[nameserver_idx + 1] = ns1;
     }
   }
 }
@@ -1318,7 +1324,7 @@ write_resolv_file(void)
   struct db_entry *entry;
   struct list_node *list_head, *list_node;
   struct rt_entry *route;
-  static struct rt_entry *nameserver_routes[NAMESERVER_COUNT + 1];
+  static struct nameserver_route nameserver_routes[NAMESERVER_COUNT + 1];
   FILE *resolv;
   int i = 0;
   time_t currtime;
@@ -1340,7 +1346,11 @@ write_resolv_file(void)
           struct ipaddr_str strbuf;
           struct lqtextbuffer lqbuffer;
 #endif /* NODEBUG */
-          route = olsr_lookup_routing_table(&name->ip);
+          /*
+           * the nameserver may be a node or sit in an HNA network,
+           * the covering route is only used to rank it by cost
+           */
+          route = olsr_lookup_best_route(&name->ip);
 
           OLSR_PRINTF(6, "NAME PLUGIN: check route for nameserver %s %s", olsr_ip_to_string(&strbuf, &name->ip),
                       route ? "suceeded" : "failed");
@@ -1349,7 +1359,8 @@ write_resolv_file(void)
             continue;
 
           /* enqueue it on the head of list */
-          *nameserver_routes = route;
+          nameserver_routes[0].route = route;
+          nameserver_routes[0].ip = name->ip;
           OLSR_PRINTF(6, "NAME PLUGIN: found nameserver %s, cost %s", olsr_ip_to_string(&strbuf, &name->ip),
                       get_linkcost_text(route->rt_best->rtp_metric.cost, true, &lqbuffer));
 
@@ -1361,7 +1372,7 @@ write_resolv_file(void)
   }
 
   /* if there is no best route we are done */
-  if (nameserver_routes[NAMESERVER_COUNT] == NULL)
+  if (nameserver_routes[NAMESERVER_COUNT].route == NULL)
     return;
 
   /* write to file */
@@ -1377,7 +1388,7 @@ write_resolv_file(void)
   for (i = NAMESERVER_COUNT; i >= 0; i--) {
     struct ipaddr_str strbuf;
 
-    route = nameserver_routes[i];
+    route = nameserver_routes[i].route;
 
     OLSR_PRINTF(2, "NAME PLUGIN: nameserver_routes #%d %p\n", i, route);
 
@@ -1385,8 +1396,8 @@ write_resolv_file(void)
       continue;
     }
 
-    OLSR_PRINTF(2, "NAME PLUGIN: nameserver %s\n", olsr_ip_to_string(&strbuf, &route->rt_dst.prefix));
-    fprintf(resolv, "nameserver %s\n", olsr_ip_to_string(&strbuf, &route->rt_dst.prefix));
+    OLSR_PRINTF(2, "NAME PLUGIN: nameserver %s\n", olsr_ip_to_string(&strbuf, &nameserver_routes[i].ip));
+    fprintf(resolv, "nameserver %s\n", olsr_ip_to_string(&strbuf, &nameserver_routes[i].ip));
   }
   if (time(&currtime)) {
     fprintf(resolv, "\n### written by olsrd at %s", ctime(&currtime));
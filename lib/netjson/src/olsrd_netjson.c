@@ -167,7 +167,7 @@ void ipc_print_network_graph(struct autobuf *abuf) {
   struct tc_entry * tc;
   struct link_entry * link_entry;
   struct neighbor_entry * neighbor;
-  int idx;
+  struct mid_entry * mid_entry;
 
   avl_init(&nodes, (olsr_cnf->ip_version == AF_INET) ? avl_comp_ipv4 : avl_comp_ipv6);
 
@@ -192,13 +192,9 @@ void ipc_print_network_graph(struct autobuf *abuf) {
   netjson_midIntoNodesTree(&nodes, &mid_self);
 
   /* MID */
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct mid_entry * entry = mid_set[idx].next;
-    while (entry != &mid_set[idx]) {
-      netjson_midIntoNodesTree(&nodes, entry);
-      entry = entry->next;
-    }
-  }
+  OLSR_FOR_ALL_MID_ENTRIES(mid_entry) {
+    netjson_midIntoNodesTree(&nodes, mid_entry);
+  } OLSR_FOR_ALL_MID_ENTRIES_END(mid_entry);
 
   /* TC */
   OLSR_FOR_ALL_TC_ENTRIES(tc) {
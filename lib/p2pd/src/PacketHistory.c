@@ -59,16 +59,16 @@
 #include <string.h> /* memset */
 #include <sys/types.h> /* u_int16_t, u_int32_t */
 #include <netinet/ip.h> /* struct iphdr */
-#include <stdlib.h> /* free() */
 
 /* OLSRD includes */
 #include "olsr.h" /* olsr_printf */
-#include "scheduler.h" /* GET_TIMESTAMP, TIMED_OUT */
+#include "scheduler.h" /* now_times */
+#include "common/dupcache.h"
 
 /* Plugin includes */
 #include "Packet.h"
 
-static struct TDupEntry* PacketHistory[HISTORY_HASH_SIZE];
+static struct dupcache PacketHistory;
 
 #define CRC_UPTO_NBYTES 256
 
@@ -172,22 +172,9 @@ u_int32_t PacketCrc32(unsigned char* ipPacket, ssize_t len)
   return result;
 } /* PacketCrc32 */
 
-/* -------------------------------------------------------------------------
- * Function   : Hash
- * Description: Calculates a hash value from a 32-bit value
- * Input      : from32 - 32-bit value
- * Output     : none
- * Return     : hash value
- * Data Used  : none
- * ------------------------------------------------------------------------- */
-u_int32_t Hash(u_int32_t from32)
-{
-  return ((from32 >> N_HASH_BITS) + from32) & ((1u << N_HASH_BITS) - 1);
-} /* Hash */
-
 /* -------------------------------------------------------------------------
  * Function   : InitPacketHistory
- * Description: Initialize the packet history table and CRC-32 table
+ * Description: Initialize the packet history cache and CRC-32 table
  * Input      : none
  * Output     : none
  * Return     : none
@@ -195,16 +182,27 @@ u_int32_t Hash(u_int32_t from32)
  * ------------------------------------------------------------------------- */
 void InitPacketHistory(void)
 {
-  unsigned int i;
-
   GenerateCrc32Table();
 
-  for(i = 0; i < HISTORY_HASH_SIZE; i++)
+  if (dupcache_init(&PacketHistory, "P2PD packet history", sizeof(u_int32_t), HISTORY_HOLD_TIME, true) < 0)
   {
-    PacketHistory[i] = NULL;
+    olsr_printf(1, "OLSRD P2PD: could not initialize the packet history\n");
   }
 } /* InitPacketHistory */
 
+/* -------------------------------------------------------------------------
+ * Function   : ClosePacketHistory
+ * Description: Free the packet history cache
+ * Input      : none
+ * Output     : none
+ * Return     : none
+ * Data Used  : PacketHistory
+ * ------------------------------------------------------------------------- */
+void ClosePacketHistory(void)
+{
+  dupcache_free(&PacketHistory);
+} /* ClosePacketHistory */
+
 /* -------------------------------------------------------------------------
  * Function   : CheckAndMarkRecentPacket
  * Description: Check if this packet was seen recently, then record the fact
@@ -216,83 +214,6 @@ void InitPacketHistory(void)
  * ------------------------------------------------------------------------- */
 int CheckAndMarkRecentPacket(u_int32_t crc32)
 {
-  u_int32_t idx;
-  struct TDupEntry* walker;
-  struct TDupEntry* newEntry;
-
-  idx = Hash(crc32);
-  assert(idx < HISTORY_HASH_SIZE);
-
-  for (walker = PacketHistory[idx]; walker != NULL; walker = walker->next)
-  {
-    if (walker->crc32 == crc32)
-    {
-      /* Found duplicate entry */
-
-      /* Always mark as "seen recently": refresh time-out */
-      walker->timeOut = olsr_getTimestamp(HISTORY_HOLD_TIME);
-
-      return 1;
-    } /* if */
-  } /* for */
-
-  /* No duplicate entry found: create one */
-  newEntry = olsr_malloc(sizeof(struct TDupEntry), "OLSRD P2PD: TDupEntry");
-  if (newEntry != NULL)
-  {
-    newEntry->crc32 = crc32;
-    newEntry->timeOut = olsr_getTimestamp(HISTORY_HOLD_TIME);
-
-    /* Add new entry at the front of the list */
-    newEntry->next = PacketHistory[idx];
-    PacketHistory[idx] = newEntry;
-  }
-
-  return 0;
+  /* A hit refreshes the time-out: the packet is marked as "seen recently" */
+  return dupcache_seen(&PacketHistory, &crc32, now_times) ? 1 : 0;
 } /* CheckAndMarkRecentPacket */
-  
-/* -------------------------------------------------------------------------
- * Function   : PrunePacketHistory
- * Description: Prune the packet history table.
- * Input      : useless - not used
- * Output     : none
- * Return     : none
- * Data Used  : PacketHistory
- * ------------------------------------------------------------------------- */
-void PrunePacketHistory(void* useless __attribute__ ((unused)))
-{
-  uint i;
-  for (i = 0; i < HISTORY_HASH_SIZE; i++)
-  {
-    if (PacketHistory[i] != NULL)
-    {
-      struct TDupEntry* nextEntry = PacketHistory[i];
-      struct TDupEntry* prevEntry = NULL;
-      while (nextEntry != NULL) 
-      {
-        struct TDupEntry* entry = nextEntry;
-        nextEntry = entry->next;
-
-        if (olsr_isTimedOut(entry->timeOut))
-        {
-          /* De-queue */
-          if (prevEntry != NULL)
-          {
-            prevEntry->next = entry->next;
-          }
-          else
-          {
-            PacketHistory[i] = entry->next;
-          } /* if */
-
-          /* De-allocate memory */
-          free(entry); 
-	      }
-	      else
-	      {
-	        prevEntry = entry;
-	      } /* if */
-      } /* while */
-    } /* if (PacketHistory[i] != NULL) */
-  } /* for (i = ...) */
-} /* PrunePacketHistory */
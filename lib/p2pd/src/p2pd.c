@@ -76,6 +76,8 @@
 #include "link_set.h"           /* get_best_link_to_neighbor() */
 #include "net_olsr.h"           /* ipequal */
 #include "parser.h"
+#include "scheduler.h"          /* now_times */
+#include "common/dupcache.h"
 
 /* plugin includes */
 #include "NetworkInterfaces.h"  /* NonOlsrInterface,
@@ -86,7 +88,6 @@
                                    BMF_ENCAP_TYPE,
                                    BMF_ENCAP_LEN etc. */
 #include "PacketHistory.h"
-#include "dllist.h"
 
 int P2pdTtl                        = 0;
 int P2pdUseHash                    = 0;  /* Switch off hash filter by default */
@@ -96,10 +97,9 @@ int P2pdDuplicateTimeout           = P2PD_VALID_TIME;
 /* List of UDP destination address and port information */
 struct UdpDestPort *                 UdpDestPortList = NULL;
 
-/* List of filter entries to check for duplicate messages
+/* Cache of the recently seen messages, to check for duplicate messages
  */
-struct node *                        dupFilterHead = NULL;
-struct node *                        dupFilterTail = NULL;
+static struct dupcache               dupFilter;
 
 bool is_broadcast(const struct sockaddr_in addr);
 bool is_multicast(const struct sockaddr_in addr);
@@ -290,123 +290,31 @@ int HighestSkfd = -1;
 /* Set of socket file descriptors */
 fd_set InputSet;
 
-/* -------------------------------------------------------------------------
- * Function   : p2pd_message_seen
- * Description: Check whether the current message has been seen before
- * Input      : head - start of the list to check for the message
- *              tail - end of the list to check for the message
- *              m    - message to check for in the list
- * Output     : none
- * Return     : true if message was found, false otherwise
- * Data Used  : P2pdDuplicateTimeout
- * ------------------------------------------------------------------------- */
-bool
-p2pd_message_seen(struct node **head, struct node **tail, union olsr_message *m)
-{
-  struct node * curr;
-  time_t now;
-
-  now = time(NULL);
-
-  // Check whether any entries have aged
-  curr = *head;
-  while (curr) {
-    struct DupFilterEntry *filter;
-    struct node * next = curr->next; // Save the current pointer since curr may
-                                     // be destroyed
-
-    filter = (struct DupFilterEntry*)curr->data;
-
-    if ((filter->creationtime + P2pdDuplicateTimeout) < now)
-      remove_node(head, tail, curr, true);
-
-    // Skip to the next element
-    curr = next;
-  }
-
-  // Now check whether there are any duplicates
-  for (curr = *head; curr; curr = curr->next) {
-    struct DupFilterEntry *filter = (struct DupFilterEntry*)curr->data;
-
-    if (olsr_cnf->ip_version == AF_INET) {
-      if (filter->address.v4.s_addr == m->v4.originator &&
-          filter->msgtype == m->v4.olsr_msgtype &&
-          filter->seqno == m->v4.seqno) {
-          return true;
-      }
-    } else /* if (olsr_cnf->ip_version == AF_INET6) */ {
-      if (memcmp(filter->address.v6.s6_addr,
-                 m->v6.originator.s6_addr,
-                 sizeof(m->v6.originator.s6_addr)) == 0 &&
-          filter->msgtype == m->v6.olsr_msgtype &&
-          filter->seqno == m->v6.seqno) {
-          return true;
-      }
-    }
-  }
-
-  return false;
-}
-
-/* -------------------------------------------------------------------------
- * Function   : p2pd_store_message
- * Description: Store a new message in the duplicate message check list
- * Input      : head - start of the list to add the message to
- *              tail - end of the list to add the message to
- *              m    - message to add to the list
- * Output     : none
- * Return     : nothing
- * Data Used  : none
- * ------------------------------------------------------------------------- */
-void
-p2pd_store_message(struct node **head, struct node **tail, union olsr_message *m)
-{
-  time_t now;
-
-  // Store a message into the database
-  struct DupFilterEntry *new_dup = calloc(1, sizeof(struct DupFilterEntry));
-  if (new_dup == NULL) {
-    OLSR_PRINTF(1, "%s: Out of memory\n", PLUGIN_NAME_SHORT);
-    return;
-  }
-
-  now = time(NULL);
-
-  new_dup->creationtime = now;
-  if (olsr_cnf->ip_version == AF_INET) {
-    new_dup->address.v4.s_addr = m->v4.originator;
-    new_dup->msgtype           = m->v4.olsr_msgtype;
-    new_dup->seqno             = m->v4.seqno;
-  } else /* if (olsr_cnf->ip_version == AF_INET6) */ {
-    memcpy(new_dup->address.v6.s6_addr,
-           m->v6.originator.s6_addr,
-           sizeof(m->v6.originator.s6_addr));
-    new_dup->msgtype           = m->v6.olsr_msgtype;
-    new_dup->seqno             = m->v6.seqno;
-  }
-
-  // Add the element to the head of the list
-  append_node(head, tail, new_dup);
-}
-
 /* -------------------------------------------------------------------------
  * Function   : p2pd_is_duplicate_message
  * Description: Check whether the specified message is a duplicate
  * Input      : msg - message to check for in the list of duplicate messages
  * Output     : none
  * Return     : true if message was found, false otherwise
- * Data Used  : none
+ * Data Used  : dupFilter
  * ------------------------------------------------------------------------- */
 bool
 p2pd_is_duplicate_message(union olsr_message *msg)
 {
-  if(p2pd_message_seen(&dupFilterHead, &dupFilterTail, msg)) {
-    return true;
-  }
+  uint8_t key[DUPCACHE_KEY_MAX];
 
-  p2pd_store_message(&dupFilterHead, &dupFilterTail, msg);
+  /* Originator, message type and sequence number identify the message */
+  if (olsr_cnf->ip_version == AF_INET) {
+    memcpy(key, &msg->v4.originator, olsr_cnf->ipsize);
+    key[olsr_cnf->ipsize] = msg->v4.olsr_msgtype;
+    memcpy(&key[olsr_cnf->ipsize + 1], &msg->v4.seqno, sizeof(msg->v4.seqno));
+  } else /* if (olsr_cnf->ip_version == AF_INET6) */ {
+    memcpy(key, &msg->v6.originator, olsr_cnf->ipsize);
+    key[olsr_cnf->ipsize] = msg->v6.olsr_msgtype;
+    memcpy(&key[olsr_cnf->ipsize + 1], &msg->v6.seqno, sizeof(msg->v6.seqno));
+  }
 
-  return false;
+  return dupcache_seen(&dupFilter, key, now_times);
 }
 
 /* -------------------------------------------------------------------------
@@ -877,6 +785,11 @@ DoP2pd(int skfd,
 int
 InitP2pd(struct interface_olsr *skipThisIntf)
 {
+  /* Originator, message type and sequence number */
+  if (dupcache_init(&dupFilter, "P2PD duplicate filter", olsr_cnf->ipsize + 3, P2pdDuplicateTimeout * MSEC_PER_SEC, false) < 0) {
+    P2pdPError("Could not initialize the duplicate message filter");
+  }
+
   if (P2pdUseHash) {
     // Initialize hash table for hash based duplicate IP packet check
     InitPacketHistory();
@@ -904,6 +817,8 @@ void
 CloseP2pd(void)
 {
   CloseNonOlsrNetworkInterfaces();
+  ClosePacketHistory();
+  dupcache_free(&dupFilter);
 }
 
 /* -------------------------------------------------------------------------
@@ -1167,23 +1082,30 @@ dump_packet(unsigned char* packet, int length)
  * Data Used  : P2pdUseHash
  * ------------------------------------------------------------------------- */
 bool
-check_and_mark_recent_packet(unsigned char *data,
-                             int len __attribute__ ((unused)))
+check_and_mark_recent_packet(unsigned char *data, int len)
 {
   unsigned char * ipPacket;
-  uint16_t ipPacketLen;
+  int ipPacketLen;
   uint32_t crc32;
 
   /* If we don't use this filter bail out here */
   if (!P2pdUseHash)
     return false;
-    
-  /* Clean up the hash table each time before we check it */
-  PrunePacketHistory(NULL);
 
-  /* Check for duplicate IP packets now based on a hash */
-  ipPacket = GetIpPacket(data);
-  ipPacketLen = GetIpTotalLength(ipPacket);
+  /* Check for duplicate IP packets now based on a hash. Both callers pass
+   * the bare IP packet, there is no encapsulation header in front of it. */
+  ipPacket = data;
+  if ((ipPacket[0] & 0xf0) == 0x40) {
+    ipPacketLen = GetIpTotalLength(ipPacket);
+  } else {
+    ipPacketLen = 40 + ntohs(((struct ip6_hdr *) ARM_NOWARN_ALIGN(ipPacket))->ip6_plen);
+  }
+
+  /* Never hash beyond the received data */
+  if (ipPacketLen > len)
+    ipPacketLen = len;
+  if (ipPacketLen <= 0)
+    return false;
 
   /* Calculate packet fingerprint */
   crc32 = PacketCrc32(ipPacket, ipPacketLen);
@@ -55,7 +55,6 @@
 #include "olsrd_plugin.h"             /* union set_plugin_parameter_addon */
 #include "duplicate_set.h"
 //#include "socket_parser.h"
-#include "dllist.h"
 
 #define P2PD_MESSAGE_TYPE         132
 #define PARSER_TYPE               P2PD_MESSAGE_TYPE
@@ -71,14 +70,6 @@
 /* Forward declaration of OLSR interface type */
 struct interface_olsr;
 
-struct DupFilterEntry {
-  int                            ip_version;
-  union olsr_ip_addr             address;
-  uint16_t                       seqno;
-  uint8_t                        msgtype;
-  time_t                         creationtime;
-};
-
 struct UdpDestPort {
   int                            ip_version;
   union olsr_ip_addr             address;
@@ -104,8 +95,6 @@ bool InUdpDestPortList(int ip_version, union olsr_ip_addr *addr, uint16_t port);
 int SetP2pdTtl(const char *value, void *data __attribute__ ((unused)), set_plugin_parameter_addon addon __attribute__ ((unused)));
 int SetP2pdUseHashFilter(const char *value, void *data __attribute__ ((unused)), set_plugin_parameter_addon addon __attribute__ ((unused)));
 int SetP2pdUseTtlDecrement(const char *value, void *data __attribute__ ((unused)), set_plugin_parameter_addon addon __attribute__ ((unused)));
-bool p2pd_message_seen(struct node **head, struct node **tail, union olsr_message *m);
-void p2pd_store_message(struct node **head, struct node **tail, union olsr_message *m);
 bool p2pd_is_duplicate_message(union olsr_message *msg);
 
 void olsr_p2pd_gen(unsigned char *packet, int len);
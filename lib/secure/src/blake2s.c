@@ -0,0 +1,242 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#include "blake2s.h"
+
+#include <string.h>
+
+static const uint32_t blake2s_iv[8] = {
+  0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+  0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+static const uint8_t blake2s_sigma[10][16] = {
+  { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+  { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+  { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+  { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+  { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+  { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+  { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+  { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+  { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+  { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 }
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* the mixing function */
+#define G(a, b, c, d, x, y) \
+  do { \
+    v[a] = v[a] + v[b] + (x); v[d] = ROTR32(v[d] ^ v[a], 16); \
+    v[c] = v[c] + v[d];       v[b] = ROTR32(v[b] ^ v[c], 12); \
+    v[a] = v[a] + v[b] + (y); v[d] = ROTR32(v[d] ^ v[a], 8); \
+    v[c] = v[c] + v[d];       v[b] = ROTR32(v[b] ^ v[c], 7); \
+  } while (0)
+
+/* the rounds are spelled out so the message schedule is constant */
+#define ROUND(r) \
+  do { \
+    G(0, 4, 8, 12, m[blake2s_sigma[r][0]], m[blake2s_sigma[r][1]]); \
+    G(1, 5, 9, 13, m[blake2s_sigma[r][2]], m[blake2s_sigma[r][3]]); \
+    G(2, 6, 10, 14, m[blake2s_sigma[r][4]], m[blake2s_sigma[r][5]]); \
+    G(3, 7, 11, 15, m[blake2s_sigma[r][6]], m[blake2s_sigma[r][7]]); \
+    G(0, 5, 10, 15, m[blake2s_sigma[r][8]], m[blake2s_sigma[r][9]]); \
+    G(1, 6, 11, 12, m[blake2s_sigma[r][10]], m[blake2s_sigma[r][11]]); \
+    G(2, 7, 8, 13, m[blake2s_sigma[r][12]], m[blake2s_sigma[r][13]]); \
+    G(3, 4, 9, 14, m[blake2s_sigma[r][14]], m[blake2s_sigma[r][15]]); \
+  } while (0)
+
+static uint32_t
+blake2s_load32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void
+blake2s_compress(BLAKE2S_CTX *ctx, int last)
+{
+  uint32_t v[16], m[16];
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    v[i] = ctx->h[i];
+    v[i + 8] = blake2s_iv[i];
+  }
+  v[12] ^= ctx->t[0];
+  v[13] ^= ctx->t[1];
+  if (last) {
+    v[14] = ~v[14];
+  }
+
+  for (i = 0; i < 16; i++) {
+    m[i] = blake2s_load32(&ctx->buf[i * 4]);
+  }
+
+  ROUND(0);
+  ROUND(1);
+  ROUND(2);
+  ROUND(3);
+  ROUND(4);
+  ROUND(5);
+  ROUND(6);
+  ROUND(7);
+  ROUND(8);
+  ROUND(9);
+
+  for (i = 0; i < 8; i++) {
+    ctx->h[i] ^= v[i] ^ v[i + 8];
+  }
+}
+
+static void
+blake2s_count(BLAKE2S_CTX *ctx, size_t n)
+{
+  ctx->t[0] += (uint32_t)n;
+  if (ctx->t[0] < n) {
+    ctx->t[1]++;
+  }
+}
+
+/**
+ * Start a BLAKE2s calculation.
+ *
+ * @param ctx the context
+ * @param outlen the length of the digest, 1 to BLAKE2S_OUTBYTES
+ * @param key the key, NULL for an unkeyed digest
+ * @param keylen the length of the key, at most BLAKE2S_KEYBYTES
+ * @return 0 on success, -1 on invalid lengths
+ */
+int
+blake2s_init(BLAKE2S_CTX *ctx, size_t outlen, const void *key, size_t keylen)
+{
+  int i;
+
+  if (outlen == 0 || outlen > BLAKE2S_OUTBYTES || keylen > BLAKE2S_KEYBYTES) {
+    return -1;
+  }
+
+  for (i = 0; i < 8; i++) {
+    ctx->h[i] = blake2s_iv[i];
+  }
+  /* parameter block: digest length, key length, fanout and depth 1 */
+  ctx->h[0] ^= 0x01010000 ^ ((uint32_t)keylen << 8) ^ (uint32_t)outlen;
+  ctx->t[0] = ctx->t[1] = 0;
+  ctx->buflen = 0;
+  ctx->outlen = outlen;
+
+  /* the key is processed as a first, zero padded block */
+  if (keylen > 0) {
+    memset(ctx->buf, 0, sizeof(ctx->buf));
+    memcpy(ctx->buf, key, keylen);
+    ctx->buflen = BLAKE2S_BLOCKBYTES;
+  }
+  return 0;
+}
+
+/**
+ * Add data to a BLAKE2s calculation.
+ *
+ * @param ctx the context
+ * @param in the data
+ * @param inlen the length of the data
+ */
+void
+blake2s_update(BLAKE2S_CTX *ctx, const void *in, size_t inlen)
+{
+  const uint8_t *p = in;
+
+  while (inlen > 0) {
+    size_t n;
+
+    /* the last block is compressed by blake2s_final(), so keep a full one buffered */
+    if (ctx->buflen == BLAKE2S_BLOCKBYTES) {
+      blake2s_count(ctx, BLAKE2S_BLOCKBYTES);
+      blake2s_compress(ctx, 0);
+      ctx->buflen = 0;
+    }
+
+    n = BLAKE2S_BLOCKBYTES - ctx->buflen;
+    if (n > inlen) {
+      n = inlen;
+    }
+    memcpy(&ctx->buf[ctx->buflen], p, n);
+    ctx->buflen += n;
+    p += n;
+    inlen -= n;
+  }
+}
+
+/**
+ * Finish a BLAKE2s calculation.
+ *
+ * @param ctx the context
+ * @param out receives the digest, of the length given to blake2s_init()
+ */
+void
+blake2s_final(BLAKE2S_CTX *ctx, void *out)
+{
+  uint8_t digest[BLAKE2S_OUTBYTES];
+  int i;
+
+  blake2s_count(ctx, ctx->buflen);
+  memset(&ctx->buf[ctx->buflen], 0, BLAKE2S_BLOCKBYTES - ctx->buflen);
+  blake2s_compress(ctx, 1);
+
+  for (i = 0; i < 8; i++) {
+    digest[i * 4] = (uint8_t)ctx->h[i];
+    digest[i * 4 + 1] = (uint8_t)(ctx->h[i] >> 8);
+    digest[i * 4 + 2] = (uint8_t)(ctx->h[i] >> 16);
+    digest[i * 4 + 3] = (uint8_t)(ctx->h[i] >> 24);
+  }
+  memcpy(out, digest, ctx->outlen);
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -77,7 +77,7 @@ my_init(void)
   /* Print plugin info to stdout */
   olsr_printf(0, "%s (%s)\n", PLUGIN_NAME, git_descriptor);
 
-  olsr_printf(0, "[ENC]Accepted parameter pairs: (\"Keyfile\" <FILENAME>)\n");
+  olsr_printf(0, "[ENC]Accepted parameter pairs: (\"Keyfile\" <FILENAME>) (\"Algorithm\" <md5|sha1|blake2s>)\n");
 }
 
 /**
@@ -106,6 +106,7 @@ store_string(const char *value, void *data, set_plugin_parameter_addon addon __a
 
 static const struct olsrd_plugin_parameters plugin_parameters[] = {
   {.name = "keyfile",.set_plugin_parameter = &store_string,.data = keyfile},
+  {.name = "algorithm",.set_plugin_parameter = &set_algorithm,.data = NULL},
 };
 
 void
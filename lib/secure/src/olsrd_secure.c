@@ -70,34 +70,64 @@
 #include "scheduler.h"
 #include "net_olsr.h"
 #include "olsr_random.h"
+#include "common/dupcache.h"
+
+#include "blake2s.h"
 
 #ifdef USE_OPENSSL
 
 /* OpenSSL stuff */
-#include <openssl/sha.h>
+#include <openssl/evp.h>
+
+#define SCHEME      SHA1_INCLUDING_KEY
+#define SCHEME_NAME "sha1"
 
-#define CHECKSUM SHA1
-#define SCHEME   SHA1_INCLUDING_KEY
+static EVP_MD_CTX *sha1_context;
 
 #else /* USE_OPENSSL */
 
 /* Homebrewn checksuming */
 #include "md5.h"
 
+#define SCHEME      MD5_INCLUDING_KEY
+#define SCHEME_NAME "md5"
+
+#endif /* USE_OPENSSL */
+
+/* algorithm used to sign and validate, all nodes must use the same */
+static uint8_t algorithm = SCHEME;
+
+/*
+ * Build the checksum of data. With a key the built-in hash is taken
+ * over the data followed by the key, BLAKE2s uses its own keyed mode.
+ * The data is hashed in place, so there is no need to copy packet and
+ * key into one buffer first.
+ */
 static void
-MD5_checksum(const uint8_t * data, const uint16_t data_len, uint8_t * hashbuf)
+secure_checksum(const void *data, size_t data_len, const void *key, size_t key_len, uint8_t * hashbuf)
 {
-  MD5_CTX context;
-
-  MD5Init(&context);
-  MD5Update(&context, data, data_len);
-  MD5Final(hashbuf, &context);
-}
+  if (algorithm == BLAKE2S_KEYED) {
+    BLAKE2S_CTX context;
 
-#define CHECKSUM MD5_checksum
-#define SCHEME   MD5_INCLUDING_KEY
+    blake2s_init(&context, SIGNATURE_SIZE, key, key_len);
+    blake2s_update(&context, data, data_len);
+    blake2s_final(&context, hashbuf);
+  } else {
+#ifdef USE_OPENSSL
+    EVP_DigestInit_ex(sha1_context, EVP_sha1(), NULL);
+    EVP_DigestUpdate(sha1_context, data, data_len);
+    EVP_DigestUpdate(sha1_context, key, key_len);
+    EVP_DigestFinal_ex(sha1_context, hashbuf, NULL);
+#else /* USE_OPENSSL */
+    MD5_CTX context;
 
+    MD5Init(&context);
+    MD5Update(&context, data, data_len);
+    MD5Update(&context, key, key_len);
+    MD5Final(hashbuf, &context);
 #endif /* USE_OPENSSL */
+  }
+}
 
 #ifdef OS
 #undef OS
@@ -141,7 +171,19 @@ struct stamp {
 /* Seconds to cache a not verified timestamp entry */
 #define EXCHANGE_HOLD_TIME 5
 
-static struct stamp timestamps[HASHSIZE];
+/*
+ * Milliseconds to remember a validated signature. A packet repeating
+ * it on the same interface is a replay and is dropped without checking
+ * the signature again. This must cover the timestamp slack.
+ */
+#define REPLAY_HOLD_TIME 10000
+
+/* signature bytes plus interface index in the replay cache key */
+#define REPLAY_SIG_BYTES 16
+
+static struct olsr_hashtable timestamps;
+
+static struct dupcache replay_cache;
 
 char keyfile[FILENAME_MAX + 1];
 char aes_key[16];
@@ -171,18 +213,40 @@ static int read_key_from_file(const char *);
 
 static char printfBuffer[PATH_MAX * 2];
 
+int
+set_algorithm(const char *value, void *data __attribute__ ((unused)), set_plugin_parameter_addon addon __attribute__ ((unused)))
+{
+  if (strcasecmp(value, "blake2s") == 0) {
+    algorithm = BLAKE2S_KEYED;
+  } else if (strcasecmp(value, SCHEME_NAME) == 0) {
+    algorithm = SCHEME;
+  } else {
+    olsr_printf(0, "[ENC]Unsupported algorithm \"%s\", use \"%s\" or \"blake2s\"\n", value, SCHEME_NAME);
+    return 1;
+  }
+  return 0;
+}
+
 int
 secure_plugin_init(void)
 {
   int i;
 
   /* Initialize the timestamp database */
-  for (i = 0; i < HASHSIZE; i++) {
-    timestamps[i].next = &timestamps[i];
-    timestamps[i].prev = &timestamps[i];
-  }
+  olsr_hashtable_init(&timestamps, struct stamp, addr, next, prev);
   olsr_printf(1, "Timestamp database initialized\n");
 
+  if (dupcache_init(&replay_cache, "SECURE replay cache", REPLAY_SIG_BYTES + sizeof(uint32_t), REPLAY_HOLD_TIME, false) < 0) {
+    olsr_exit("SECURE: Could not initialize the replay cache", EXIT_FAILURE);
+  }
+
+#ifdef USE_OPENSSL
+  sha1_context = EVP_MD_CTX_new();
+  if (sha1_context == NULL) {
+    olsr_exit("SECURE: Could not allocate the SHA-1 context", EXIT_FAILURE);
+  }
+#endif /* USE_OPENSSL */
+
   if (!strlen(keyfile))
     strscpy(keyfile, KEYFILE, sizeof(keyfile));
 
@@ -220,7 +284,27 @@ plugin_ipc_init(void)
 void
 secure_plugin_exit(void)
 {
+  uint32_t idx;
+
   olsr_preprocessor_remove_function(&secure_preprocessor);
+
+  for (idx = 0; idx < olsr_hashtable_buckets(&timestamps); idx++) {
+    struct stamp *head = olsr_hashtable_bucket(&timestamps, idx);
+
+    while (head->next != head) {
+      struct stamp *entry = head->next;
+
+      olsr_hashtable_remove(&timestamps, entry);
+      free(entry);
+    }
+  }
+  olsr_hashtable_free(&timestamps);
+  dupcache_free(&replay_cache);
+
+#ifdef USE_OPENSSL
+  EVP_MD_CTX_free(sha1_context);
+  sha1_context = NULL;
+#endif /* USE_OPENSSL */
 }
 
 static char *
@@ -243,7 +327,7 @@ secure_preprocessor(char *packet, struct interface_olsr *olsr_if, union olsr_ip_
     return NULL;
   }
 
-  olsr_printf(1, "[ENC]Packet from %s OK size %d\n", olsr_ip_to_string(&buf, from_addr), *length);
+  olsr_printf(3, "[ENC]Packet from %s OK size %d\n", olsr_ip_to_string(&buf, from_addr), *length);
 
   /* Fix OLSR packet header */
   olsr->olsr_packlen = htons(*length);
@@ -285,8 +369,9 @@ check_auth(struct interface_olsr *olsr_if, char *pck, int *size __attribute__ ((
 
 /**
  * Packet transform function
- * Build a SHA-1/MD5 hash of the original message
- * + the signature message(-digest) + key
+ * Build a keyed hash (MD5/SHA-1 including the key or
+ * keyed BLAKE2s) of the original message + the
+ * signature message(-digest)
  *
  * Then add the signature message to the packet and
  * increase the size
@@ -319,7 +404,7 @@ add_signature(uint8_t * pck, int *size)
 
   /* Fill subheader */
   msg->sig.type = ONE_CHECKSUM;
-  msg->sig.algorithm = SCHEME;
+  msg->sig.algorithm = algorithm;
   memset(&msg->sig.reserved, 0, 2);
 
   /* Add timestamp */
@@ -330,17 +415,8 @@ add_signature(uint8_t * pck, int *size)
   /* Set the new size */
   *size += sizeof(struct s_olsrmsg);
 
-  {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, pck, *size - SIGNATURE_SIZE);
-    /* Then the key */
-    memcpy(&checksum_cache[*size - SIGNATURE_SIZE], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (*size - SIGNATURE_SIZE) + KEYLENGTH, &pck[*size - SIGNATURE_SIZE]);
-  }
+  /* Hash the OLSR packet + signature message - digest */
+  secure_checksum(pck, *size - SIGNATURE_SIZE, aes_key, KEYLENGTH, &pck[*size - SIGNATURE_SIZE]);
 
 #ifdef DEBUG
   olsr_printf(1, "Signature message:\n");
@@ -370,6 +446,7 @@ validate_packet(struct interface_olsr *olsr_if, const char *pck, int *size)
   uint8_t sha1_hash[SIGNATURE_SIZE];
   const struct s_olsrmsg *sig;
   time_t rec_time;
+  uint8_t replay_key[REPLAY_SIG_BYTES + sizeof(uint32_t)];
 
 #ifdef DEBUG
   unsigned int i;
@@ -411,37 +488,24 @@ validate_packet(struct interface_olsr *olsr_if, const char *pck, int *size)
   }
 
   /* Check scheme and type */
-  switch (sig->sig.type) {
-  case (ONE_CHECKSUM):
-    switch (sig->sig.algorithm) {
-    case (SCHEME):
-      goto one_checksum_SHA;    /* Ahhh... fix this */
-      break;
-    default:
-    	break;
-    }
-    break;
-
-  default:
+  if ((sig->sig.type != ONE_CHECKSUM) || (sig->sig.algorithm != algorithm)) {
     olsr_printf(1, "[ENC]Unsupported sceme: %d enc: %d!\n", sig->sig.type, sig->sig.algorithm);
     return 0;
   }
   //olsr_printf(1, "Packet sane...\n");
 
-one_checksum_SHA:
-
-  {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, pck, *size - SIGNATURE_SIZE);
-    /* Then the key */
-    memcpy(&checksum_cache[*size - SIGNATURE_SIZE], aes_key, KEYLENGTH);
+  /* A signature we validated a moment ago is a replay, drop it before hashing */
+  memcpy(replay_key, sig->sig.signature, REPLAY_SIG_BYTES);
+  memcpy(&replay_key[REPLAY_SIG_BYTES], &olsr_if->if_index, sizeof(uint32_t));
 
-    /* generate SHA-1 */
-    CHECKSUM(checksum_cache, *size - SIGNATURE_SIZE + KEYLENGTH, sha1_hash);
+  if (dupcache_check(&replay_cache, replay_key, now_times)) {
+    olsr_printf(3, "[ENC]Replayed signature\n");
+    return 0;
   }
 
+  /* Hash the OLSR packet + signature message - digest */
+  secure_checksum(pck, *size - SIGNATURE_SIZE, aes_key, KEYLENGTH, sha1_hash);
+
 #ifdef DEBUG
   olsr_printf(1, "Recevied hash:\n");
 
@@ -477,8 +541,10 @@ one_checksum_SHA:
     return 0;
   }
 #ifndef _WIN32
-  olsr_printf(1, "[ENC]Received timestamp %lld diff: %lld\n", (long long)rec_time, (long long)now.tv_sec - (long long)rec_time);
+  olsr_printf(3, "[ENC]Received timestamp %lld diff: %lld\n", (long long)rec_time, (long long)now.tv_sec - (long long)rec_time);
 #endif /* _WIN32 */
+  dupcache_add(&replay_cache, replay_key, now_times);
+
   /* Remove signature message */
   *size = packetsize;
   return 1;
@@ -539,7 +605,7 @@ send_challenge(struct interface_olsr *olsr_if, const union olsr_ip_addr *new_hos
 {
   struct challengemsg cmsg;
   struct stamp *entry;
-  uint32_t challenge, hash;
+  uint32_t challenge;
   struct ipaddr_str buf;
 
   olsr_printf(1, "[ENC]Building CHALLENGE message\n");
@@ -566,17 +632,8 @@ send_challenge(struct interface_olsr *olsr_if, const union olsr_ip_addr *new_hos
 
   olsr_printf(3, "[ENC]Size: %lu\n", (unsigned long)sizeof(struct challengemsg));
 
-  {
-    uint8_t checksum_cache[(sizeof(cmsg) - sizeof(cmsg.signature)) + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, &cmsg, sizeof(cmsg) - sizeof(cmsg.signature));
-    /* Then the key */
-    memcpy(&checksum_cache[sizeof(cmsg) - sizeof(cmsg.signature)], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (sizeof(cmsg) - sizeof(cmsg.signature)) + KEYLENGTH, cmsg.signature);
-  }
+  /* Hash the message - digest */
+  secure_checksum(&cmsg, sizeof(cmsg) - sizeof(cmsg.signature), aes_key, KEYLENGTH, cmsg.signature);
   olsr_printf(3, "[ENC]Sending timestamp request to %s challenge 0x%x\n",
 	      olsr_ip_to_string(&buf, new_host), challenge);
 
@@ -587,7 +644,7 @@ send_challenge(struct interface_olsr *olsr_if, const union olsr_ip_addr *new_hos
   net_output(olsr_if);
 
   /* Create new entry */
-  entry = malloc(sizeof(struct stamp));
+  entry = olsr_malloc(sizeof(struct stamp), "SECURE timestamp");
 
   entry->diff = 0;
   entry->validated = 0;
@@ -598,13 +655,8 @@ send_challenge(struct interface_olsr *olsr_if, const union olsr_ip_addr *new_hos
   /* update validtime - not validated */
   entry->conftime = GET_TIMESTAMP(EXCHANGE_HOLD_TIME * 1000);
 
-  hash = olsr_ip_hashing(new_host);
-
   /* Queue */
-  timestamps[hash].next->prev = entry;
-  entry->next = timestamps[hash].next;
-  timestamps[hash].next = entry;
-  entry->prev = &timestamps[hash];
+  olsr_hashtable_insert(&timestamps, entry);
 
   return 1;
 
@@ -632,17 +684,7 @@ parse_cres(struct interface_olsr *olsr_if, char *in_msg)
 
   /* Check signature */
 
-  {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, msg, sizeof(struct c_respmsg) - SIGNATURE_SIZE);
-    /* Then the key */
-    memcpy(&checksum_cache[sizeof(struct c_respmsg) - SIGNATURE_SIZE], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (sizeof(struct c_respmsg) - SIGNATURE_SIZE) + KEYLENGTH, sha1_hash);
-  }
+  secure_checksum(msg, sizeof(struct c_respmsg) - SIGNATURE_SIZE, aes_key, KEYLENGTH, sha1_hash);
 
   if (memcmp(sha1_hash, &msg->signature, SIGNATURE_SIZE) != 0) {
     olsr_printf(1, "[ENC]Signature missmatch in challenge-response!\n");
@@ -662,7 +704,7 @@ parse_cres(struct interface_olsr *olsr_if, char *in_msg)
   olsr_printf(3, "[ENC]Entry-challenge 0x%x\n", entry->challenge);
 
   {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
+    uint8_t checksum_cache[sizeof(uint32_t) + sizeof(union olsr_ip_addr)];
     uint32_t netorder_challenge;
 
     /* First the challenge received */
@@ -676,7 +718,7 @@ parse_cres(struct interface_olsr *olsr_if, char *in_msg)
     memcpy(&checksum_cache[sizeof(uint32_t)], &msg->originator, olsr_cnf->ipsize);
 
     /* Create the hash */
-    CHECKSUM(checksum_cache, sizeof(uint32_t) + olsr_cnf->ipsize, sha1_hash);
+    secure_checksum(checksum_cache, sizeof(uint32_t) + olsr_cnf->ipsize, NULL, 0, sha1_hash);
   }
 
   if (memcmp(msg->res_sig, sha1_hash, SIGNATURE_SIZE) != 0) {
@@ -733,17 +775,7 @@ parse_rres(char *in_msg)
 
   /* Check signature */
 
-  {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, msg, sizeof(struct r_respmsg) - SIGNATURE_SIZE);
-    /* Then the key */
-    memcpy(&checksum_cache[sizeof(struct r_respmsg) - SIGNATURE_SIZE], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (sizeof(struct r_respmsg) - SIGNATURE_SIZE) + KEYLENGTH, sha1_hash);
-  }
+  secure_checksum(msg, sizeof(struct r_respmsg) - SIGNATURE_SIZE, aes_key, KEYLENGTH, sha1_hash);
 
   if (memcmp(sha1_hash, &msg->signature, SIGNATURE_SIZE) != 0) {
     olsr_printf(1, "[ENC]Signature missmatch in response-response!\n");
@@ -763,7 +795,7 @@ parse_rres(char *in_msg)
   olsr_printf(3, "[ENC]Entry-challenge 0x%x\n", entry->challenge);
 
   {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
+    uint8_t checksum_cache[sizeof(uint32_t) + sizeof(union olsr_ip_addr)];
     uint32_t netorder_challenge;
 
     /* First the challenge received */
@@ -776,7 +808,7 @@ parse_rres(char *in_msg)
     memcpy(&checksum_cache[sizeof(uint32_t)], &msg->originator, olsr_cnf->ipsize);
 
     /* Create the hash */
-    CHECKSUM(checksum_cache, sizeof(uint32_t) + olsr_cnf->ipsize, sha1_hash);
+    secure_checksum(checksum_cache, sizeof(uint32_t) + olsr_cnf->ipsize, NULL, 0, sha1_hash);
   }
 
   if (memcmp(msg->res_sig, sha1_hash, SIGNATURE_SIZE) != 0) {
@@ -811,7 +843,6 @@ parse_challenge(struct interface_olsr *olsr_if, char *in_msg)
   struct challengemsg *msg;
   uint8_t sha1_hash[SIGNATURE_SIZE];
   struct stamp *entry;
-  uint32_t hash;
   struct ipaddr_str buf;
 
   msg = (struct challengemsg *)ARM_NOWARN_ALIGN(in_msg);
@@ -826,16 +857,11 @@ parse_challenge(struct interface_olsr *olsr_if, char *in_msg)
 
   /* Create entry if not registered */
   if ((entry = lookup_timestamp_entry((const union olsr_ip_addr *)&msg->originator)) == NULL) {
-    entry = malloc(sizeof(struct stamp));
+    entry = olsr_malloc(sizeof(struct stamp), "SECURE timestamp");
     memcpy(&entry->addr, &msg->originator, olsr_cnf->ipsize);
 
-    hash = olsr_ip_hashing((union olsr_ip_addr *)&msg->originator);
-
     /* Queue */
-    timestamps[hash].next->prev = entry;
-    entry->next = timestamps[hash].next;
-    timestamps[hash].next = entry;
-    entry->prev = &timestamps[hash];
+    olsr_hashtable_insert(&timestamps, entry);
   } else {
     /* Check configuration timeout */
     if (!TIMED_OUT(entry->conftime)) {
@@ -851,17 +877,7 @@ parse_challenge(struct interface_olsr *olsr_if, char *in_msg)
 
   /* Check signature */
 
-  {
-    uint8_t checksum_cache[1512 + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, msg, sizeof(struct challengemsg) - SIGNATURE_SIZE);
-    /* Then the key */
-    memcpy(&checksum_cache[sizeof(struct challengemsg) - SIGNATURE_SIZE], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (sizeof(struct challengemsg) - SIGNATURE_SIZE) + KEYLENGTH, sha1_hash);
-  }
+  secure_checksum(msg, sizeof(struct challengemsg) - SIGNATURE_SIZE, aes_key, KEYLENGTH, sha1_hash);
   if (memcmp(sha1_hash, &msg->signature, SIGNATURE_SIZE) != 0) {
     olsr_printf(1, "[ENC]Signature missmatch in challenge!\n");
     return 0;
@@ -942,22 +958,12 @@ send_cres(struct interface_olsr *olsr_if, union olsr_ip_addr *to, union olsr_ip_
     memcpy(&checksum_cache[sizeof(chal_in)], from, olsr_cnf->ipsize);
 
     /* Create the hash */
-    CHECKSUM(checksum_cache, sizeof(chal_in) + olsr_cnf->ipsize, crmsg.res_sig);
+    secure_checksum(checksum_cache, sizeof(chal_in) + olsr_cnf->ipsize, NULL, 0, crmsg.res_sig);
   }
 
   /* Now create the digest of the message and the key */
 
-  {
-    uint8_t checksum_cache[(sizeof(crmsg) - sizeof(crmsg.signature)) + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, &crmsg, sizeof(crmsg) - sizeof(crmsg.signature));
-    /* Then the key */
-    memcpy(&checksum_cache[sizeof(crmsg) - sizeof(crmsg.signature)], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (sizeof(crmsg) - sizeof(crmsg.signature)) + KEYLENGTH, crmsg.signature);
-  }
+  secure_checksum(&crmsg, sizeof(crmsg) - sizeof(crmsg.signature), aes_key, KEYLENGTH, crmsg.signature);
 
   olsr_printf(3, "[ENC]Sending challenge response to %s challenge 0x%x\n", olsr_ip_to_string(&buf, to), challenge);
 
@@ -1016,22 +1022,12 @@ send_rres(struct interface_olsr *olsr_if, union olsr_ip_addr *to, union olsr_ip_
     memcpy(&checksum_cache[sizeof(chal_in)], from, olsr_cnf->ipsize);
 
     /* Create the hash */
-    CHECKSUM(checksum_cache, sizeof(chal_in) + olsr_cnf->ipsize, rrmsg.res_sig);
+    secure_checksum(checksum_cache, sizeof(chal_in) + olsr_cnf->ipsize, NULL, 0, rrmsg.res_sig);
   }
 
   /* Now create the digest of the message and the key */
 
-  {
-    uint8_t checksum_cache[(sizeof(rrmsg) - sizeof(rrmsg.signature)) + KEYLENGTH];
-    /* Create packet + key cache */
-    /* First the OLSR packet + signature message - digest */
-    memcpy(checksum_cache, &rrmsg, sizeof(rrmsg) - sizeof(rrmsg.signature));
-    /* Then the key */
-    memcpy(&checksum_cache[sizeof(rrmsg) - sizeof(rrmsg.signature)], aes_key, KEYLENGTH);
-
-    /* Create the hash */
-    CHECKSUM(checksum_cache, (sizeof(rrmsg) - sizeof(rrmsg.signature)) + KEYLENGTH, rrmsg.signature);
-  }
+  secure_checksum(&rrmsg, sizeof(rrmsg) - sizeof(rrmsg.signature), aes_key, KEYLENGTH, rrmsg.signature);
 
   olsr_printf(3, "[ENC]Sending response response to %s\n", olsr_ip_to_string(&buf, to));
 
@@ -1047,20 +1043,19 @@ send_rres(struct interface_olsr *olsr_if, union olsr_ip_addr *to, union olsr_ip_
 static struct stamp *
 lookup_timestamp_entry(const union olsr_ip_addr *adr)
 {
-  uint32_t hash;
-  struct stamp *entry;
+  struct stamp *head, *entry;
   struct ipaddr_str buf;
 
-  hash = olsr_ip_hashing(adr);
+  head = olsr_hashtable_head(&timestamps, adr);
 
-  for (entry = timestamps[hash].next; entry != &timestamps[hash]; entry = entry->next) {
+  for (entry = head->next; entry != head; entry = entry->next) {
     if (memcmp(&entry->addr, adr, olsr_cnf->ipsize) == 0) {
       olsr_printf(3, "[ENC]Match for %s\n", olsr_ip_to_string(&buf, adr));
       return entry;
     }
   }
 
-  olsr_printf(1, "[ENC]No match for %s\n", olsr_ip_to_string(&buf, adr));
+  olsr_printf(3, "[ENC]No match for %s\n", olsr_ip_to_string(&buf, adr));
 
   return NULL;
 }
@@ -1073,17 +1068,19 @@ lookup_timestamp_entry(const union olsr_ip_addr *adr)
 void
 timeout_timestamps(void *foo __attribute__ ((unused)))
 {
+  struct stamp *head;
   struct stamp *tmp_list;
   struct stamp *entry_to_delete;
-  int idx;
+  uint32_t idx;
 
   /* Update our local timestamp */
   gettimeofday(&now, NULL);
 
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    tmp_list = timestamps[idx].next;
+  for (idx = 0; idx < olsr_hashtable_buckets(&timestamps); idx++) {
+    head = olsr_hashtable_bucket(&timestamps, idx);
+    tmp_list = head->next;
     /*Traverse MID list */
-    while (tmp_list != &timestamps[idx]) {
+    while (tmp_list != head) {
       /*Check if the entry is timed out */
       if ((TIMED_OUT(tmp_list->valtime)) && (TIMED_OUT(tmp_list->conftime))) {
         struct ipaddr_str buf;
@@ -1094,8 +1091,7 @@ timeout_timestamps(void *foo __attribute__ ((unused)))
 		    olsr_ip_to_string(&buf, &entry_to_delete->addr));
 
         /*Delete it */
-        entry_to_delete->next->prev = entry_to_delete->prev;
-        entry_to_delete->prev->next = entry_to_delete->next;
+        olsr_hashtable_remove(&timestamps, entry_to_delete);
 
         free(entry_to_delete);
       } else
@@ -53,6 +53,7 @@
 #include "secure_messages.h"
 
 #include "hashing.h"
+#include "olsrd_plugin.h"             /* union set_plugin_parameter_addon */
 
 #define KEYFILE "/etc/olsrd.d/olsrd_secure_key"
 
@@ -62,6 +63,7 @@
 /* Algorithm definitions */
 #define SHA1_INCLUDING_KEY   1
 #define MD5_INCLUDING_KEY   2
+#define BLAKE2S_KEYED       3
 
 #ifdef USE_OPENSSL
 #define SIGNATURE_SIZE 20
@@ -79,6 +81,8 @@ extern char aes_key[16];
 /* Seconds of slack allowed */
 #define SLACK 3
 
+int set_algorithm(const char *, void *, set_plugin_parameter_addon);
+
 int secure_plugin_init(void);
 
 void secure_plugin_exit(void);
@@ -53,6 +53,7 @@
 #include "olsr.h"
 #include "olsr_cookie.h"
 #include "scheduler.h"
+#include "filewatch.h"
 #include "log.h"
 #include "gateway.h"
 
@@ -101,7 +102,7 @@ void sgwDynSpeedError(bool useErrno, const char *format, ...) {
 }
 
 /**
- * Timer callback that reads the smart gateway speed file
+ * Timer and file watch callback that reads the smart gateway speed file
  */
 static void smartgw_read_speed_file(void *context __attribute__ ((unused))) {
 	readSpeedFile(getSpeedFile());
@@ -111,9 +112,12 @@ static void smartgw_read_speed_file(void *context __attribute__ ((unused))) {
 /** The timer cookie, used to trace back the originator in debug */
 static struct olsr_cookie_info *smartgw_speed_file_timer_cookie = NULL;
 
-/** The timer */
+/** The timer, only used when the speed file can't be watched */
 static struct timer_entry * smartgw_speed_file_timer = NULL;
 
+/** The watch of the speed file */
+static struct file_watch * smartgw_speed_file_watch = NULL;
+
 /**
  Initialise the plugin: check the configuration, initialise the NMEA parser,
  create network interface sockets, hookup the plugin to OLSR and setup data
@@ -138,6 +142,13 @@ static struct timer_entry * smartgw_speed_file_timer = NULL;
 	if (speedFile) {
 		readSpeedFile(speedFile);
 
+		if (smartgw_speed_file_watch == NULL) {
+			smartgw_speed_file_watch = olsr_watch_file(speedFile, getSpeedFilePeriod(), &smartgw_read_speed_file, NULL);
+		}
+		if (smartgw_speed_file_watch != NULL) {
+			return true;
+		}
+
 		if (smartgw_speed_file_timer_cookie == NULL) {
 			smartgw_speed_file_timer_cookie = olsr_alloc_cookie("smartgw speed file", OLSR_COOKIE_TYPE_TIMER);
 			if (smartgw_speed_file_timer_cookie == NULL) {
@@ -162,6 +173,10 @@ static struct timer_entry * smartgw_speed_file_timer = NULL;
   * stop the plugin, free resources
   */
 void stopSgwDynSpeed(void) {
+	if (smartgw_speed_file_watch != NULL) {
+		olsr_unwatch_file(smartgw_speed_file_watch);
+		smartgw_speed_file_watch = NULL;
+	}
 	if (smartgw_speed_file_timer != NULL) {
 		olsr_stop_timer(smartgw_speed_file_timer);
 		smartgw_speed_file_timer = NULL;
@@ -110,12 +110,18 @@ int olsrd_plugin_init(void) {
   functions.topology = ipc_print_topology;
   functions.hna = ipc_print_hna;
   functions.mid = ipc_print_mid;
+  functions.routesPaged = ipc_print_routes_paged;
+  functions.topologyPaged = ipc_print_topology_paged;
+  functions.hnaPaged = ipc_print_hna_paged;
+  functions.midPaged = ipc_print_mid_paged;
   functions.gateways = ipc_print_gateways;
   functions.sgw = ipc_print_sgw;
   functions.version = ipc_print_version;
   functions.olsrd_conf = ipc_print_olsrd_conf;
   functions.interfaces = ipc_print_interfaces;
   functions.twohop = ipc_print_twohop;
+  functions.cookies = ipc_print_cookies;
+  functions.parser = ipc_print_parser;
 
   return info_plugin_init(PLUGIN_NAME, &functions, &config);
 }
@@ -52,6 +52,8 @@
 #include "neighbor_table.h"
 #include "mpr_selector_set.h"
 #include "mid_set.h"
+#include "olsr_cookie.h"
+#include "parser.h"
 #include "routing_table.h"
 #include "lq_plugin.h"
 #include "gateway.h"
@@ -59,10 +61,11 @@
 #include "olsrd_plugin.h"
 #include "info/info_types.h"
 #include "info/http_headers.h"
+#include "info/info_cursor.h"
 #include "gateway_default_handler.h"
 
 unsigned long long get_supported_commands_mask(void) {
-  return (SIW_ALL | SIW_OLSRD_CONF) & ~(SIW_CONFIG | SIW_PLUGINS);
+  return (SIW_ALL | SIW_OLSRD_CONF | SIW_STATISTICS) & ~(SIW_CONFIG | SIW_PLUGINS);
 }
 
 bool isCommand(const char *str, unsigned long long siw) {
@@ -132,6 +135,14 @@ bool isCommand(const char *str, unsigned long long siw) {
       cmd = "/neighbours";
       break;
 
+    case SIW_COOKIES:
+      cmd = "/coo";
+      break;
+
+    case SIW_PARSER:
+      cmd = "/par";
+      break;
+
     default:
       return false;
   }
@@ -241,18 +252,26 @@ void ipc_print_links(struct autobuf *abuf) {
   abuf_puts(abuf, "\n");
 }
 
-void ipc_print_routes(struct autobuf *abuf) {
+void ipc_print_routes_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
   struct rt_entry *rt;
 
-  abuf_puts(abuf, "Table: Routes\n");
-  abuf_puts(abuf, "Destination\tGateway IP\tMetric\tETX\tInterface\n");
+  if (!cursor->started) {
+    cursor->started = true;
+    abuf_puts(abuf, "Table: Routes\n");
+    abuf_puts(abuf, "Destination\tGateway IP\tMetric\tETX\tInterface\n");
+  }
 
   /* Walk the route table */
-  OLSR_FOR_ALL_RT_ENTRIES(rt) {
+  for (rt = info_cursor_rt(cursor); rt; rt = info_cursor_rt_next(rt)) {
     struct ipaddr_str dstAddr;
     struct ipaddr_str nexthopAddr;
     struct lqtextbuffer costbuffer;
 
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_rt_suspend(cursor, rt);
+      return;
+    }
+
     if (rt->rt_best) {
       abuf_appendf(abuf, "%s/%d\t%s\t%d\t%s\t%s\t\n",
         olsr_ip_to_string(&dstAddr, &rt->rt_dst.prefix),
@@ -262,84 +281,109 @@ void ipc_print_routes(struct autobuf *abuf) {
         get_linkcost_text(rt->rt_best->rtp_metric.cost, true, &costbuffer),
         if_ifwithindex_name(rt->rt_best->rtp_nexthop.iif_index));
     }
-  } OLSR_FOR_ALL_RT_ENTRIES_END(rt);
+  }
   abuf_puts(abuf, "\n");
+  cursor->done = true;
 }
 
-void ipc_print_topology(struct autobuf *abuf) {
-  struct tc_entry *tc;
+void ipc_print_routes(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_routes_paged, abuf);
+}
 
-  const char * field;
-  if (vtime) {
-    field = "\tVTime";
-  } else {
-    field = "";
-  }
+void ipc_print_topology_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
+  struct tc_edge_entry *tc_edge;
+
+  if (!cursor->started) {
+    const char * field;
+    if (vtime) {
+      field = "\tVTime";
+    } else {
+      field = "";
+    }
 
-  abuf_puts(abuf, "Table: Topology\n");
-  abuf_appendf(abuf, "Dest. IP\tLast hop IP\tLQ\tNLQ\tCost%s\n", field);
+    cursor->started = true;
+    abuf_puts(abuf, "Table: Topology\n");
+    abuf_appendf(abuf, "Dest. IP\tLast hop IP\tLQ\tNLQ\tCost%s\n", field);
+  }
 
   /* Topology */
-  OLSR_FOR_ALL_TC_ENTRIES(tc) {
-    struct tc_edge_entry *tc_edge;
-    OLSR_FOR_ALL_TC_EDGE_ENTRIES(tc, tc_edge) {
-      if (tc_edge->edge_inv) {
-        struct ipaddr_str dstAddr;
-        struct ipaddr_str lastHopAddr;
-        struct lqtextbuffer lqbuffer;
-        struct lqtextbuffer costbuffer;
-
-        abuf_appendf(abuf, "%s\t%s\t%s\t%s",
-          olsr_ip_to_string(&dstAddr, &tc_edge->T_dest_addr),
-          olsr_ip_to_string(&lastHopAddr, &tc->addr),
-          get_tc_edge_entry_text(tc_edge, '\t', &lqbuffer),
-          get_linkcost_text(tc_edge->cost, false, &costbuffer));
+  for (tc_edge = info_cursor_tc_edge(cursor); tc_edge; tc_edge = info_cursor_tc_edge_next(tc_edge)) {
+    struct tc_entry *tc = tc_edge->tc;
 
-        if (vtime) {
-          unsigned int diff = (unsigned int) (tc->validity_timer ? (tc->validity_timer->timer_clock - now_times) : 0);
-          abuf_appendf(abuf, "\t%u.%03u", diff / 1000, diff % 1000);
-        }
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_tc_edge_suspend(cursor, tc_edge);
+      return;
+    }
 
-        abuf_puts(abuf, "\n");
+    if (tc_edge->edge_inv) {
+      struct ipaddr_str dstAddr;
+      struct ipaddr_str lastHopAddr;
+      struct lqtextbuffer lqbuffer;
+      struct lqtextbuffer costbuffer;
+
+      abuf_appendf(abuf, "%s\t%s\t%s\t%s",
+        olsr_ip_to_string(&dstAddr, &tc_edge->T_dest_addr),
+        olsr_ip_to_string(&lastHopAddr, &tc->addr),
+        get_tc_edge_entry_text(tc_edge, '\t', &lqbuffer),
+        get_linkcost_text(tc_edge->cost, false, &costbuffer));
+
+      if (vtime) {
+        unsigned int diff = (unsigned int) (tc->validity_timer ? (tc->validity_timer->timer_clock - now_times) : 0);
+        abuf_appendf(abuf, "\t%u.%03u", diff / 1000, diff % 1000);
       }
-    } OLSR_FOR_ALL_TC_EDGE_ENTRIES_END(tc, tc_edge);
-  } OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+
+      abuf_puts(abuf, "\n");
+    }
+  }
   abuf_puts(abuf, "\n");
+  cursor->done = true;
 }
 
-void ipc_print_hna(struct autobuf *abuf) {
-  struct ip_prefix_list *hna;
+void ipc_print_topology(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_topology_paged, abuf);
+}
+
+void ipc_print_hna_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
   struct hna_entry *tmp_hna;
   struct ipaddr_str prefixbuf;
   struct ipaddr_str gwaddrbuf;
 
-  const char * field;
-  if (vtime) {
-    field = "\tVTime";
-  } else {
-    field = "";
-  }
+  if (!cursor->started) {
+    struct ip_prefix_list *hna;
+    const char * field;
+    if (vtime) {
+      field = "\tVTime";
+    } else {
+      field = "";
+    }
 
-  abuf_puts(abuf, "Table: HNA\n");
-  abuf_appendf(abuf, "Destination\tGateway%s\n", field);
+    cursor->started = true;
+    abuf_puts(abuf, "Table: HNA\n");
+    abuf_appendf(abuf, "Destination\tGateway%s\n", field);
 
-  /* Announced HNA entries */
-  for (hna = olsr_cnf->hna_entries; hna != NULL ; hna = hna->next) {
-    abuf_appendf(abuf, "%s/%d\t%s",
-      olsr_ip_to_string(&prefixbuf, &hna->net.prefix),
-      hna->net.prefix_len,
-      olsr_ip_to_string(&gwaddrbuf, &olsr_cnf->main_addr));
+    /* Announced HNA entries */
+    for (hna = olsr_cnf->hna_entries; hna != NULL ; hna = hna->next) {
+      abuf_appendf(abuf, "%s/%d\t%s",
+        olsr_ip_to_string(&prefixbuf, &hna->net.prefix),
+        hna->net.prefix_len,
+        olsr_ip_to_string(&gwaddrbuf, &olsr_cnf->main_addr));
 
-      if (vtime) {
-        abuf_appendf(abuf, "\t%u.%03u", 0, 0);
-      }
-      abuf_puts(abuf, "\n");
+        if (vtime) {
+          abuf_appendf(abuf, "\t%u.%03u", 0, 0);
+        }
+        abuf_puts(abuf, "\n");
+    }
   }
 
   /* HNA entries */
-  OLSR_FOR_ALL_HNA_ENTRIES(tmp_hna) {
+  for (tmp_hna = info_cursor_hash(cursor, &hna_set); tmp_hna; tmp_hna = info_cursor_hash_next(cursor, &hna_set, tmp_hna)) {
     struct hna_net *tmp_net;
 
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_hash_suspend(cursor, &hna_set, tmp_hna);
+      return;
+    }
+
     /* Check all networks */
     for (tmp_net = tmp_hna->networks.next; tmp_net != &tmp_hna->networks; tmp_net = tmp_net->next) {
       abuf_appendf(abuf, "%s/%d\t%s",
@@ -353,51 +397,64 @@ void ipc_print_hna(struct autobuf *abuf) {
       }
       abuf_puts(abuf, "\n");
     }
-  } OLSR_FOR_ALL_HNA_ENTRIES_END(tmp_hna);
+  }
   abuf_puts(abuf, "\n");
+  cursor->done = true;
 }
 
-void ipc_print_mid(struct autobuf *abuf) {
-  int idx;
+void ipc_print_hna(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_hna_paged, abuf);
+}
 
-  const char * field;
-  if (vtime) {
-    field = ":VTime";
-  } else {
-    field = "";
-  }
+void ipc_print_mid_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget) {
+  struct mid_entry *entry;
 
-  abuf_puts(abuf, "Table: MID\n");
-  abuf_appendf(abuf, "IP address\t(Alias%s)+\n", field);
+  if (!cursor->started) {
+    const char * field;
+    if (vtime) {
+      field = ":VTime";
+    } else {
+      field = "";
+    }
 
-  /* MID */
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct mid_entry *entry = mid_set[idx].next;
+    cursor->started = true;
+    abuf_puts(abuf, "Table: MID\n");
+    abuf_appendf(abuf, "IP address\t(Alias%s)+\n", field);
+  }
 
-    while (entry && (entry != &mid_set[idx])) {
-      struct mid_address *alias = entry->aliases;
-      struct ipaddr_str ipAddr;
+  /* MID */
+  for (entry = info_cursor_hash(cursor, &mid_set); entry; entry = info_cursor_hash_next(cursor, &mid_set, entry)) {
+    struct mid_address *alias = entry->aliases;
+    struct ipaddr_str ipAddr;
 
-      abuf_puts(abuf, olsr_ip_to_string(&ipAddr, &entry->main_addr));
-      abuf_puts(abuf, "\t");
+    if ((size_t) abuf->len >= budget) {
+      info_cursor_hash_suspend(cursor, &mid_set, entry);
+      return;
+    }
 
-      while (alias) {
-        struct ipaddr_str buf2;
+    abuf_puts(abuf, olsr_ip_to_string(&ipAddr, &entry->main_addr));
+    abuf_puts(abuf, "\t");
 
-        abuf_appendf(abuf, "\t%s", olsr_ip_to_string(&buf2, &alias->alias));
+    while (alias) {
+      struct ipaddr_str buf2;
 
-        if (vtime) {
-          unsigned int diff = (unsigned int) (alias->vtime - now_times);
-          abuf_appendf(abuf, ":%u.%03u", diff / 1000, diff % 1000);
-        }
+      abuf_appendf(abuf, "\t%s", olsr_ip_to_string(&buf2, &alias->alias));
 
-        alias = alias->next_alias;
+      if (vtime) {
+        unsigned int diff = (unsigned int) (alias->vtime - now_times);
+        abuf_appendf(abuf, ":%u.%03u", diff / 1000, diff % 1000);
       }
-      entry = entry->next;
-      abuf_puts(abuf, "\n");
+
+      alias = alias->next_alias;
     }
+    abuf_puts(abuf, "\n");
   }
   abuf_puts(abuf, "\n");
+  cursor->done = true;
+}
+
+void ipc_print_mid(struct autobuf *abuf) {
+  info_cursor_print_all(ipc_print_mid_paged, abuf);
 }
 
 void ipc_print_gateways(struct autobuf *abuf) {
@@ -612,3 +669,53 @@ void ipc_print_interfaces(struct autobuf *abuf) {
 void ipc_print_twohop(struct autobuf *abuf) {
   ipc_print_neighbors_internal(abuf, true);
 }
+
+void ipc_print_cookies(struct autobuf *abuf) {
+  olsr_cookie_t id;
+
+  abuf_puts(abuf, "Table: Cookies\n");
+  abuf_puts(abuf, "Name\tType\tSize\tUsage\tChanges\tFree\tSlabs\tBytes\tWalks\tFires\n");
+
+  for (id = 1; id < COOKIE_ID_MAX; id++) {
+    struct olsr_cookie_info *ci = olsr_cookie_get(id);
+    if (!ci) {
+      continue;
+    }
+
+    abuf_appendf(abuf, "%s\t%s\t%lu\t%u\t%u\t%u\t%u\t%lu\t%u\t%u\n",
+        ci->ci_name ? ci->ci_name : "",
+        (ci->ci_type == OLSR_COOKIE_TYPE_MEMORY) ? "memory" : "timer",
+        (unsigned long) ci->ci_size,
+        ci->ci_usage,
+        ci->ci_changes,
+        ci->ci_free,
+        ci->ci_slabs,
+        (unsigned long) (ci->ci_slabs * ci->ci_slab_size),
+        ci->ci_timer_walks,
+        ci->ci_timer_fires);
+  }
+  abuf_puts(abuf, "\n");
+}
+
+void ipc_print_parser(struct autobuf *abuf) {
+  int type;
+
+  abuf_puts(abuf, "Table: Parser\n");
+  abuf_puts(abuf, "Type\tName\tHandlers\tMessages\tBytes\tTime(us)\n");
+
+  for (type = 0; type < PARSER_TYPES; type++) {
+    const struct parser_type_stats *stats = olsr_parser_get_stats(type);
+    if (!stats->messages && !stats->handlers) {
+      continue;
+    }
+
+    abuf_appendf(abuf, "%d\t%s\t%u\t%u\t%llu\t%llu\n",
+        type,
+        olsr_msgtype_to_string(type),
+        stats->handlers,
+        stats->messages,
+        (unsigned long long) stats->bytes,
+        (unsigned long long) (stats->handler_ns / 1000));
+  }
+  abuf_puts(abuf, "\n");
+}
@@ -47,9 +47,12 @@
 #define LIB_TXTINFO_SRC_OLSRD_TXTINFO_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "common/autobuf.h"
 
+struct info_cursor;
+
 unsigned long long get_supported_commands_mask(void);
 bool isCommand(const char *str, unsigned long long siw);
 void output_error(struct autobuf *abuf, unsigned int status, const char * req, bool http_headers);
@@ -57,14 +60,20 @@ void output_error(struct autobuf *abuf, unsigned int status, const char * req, b
 void ipc_print_neighbors(struct autobuf *abuf);
 void ipc_print_links(struct autobuf *abuf);
 void ipc_print_routes(struct autobuf *abuf);
+void ipc_print_routes_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_topology(struct autobuf *abuf);
+void ipc_print_topology_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_hna(struct autobuf *abuf);
+void ipc_print_hna_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_mid(struct autobuf *abuf);
+void ipc_print_mid_paged(struct autobuf *abuf, struct info_cursor *cursor, size_t budget);
 void ipc_print_gateways(struct autobuf *abuf);
 void ipc_print_sgw(struct autobuf *abuf);
 void ipc_print_version(struct autobuf *abuf);
 void ipc_print_olsrd_conf(struct autobuf *abuf);
 void ipc_print_interfaces(struct autobuf *abuf);
 void ipc_print_twohop(struct autobuf *abuf);
+void ipc_print_cookies(struct autobuf *abuf);
+void ipc_print_parser(struct autobuf *abuf);
 
 #endif /* LIB_TXTINFO_SRC_OLSRD_TXTINFO_H_ */
@@ -404,12 +404,23 @@ void olsrd_write_cnf_autobuf_uncached(struct autobuf *out, struct olsrd_config *
   abuf_appendf(out,
     "\n"
     "# Interval to poll network interfaces for configuration changes (in seconds).\n"
-    "# Linux systems can detect interface statechange via netlink sockets.\n"
+    "# Linux systems detect interface state and address changes via netlink\n"
+    "# sockets and only poll every %.1f seconds as a fallback, unless this is set.\n"
     "# (default is %.1f)\n"
-    "\n", (double)DEF_NICCHGPOLLRT);
+    "\n", (double)DEF_NICCHGPOLLRT_NL, (double)DEF_NICCHGPOLLRT);
   abuf_appendf(out, "%sNicChgsPollInt  %.1f\n",
       cnf->nic_chgs_pollrate == (float)DEF_NICCHGPOLLRT ? "# " : "",
       (double)cnf->nic_chgs_pollrate);
+  abuf_appendf(out,
+    "\n"
+    "# Maximum number of packets read from an OLSR socket per wakeup before\n"
+    "# olsrd returns to its main loop (CPU overload protection).\n"
+    "# Linux reads them in batches with recvmmsg(2).\n"
+    "# (default is %u)\n"
+    "\n", DEF_INPUT_BUDGET);
+  abuf_appendf(out, "%sInputBudget %u\n",
+      cnf->input_budget == DEF_INPUT_BUDGET ? "# " : "",
+      cnf->input_budget);
   abuf_appendf(out,
     "\n"
     "# TOS(type of service) value for the IP header of control traffic.\n"
@@ -784,7 +795,8 @@ void olsrd_write_cnf_autobuf_uncached(struct autobuf *out, struct olsrd_config *
   abuf_appendf(out,
     "\n"
     "# Determines the period (in milliseconds) on which the SmartGatewayEgressFile\n"
-    "# is checked for changes and processed if changed.\n"
+    "# is checked for changes and processed if changed. The period is only used\n"
+    "# when the directory of the file can't be watched for changes (inotify).\n"
     "# (default is %u)\n"
     "\n", DEF_GW_EGRESS_FILE_PERIOD);
   abuf_appendf(out, "%sSmartGatewayEgressFilePeriod %u\n",
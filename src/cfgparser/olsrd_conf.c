@@ -604,6 +604,12 @@ olsrd_sanity_check_cnf(struct olsrd_config *cnf)
     return -1;
   }
 
+  /* Input budget */
+  if (cnf->input_budget < MIN_INPUT_BUDGET || cnf->input_budget > MAX_INPUT_BUDGET) {
+    fprintf(stderr, "Input budget %u is not allowed\n", cnf->input_budget);
+    return -1;
+  }
+
   /* TC redundancy */
   if (cnf->tc_redundancy != 2) {
     fprintf(stderr, "Sorry, tc-redundancy 0/1 are not working on 0.5.6. "
@@ -1116,6 +1122,7 @@ set_default_cnf(struct olsrd_config *cnf, char * configuration_file)
   cnf->interfaces = NULL;
   cnf->pollrate = DEF_POLLRATE;
   cnf->nic_chgs_pollrate = DEF_NICCHGPOLLRT;
+  cnf->input_budget = DEF_INPUT_BUDGET;
   cnf->clear_screen = DEF_CLEAR_SCREEN;
   cnf->tc_redundancy = TC_REDUNDANCY;
   cnf->mpr_coverage = MPR_COVERAGE;
@@ -1275,6 +1282,8 @@ olsrd_print_cnf(struct olsrd_config *cnf)
 
   printf("NIC ChangPollrate: %0.2f\n", (double)cnf->nic_chgs_pollrate);
 
+  printf("Input budget     : %u\n", cnf->input_budget);
+
   printf("TC redundancy    : %d\n", cnf->tc_redundancy);
 
   printf("MPR coverage     : %d\n", cnf->mpr_coverage);
@@ -209,6 +209,7 @@ static int add_ipv6_addr(YYSTYPE ipaddr_arg, YYSTYPE prefixlen_arg)
 %token TOK_HYSTLOWER
 %token TOK_POLLRATE
 %token TOK_NICCHGSPOLLRT
+%token TOK_INPUTBUDGET
 %token TOK_TCREDUNDANCY
 %token TOK_MPRCOVERAGE
 %token TOK_LQ_LEVEL
@@ -310,6 +311,7 @@ stmt:       idebug
           | fhystlower
           | fpollrate
           | fnicchgspollrt
+          | ainputbudget
           | atcredundancy
           | amprcoverage
           | alq_level
@@ -1249,6 +1251,14 @@ fnicchgspollrt: TOK_NICCHGSPOLLRT TOK_FLOAT
 }
 ;
 
+ainputbudget: TOK_INPUTBUDGET TOK_INTEGER
+{
+  PARSER_DEBUG_PRINTF("Input budget: %d\n", $2->integer);
+  olsr_cnf->input_budget = $2->integer;
+  free($2);
+}
+;
+
 atcredundancy: TOK_TCREDUNDANCY TOK_INTEGER
 {
   PARSER_DEBUG_PRINTF("TC redundancy %d\n", $2->integer);
@@ -100,7 +100,15 @@ static int autobuf_enlarge(struct autobuf *autobuf, unsigned int new_size) {
 
   if (new_size > (unsigned int) autobuf->size) {
     char *p;
-    int roundUpSize = ROUND_UP_TO_POWER_OF_2(new_size, AUTOBUFCHUNK);
+    int roundUpSize;
+
+    /* grow at least geometrically: appending to a large buffer in small steps
+     * must not realloc (and copy) it for every chunk */
+    if ((autobuf->size <= (AUTOBUFSIZEMAX / 2)) && (new_size < ((unsigned int) autobuf->size * 2))) {
+      new_size = autobuf->size * 2;
+    }
+
+    roundUpSize = ROUND_UP_TO_POWER_OF_2(new_size, AUTOBUFCHUNK);
     p = realloc(autobuf->buf, roundUpSize);
     if (p == NULL) {
 #ifdef _WIN32
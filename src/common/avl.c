@@ -155,6 +155,34 @@ avl_find(struct avl_tree *tree, const void *key)
   return node;
 }
 
+/*
+ * Find the first node whose key is not less than key, for walks
+ * that resume at a key that may have been deleted meanwhile.
+ * Returns NULL when all keys are less than key.
+ */
+struct avl_node *
+avl_find_greaterequal(struct avl_tree *tree, const void *key)
+{
+  struct avl_node *node;
+  int diff;
+
+  if (tree->root == NULL)
+    return NULL;
+
+  node = avl_find_rec(tree->root, key, tree->comp);
+
+  if (NULL == tree->comp) {
+    /* the order of avl_find_rec_ipv4 */
+    diff = (*(const unsigned int *)node->key < *(const unsigned int *)key) ? -1 : 0;
+  }
+
+  else {
+    diff = (*tree->comp) (node->key, key);
+  }
+
+  return diff < 0 ? node->next : node;
+}
+
 static void
 avl_rotate_right(struct avl_tree *tree, struct avl_node *node)
 {
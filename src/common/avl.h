@@ -76,6 +76,7 @@ struct avl_tree {
 
 void avl_init(struct avl_tree *, avl_tree_comp);
 struct avl_node *avl_find(struct avl_tree *, const void *);
+struct avl_node *avl_find_greaterequal(struct avl_tree *, const void *);
 int avl_insert(struct avl_tree *, struct avl_node *, int);
 void avl_delete(struct avl_tree *, struct avl_node *);
 
@@ -0,0 +1,343 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/dupcache.h"
+
+LISTNODE2STRUCT(bucket2entry, struct dupcache_entry, bucket_node);
+
+/*
+ * FNV-1a, the keys are short and often differ in a single byte only.
+ */
+static uint32_t
+dupcache_hash(const uint8_t *key, unsigned int len)
+{
+  uint32_t hash = 2166136261u;
+  unsigned int i;
+
+  for (i = 0; i < len; i++) {
+    hash ^= key[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * Initialize a duplicate cache.
+ *
+ * @param cache the cache
+ * @param name the name of the memory cookie of the entries
+ * @param key_len the length of the keys, at most DUPCACHE_KEY_MAX
+ * @param hold_time the time an entry is remembered, in milliseconds
+ * @param refresh true if a hit renews the hold time of the entry
+ * @return 0 on success, -1 otherwise
+ */
+int
+dupcache_init(struct dupcache *cache, const char *name, unsigned int key_len, uint32_t hold_time, bool refresh)
+{
+  unsigned int i;
+
+  if (key_len == 0 || key_len > DUPCACHE_KEY_MAX) {
+    return -1;
+  }
+
+  memset(cache, 0, sizeof(*cache));
+  cache->hash = calloc(DUPCACHE_HASH_MIN, sizeof(*cache->hash));
+  if (cache->hash == NULL) {
+    return -1;
+  }
+  cache->cookie = olsr_alloc_cookie(name, OLSR_COOKIE_TYPE_MEMORY);
+  olsr_cookie_set_memory_size(cache->cookie, sizeof(struct dupcache_entry));
+  cache->hash_mask = DUPCACHE_HASH_MIN - 1;
+  cache->key_len = key_len;
+  cache->refresh = refresh;
+
+  /* the bucket an entry was added to is dropped DUPCACHE_BUCKETS spans later */
+  cache->bucket_span = (hold_time + DUPCACHE_BUCKETS - 2) / (DUPCACHE_BUCKETS - 1);
+  if (cache->bucket_span == 0) {
+    cache->bucket_span = 1;
+  }
+
+  for (i = 0; i < DUPCACHE_BUCKETS; i++) {
+    list_head_init(&cache->buckets[i]);
+  }
+  return 0;
+}
+
+static void
+dupcache_unhash(struct dupcache *cache, struct dupcache_entry *entry)
+{
+  struct dupcache_entry **prev = &cache->hash[entry->hash & cache->hash_mask];
+
+  while (*prev != entry) {
+    prev = &(*prev)->hash_next;
+  }
+  *prev = entry->hash_next;
+}
+
+static void
+dupcache_drop_bucket(struct dupcache *cache, unsigned int bucket)
+{
+  struct list_node *head = &cache->buckets[bucket];
+
+  while (!list_is_empty(head)) {
+    struct dupcache_entry *entry = bucket2entry(head->next);
+
+    list_remove(&entry->bucket_node);
+    dupcache_unhash(cache, entry);
+    olsr_cookie_free(cache->cookie, entry);
+    cache->count--;
+  }
+}
+
+/**
+ * Free all entries of a duplicate cache.
+ *
+ * @param cache the cache
+ */
+void
+dupcache_free(struct dupcache *cache)
+{
+  unsigned int i;
+
+  if (cache->hash == NULL) {
+    return;
+  }
+
+  for (i = 0; i < DUPCACHE_BUCKETS; i++) {
+    dupcache_drop_bucket(cache, i);
+  }
+  free(cache->hash);
+  cache->hash = NULL;
+  olsr_free_cookie(cache->cookie);
+  cache->cookie = NULL;
+}
+
+/**
+ * Drop the entries whose hold time has passed. This is done by
+ * dupcache_seen() as well, calling it from a timer only releases
+ * the memory of an idle cache.
+ *
+ * @param cache the cache
+ * @param now the current time in milliseconds
+ */
+void
+dupcache_expire(struct dupcache *cache, uint32_t now)
+{
+  uint32_t steps;
+
+  if (cache->count == 0) {
+    /* nothing to drop, restart the ring from now */
+    cache->bucket_start = now;
+    return;
+  }
+
+  steps = (now - cache->bucket_start) / cache->bucket_span;
+  if (steps == 0) {
+    return;
+  }
+
+  if (steps >= DUPCACHE_BUCKETS) {
+    unsigned int i;
+
+    for (i = 0; i < DUPCACHE_BUCKETS; i++) {
+      dupcache_drop_bucket(cache, i);
+    }
+    cache->bucket_start = now;
+    return;
+  }
+
+  cache->bucket_start += steps * cache->bucket_span;
+  while (steps--) {
+    cache->current = (cache->current + 1) % DUPCACHE_BUCKETS;
+    dupcache_drop_bucket(cache, cache->current);
+  }
+}
+
+/*
+ * Double the number of hash slots. The cache keeps working with the
+ * old table if there is no memory for a new one.
+ */
+static void
+dupcache_grow(struct dupcache *cache)
+{
+  unsigned int size = (cache->hash_mask + 1) * 2;
+  struct dupcache_entry **hash;
+  unsigned int i;
+
+  hash = calloc(size, sizeof(*hash));
+  if (hash == NULL) {
+    return;
+  }
+
+  for (i = 0; i <= cache->hash_mask; i++) {
+    struct dupcache_entry *entry, *next;
+
+    for (entry = cache->hash[i]; entry; entry = next) {
+      next = entry->hash_next;
+      entry->hash_next = hash[entry->hash & (size - 1)];
+      hash[entry->hash & (size - 1)] = entry;
+    }
+  }
+
+  free(cache->hash);
+  cache->hash = hash;
+  cache->hash_mask = size - 1;
+}
+
+static struct dupcache_entry *
+dupcache_find(struct dupcache *cache, const void *key, uint32_t hash)
+{
+  struct dupcache_entry *entry;
+
+  for (entry = cache->hash[hash & cache->hash_mask]; entry; entry = entry->hash_next) {
+    if (entry->hash == hash && memcmp(entry->key, key, cache->key_len) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static void
+dupcache_insert(struct dupcache *cache, const void *key, uint32_t hash)
+{
+  struct dupcache_entry *entry = olsr_cookie_malloc(cache->cookie);
+
+  memcpy(entry->key, key, cache->key_len);
+  entry->hash = hash;
+  entry->bucket = cache->current;
+  list_add_before(&cache->buckets[cache->current], &entry->bucket_node);
+  entry->hash_next = cache->hash[hash & cache->hash_mask];
+  cache->hash[hash & cache->hash_mask] = entry;
+
+  if (++cache->count > cache->hash_mask + 1) {
+    dupcache_grow(cache);
+  }
+}
+
+static void
+dupcache_refresh(struct dupcache *cache, struct dupcache_entry *entry)
+{
+  if (cache->refresh && entry->bucket != cache->current) {
+    list_remove(&entry->bucket_node);
+    list_add_before(&cache->buckets[cache->current], &entry->bucket_node);
+    entry->bucket = cache->current;
+  }
+}
+
+/**
+ * Check whether a key was seen within the hold time, without
+ * remembering it. A cache that could not be initialized never
+ * reports a duplicate.
+ *
+ * @param cache the cache
+ * @param key the key, of the length given to dupcache_init()
+ * @param now the current time in milliseconds
+ * @return true if the key was seen before, false otherwise
+ */
+bool
+dupcache_check(struct dupcache *cache, const void *key, uint32_t now)
+{
+  if (cache->hash == NULL) {
+    return false;
+  }
+
+  dupcache_expire(cache, now);
+  return dupcache_find(cache, key, dupcache_hash(key, cache->key_len)) != NULL;
+}
+
+/**
+ * Remember a key, or renew it if the cache does so on a hit.
+ *
+ * @param cache the cache
+ * @param key the key, of the length given to dupcache_init()
+ * @param now the current time in milliseconds
+ */
+void
+dupcache_add(struct dupcache *cache, const void *key, uint32_t now)
+{
+  dupcache_seen(cache, key, now);
+}
+
+/**
+ * Check whether a key was seen within the hold time and remember it.
+ * A cache that could not be initialized never reports a duplicate.
+ *
+ * @param cache the cache
+ * @param key the key, of the length given to dupcache_init()
+ * @param now the current time in milliseconds
+ * @return true if the key was seen before, false otherwise
+ */
+bool
+dupcache_seen(struct dupcache *cache, const void *key, uint32_t now)
+{
+  struct dupcache_entry *entry;
+  uint32_t hash;
+
+  if (cache->hash == NULL) {
+    return false;
+  }
+
+  dupcache_expire(cache, now);
+
+  hash = dupcache_hash(key, cache->key_len);
+  entry = dupcache_find(cache, key, hash);
+  if (entry) {
+    dupcache_refresh(cache, entry);
+    return true;
+  }
+
+  dupcache_insert(cache, key, hash);
+  return false;
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
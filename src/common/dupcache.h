@@ -0,0 +1,116 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#ifndef _DUPCACHE_H
+#define _DUPCACHE_H
+
+#include <stdint.h>
+#include "compiler.h"
+#include "defs.h"
+#include "common/list.h"
+#include "olsr_cookie.h"
+
+/* the longest key: an IPv6 originator, a message type and a sequence number */
+#define DUPCACHE_KEY_MAX 20
+
+/* number of time buckets the hold time is spread over */
+#define DUPCACHE_BUCKETS 16
+
+/* initial number of hash slots, the table doubles when it gets full */
+#define DUPCACHE_HASH_MIN 64
+
+/*
+ * Hashed cache of recently seen keys, used by the plugins to filter
+ * duplicate messages and packets.
+ *
+ * Entries are hashed by their key for the lookup and are kept in a
+ * ring of time buckets for the expiry. Every bucket covers a fixed
+ * slice of the hold time, so the expiry drops whole buckets instead
+ * of looking at every entry. An entry lives at least the hold time
+ * and at most one bucket span longer.
+ *
+ * The entries are carved out of the slabs of a memory cookie, so a
+ * busy cache recycles its memory instead of calling malloc() and free()
+ * for every packet.
+ *
+ * The cache has no clock of its own: the caller passes the current
+ * time in milliseconds (like now_times) to every call.
+ */
+struct dupcache_entry {
+  struct dupcache_entry *hash_next;
+  struct list_node bucket_node;
+  uint32_t hash;
+  uint8_t bucket;
+  uint8_t key[DUPCACHE_KEY_MAX];
+};
+
+struct dupcache {
+  struct olsr_cookie_info *cookie;
+  struct dupcache_entry **hash;
+  unsigned int hash_mask;
+  unsigned int count;
+  unsigned int key_len;
+  bool refresh;                        /* a hit renews the hold time of the entry */
+  uint32_t bucket_span;
+  uint32_t bucket_start;               /* time the current bucket started */
+  unsigned int current;
+  struct list_node buckets[DUPCACHE_BUCKETS];
+};
+
+int dupcache_init(struct dupcache *, const char *, unsigned int, uint32_t, bool);
+void dupcache_free(struct dupcache *);
+void dupcache_expire(struct dupcache *, uint32_t);
+bool dupcache_check(struct dupcache *, const void *, uint32_t);
+void dupcache_add(struct dupcache *, const void *, uint32_t);
+bool dupcache_seen(struct dupcache *, const void *, uint32_t);
+
+#endif /* _DUPCACHE_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
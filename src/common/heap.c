@@ -0,0 +1,229 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#include <stddef.h>
+
+#include "common/heap.h"
+
+/*
+ * Pairing heap, see Fredman, Sedgewick, Sleator and Tarjan,
+ * "The pairing heap: A new form of self-adjusting heap".
+ *
+ * Insert, decrease-key and meld are O(1), extracting the minimum
+ * is O(log n) amortized. Nodes are embedded in the user structure,
+ * so no memory is allocated by the heap itself.
+ */
+
+void
+heap_init(struct heap *heap, heap_comp comp)
+{
+  heap->root = NULL;
+  heap->count = 0;
+  heap->comp = comp;
+}
+
+/*
+ * Link two heap-ordered trees, the one with the bigger root
+ * becomes the leftmost child of the other one.
+ * Both arguments must be roots (no prev and no next pointer).
+ */
+static struct heap_node *
+heap_link(struct heap *heap, struct heap_node *a, struct heap_node *b)
+{
+  struct heap_node *tmp;
+
+  if (a == NULL) {
+    return b;
+  }
+  if (b == NULL) {
+    return a;
+  }
+
+  if (heap->comp(b->key, a->key) < 0) {
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  b->prev = a;
+  b->next = a->child;
+  if (a->child) {
+    a->child->prev = b;
+  }
+  a->child = b;
+
+  return a;
+}
+
+/*
+ * Unlink a node (and its subtree) from its parent or left sibling.
+ */
+static void
+heap_cut(struct heap_node *node)
+{
+  if (node->prev->child == node) {
+    node->prev->child = node->next;
+  } else {
+    node->prev->next = node->next;
+  }
+  if (node->next) {
+    node->next->prev = node->prev;
+  }
+  node->prev = NULL;
+  node->next = NULL;
+}
+
+/*
+ * Combine a list of siblings into a single tree using the
+ * standard two-pass pairing (left to right, then right to left).
+ */
+static struct heap_node *
+heap_merge_pairs(struct heap *heap, struct heap_node *first)
+{
+  struct heap_node *a, *b, *next, *pairs = NULL, *result = NULL;
+
+  /* first pass: link pairs, collect results in reverse order via next */
+  while (first) {
+    a = first;
+    b = a->next;
+    next = b ? b->next : NULL;
+
+    a->prev = a->next = NULL;
+    if (b) {
+      b->prev = b->next = NULL;
+    }
+
+    a = heap_link(heap, a, b);
+    a->next = pairs;
+    pairs = a;
+
+    first = next;
+  }
+
+  /* second pass: link from right to left */
+  while (pairs) {
+    next = pairs->next;
+    pairs->next = NULL;
+    result = heap_link(heap, result, pairs);
+    pairs = next;
+  }
+  return result;
+}
+
+/*
+ * Add a node with the key already set.
+ */
+void
+heap_insert(struct heap *heap, struct heap_node *node)
+{
+  node->child = NULL;
+  node->next = NULL;
+  node->prev = NULL;
+
+  heap->root = heap_link(heap, heap->root, node);
+  heap->count++;
+}
+
+/*
+ * Restore the heap order after the key of a node was lowered.
+ */
+void
+heap_decrease_key(struct heap *heap, struct heap_node *node)
+{
+  if (node == heap->root) {
+    return;
+  }
+
+  heap_cut(node);
+  heap->root = heap_link(heap, heap->root, node);
+}
+
+/*
+ * Remove and return the node with the smallest key,
+ * NULL if the heap is empty.
+ */
+struct heap_node *
+heap_extract_min(struct heap *heap)
+{
+  struct heap_node *min = heap->root;
+
+  if (min == NULL) {
+    return NULL;
+  }
+
+  heap->root = heap_merge_pairs(heap, min->child);
+  heap->count--;
+
+  min->child = NULL;
+  return min;
+}
+
+/*
+ * Remove an arbitrary node from the heap.
+ */
+void
+heap_delete(struct heap *heap, struct heap_node *node)
+{
+  struct heap_node *subtree;
+
+  if (node == heap->root) {
+    heap_extract_min(heap);
+    return;
+  }
+
+  heap_cut(node);
+  subtree = heap_merge_pairs(heap, node->child);
+  node->child = NULL;
+
+  heap->root = heap_link(heap, heap->root, subtree);
+  heap->count--;
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,116 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#ifndef _HEAP_H
+#define _HEAP_H
+
+#include <stddef.h>
+#include "compiler.h"
+#include "defs.h"
+
+/*
+ * Intrusive pairing heap (min-heap).
+ *
+ * Each node has a pointer to its leftmost child and to its right
+ * sibling. prev points to the left sibling, or to the parent for
+ * the leftmost child, and is NULL for the root and for nodes
+ * that are not in a heap.
+ */
+struct heap_node {
+  struct heap_node *child;
+  struct heap_node *next;
+  struct heap_node *prev;
+  void *key;
+};
+
+typedef int (*heap_comp) (const void *, const void *);
+
+struct heap {
+  struct heap_node *root;
+  unsigned int count;
+  heap_comp comp;
+};
+
+void heap_init(struct heap *, heap_comp);
+void heap_insert(struct heap *, struct heap_node *);
+void heap_decrease_key(struct heap *, struct heap_node *);
+void heap_delete(struct heap *, struct heap_node *);
+struct heap_node *heap_extract_min(struct heap *);
+
+static INLINE struct heap_node *
+heap_peek_min(struct heap *heap)
+{
+  return heap->root;
+}
+
+static INLINE bool
+heap_is_empty(struct heap *heap)
+{
+  return heap->root == NULL;
+}
+
+static INLINE bool
+heap_is_member(struct heap *heap, struct heap_node *node)
+{
+  return node == heap->root || node->prev != NULL;
+}
+
+#define HEAPNODE2STRUCT(funcname, structname, heapnodename) \
+static INLINE structname * funcname (struct heap_node *ptr)\
+{\
+  return( \
+    ptr ? \
+      (structname *) (((size_t) ptr) - offsetof(structname, heapnodename)) : \
+      NULL); \
+}
+
+#endif /* _HEAP_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
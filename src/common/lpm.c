@@ -0,0 +1,317 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/lpm.h"
+
+/*
+ * Lookups walk at most one node per prefix length of the key, and
+ * only nodes that branch (or carry data) exist, so the depth stays
+ * close to log2 of the number of prefixes for real routing tables.
+ */
+
+static INLINE unsigned int
+lpm_bit(const uint8_t *key, unsigned int bit)
+{
+  return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/*
+ * Number of leading bits (at most max) two keys have in common.
+ */
+static unsigned int
+lpm_common_len(const uint8_t *a, const uint8_t *b, unsigned int max)
+{
+  unsigned int i;
+
+  for (i = 0; i < max; i += 8) {
+    uint8_t diff = a[i >> 3] ^ b[i >> 3];
+
+    if (diff) {
+      while (!(diff & 0x80)) {
+        diff <<= 1;
+        i++;
+      }
+      return MIN(i, max);
+    }
+  }
+  return max;
+}
+
+static INLINE bool
+lpm_node_covers(const struct lpm_node *node, const uint8_t *key)
+{
+  return lpm_common_len(node->prefix, key, node->prefix_len) == node->prefix_len;
+}
+
+static struct lpm_node *
+lpm_node_new(const uint8_t *key, unsigned int prefix_len, void *data)
+{
+  struct lpm_node *node = calloc(1, sizeof(*node));
+
+  if (node == NULL) {
+    return NULL;
+  }
+
+  /* the bits after the prefix stay cleared */
+  memcpy(node->prefix, key, prefix_len >> 3);
+  if (prefix_len & 7) {
+    node->prefix[prefix_len >> 3] = key[prefix_len >> 3] & (0xff << (8 - (prefix_len & 7)));
+  }
+  node->prefix_len = prefix_len;
+  node->data = data;
+
+  return node;
+}
+
+/*
+ * Hang a node below parent, or make it the root.
+ */
+static void
+lpm_link(struct lpm_tree *tree, struct lpm_node *parent, struct lpm_node *node)
+{
+  node->parent = parent;
+  if (parent == NULL) {
+    tree->root = node;
+  } else {
+    parent->child[lpm_bit(node->prefix, parent->prefix_len)] = node;
+  }
+}
+
+/*
+ * Find the node of a prefix, which may be a glue node.
+ */
+static struct lpm_node *
+lpm_find_node(struct lpm_tree *tree, const uint8_t *key, unsigned int prefix_len)
+{
+  struct lpm_node *node = tree->root;
+
+  while (node && node->prefix_len <= prefix_len && lpm_node_covers(node, key)) {
+    if (node->prefix_len == prefix_len) {
+      return node;
+    }
+    node = node->child[lpm_bit(key, node->prefix_len)];
+  }
+  return NULL;
+}
+
+/**
+ * Initialize a trie.
+ *
+ * @param tree the trie
+ * @param key_bits the length of the keys in bits (32 or 128)
+ */
+void
+lpm_init(struct lpm_tree *tree, unsigned int key_bits)
+{
+  tree->root = NULL;
+  tree->count = 0;
+  tree->key_bits = MIN(key_bits, LPM_KEY_MAX * 8);
+}
+
+/**
+ * Add a prefix to a trie.
+ *
+ * @param tree the trie
+ * @param prefix the prefix (only its first prefix_len bits are used)
+ * @param prefix_len the length of the prefix
+ * @param data the data of the prefix, must not be NULL
+ * @return 0 on success, -1 when the prefix is in the trie already,
+ * when its length is invalid or when there is no memory
+ */
+int
+lpm_insert(struct lpm_tree *tree, const void *prefix, uint8_t prefix_len, void *data)
+{
+  const uint8_t *key = prefix;
+  struct lpm_node *node = tree->root, *parent = NULL, *new_node, *top;
+
+  if ((prefix_len > tree->key_bits) || (data == NULL)) {
+    return -1;
+  }
+
+  while (node && node->prefix_len <= prefix_len && lpm_node_covers(node, key)) {
+    if (node->prefix_len == prefix_len) {
+      /* a glue node becomes a real one */
+      if (node->data) {
+        return -1;
+      }
+      node->data = data;
+      tree->count++;
+      return 0;
+    }
+    parent = node;
+    node = node->child[lpm_bit(key, node->prefix_len)];
+  }
+
+  new_node = lpm_node_new(key, prefix_len, data);
+  if (new_node == NULL) {
+    return -1;
+  }
+  top = new_node;
+
+  if (node) {
+    /* node and the new prefix differ somewhere below parent */
+    unsigned int common = lpm_common_len(node->prefix, new_node->prefix, MIN(node->prefix_len, prefix_len));
+
+    if (common == prefix_len) {
+      /* the new prefix covers node */
+      new_node->child[lpm_bit(node->prefix, prefix_len)] = node;
+      node->parent = new_node;
+    } else {
+      /* join both below a glue node of their common prefix */
+      struct lpm_node *glue = lpm_node_new(new_node->prefix, common, NULL);
+
+      if (glue == NULL) {
+        free(new_node);
+        return -1;
+      }
+      glue->child[lpm_bit(new_node->prefix, common)] = new_node;
+      glue->child[lpm_bit(node->prefix, common)] = node;
+      new_node->parent = glue;
+      node->parent = glue;
+      top = glue;
+    }
+  }
+
+  lpm_link(tree, parent, top);
+  tree->count++;
+  return 0;
+}
+
+/**
+ * Remove a prefix from a trie.
+ *
+ * @param tree the trie
+ * @param prefix the prefix
+ * @param prefix_len the length of the prefix
+ * @return the data of the prefix, NULL when it is not in the trie
+ */
+void *
+lpm_delete(struct lpm_tree *tree, const void *prefix, uint8_t prefix_len)
+{
+  struct lpm_node *node = lpm_find_node(tree, prefix, prefix_len);
+  void *data;
+
+  if (node == NULL || node->data == NULL) {
+    return NULL;
+  }
+
+  data = node->data;
+  node->data = NULL;
+  tree->count--;
+
+  /* remove nodes that do not branch anymore, up to the first one that does */
+  while (node && node->data == NULL && !(node->child[0] && node->child[1])) {
+    struct lpm_node *child = node->child[0] ? node->child[0] : node->child[1];
+    struct lpm_node *parent = node->parent;
+
+    if (child) {
+      child->parent = parent;
+    }
+    if (parent == NULL) {
+      tree->root = child;
+    } else {
+      parent->child[parent->child[1] == node] = child;
+    }
+
+    free(node);
+    node = parent;
+  }
+
+  return data;
+}
+
+/**
+ * Look up a prefix in a trie.
+ *
+ * @param tree the trie
+ * @param prefix the prefix
+ * @param prefix_len the length of the prefix
+ * @return the data of the prefix, NULL when it is not in the trie
+ */
+void *
+lpm_find(struct lpm_tree *tree, const void *prefix, uint8_t prefix_len)
+{
+  struct lpm_node *node = lpm_find_node(tree, prefix, prefix_len);
+
+  return node ? node->data : NULL;
+}
+
+/**
+ * Look up the longest prefix of a trie that covers an address.
+ *
+ * @param tree the trie
+ * @param addr the address, key_bits long
+ * @return the data of the longest prefix, NULL when no prefix covers
+ * the address
+ */
+void *
+lpm_match(struct lpm_tree *tree, const void *addr)
+{
+  const uint8_t *key = addr;
+  struct lpm_node *node = tree->root;
+  void *best = NULL;
+
+  while (node && lpm_node_covers(node, key)) {
+    if (node->data) {
+      best = node->data;
+    }
+    if (node->prefix_len >= tree->key_bits) {
+      break;
+    }
+    node = node->child[lpm_bit(key, node->prefix_len)];
+  }
+
+  return best;
+}
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,95 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#ifndef _LPM_H
+#define _LPM_H
+
+#include <stdint.h>
+#include "compiler.h"
+#include "defs.h"
+
+/* the longest key: an IPv6 address */
+#define LPM_KEY_MAX 16
+
+/*
+ * Path-compressed binary (Patricia) trie for longest prefix matching.
+ *
+ * Keys are addresses in network byte order, bit 0 being the most
+ * significant bit of the first byte. Every node holds a prefix and
+ * branches on the bit right after it. Nodes without data are glue
+ * nodes, they only exist to join two subtries and always have two
+ * children.
+ *
+ * Unlike the avl tree the trie allocates its nodes itself, because
+ * a glue node does not belong to any user structure.
+ */
+struct lpm_node {
+  struct lpm_node *parent;
+  struct lpm_node *child[2];
+  void *data;
+  uint8_t prefix_len;
+  uint8_t prefix[LPM_KEY_MAX];
+};
+
+struct lpm_tree {
+  struct lpm_node *root;
+  unsigned int count;
+  unsigned int key_bits;
+};
+
+void lpm_init(struct lpm_tree *, unsigned int);
+int lpm_insert(struct lpm_tree *, const void *, uint8_t, void *);
+void *lpm_delete(struct lpm_tree *, const void *, uint8_t);
+void *lpm_find(struct lpm_tree *, const void *, uint8_t);
+void *lpm_match(struct lpm_tree *, const void *);
+
+#endif /* _LPM_H */
+
+/*
+ * Local Variables:
+ * c-basic-offset: 2
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -45,7 +45,7 @@
 
 #include "duplicate_set.h"
 #include "ipcalc.h"
-#include "common/avl.h"
+#include "hashing.h"
 #include "olsr.h"
 #include "mid_set.h"
 #include "scheduler.h"
@@ -53,54 +53,145 @@
 
 static void olsr_cleanup_duplicate_entry(void *unused);
 
-struct avl_tree duplicate_set;
+struct dup_set duplicate_set;
 struct timer_entry *duplicate_cleanup_timer;
 
-void
-olsr_init_duplicate_set(void)
+/**
+ * Allocate a new (empty) table for the duplicate set and move
+ * all existing entries over.
+ *
+ * @param size new number of slots, must be a power of two
+ */
+static void
+olsr_resize_duplicate_set(uint32_t size)
 {
-  avl_init(&duplicate_set, olsr_cnf->ip_version == AF_INET ? &avl_comp_ipv4 : &avl_comp_ipv6);
+  struct dup_entry *old = duplicate_set.table;
+  uint32_t old_size = duplicate_set.size;
+  uint32_t i;
+
+  duplicate_set.table = olsr_malloc(sizeof(struct dup_entry) * size, "Duplicate table");
+  duplicate_set.size = size;
+  duplicate_set.cleanup_cursor = 0;
 
-  olsr_set_timer(&duplicate_cleanup_timer, DUPLICATE_CLEANUP_INTERVAL, DUPLICATE_CLEANUP_JITTER, OLSR_TIMER_PERIODIC,
-                 &olsr_cleanup_duplicate_entry, NULL, 0);
+  for (i = 0; i < old_size; i++) {
+    uint32_t idx;
+
+    if (!old[i].used) {
+      continue;
+    }
+
+    idx = old[i].hash & (size - 1);
+    while (duplicate_set.table[idx].used) {
+      idx = (idx + 1) & (size - 1);
+    }
+    duplicate_set.table[idx] = old[i];
+  }
+  free(old);
 }
 
-void olsr_cleanup_duplicates(union olsr_ip_addr *orig) {
-  struct dup_entry *entry;
+/**
+ * Lookup an originator in the duplicate set.
+ *
+ * @param ip the originator address
+ * @param hash olsr_ip_hash32() of the originator
+ * @return the slot of the entry, or the free slot the entry
+ *   would be stored in
+ */
+static struct dup_entry *
+olsr_lookup_duplicate_slot(const union olsr_ip_addr *ip, uint32_t hash)
+{
+  uint32_t mask = duplicate_set.size - 1;
+  uint32_t idx = hash & mask;
 
-  entry = (struct dup_entry *)avl_find(&duplicate_set, orig);
-  if (entry != NULL) {
-    entry->too_low_counter = DUP_MAX_TOO_LOW - 2;
+  while (duplicate_set.table[idx].used) {
+    if (duplicate_set.table[idx].hash == hash && ipequal(&duplicate_set.table[idx].ip, ip)) {
+      break;
+    }
+    idx = (idx + 1) & mask;
   }
+  return &duplicate_set.table[idx];
 }
 
-struct dup_entry *
-olsr_create_duplicate_entry(void *ip, uint16_t seqnr)
+/**
+ * Remove an entry from the duplicate set. Following entries of the
+ * same probe sequence are shifted back, so the table never contains
+ * tombstones.
+ *
+ * @param idx the slot to clear
+ */
+static void
+olsr_delete_duplicate_slot(uint32_t idx)
 {
+  uint32_t mask = duplicate_set.size - 1;
+  uint32_t next = idx;
+
+  for (;;) {
+    uint32_t home;
+
+    next = (next + 1) & mask;
+    if (!duplicate_set.table[next].used) {
+      break;
+    }
+
+    /* move the entry back if its home slot is not in (idx, next] */
+    home = duplicate_set.table[next].hash & mask;
+    if (((next - home) & mask) >= ((next - idx) & mask)) {
+      duplicate_set.table[idx] = duplicate_set.table[next];
+      idx = next;
+    }
+  }
+
+  memset(&duplicate_set.table[idx], 0, sizeof(struct dup_entry));
+  duplicate_set.count--;
+}
+
+void
+olsr_init_duplicate_set(void)
+{
+  olsr_resize_duplicate_set(DUPLICATE_TABLE_MINSIZE);
+
+  olsr_set_timer(&duplicate_cleanup_timer, DUPLICATE_CLEANUP_INTERVAL / DUPLICATE_CLEANUP_STEPS, DUPLICATE_CLEANUP_JITTER,
+                 OLSR_TIMER_PERIODIC, &olsr_cleanup_duplicate_entry, NULL, 0);
+}
+
+void olsr_cleanup_duplicates(union olsr_ip_addr *orig) {
   struct dup_entry *entry;
-  entry = olsr_malloc(sizeof(struct dup_entry), "New duplicate entry");
-  if (entry != NULL) {
-    memcpy(&entry->ip, ip, olsr_cnf->ip_version == AF_INET ? sizeof(entry->ip.v4) : sizeof(entry->ip.v6));
-    entry->seqnr = seqnr;
-    entry->too_low_counter = 0;
-    entry->avl.key = &entry->ip;
-    entry->array = 0;
+
+  entry = olsr_lookup_duplicate_slot(orig, olsr_ip_hash32(orig));
+  if (entry->used) {
+    entry->too_low_counter = DUP_MAX_TOO_LOW - 2;
   }
-  return entry;
 }
 
+/**
+ * Age a slice of the duplicate set, a full pass over the table
+ * takes DUPLICATE_CLEANUP_STEPS runs of this timer.
+ */
 static void
 olsr_cleanup_duplicate_entry(void __attribute__ ((unused)) * unused)
 {
-  struct dup_entry *entry;
+  uint32_t steps = duplicate_set.size / DUPLICATE_CLEANUP_STEPS;
 
-  OLSR_FOR_ALL_DUP_ENTRIES(entry) {
-    if (TIMED_OUT(entry->valid_until)) {
-      avl_delete(&duplicate_set, &entry->avl);
-      free(entry);
+  if (steps == 0) {
+    steps = 1;
+  }
+
+  while (steps-- > 0) {
+    struct dup_entry *entry = &duplicate_set.table[duplicate_set.cleanup_cursor];
+
+    if (entry->used && TIMED_OUT(entry->valid_until)) {
+      /* a shifted-back entry might now occupy this slot, check it again */
+      olsr_delete_duplicate_slot(duplicate_set.cleanup_cursor);
+      continue;
     }
+    duplicate_set.cleanup_cursor = (duplicate_set.cleanup_cursor + 1) & (duplicate_set.size - 1);
+  }
+
+  /* shrink the table after a pass if it became mostly empty */
+  if (duplicate_set.cleanup_cursor < duplicate_set.size / DUPLICATE_CLEANUP_STEPS
+      && duplicate_set.size > DUPLICATE_TABLE_MINSIZE && duplicate_set.count * 8 < duplicate_set.size) {
+    olsr_resize_duplicate_set(duplicate_set.size / 2);
   }
-  OLSR_FOR_ALL_DUP_ENTRIES_END(entry);
 }
 
 int olsr_seqno_diff(uint16_t seqno1, uint16_t seqno2) {
@@ -125,6 +216,7 @@ olsr_message_is_duplicate(union olsr_message *m)
   uint32_t valid_until;
   struct ipaddr_str buf;
   uint16_t seqnr;
+  uint32_t hash;
   void *ip;
 
   if (olsr_cnf->ip_version == AF_INET) {
@@ -143,13 +235,23 @@ olsr_message_is_duplicate(union olsr_message *m)
 
   valid_until = GET_TIMESTAMP(DUPLICATE_VTIME);
 
-  entry = (struct dup_entry *)avl_find(&duplicate_set, ip);
-  if (entry == NULL) {
-    entry = olsr_create_duplicate_entry(ip, seqnr);
-    if (entry != NULL) {
-      avl_insert(&duplicate_set, &entry->avl, 0);
-      entry->valid_until = valid_until;
+  hash = olsr_ip_hash32(ip);
+  entry = olsr_lookup_duplicate_slot(ip, hash);
+  if (!entry->used) {
+    /* keep the load factor below 1/2 */
+    if ((duplicate_set.count + 1) * 2 > duplicate_set.size) {
+      olsr_resize_duplicate_set(duplicate_set.size * 2);
+      entry = olsr_lookup_duplicate_slot(ip, hash);
     }
+
+    memcpy(&entry->ip, ip, olsr_cnf->ip_version == AF_INET ? sizeof(entry->ip.v4) : sizeof(entry->ip.v6));
+    entry->hash = hash;
+    entry->seqnr = seqnr;
+    entry->too_low_counter = 0;
+    entry->array = 0;
+    entry->valid_until = valid_until;
+    entry->used = true;
+    duplicate_set.count++;
     return false;               // okay, we process this package
   }
 
@@ -209,7 +311,7 @@ olsr_print_duplicate_table(void)
               olsr_wallclock_string(), ipwidth, "Node IP", "DupArray", "VTime");
 
   OLSR_FOR_ALL_DUP_ENTRIES(entry) {
-    OLSR_PRINTF(1, "%-*s %08x %s\n", ipwidth, olsr_ip_to_string(&addrbuf, (union olsr_ip_addr *)(entry->avl.key)),
+    OLSR_PRINTF(1, "%-*s %08x %s\n", ipwidth, olsr_ip_to_string(&addrbuf, &entry->ip),
                 entry->array, olsr_clock_string(entry->valid_until));
   } OLSR_FOR_ALL_DUP_ENTRIES_END(entry);
 }
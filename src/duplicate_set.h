@@ -49,27 +49,47 @@
 #include "defs.h"
 #include "olsr.h"
 #include "mantissa.h"
-#include "common/avl.h"
 
 #define DUPLICATE_CLEANUP_INTERVAL 15000
 #define DUPLICATE_CLEANUP_JITTER 25
 #define DUPLICATE_VTIME 120000
 #define DUP_MAX_TOO_LOW 16
 
+/*
+ * the cleanup timer runs DUPLICATE_CLEANUP_STEPS times per
+ * DUPLICATE_CLEANUP_INTERVAL and checks a slice of the table each
+ * time, so every entry is aged once per interval
+ */
+#define DUPLICATE_CLEANUP_STEPS 16
+
+/* initial (and minimal) number of slots of the duplicate table */
+#define DUPLICATE_TABLE_MINSIZE 64
+
 struct dup_entry {
-  struct avl_node avl;
   union olsr_ip_addr ip;
+  uint32_t hash;
   uint16_t seqnr;
   uint16_t too_low_counter;
   uint32_t array;
   uint32_t valid_until;
+  bool used;
+};
+
+/*
+ * open addressing hashtable (linear probing) keyed by originator,
+ * the size is always a power of two
+ */
+struct dup_set {
+  struct dup_entry *table;
+  uint32_t size;
+  uint32_t count;
+  uint32_t cleanup_cursor;
 };
 
-AVLNODE2STRUCT(duptree2dupentry, struct dup_entry, avl);
+extern struct dup_set duplicate_set;
 
 void olsr_init_duplicate_set(void);
 void olsr_cleanup_duplicates(union olsr_ip_addr *orig);
-struct dup_entry *olsr_create_duplicate_entry(void *ip, uint16_t seqnr);
 int olsr_seqno_diff(uint16_t seqno1, uint16_t seqno2);
 int olsr_message_is_duplicate(union olsr_message *m);
 #ifndef NODEBUG
@@ -80,11 +100,10 @@ void olsr_print_duplicate_table(void);
 
 #define OLSR_FOR_ALL_DUP_ENTRIES(dup) \
 { \
-  struct avl_node *dup_tree_node, *next_dup_tree_node; \
-  for (dup_tree_node = avl_walk_first(&duplicate_set); \
-    dup_tree_node; dup_tree_node = next_dup_tree_node) { \
-    next_dup_tree_node = avl_walk_next(dup_tree_node); \
-    dup = duptree2dupentry(dup_tree_node);
+  uint32_t dup_index; \
+  for (dup_index = 0; dup_index < duplicate_set.size; dup_index++) { \
+    dup = &duplicate_set.table[dup_index]; \
+    if (!dup->used) continue;
 #define OLSR_FOR_ALL_DUP_ENTRIES_END(dup) }}
 
 #endif /* DUPLICATE_SET_2_H_ */
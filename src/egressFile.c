@@ -54,6 +54,7 @@
 #include "gateway_costs.h"
 #include "gateway.h"
 #include "scheduler.h"
+#include "filewatch.h"
 #include "ipcalc.h"
 #include "log.h"
 
@@ -370,11 +371,14 @@ void egressBwClear(struct egress_if_bw * bw, bool up) {
  * Timer
  */
 
-/** the timer for polling the egress file for changes */
+/** the timer for polling the egress file for changes, when it can't be watched */
 static struct timer_entry *egress_file_timer;
 
+/** the watch of the egress file */
+static struct file_watch *egress_file_watch;
+
 /**
- * Timer callback to read the egress file
+ * Timer and file watch callback to read the egress file
  *
  * @param unused unused
  */
@@ -434,7 +438,12 @@ bool startEgressFile(void) {
 
   readEgressFile(olsr_cnf->smart_gw_egress_file);
 
-  olsr_set_timer(&egress_file_timer, olsr_cnf->smart_gw_egress_file_period, 0, true, &egress_file_timer_callback, NULL, NULL);
+  /* only poll the file when changes to it can't be watched */
+  egress_file_watch = olsr_watch_file(!olsr_cnf->smart_gw_egress_file ? DEF_GW_EGRESS_FILE : olsr_cnf->smart_gw_egress_file,
+      olsr_cnf->smart_gw_egress_file_period, &egress_file_timer_callback, NULL);
+  if (!egress_file_watch) {
+    olsr_set_timer(&egress_file_timer, olsr_cnf->smart_gw_egress_file_period, 0, true, &egress_file_timer_callback, NULL, NULL);
+  }
 
   started = true;
   return true;
@@ -447,6 +456,8 @@ void stopEgressFile(void) {
   if (started) {
     olsr_stop_timer(egress_file_timer);
     egress_file_timer = NULL;
+    olsr_unwatch_file(egress_file_watch);
+    egress_file_watch = NULL;
 
     regfree(&compiledRegexEgress);
     regfree(&compiledRegexComment);
@@ -0,0 +1,260 @@
+/*
+ * The olsr.org Optimized Link-State Routing daemon (olsrd)
+ *
+ * (c) by the OLSR project
+ *
+ * See our Git repository to find out who worked on this file
+ * and thus is a copyright holder on it.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#ifdef __linux__
+
+#include "filewatch.h"
+
+/* OLSRD includes */
+#include "defs.h"
+#include "scheduler.h"
+#include "common/list.h"
+
+/* System includes */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/inotify.h>
+
+/*
+ * A file is watched through its directory: files that are updated by
+ * writing a temporary file and renaming it over the original (and files
+ * that do not exist yet) can not be watched directly.
+ *
+ * Only events that mean that the file content is complete trigger a
+ * callback: the file was closed after writing, was renamed into place,
+ * or went away.
+ */
+#define FILE_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM)
+
+struct file_watch {
+  struct list_node node;
+  int wd;                   /* the inotify watch of the directory, -1 while it is lost */
+  bool pending;             /* an event arrived in the current batch */
+  file_watch_func callback;
+  void * data;
+  unsigned int period;      /* poll interval while the watch is lost */
+  struct timer_entry *timer;
+  char * name;              /* the file name, in dir */
+  char dir[1];              /* the directory, allocated with the name */
+};
+
+LISTNODE2STRUCT(list2watch, struct file_watch, node);
+
+/** the inotify instance, shared by all watches */
+static int inotify_fd = -1;
+
+/** the watches */
+static struct list_node watches = { &watches, &watches };
+
+/**
+ * Poll a file whose directory watch was lost: try to watch the directory
+ * again, and let the owner re-read the file either way.
+ */
+static void filewatch_poll(void *data) {
+  struct file_watch *watch = data;
+
+  watch->wd = inotify_add_watch(inotify_fd, watch->dir, FILE_WATCH_EVENTS);
+  if (watch->wd >= 0) {
+    OLSR_PRINTF(1, "Watching directory %s again\n", watch->dir);
+    olsr_stop_timer(watch->timer);
+    watch->timer = NULL;
+  }
+  watch->callback(watch->data);
+}
+
+/**
+ * Read the pending inotify events and call the callbacks of the watched
+ * files they concern, once per file per batch of events.
+ */
+static void filewatch_read(int fd, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused))) {
+  char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  struct list_node *node, *next;
+  ssize_t len;
+
+  while ((len = read(fd, buf, sizeof(buf))) > 0) {
+    char *ptr = buf;
+
+    while (ptr < (buf + len)) {
+      struct inotify_event *event = (struct inotify_event *) ptr;
+
+      for (node = watches.next; node != &watches; node = node->next) {
+        struct file_watch *watch = list2watch(node);
+
+        if ((event->mask & IN_Q_OVERFLOW) //
+            || ((event->wd == watch->wd) && event->len && !strcmp(event->name, watch->name))) {
+          watch->pending = true;
+        } else if ((event->mask & IN_IGNORED) && (event->wd == watch->wd)) {
+          /* the directory was removed or unmounted, poll the file until it can be watched again */
+          OLSR_PRINTF(1, "Lost the watch of directory %s, polling %s\n", watch->dir, watch->name);
+          watch->wd = -1;
+          watch->pending = true;
+          watch->timer = olsr_start_timer(watch->period, 0, OLSR_TIMER_PERIODIC, &filewatch_poll, watch, NULL);
+        }
+      }
+
+      ptr += sizeof(struct inotify_event) + event->len;
+    }
+  }
+
+  /* a callback may remove its own watch */
+  for (node = watches.next; node != &watches; node = next) {
+    struct file_watch *watch = list2watch(node);
+    next = node->next;
+
+    if (watch->pending) {
+      watch->pending = false;
+      watch->callback(watch->data);
+    }
+  }
+}
+
+/**
+ * Watch a file for changes
+ *
+ * @param path the path of the file, the file itself does not need to exist
+ * @param period the interval (in milliseconds) at which the file is polled
+ * when the directory can no longer be watched, e.g. because it was removed
+ * @param callback the function to call when the file changed
+ * @param data passed to the callback
+ * @return the watch, or NULL when the directory of the file can not be
+ * watched (the caller then has to poll the file)
+ */
+struct file_watch * olsr_watch_file(const char * path, unsigned int period, file_watch_func callback, void * data) {
+  const char * slash = strrchr(path, '/');
+  size_t len = strlen(path);
+  struct file_watch *watch;
+
+  if (!callback || !len || (slash && !slash[1])) {
+    return NULL;
+  }
+
+  if (inotify_fd < 0) {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+      OLSR_PRINTF(1, "Could not create an inotify instance: %s\n", strerror(errno));
+      return NULL;
+    }
+    add_olsr_socket(inotify_fd, NULL, &filewatch_read, NULL, SP_IMM_READ);
+  }
+
+  /* room for "dir\0name\0", "." being the directory of a bare file name */
+  watch = calloc(1, sizeof(*watch) + len + 2);
+  if (!watch) {
+    return NULL;
+  }
+
+  if (!slash) {
+    strcpy(watch->dir, ".");
+    watch->name = &watch->dir[2];
+    strcpy(watch->name, path);
+  } else {
+    size_t dirlen = (slash == path) ? 1 : (size_t) (slash - path);
+
+    memcpy(watch->dir, path, dirlen);
+    watch->dir[dirlen] = '\0';
+    watch->name = &watch->dir[dirlen + 1];
+    strcpy(watch->name, slash + 1);
+  }
+
+  /* watches of files in the same directory share the inotify watch */
+  watch->wd = inotify_add_watch(inotify_fd, watch->dir, FILE_WATCH_EVENTS);
+  if (watch->wd < 0) {
+    OLSR_PRINTF(1, "Could not watch directory %s: %s\n", watch->dir, strerror(errno));
+    free(watch);
+    watch = NULL;
+  } else {
+    watch->callback = callback;
+    watch->data = data;
+    watch->period = period;
+    list_add_before(&watches, &watch->node);
+  }
+
+  if (list_is_empty(&watches)) {
+    remove_olsr_socket(inotify_fd, NULL, &filewatch_read);
+    close(inotify_fd);
+    inotify_fd = -1;
+  }
+
+  return watch;
+}
+
+/**
+ * Stop watching a file
+ *
+ * @param watch the watch, may be NULL
+ */
+void olsr_unwatch_file(struct file_watch * watch) {
+  struct list_node *node;
+  bool shared = false;
+
+  if (!watch) {
+    return;
+  }
+
+  list_remove(&watch->node);
+  olsr_stop_timer(watch->timer);
+
+  for (node = watches.next; node != &watches; node = node->next) {
+    if (list2watch(node)->wd == watch->wd) {
+      shared = true;
+      break;
+    }
+  }
+  if (!shared && watch->wd >= 0) {
+    inotify_rm_watch(inotify_fd, watch->wd);
+  }
+  free(watch);
+
+  if (list_is_empty(&watches)) {
+    remove_olsr_socket(inotify_fd, NULL, &filewatch_read);
+    close(inotify_fd);
+    inotify_fd = -1;
+  }
+}
+
+#endif /* __linux__ */
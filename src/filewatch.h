@@ -43,18 +43,26 @@
  *
  */
 
-#ifndef _DLLIST_H
-#define	_DLLIST_H
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
 
-struct node {
-  void * data;
-  struct node * next;
-  struct node * prev;
-};
+#ifdef __linux__
 
-struct node * append_node(struct node ** head, struct node ** tail, void * data);
-void remove_node(struct node ** head, struct node **tail, struct node * node, bool free_data);
-void clear_list(struct node **head, struct node **tail, bool free_data);
+/* System includes */
+#include <stdbool.h>
 
-#endif	/* _DLLIST_H */
+/**
+ * Called when a watched file was written, replaced or removed
+ *
+ * @param data the data that was passed to olsr_watch_file
+ */
+typedef void (*file_watch_func)(void *data);
+
+struct file_watch;
+
+struct file_watch * olsr_watch_file(const char * path, unsigned int period, file_watch_func callback, void * data);
+void olsr_unwatch_file(struct file_watch * watch);
+
+#endif /* __linux__ */
 
+#endif /* FILEWATCH_H */
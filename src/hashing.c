@@ -46,6 +46,7 @@
 #include "olsr_protocol.h"
 #include "hashing.h"
 #include "defs.h"
+#include "olsr.h"
 
 /*
  * Taken from lookup2.c by Bob Jenkins.  (http://burtleburtle.net/bob/c/lookup2.c).
@@ -150,12 +151,13 @@ jenkins_hash(const uint8_t * k, uint32_t length)
 }
 
 /**
- * Hashing function. Creates a key based on an IP address.
+ * Hashing function. Creates a full 32 bit key based on an IP address,
+ * for tables that are not limited to HASHSIZE buckets.
  * @param address the address to hash
- * @return the hash(a value in the (0 to HASHMASK-1) range)
+ * @return the hash
  */
 uint32_t
-olsr_ip_hashing(const union olsr_ip_addr * address)
+olsr_ip_hash32(const union olsr_ip_addr * address)
 {
   uint32_t hash;
 
@@ -171,7 +173,172 @@ olsr_ip_hashing(const union olsr_ip_addr * address)
     break;
 
   }
-  return hash & HASHMASK;
+  return hash;
+}
+
+/**
+ * Hashing function. Creates a key based on an IP address.
+ * @param address the address to hash
+ * @return the hash(a value in the (0 to HASHMASK-1) range)
+ */
+uint32_t
+olsr_ip_hashing(const union olsr_ip_addr * address)
+{
+  return olsr_ip_hash32(address) & HASHMASK;
+}
+
+/* access to the chain pointers of an element */
+#define HT_NEXT(table, elem) (*(char **)(void *)((elem) + (table)->next_offset))
+#define HT_PREV(table, elem) (*(char **)(void *)((elem) + (table)->prev_offset))
+
+static char *
+olsr_hashtable_alloc(const struct olsr_hashtable *table, uint32_t size)
+{
+  char *buckets = olsr_malloc(size * table->elem_size, "hashtable buckets");
+  uint32_t i;
+
+  for (i = 0; i < size; i++) {
+    char *head = buckets + i * table->elem_size;
+    HT_NEXT(table, head) = head;
+    HT_PREV(table, head) = head;
+  }
+  return buckets;
+}
+
+/* link an element to the head of a chain */
+static void
+olsr_hashtable_link(const struct olsr_hashtable *table, char *head, char *elem)
+{
+  HT_PREV(table, HT_NEXT(table, head)) = elem;
+  HT_NEXT(table, elem) = HT_NEXT(table, head);
+  HT_PREV(table, elem) = head;
+  HT_NEXT(table, head) = elem;
+}
+
+/* move the chains of some old buckets into the new bucket array */
+static void
+olsr_hashtable_rehash(struct olsr_hashtable *table, uint32_t steps)
+{
+  while (table->old_buckets && steps-- > 0) {
+    char *head = table->old_buckets + table->rehash_pos * table->elem_size;
+
+    while (HT_NEXT(table, head) != head) {
+      char *elem = HT_NEXT(table, head);
+      uint32_t hash = olsr_ip_hash32((const union olsr_ip_addr *)(void *)(elem + table->key_offset));
+
+      HT_NEXT(table, head) = HT_NEXT(table, elem);
+      olsr_hashtable_link(table, table->buckets + (hash & (table->size - 1)) * table->elem_size, elem);
+    }
+    HT_PREV(table, head) = head;
+
+    if (++table->rehash_pos == table->old_size) {
+      free(table->old_buckets);
+      table->old_buckets = NULL;
+    }
+  }
+}
+
+/**
+ * Initialize an empty hashtable, use the olsr_hashtable_init() macro
+ * to get the sizes and offsets from the element type.
+ *
+ * @param table the hashtable
+ * @param elem_size size of the stored elements
+ * @param key_offset offset of the union olsr_ip_addr key
+ * @param next_offset offset of the next pointer
+ * @param prev_offset offset of the prev pointer
+ */
+void
+olsr_hashtable_init_raw(struct olsr_hashtable *table, size_t elem_size, size_t key_offset, size_t next_offset, size_t prev_offset)
+{
+  memset(table, 0, sizeof(*table));
+  table->elem_size = elem_size;
+  table->key_offset = key_offset;
+  table->next_offset = next_offset;
+  table->prev_offset = prev_offset;
+  table->size = OLSR_HASHTABLE_MINSIZE;
+  table->buckets = olsr_hashtable_alloc(table, table->size);
+}
+
+/**
+ * Get the chain an address is stored in.
+ *
+ * @param table the hashtable
+ * @param key the address
+ * @return sentinel element of the chain
+ */
+void *
+olsr_hashtable_head(struct olsr_hashtable *table, const union olsr_ip_addr *key)
+{
+  uint32_t hash = olsr_ip_hash32(key);
+
+  if (table->old_buckets) {
+    uint32_t old_idx = hash & (table->old_size - 1);
+    if (old_idx >= table->rehash_pos) {
+      /* not moved yet */
+      return table->old_buckets + old_idx * table->elem_size;
+    }
+  }
+  return table->buckets + (hash & (table->size - 1)) * table->elem_size;
+}
+
+/**
+ * Insert an element into the hashtable, growing it if necessary.
+ *
+ * @param table the hashtable
+ * @param elem the element, its key must be set
+ */
+void
+olsr_hashtable_insert(struct olsr_hashtable *table, void *elem)
+{
+  olsr_hashtable_rehash(table, OLSR_HASHTABLE_REHASH_STEPS);
+
+  if (table->count >= table->size) {
+    /* finish a running rehash before starting the next one */
+    olsr_hashtable_rehash(table, table->old_size);
+
+    table->old_buckets = table->buckets;
+    table->old_size = table->size;
+    table->rehash_pos = 0;
+
+    table->size *= 2;
+    table->buckets = olsr_hashtable_alloc(table, table->size);
+  }
+
+  olsr_hashtable_link(table, olsr_hashtable_head(table, (const union olsr_ip_addr *)(void *)((char *)elem + table->key_offset)), elem);
+  table->count++;
+}
+
+/**
+ * Remove an element from the hashtable.
+ *
+ * @param table the hashtable
+ * @param elem the element
+ */
+void
+olsr_hashtable_remove(struct olsr_hashtable *table, void *elem)
+{
+  char *e = elem;
+
+  HT_NEXT(table, HT_PREV(table, e)) = HT_NEXT(table, e);
+  HT_PREV(table, HT_NEXT(table, e)) = HT_PREV(table, e);
+  table->count--;
+}
+
+/**
+ * Release the bucket arrays of a hashtable. The elements belong to
+ * the caller and must have been removed and freed before.
+ *
+ * @param table the hashtable
+ */
+void
+olsr_hashtable_free(struct olsr_hashtable *table)
+{
+  free(table->buckets);
+  free(table->old_buckets);
+  table->buckets = NULL;
+  table->old_buckets = NULL;
+  table->size = table->old_size = table->count = 0;
 }
 
 /*
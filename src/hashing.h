@@ -50,8 +50,70 @@
 #define	HASHMASK	(HASHSIZE - 1)
 
 #include "olsr_types.h"
+#include "compiler.h"
+
+#include <stddef.h>
+
+/*
+ * Resizable hash table of circular doubly-linked chains.
+ *
+ * Every bucket is a sentinel element of the stored type, so code working
+ * directly on the chains (next/prev, DEQUEUE_ELEM) keeps working. Elements
+ * are keyed by an IP address. The table doubles its size when it holds more
+ * elements than buckets, the chains of the old bucket array are then moved
+ * a few buckets per insert. Elements must not be inserted while iterating
+ * over the table.
+ */
+struct olsr_hashtable {
+  char *buckets;                       /* array of sentinel elements */
+  char *old_buckets;                   /* previous bucket array while rehashing, NULL otherwise */
+  uint32_t size;                       /* number of buckets, power of two */
+  uint32_t old_size;
+  uint32_t rehash_pos;                 /* first bucket of old_buckets not yet moved */
+  uint32_t count;                      /* number of elements */
+  size_t elem_size;
+  size_t key_offset;
+  size_t next_offset;
+  size_t prev_offset;
+};
+
+/* initial number of buckets */
+#define OLSR_HASHTABLE_MINSIZE  HASHSIZE
+
+/* number of old buckets moved by every insert while rehashing */
+#define OLSR_HASHTABLE_REHASH_STEPS 2
+
+#define olsr_hashtable_init(table, type, key, next, prev) \
+  olsr_hashtable_init_raw(table, sizeof(type), offsetof(type, key), offsetof(type, next), offsetof(type, prev))
+
+void olsr_hashtable_init_raw(struct olsr_hashtable *, size_t, size_t, size_t, size_t);
+void *olsr_hashtable_head(struct olsr_hashtable *, const union olsr_ip_addr *);
+void olsr_hashtable_insert(struct olsr_hashtable *, void *);
+void olsr_hashtable_remove(struct olsr_hashtable *, void *);
+void olsr_hashtable_free(struct olsr_hashtable *);
+
+/*
+ * Number of buckets to iterate over, including the not yet
+ * moved buckets of the old array while rehashing.
+ */
+static INLINE uint32_t
+olsr_hashtable_buckets(const struct olsr_hashtable *table)
+{
+  return table->size + (table->old_buckets ? table->old_size - table->rehash_pos : 0);
+}
+
+/* sentinel of bucket idx (0 <= idx < olsr_hashtable_buckets()) */
+static INLINE void *
+olsr_hashtable_bucket(const struct olsr_hashtable *table, uint32_t idx)
+{
+  if (idx < table->size) {
+    return table->buckets + idx * table->elem_size;
+  }
+  return table->old_buckets + (table->rehash_pos + idx - table->size) * table->elem_size;
+}
 
 uint32_t olsr_ip_hashing(const union olsr_ip_addr *);
+uint32_t olsr_ip_hash32(const union olsr_ip_addr *);
 
 #endif /* _OLSR_HASHING */
 
@@ -53,7 +53,7 @@
 #include "gateway.h"
 #include "duplicate_handler.h"
 
-struct hna_entry hna_set[HASHSIZE];
+struct olsr_hashtable hna_set;
 struct olsr_cookie_info *hna_net_timer_cookie = NULL;
 struct olsr_cookie_info *hna_entry_mem_cookie = NULL;
 struct olsr_cookie_info *hna_net_mem_cookie = NULL;
@@ -66,12 +66,7 @@ static bool olsr_delete_hna_net_entry(struct hna_net *net_to_delete);
 int
 olsr_init_hna_set(void)
 {
-  int idx;
-
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    hna_set[idx].next = &hna_set[idx];
-    hna_set[idx].prev = &hna_set[idx];
-  }
+  olsr_hashtable_init(&hna_set, struct hna_entry, A_gateway_addr, next, prev);
 
   hna_net_timer_cookie = olsr_alloc_cookie("HNA Network", OLSR_COOKIE_TYPE_TIMER);
 
@@ -130,11 +125,11 @@ struct hna_entry *
 olsr_lookup_hna_gw(const union olsr_ip_addr *gw)
 {
   struct hna_entry *tmp_hna;
-  uint32_t hash = olsr_ip_hashing(gw);
+  struct hna_entry *head = olsr_hashtable_head(&hna_set, gw);
 
   /* Check for registered entry */
 
-  for (tmp_hna = hna_set[hash].next; tmp_hna != &hna_set[hash]; tmp_hna = tmp_hna->next) {
+  for (tmp_hna = head->next; tmp_hna != head; tmp_hna = tmp_hna->next) {
     if (ipequal(&tmp_hna->A_gateway_addr, gw)) {
       return tmp_hna;
     }
@@ -155,7 +150,6 @@ struct hna_entry *
 olsr_add_hna_entry(const union olsr_ip_addr *addr)
 {
   struct hna_entry *new_entry;
-  uint32_t hash;
 
   new_entry = olsr_cookie_malloc(hna_entry_mem_cookie);
 
@@ -167,12 +161,7 @@ olsr_add_hna_entry(const union olsr_ip_addr *addr)
   new_entry->networks.prev = &new_entry->networks;
 
   /* queue */
-  hash = olsr_ip_hashing(addr);
-
-  hna_set[hash].next->prev = new_entry;
-  new_entry->next = hna_set[hash].next;
-  hna_set[hash].next = new_entry;
-  new_entry->prev = &hna_set[hash];
+  olsr_hashtable_insert(&hna_set, new_entry);
 
   return new_entry;
 }
@@ -206,6 +195,7 @@ olsr_add_hna_net(struct hna_entry *hna_gw, const union olsr_ip_addr *net, uint8_
   hna_gw->networks.next = new_net;
   new_net->prev = &hna_gw->networks;
 
+  olsr_bump_generation(OLSR_GEN_HNA);
   return new_net;
 }
 
@@ -244,12 +234,13 @@ olsr_delete_hna_net_entry(struct hna_net *net_to_delete) {
 
   /* Delete hna_gw if empty */
   if (hna_gw->networks.next == &hna_gw->networks) {
-    DEQUEUE_ELEM(hna_gw);
+    olsr_hashtable_remove(&hna_set, hna_gw);
     olsr_cookie_free(hna_entry_mem_cookie, hna_gw);
     removed_entry = true;
   }
 
   olsr_cookie_free(hna_net_mem_cookie, net_to_delete);
+  olsr_bump_generation(OLSR_GEN_HNA);
   return removed_entry;
 }
 
@@ -317,7 +308,7 @@ void
 olsr_print_hna_set(void)
 {
   /* The whole function doesn't do anything else. */
-  int idx;
+  struct hna_entry *tmp_hna;
   struct tm * nowtm;
   struct timeval now;
   const int ipwidth = olsr_cnf->ip_version == AF_INET ? (INET_ADDRSTRLEN - 1) : (INET6_ADDRSTRLEN - 1);
@@ -334,23 +325,19 @@ olsr_print_hna_set(void)
   else
     OLSR_PRINTF(1, "IP net/prefixlen               GW IP\n");
 
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct hna_entry *tmp_hna = hna_set[idx].next;
-    /* Check all entrys */
-    while (tmp_hna != &hna_set[idx]) {
-      /* Check all networks */
-      struct hna_net *tmp_net = tmp_hna->networks.next;
+  /* Check all entrys */
+  OLSR_FOR_ALL_HNA_ENTRIES(tmp_hna) {
+    /* Check all networks */
+    struct hna_net *tmp_net = tmp_hna->networks.next;
 
-      while (tmp_net != &tmp_hna->networks) {
-        struct ipaddr_str buf;
-        OLSR_PRINTF(1, "%-*s ", ipwidthprefix, olsr_ip_prefix_to_string(&tmp_net->hna_prefix));
-        OLSR_PRINTF(1, "%-*s\n", ipwidth, olsr_ip_to_string(&buf, &tmp_hna->A_gateway_addr));
+    while (tmp_net != &tmp_hna->networks) {
+      struct ipaddr_str buf;
+      OLSR_PRINTF(1, "%-*s ", ipwidthprefix, olsr_ip_prefix_to_string(&tmp_net->hna_prefix));
+      OLSR_PRINTF(1, "%-*s\n", ipwidth, olsr_ip_to_string(&buf, &tmp_hna->A_gateway_addr));
 
-        tmp_net = tmp_net->next;
-      }
-      tmp_hna = tmp_hna->next;
+      tmp_net = tmp_net->next;
     }
-  }
+  } OLSR_FOR_ALL_HNA_ENTRIES_END(tmp_hna);
 }
 #endif /* NODEBUG */
 
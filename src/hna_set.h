@@ -50,6 +50,7 @@
 #include "olsr_types.h"
 #include "olsr_protocol.h"
 #include "mantissa.h"
+#include "hashing.h"
 
 #include <time.h>
 
@@ -74,16 +75,16 @@ struct hna_entry {
 
 #define OLSR_FOR_ALL_HNA_ENTRIES(hna) \
 { \
-  int _idx; \
-  for (_idx = 0; _idx < HASHSIZE; _idx++) { \
-    struct hna_entry *_next; \
-    for(hna = hna_set[_idx].next; \
-        hna != &hna_set[_idx]; \
+  uint32_t _idx; \
+  for (_idx = 0; _idx < olsr_hashtable_buckets(&hna_set); _idx++) { \
+    struct hna_entry *_head = olsr_hashtable_bucket(&hna_set, _idx), *_next; \
+    for(hna = _head->next; \
+        hna != _head; \
         hna = _next) { \
       _next = hna->next;
 #define OLSR_FOR_ALL_HNA_ENTRIES_END(hna) }}}
 
-extern struct hna_entry hna_set[HASHSIZE];
+extern struct olsr_hashtable hna_set;
 
 int olsr_init_hna_set(void);
 void olsr_cleanup_hna(union olsr_ip_addr *orig);
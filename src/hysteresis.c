@@ -73,6 +73,9 @@ olsr_hyst_calc_instability(float old_quality)
 int
 olsr_process_hysteresis(struct link_entry *entry)
 {
+  /* L_link_pending and L_LOST_LINK_time affect the link status */
+  olsr_invalidate_best_link(entry->neighbor);
+
   //printf("PROCESSING QUALITY: %f\n", entry->L_link_quality);
   if (entry->L_link_quality > hhigh) {
     if (entry->L_link_pending == 1) {
@@ -90,6 +90,7 @@ int
 olsr_init_interfacedb(void)
 {
   struct olsr_if *tmp_if;
+  float pollrate;
 
   /* Initial values */
   ifnet = NULL;
@@ -116,7 +117,14 @@ olsr_init_interfacedb(void)
   }
 
   /* Kick a periodic timer for the network interface update function */
-  olsr_start_timer((unsigned int)olsr_cnf->nic_chgs_pollrate * MSEC_PER_SEC, 5, OLSR_TIMER_PERIODIC, &check_interface_updates, NULL,
+  pollrate = olsr_cnf->nic_chgs_pollrate;
+#ifdef __linux__
+  if (olsr_cnf->rt_monitor_socket >= 0 && pollrate == (float)DEF_NICCHGPOLLRT) {
+    /* changes are reported by netlink, polling is only a fallback */
+    pollrate = (float)DEF_NICCHGPOLLRT_NL;
+  }
+#endif /* __linux__ */
+  olsr_start_timer((unsigned int)pollrate * MSEC_PER_SEC, 5, OLSR_TIMER_PERIODIC, &check_interface_updates, NULL,
                    interface_poll_timer_cookie);
 
   return (ifnet == NULL) ? 0 : 1;
@@ -109,12 +109,18 @@ struct vtimes {
 
 /* Output buffer structure. This should actually be in net_olsr.h but we have circular references then.
  */
+struct net_fragment_ref;
+
 struct olsr_netbuf {
   uint8_t *buff;                       /* Pointer to the allocated buffer */
   int bufsize;                         /* Size of the buffer */
   int maxsize;                         /* Max bytes of payload that can be added to the buffer */
   int pending;                         /* How much data is currently pending in the buffer */
   int reserved;                        /* Plugins can reserve space in buffers */
+  int local;                           /* How much of the pending data is in buff, the rest is in frags */
+  struct net_fragment_ref *frags;      /* Shared (forwarded) messages, in packet order */
+  int frag_count;                      /* Number of frags in use */
+  int frag_size;                       /* Number of frags allocated */
 };
 
 /**
@@ -230,6 +230,22 @@ prefix_to_netmask4(uint8_t prefixlen)
   return prefixlen == 0 ? 0 : (~0U << (32 - prefixlen));
 }
 
+/**
+ * Clear the bits of a prefix beyond its prefix length.
+ *
+ * @param prefix the prefix to normalize
+ */
+void
+ip_prefix_normalize(struct olsr_ip_prefix *prefix)
+{
+  uint8_t *a = (uint8_t *)&prefix->prefix;
+  unsigned int i;
+
+  for (i = prefix->prefix_len / 8; i < olsr_cnf->ipsize; i++) {
+    a[i] &= i == prefix->prefix_len / 8 ? (uint8_t)(0xff << (8 - prefix->prefix_len % 8)) : 0;
+  }
+}
+
 /* see if the ipaddr is in the net. That is equivalent to the fact that the net part
  * of both are equal. So we must compare the first <prefixlen> bits. Network-byte-order!
  */
@@ -64,6 +64,14 @@ int olsr_ioctl_del_route6(const struct rt_entry *rt);
     const struct olsr_ip_prefix *dst, bool set, bool del_similar, bool blackhole);
 
   int rtnetlink_register_socket(int);
+
+  int olsr_netlink_route_init(void);
+  void olsr_netlink_route_flush(void);
+  void olsr_netlink_route_close(void);
+  int olsr_netlink_route_sync(bool purge, void (*done)(bool));
+  bool olsr_netlink_route_syncing(void);
+  void olsr_netlink_route_sync_abort(void);
+  void olsr_netlink_route_confirm(struct rt_entry *rt);
 #endif /* __linux__ */
 
 void olsr_os_niit_4to6_route(const struct olsr_ip_prefix *dst_v4, bool set);
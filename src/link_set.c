@@ -61,16 +61,26 @@
 #include "net_olsr.h"
 #include "ipcalc.h"
 #include "lq_plugin.h"
+#include "lq_packet.h"
 
 /* head node for all link sets */
 struct list_node link_entry_head;
 
+/* all links, keyed by the remote interface address */
+static struct olsr_hashtable link_hash;
+
+/* generation of the cached best links of the neighbors */
+static uint32_t best_link_gen = 1;
+
 bool link_changes = false; /* is set if changes occur in MPRS set */
 
 void
 signal_link_changes(bool val)
 {                               /* XXX ugly */
   link_changes = val;
+  if (val) {
+    olsr_invalidate_lq_tc();
+  }
 }
 
 /* Prototypes. */
@@ -80,12 +90,60 @@ static struct link_entry *add_link_entry(const union olsr_ip_addr *, const union
 static int get_neighbor_status(const union olsr_ip_addr *);
 static void olsr_expire_link_sym_timer(void *context);
 
+/*
+ * interface metrics and names are used for selecting the best link,
+ * so forget all cached best links when an interface changes.
+ */
+static void
+olsr_link_ifchange(int if_index __attribute__ ((unused)), struct interface_olsr *ifp __attribute__ ((unused)),
+                   enum olsr_ifchg_flag flag __attribute__ ((unused)))
+{
+  olsr_invalidate_all_best_links();
+}
+
 void
 olsr_init_link_set(void)
 {
 
   /* Init list head */
   list_head_init(&link_entry_head);
+
+  olsr_hashtable_init(&link_hash, struct link_entry, neighbor_iface_addr, hash_next, hash_prev);
+
+  olsr_add_ifchange_handler(&olsr_link_ifchange);
+}
+
+/**
+ * Forget the cached best link of a neighbor, this must be called
+ * whenever the cost or the status of one of its links changes.
+ *
+ * @param nbr the neighbor, may be NULL
+ */
+void
+olsr_invalidate_best_link(struct neighbor_entry *nbr)
+{
+  if (nbr != NULL) {
+    nbr->best_link_gen = 0;
+  }
+}
+
+/**
+ * Forget the cached best links of all neighbors.
+ */
+void
+olsr_invalidate_all_best_links(void)
+{
+  olsr_invalidate_lq_tc();
+
+  if (++best_link_gen == 0) {
+    struct neighbor_entry *nbr;
+
+    /* wrapped around, make sure no stale entry matches again */
+    OLSR_FOR_ALL_NBR_ENTRIES(nbr) {
+      nbr->best_link_gen = 0;
+    } OLSR_FOR_ALL_NBR_ENTRIES_END(nbr);
+    best_link_gen = 1;
+  }
 }
 
 /**
@@ -106,6 +164,8 @@ void olsr_reset_all_links(void) {
     link->neighbor->status = NOT_SYM;
   } OLSR_FOR_ALL_LINK_ENTRIES_END(link)
 
+  olsr_invalidate_all_best_links();
+
 
   OLSR_FOR_ALL_LINK_ENTRIES(link) {
     olsr_expire_link_sym_timer(link);
@@ -212,36 +272,37 @@ get_neighbor_status(const union olsr_ip_addr *address)
 }
 
 /**
- * Find best link to a neighbor
+ * Select the best link out of the links to a neighbor.
+ *
+ * @param nbr the neighbor
+ * @param remote the requested remote address, used as a tie-breaker
+ * @param stable set to false if the result may change without
+ *   any change to the links (hysteresis timeouts)
+ * @return the best link, NULL if there is none
  */
-struct link_entry *
-get_best_link_to_neighbor(const union olsr_ip_addr *remote)
+static struct link_entry *
+olsr_select_best_link(struct neighbor_entry *nbr, const union olsr_ip_addr *remote, bool *stable)
 {
-  const union olsr_ip_addr *main_addr;
+  struct list_node *node;
   struct link_entry *walker, *good_link, *backup_link;
   struct interface_olsr *tmp_if;
   int curr_metric = MAX_IF_METRIC;
   olsr_linkcost curr_lcost = LINK_COST_BROKEN;
   olsr_linkcost tmp_lc;
 
-  /* main address lookup */
-  main_addr = mid_lookup_main_addr(remote);
-
-  /* "remote" *already is* the main address */
-  if (!main_addr) {
-    main_addr = remote;
-  }
-
   /* we haven't selected any links, yet */
   good_link = NULL;
   backup_link = NULL;
+  *stable = true;
 
-  /* loop through all links that we have */
-  OLSR_FOR_ALL_LINK_ENTRIES(walker) {
+  /* loop through all links to the neighbor */
+  for (node = nbr->link_list.next; node != &nbr->link_list; node = node->next) {
+    walker = nbrlist2link(node);
 
-    /* if this is not a link to the neighour in question, skip */
-    if (!ipequal(&walker->neighbor->neighbor_main_addr, main_addr))
-      continue;
+    if (olsr_cnf->use_hysteresis && !TIMED_OUT(walker->L_LOST_LINK_time)) {
+      /* the status of this link changes when L_LOST_LINK_time runs out */
+      *stable = false;
+    }
 
     if (olsr_cnf->lq_level == 0) {
 
@@ -302,7 +363,6 @@ get_best_link_to_neighbor(const union olsr_ip_addr *remote)
       }
     }
   }
-  OLSR_FOR_ALL_LINK_ENTRIES_END(walker);
 
   /*
    * if we haven't found any symmetric links, try to return an asymmetric link.
@@ -310,6 +370,50 @@ get_best_link_to_neighbor(const union olsr_ip_addr *remote)
   return good_link ? good_link : backup_link;
 }
 
+/**
+ * Find best link to a neighbor
+ *
+ * The result for the main address of a neighbor is cached in the
+ * neighbor entry until olsr_invalidate_best_link() is called.
+ */
+struct link_entry *
+get_best_link_to_neighbor(const union olsr_ip_addr *remote)
+{
+  const union olsr_ip_addr *main_addr;
+  struct neighbor_entry *nbr;
+  struct link_entry *best;
+  bool stable;
+
+  /* main address lookup */
+  main_addr = mid_lookup_main_addr(remote);
+
+  /* "remote" *already is* the main address */
+  if (!main_addr) {
+    main_addr = remote;
+  }
+
+  nbr = olsr_lookup_neighbor_table_alias(main_addr);
+  if (nbr == NULL) {
+    return NULL;
+  }
+
+  /* the tie-breaker depends on remote, only cache lookups by main address */
+  if (main_addr != remote) {
+    return olsr_select_best_link(nbr, remote, &stable);
+  }
+
+  if (nbr->best_link_gen != best_link_gen) {
+    best = olsr_select_best_link(nbr, remote, &stable);
+
+    if (!stable) {
+      return best;
+    }
+    nbr->best_link = best;
+    nbr->best_link_gen = best_link_gen;
+  }
+  return nbr->best_link;
+}
+
 static void
 set_loss_link_multiplier(struct link_entry *entry)
 {
@@ -378,11 +482,14 @@ olsr_delete_link_entry(struct link_entry *link)
 
 
   /* Delete neighbor entry */
-  if (link->neighbor->linkcount == 1) {
+  list_remove(&link->nbr_link_list);
+  if (list_is_empty(&link->neighbor->link_list)) {
     olsr_delete_neighbor_table(&link->neighbor->neighbor_main_addr);
   } else {
     link->neighbor->linkcount--;
+    olsr_invalidate_best_link(link->neighbor);
   }
+  olsr_invalidate_lq_tc();
 
   /* Kill running timers */
   olsr_stop_timer(link->link_timer);
@@ -394,11 +501,13 @@ olsr_delete_link_entry(struct link_entry *link)
   olsr_stop_timer(link->link_loss_timer);
   link->link_loss_timer = NULL;
   list_remove(&link->link_list);
+  olsr_hashtable_remove(&link_hash, link);
 
   free(link->if_name);
   free(link);
 
   changes_neighborhood = true;
+  olsr_bump_generation(OLSR_GEN_LINKS);
 }
 
 /**
@@ -451,6 +560,10 @@ olsr_expire_link_sym_timer(void *context)
   link = (struct link_entry *)context;
   link->link_sym_timer = NULL;  /* be pedandic */
 
+  olsr_invalidate_best_link(link->neighbor);
+  olsr_invalidate_lq_tc();
+  olsr_bump_generation(OLSR_GEN_LINKS);
+
   if (link->prev_status != SYM_LINK) {
     return;
   }
@@ -606,6 +719,7 @@ add_link_entry(const union olsr_ip_addr *local, const union olsr_ip_addr *remote
 
   /* Add to queue */
   list_add_before(&link_entry_head, &new_link->link_list);
+  olsr_hashtable_insert(&link_hash, new_link);
 
   /*
    * Create the neighbor entry
@@ -623,6 +737,9 @@ add_link_entry(const union olsr_ip_addr *local, const union olsr_ip_addr *remote
 
   neighbor->linkcount++;
   new_link->neighbor = neighbor;
+  list_add_before(&neighbor->link_list, &new_link->nbr_link_list);
+  olsr_invalidate_best_link(neighbor);
+  olsr_bump_generation(OLSR_GEN_LINKS);
 
   return new_link;
 }
@@ -631,21 +748,26 @@ add_link_entry(const union olsr_ip_addr *local, const union olsr_ip_addr *remote
  * Lookup the status of a link.
  *
  * @param int_addr address of the remote interface
- * @return 1 of the link is symmertic 0 if not
+ * @return SYM_LINK if one of the links to the remote interface
+ *   is symmetric, otherwise the status of one of them
  */
 int
 check_neighbor_link(const union olsr_ip_addr *int_addr)
 {
-  struct link_entry *link;
+  struct link_entry *head, *link;
+  int status = UNSPEC_LINK;
 
-  OLSR_FOR_ALL_LINK_ENTRIES(link) {
+  head = olsr_hashtable_head(&link_hash, int_addr);
+  for (link = head->hash_next; link != head; link = link->hash_next) {
     if (ipequal(int_addr, &link->neighbor_iface_addr)) {
-      return lookup_link_status(link);
+      status = lookup_link_status(link);
+      if (status == SYM_LINK) {
+        break;
+      }
     }
   }
-  OLSR_FOR_ALL_LINK_ENTRIES_END(link);
 
-  return UNSPEC_LINK;
+  return status;
 }
 
 /**
@@ -659,9 +781,10 @@ check_neighbor_link(const union olsr_ip_addr *int_addr)
 struct link_entry *
 lookup_link_entry(const union olsr_ip_addr *remote, const union olsr_ip_addr *remote_main, const struct interface_olsr *local)
 {
-  struct link_entry *link;
+  struct link_entry *head, *link;
 
-  OLSR_FOR_ALL_LINK_ENTRIES(link) {
+  head = olsr_hashtable_head(&link_hash, remote);
+  for (link = head->hash_next; link != head; link = link->hash_next) {
     if (ipequal(remote, &link->neighbor_iface_addr)
         && (link->if_name ? !strcmp(link->if_name, local->int_name) : ipequal(&local->ip_addr, &link->local_iface_addr))) {
       /* check the remote-main address only if there is one given */
@@ -676,7 +799,6 @@ lookup_link_entry(const union olsr_ip_addr *remote, const union olsr_ip_addr *re
       return link;
     }
   }
-  OLSR_FOR_ALL_LINK_ENTRIES_END(link);
 
   return NULL;
 }
@@ -697,9 +819,11 @@ update_link_entry(const union olsr_ip_addr *local, const union olsr_ip_addr *rem
                   const struct interface_olsr *in_if)
 {
   struct link_entry *entry;
+  int old_status;
 
   /* Add if not registered */
   entry = add_link_entry(local, remote, &message->source_addr, message->vtime, message->htime, in_if);
+  old_status = lookup_link_status(entry);
 
   /* Update ASYM_time */
   entry->vtime = message->vtime;
@@ -735,6 +859,13 @@ update_link_entry(const union olsr_ip_addr *local, const union olsr_ip_addr *rem
   if (olsr_cnf->use_hysteresis)
     olsr_process_hysteresis(entry);
 
+  /* the link status may have changed */
+  olsr_invalidate_best_link(entry->neighbor);
+  if (lookup_link_status(entry) != old_status) {
+    olsr_invalidate_lq_tc();
+    olsr_bump_generation(OLSR_GEN_LINKS);
+  }
+
   /* Update neighbor */
   update_neighbor_status(entry->neighbor, get_neighbor_status(remote));
 
@@ -751,23 +882,28 @@ update_link_entry(const union olsr_ip_addr *local, const union olsr_ip_addr *rem
  * @return the number of entries updated
  */
 int
-replace_neighbor_link_set(const struct neighbor_entry *old, struct neighbor_entry *new)
+replace_neighbor_link_set(struct neighbor_entry *old, struct neighbor_entry *new)
 {
-  struct link_entry *link;
+  struct list_node *node;
   int retval = 0;
 
-  if (list_is_empty(&link_entry_head)) {
+  if (old == new) {
     return retval;
   }
 
-  OLSR_FOR_ALL_LINK_ENTRIES(link) {
-
-    if (link->neighbor == old) {
-      link->neighbor = new;
-      retval++;
-    }
+  for (node = old->link_list.next; node != &old->link_list; node = node->next) {
+    nbrlist2link(node)->neighbor = new;
+    retval++;
   }
-  OLSR_FOR_ALL_LINK_ENTRIES_END(link);
+
+  /* move the links over to the new neighbor */
+  list_merge(&new->link_list, &old->link_list);
+  new->linkcount += retval;
+  old->linkcount -= retval;
+
+  olsr_invalidate_best_link(old);
+  olsr_invalidate_best_link(new);
+  olsr_bump_generation(OLSR_GEN_LINKS);
 
   return retval;
 }
@@ -95,11 +95,18 @@ struct link_entry {
   olsr_linkcost linkcost;
 
   struct list_node link_list;          /* double linked list of all link entries */
+  struct list_node nbr_link_list;      /* links to the same neighbor */
+
+  /* hash index of all links, keyed by neighbor_iface_addr */
+  struct link_entry *hash_next;
+  struct link_entry *hash_prev;
+
   uint32_t linkquality[0];
 };
 
 /* INLINE to recast from link_list back to link_entry */
 LISTNODE2STRUCT(list2link, struct link_entry, link_list);
+LISTNODE2STRUCT(nbrlist2link, struct link_entry, nbr_link_list);
 
 #define OLSR_LINK_JITTER       5        /* percent */
 #define OLSR_LINK_HELLO_JITTER 0        /* percent jitter */
@@ -129,6 +136,8 @@ void olsr_reset_all_links(void);
 void olsr_delete_link_entry_by_ip(const union olsr_ip_addr *);
 void olsr_expire_link_hello_timer(void *);
 void signal_link_changes(bool);        /* XXX ugly */
+void olsr_invalidate_best_link(struct neighbor_entry *);
+void olsr_invalidate_all_best_links(void);
 
 struct link_entry *get_best_link_to_neighbor(const union olsr_ip_addr *);
 
@@ -138,7 +147,7 @@ struct link_entry *update_link_entry(const union olsr_ip_addr *, const union ols
                                      const struct interface_olsr *);
 
 int check_neighbor_link(const union olsr_ip_addr *);
-int replace_neighbor_link_set(const struct neighbor_entry *, struct neighbor_entry *);
+int replace_neighbor_link_set(struct neighbor_entry *, struct neighbor_entry *);
 int lookup_link_status(const struct link_entry *);
 void olsr_update_packet_loss_hello_int(struct link_entry *, olsr_reltime);
 void olsr_received_hello_handler(struct link_entry *entry);
@@ -46,12 +46,14 @@
 #ifdef __linux__
 
 #include "kernel_routes.h"
+#include "process_routes.h"
 #include "ipc_frontend.h"
 #include "log.h"
 #include "net_os.h"
 #include "ifnet.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <linux/types.h>
 #include <linux/rtnetlink.h>
 
@@ -73,7 +75,7 @@
  * from /usr/include/linux/netlink.h and adapted for ARM
  */
 #define MY_NLMSG_NEXT(nlh,len)   ((len) -= NLMSG_ALIGN((nlh)->nlmsg_len), \
-          (struct nlmsghdr*)ARM_NOWARN_ALIGN((((char*)(nlh)) + NLMSG_ALIGN((nlh)->nlmsg_len)))
+          (struct nlmsghdr*)ARM_NOWARN_ALIGN((((char*)(nlh)) + NLMSG_ALIGN((nlh)->nlmsg_len))))
 
 
 static void rtnetlink_read(int sock, void *, unsigned int);
@@ -90,6 +92,25 @@ struct olsr_ipadd_req {
   char buf[256];
 };
 
+/* parameters of a route operation, see olsr_new_netlink_route() */
+struct olsr_nl_route {
+  unsigned char family;
+  unsigned char scope;
+  bool set;
+  bool del_similar;
+  bool blackhole;
+  bool has_src;
+  bool has_gw;
+  uint32_t rttable;
+  unsigned int flags;
+  int if_index;
+  int metric;
+  int protocol;
+  union olsr_ip_addr src;
+  union olsr_ip_addr gw;
+  struct olsr_ip_prefix dst;
+};
+
 int rtnetlink_register_socket(int rtnl_mgrp)
 {
   int sock = socket(AF_NETLINK,SOCK_RAW,NETLINK_ROUTE);
@@ -145,12 +166,48 @@ static void netlink_process_link(struct nlmsghdr *h)
     olsr_remove_interface(iface->olsr_if);
   }
 
+  if (iface && up && oif && oif->cnf->autodetect_chg && !olsr_cnf->host_emul) {
+    /* flags or MTU may have changed */
+    chk_if_changed(oif);
+  }
+
   if (!iface && !oif) {
     /* this is not an OLSR interface */
     olsr_trigger_ifchange(ifi->ifi_index, NULL, up ? IFCHG_IF_ADD : IFCHG_IF_REMOVE);
   }
 }
 
+static void netlink_process_addr(struct nlmsghdr *h)
+{
+  struct ifaddrmsg *ifa = (struct ifaddrmsg *) NLMSG_DATA(h);
+  struct interface_olsr *iface;
+  struct olsr_if *oif;
+  char namebuffer[IF_NAMESIZE];
+
+  if (ifa->ifa_family != olsr_cnf->ip_version || olsr_cnf->host_emul) {
+    return;
+  }
+
+  iface = if_ifwithindex(ifa->ifa_index);
+  if (iface) {
+    oif = iface->olsr_if;
+  } else {
+    oif = if_indextoname(ifa->ifa_index, namebuffer) ? olsrif_ifwithname(namebuffer) : NULL;
+  }
+
+  if (!oif || oif->host_emul || !oif->cnf->autodetect_chg) {
+    return;
+  }
+
+  if (oif->configured) {
+    /* address added or removed, will trigger ifchange */
+    chk_if_changed(oif);
+  } else {
+    /* the interface may have got the address it was waiting for */
+    chk_if_up(oif, 3);
+  }
+}
+
 static void rtnetlink_read(int sock, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused)))
 {
   int len, plen;
@@ -167,31 +224,40 @@ static void rtnetlink_read(int sock, void *data __attribute__ ((unused)), unsign
   };
 
   char buffer[4096];
-  struct nlmsghdr *nlh = (struct nlmsghdr *)ARM_NOWARN_ALIGN(buffer);
+  struct nlmsghdr *nlh;
   int ret;
 
   iov.iov_base = (void *) buffer;
   iov.iov_len = sizeof(buffer);
 
   while ((ret = recvmsg(sock, &msg, MSG_DONTWAIT)) >= 0) {
-    /*check message*/
-    len = nlh->nlmsg_len;
-    plen = len - sizeof(nlh);
-    if (len > ret || plen < 0) {
-      OLSR_PRINTF(1,"Malformed netlink message: "
-             "len=%d left=%d plen=%d\n",
-              len, ret, plen);
-      return;
-    }
-
-    OLSR_PRINTF(3, "Netlink message received: type 0x%x\n", nlh->nlmsg_type);
-    if ((nlh->nlmsg_type == RTM_NEWLINK) || ( nlh->nlmsg_type == RTM_DELLINK)) {
-      /* handle ifup/ifdown */
-      netlink_process_link(nlh);
+    for (nlh = (struct nlmsghdr *)ARM_NOWARN_ALIGN(buffer); ret >= (int)sizeof(struct nlmsghdr) && NLMSG_OK(nlh, (unsigned int)ret); nlh = MY_NLMSG_NEXT(nlh, ret)) {
+      /*check message*/
+      len = nlh->nlmsg_len;
+      plen = len - sizeof(nlh);
+      if (len > ret || plen < 0) {
+        OLSR_PRINTF(1,"Malformed netlink message: "
+               "len=%d left=%d plen=%d\n",
+                len, ret, plen);
+        return;
+      }
+
+      OLSR_PRINTF(3, "Netlink message received: type 0x%x\n", nlh->nlmsg_type);
+      if ((nlh->nlmsg_type == RTM_NEWLINK) || ( nlh->nlmsg_type == RTM_DELLINK)) {
+        /* handle ifup/ifdown */
+        netlink_process_link(nlh);
+      } else if ((nlh->nlmsg_type == RTM_NEWADDR) || (nlh->nlmsg_type == RTM_DELADDR)) {
+        /* handle address changes */
+        netlink_process_addr(nlh);
+      }
     }
   }
 
-  if (errno != EAGAIN) {
+  if (errno == ENOBUFS) {
+    /* the kernel dropped events, check all interfaces the slow way */
+    OLSR_PRINTF(1, "netlink monitor overrun, rechecking all interfaces\n");
+    check_interface_updates(NULL);
+  } else if (errno != EAGAIN) {
     OLSR_PRINTF(1,"netlink listen error %u - %s\n",errno,strerror(errno));
   }
 }
@@ -344,122 +410,151 @@ int olsr_os_ifip(int ifindex, union olsr_ip_addr *ip, bool create) {
   return olsr_add_ip(ifindex, ip, NULL, create);
 }
 
-int olsr_new_netlink_route(unsigned char family, uint32_t rttable, unsigned int flags, unsigned char scope, int if_index, int metric, int protocol,
-    const union olsr_ip_addr *src, const union olsr_ip_addr *gw, const struct olsr_ip_prefix *dst,
-    bool set, bool del_similar, bool blackhole) {
-
-  struct olsr_rtreq req;
-  int family_size;
-  int err;
-
-  if (0) {
-    struct ipaddr_str buf1, buf2;
+/* fill a rtnetlink request for a route operation */
+static void
+olsr_netlink_route_req(struct olsr_rtreq *req, const struct olsr_nl_route *route)
+{
+  int family_size = route->family == AF_INET ? sizeof(struct in_addr) : sizeof(struct in6_addr);
 
-    olsr_syslog(OLSR_LOG_INFO, "new_netlink_route: family=%d,rttable=%d,if_index=%d,metric=%d,protocol=%d,src=%s,gw=%s,dst=%s,set=%s,del_similar=%s",
-        family, rttable, if_index, metric, protocol, src == NULL ? "" : olsr_ip_to_string(&buf1, src),
-        gw == NULL ? "" : olsr_ip_to_string(&buf2, gw), olsr_ip_prefix_to_string(dst),
-        set ? "true" : "false", del_similar ? "true" : "false");
-  }
-  family_size = family == AF_INET ? sizeof(struct in_addr) : sizeof(struct in6_addr);
+  memset(req, 0, sizeof(*req));
 
-  memset(&req, 0, sizeof(req));
+  req->n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+  req->n.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
 
-  req.r.rtm_flags = flags;
-  req.r.rtm_family = family;
+  req->r.rtm_flags = route->flags;
+  req->r.rtm_family = route->family;
 #ifndef __ANDROID__
-  if (rttable < 256)
-    req.r.rtm_table = rttable;
+  if (route->rttable < 256)
+    req->r.rtm_table = route->rttable;
   else {
-    req.r.rtm_table = RT_TABLE_UNSPEC;
-    olsr_netlink_addreq(&req.n, sizeof(req), RTA_TABLE, &rttable, sizeof(rttable));
+    req->r.rtm_table = RT_TABLE_UNSPEC;
+    olsr_netlink_addreq(&req->n, sizeof(*req), RTA_TABLE, &route->rttable, sizeof(route->rttable));
   }
 #else
-  req.r.rtm_table = rttable;
+  req->r.rtm_table = route->rttable;
 #endif
 
-  req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
-  req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
-
-  if (set) {
-    req.n.nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
-    req.n.nlmsg_type = RTM_NEWROUTE;
+  if (route->set) {
+    req->n.nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
+    req->n.nlmsg_type = RTM_NEWROUTE;
   } else {
-    req.n.nlmsg_type = RTM_DELROUTE;
+    req->n.nlmsg_type = RTM_DELROUTE;
   }
 
   /* RTN_UNSPEC would be the wildcard, but blackhole broadcast or nat roules should usually not conflict */
   /* -> olsr only adds deletes unicast routes */
-  if (blackhole) {
-    req.r.rtm_type = RTN_BLACKHOLE;
+  if (route->blackhole) {
+    req->r.rtm_type = RTN_BLACKHOLE;
   } else {
-    req.r.rtm_type = RTN_UNICAST;
+    req->r.rtm_type = RTN_UNICAST;
   }
 
-  req.r.rtm_dst_len = dst->prefix_len;
+  req->r.rtm_dst_len = route->dst.prefix_len;
 
-  if (set) {
+  if (route->set) {
     /* add protocol for setting a route */
-    req.r.rtm_protocol = protocol;
+    req->r.rtm_protocol = route->protocol;
   }
 
   /* calculate scope of operation */
-  if (!set && del_similar) {
+  if (!route->set && route->del_similar) {
     /* as wildcard for fuzzy deletion */
-    req.r.rtm_scope = RT_SCOPE_NOWHERE;
+    req->r.rtm_scope = RT_SCOPE_NOWHERE;
   }
   else {
     /* for all our routes */
-    req.r.rtm_scope = scope;
+    req->r.rtm_scope = route->scope;
   }
 
-  if ((set || !del_similar) && !blackhole) {
+  if ((route->set || !route->del_similar) && !route->blackhole) {
     /* add interface*/
-    olsr_netlink_addreq(&req.n, sizeof(req), RTA_OIF, &if_index, sizeof(if_index));
+    olsr_netlink_addreq(&req->n, sizeof(*req), RTA_OIF, &route->if_index, sizeof(route->if_index));
   }
 
-  if (set && src != NULL) {
+  if (route->set && route->has_src) {
     /* add src-ip */
-    olsr_netlink_addreq(&req.n, sizeof(req), RTA_PREFSRC, src, family_size);
+    olsr_netlink_addreq(&req->n, sizeof(*req), RTA_PREFSRC, &route->src, family_size);
   }
 
-  if (metric >= 0) {
+  if (route->metric >= 0) {
     /* add metric */
-    olsr_netlink_addreq(&req.n, sizeof(req), RTA_PRIORITY, &metric, sizeof(metric));
+    olsr_netlink_addreq(&req->n, sizeof(*req), RTA_PRIORITY, &route->metric, sizeof(route->metric));
   }
 
-  if (gw) {
+  if (route->has_gw) {
     /* add gateway */
-    olsr_netlink_addreq(&req.n, sizeof(req), RTA_GATEWAY, gw, family_size);
+    olsr_netlink_addreq(&req->n, sizeof(*req), RTA_GATEWAY, &route->gw, family_size);
   }
   else {
-    if ( dst->prefix_len == 32 ) {
+    if ( route->dst.prefix_len == 32 ) {
       /* use destination as gateway, to 'force' linux kernel to do proper source address selection */
-      olsr_netlink_addreq(&req.n, sizeof(req), RTA_GATEWAY, &dst->prefix, family_size);
+      olsr_netlink_addreq(&req->n, sizeof(*req), RTA_GATEWAY, &route->dst.prefix, family_size);
     }
     else {
       /*do not use onlink on such routes(no gateway, but no hostroute aswell) -  e.g. smartgateway default route over an ptp tunnel interface*/
-      req.r.rtm_flags &= (~RTNH_F_ONLINK);
+      req->r.rtm_flags &= (~RTNH_F_ONLINK);
     }
   }
 
    /* add destination */
-  olsr_netlink_addreq(&req.n, sizeof(req), RTA_DST, &dst->prefix, family_size);
+  olsr_netlink_addreq(&req->n, sizeof(*req), RTA_DST, &route->dst.prefix, family_size);
+}
+
+/* log a failed route operation */
+static void
+olsr_netlink_route_error(const struct olsr_nl_route *route, int err)
+{
+  struct ipaddr_str buf;
+
+  olsr_syslog(OLSR_LOG_ERR, ". error: %s route to %s via %s dev %s onlink (%s %d)",
+      route->set ? "add" : "del",
+      olsr_ip_prefix_to_string(&route->dst), olsr_ip_to_string(&buf, route->has_gw ? &route->gw : &route->dst.prefix),
+      if_ifwithindex_name(route->if_index), strerror(err), err);
+}
+
+int olsr_new_netlink_route(unsigned char family, uint32_t rttable, unsigned int flags, unsigned char scope, int if_index, int metric, int protocol,
+    const union olsr_ip_addr *src, const union olsr_ip_addr *gw, const struct olsr_ip_prefix *dst,
+    bool set, bool del_similar, bool blackhole) {
+
+  struct olsr_nl_route route;
+  struct olsr_rtreq req;
+  int err;
+
+  if (0) {
+    struct ipaddr_str buf1, buf2;
+
+    olsr_syslog(OLSR_LOG_INFO, "new_netlink_route: family=%d,rttable=%d,if_index=%d,metric=%d,protocol=%d,src=%s,gw=%s,dst=%s,set=%s,del_similar=%s",
+        family, rttable, if_index, metric, protocol, src == NULL ? "" : olsr_ip_to_string(&buf1, src),
+        gw == NULL ? "" : olsr_ip_to_string(&buf2, gw), olsr_ip_prefix_to_string(dst),
+        set ? "true" : "false", del_similar ? "true" : "false");
+  }
+
+  memset(&route, 0, sizeof(route));
+  route.family = family;
+  route.rttable = rttable;
+  route.flags = flags;
+  route.scope = scope;
+  route.if_index = if_index;
+  route.metric = metric;
+  route.protocol = protocol;
+  if (src) {
+    route.has_src = true;
+    route.src = *src;
+  }
+  if (gw) {
+    route.has_gw = true;
+    route.gw = *gw;
+  }
+  route.dst = *dst;
+  route.set = set;
+  route.del_similar = del_similar;
+  route.blackhole = blackhole;
+
+  olsr_netlink_route_req(&req, &route);
 
   err = olsr_netlink_send(&req.n);
   if (err) {
-      struct ipaddr_str buf;
-    if (gw) {
-      olsr_syslog(OLSR_LOG_ERR, ". error: %s route to %s via %s dev %s onlink (%s %d)",
-          set ? "add" : "del",
-          olsr_ip_prefix_to_string(dst), olsr_ip_to_string(&buf, gw),
-          if_ifwithindex_name(if_index), strerror(errno), errno);
-    }
-    else {
-      olsr_syslog(OLSR_LOG_ERR, ". error: %s route to %s via %s dev %s onlink (%s %d)",
-          set ? "add" : "del",
-          olsr_ip_prefix_to_string(dst), olsr_ip_to_string(&buf, &dst->prefix), if_ifwithindex_name(if_index),
-          strerror(errno), errno);
-    }
+    olsr_netlink_route_error(&route, err);
   }
 
   return err;
@@ -499,29 +594,473 @@ void olsr_os_inetgw_tunnel_route(uint32_t if_idx, bool ipv4, bool set, uint8_t t
   }
 }
 
-static int olsr_os_process_rt_entry(unsigned char af_family, const struct rt_entry *rt, bool set) {
-  int metric;
-  uint32_t table;
+/*
+ * Asynchronous route writer
+ *
+ * Route changes of the RIB are not written with one blocking round trip
+ * per route. The requests are packed into a batch buffer which is written
+ * with a single sendmsg() at the end of a route update (or whenever the
+ * buffer runs full). The kernel acknowledges every request in order, the
+ * answers are collected by a socket handler in the scheduler.
+ *
+ * Each request in flight has an entry in a ring of pending requests, which
+ * keeps the route parameters so errors can be repaired (deleting similar
+ * routes, adding a hostroute to the gateway), retried or reported later.
+ */
+#define NL_ROUTE_BATCH_SIZE   16384
+#define NL_ROUTE_PENDING_MAX  512
+#define NL_ROUTE_MAX_RETRIES  3
+
+enum olsr_nl_stage {
+  NL_STAGE_ROUTE,                      /* the route itself */
+  NL_STAGE_DEL_SIMILAR,                /* delete similar routes after 'File exists' */
+  NL_STAGE_HOSTROUTE,                  /* add a hostroute to the gateway after 'Network unreachable' */
+  NL_STAGE_FINAL                       /* second try of the route after a successful repair */
+};
+
+struct olsr_nl_pending {
+  uint32_t seq;
+  uint8_t stage;
+  uint8_t retries;
+  bool host_route;
+  struct olsr_nl_route route;
+};
+
+static int nl_route_sock = -1;
+static uint32_t nl_route_seq;
+
+/* ring of requests in flight, the last nl_pending_unsent ones are still in the batch buffer */
+static struct olsr_nl_pending nl_pending[NL_ROUTE_PENDING_MAX];
+static unsigned int nl_pending_head, nl_pending_count, nl_pending_unsent;
+static bool nl_route_reading;
+
+static uint32_t nl_batch[NL_ROUTE_BATCH_SIZE / sizeof(uint32_t)];
+static size_t nl_batch_len;
+
+static void olsr_netlink_route_read(int sock, void *, unsigned int);
+
+/* fill the request for the current stage of a pending route */
+static void
+olsr_netlink_stage_req(struct olsr_rtreq *req, const struct olsr_nl_pending *p)
+{
+  struct olsr_nl_route route = p->route;
+
+  switch (p->stage) {
+    case NL_STAGE_DEL_SIMILAR:
+      /* wildcard deletion of all routes to the destination */
+      route.set = false;
+      route.del_similar = true;
+      route.if_index = 0;
+      route.metric = 0;
+      route.protocol = -1;
+      route.has_src = false;
+      route.has_gw = false;
+      break;
+    case NL_STAGE_HOSTROUTE:
+      /* hostroute to the gateway of the route */
+      route.rttable = olsr_cnf->rt_table;
+      route.set = true;
+      route.dst.prefix = p->route.gw;
+      route.dst.prefix_len = olsr_cnf->ipsize * 8;
+      route.has_gw = false;
+      break;
+    default:
+      break;
+  }
+  olsr_netlink_route_req(req, &route);
+}
+
+/*
+ * Report a route which could not be written to the kernel. If the
+ * route is still in the RIB with the same nexthop, the nexthop is
+ * invalidated and the route is scheduled to be written again.
+ */
+static void
+olsr_netlink_route_failed(const struct olsr_nl_pending *p, int err)
+{
+  struct avl_node *node;
+  struct rt_entry *rt;
+
+  olsr_netlink_route_error(&p->route, err);
+
+  if (!p->route.set) {
+    return;
+  }
+
+  node = avl_find(&routingtree, &p->route.dst);
+  if (node == NULL) {
+    return;
+  }
+  rt = rt_tree2rt(node);
+  if (rt->rt_nexthop.iif_index == p->route.if_index
+      && ipequal(&rt->rt_nexthop.gateway, p->route.has_gw ? &p->route.gw : &p->route.dst.prefix)) {
+    rt->rt_nexthop.iif_index = -1;
+    olsr_retry_kernel_routes();
+  }
+}
+
+/**
+ * Write all queued route requests to the kernel with a single sendmsg().
+ */
+void
+olsr_netlink_route_flush(void)
+{
+  struct sockaddr_nl nladdr;
+  struct iovec iov;
+  struct msghdr msg;
+
+  if (nl_batch_len == 0) {
+    return;
+  }
+
+  memset(&nladdr, 0, sizeof(nladdr));
+  memset(&msg, 0, sizeof(msg));
+
+  nladdr.nl_family = AF_NETLINK;
+
+  msg.msg_name = &nladdr;
+  msg.msg_namelen = sizeof(nladdr);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  iov.iov_base = nl_batch;
+  iov.iov_len = nl_batch_len;
+
+  if (sendmsg(nl_route_sock, &msg, 0) < 0) {
+    int err = errno;
+
+    olsr_syslog(OLSR_LOG_ERR, "Cannot send %u route(s) to netlink socket (%d: %s)",
+        nl_pending_unsent, err, strerror(err));
+
+    /* drop the requests of the batch from the tail of the ring */
+    while (nl_pending_unsent > 0) {
+      nl_pending_unsent--;
+      nl_pending_count--;
+      olsr_netlink_route_failed(&nl_pending[(nl_pending_head + nl_pending_count) % NL_ROUTE_PENDING_MAX], err);
+    }
+  }
+
+  nl_pending_unsent = 0;
+  nl_batch_len = 0;
+}
+
+/* append the request for a pending route to the batch buffer */
+static int
+olsr_netlink_queue_route(const struct olsr_nl_pending *p)
+{
+  struct olsr_rtreq req;
+  struct olsr_nl_pending *entry;
+
+  if (nl_route_sock < 0) {
+    errno = EBADF;
+    return -1;
+  }
+
+  olsr_netlink_stage_req(&req, p);
+
+  if (nl_batch_len + NLMSG_ALIGN(req.n.nlmsg_len) > sizeof(nl_batch)) {
+    olsr_netlink_route_flush();
+  }
+  if (nl_pending_count == NL_ROUTE_PENDING_MAX && !nl_route_reading) {
+    /* the kernel answers synchronously, so collecting the answers opens the window again */
+    olsr_netlink_route_flush();
+    olsr_netlink_route_read(nl_route_sock, NULL, 0);
+  }
+  if (nl_pending_count == NL_ROUTE_PENDING_MAX) {
+    olsr_syslog(OLSR_LOG_ERR, "Too many netlink route requests in flight");
+    errno = ENOBUFS;
+    return -1;
+  }
+
+  req.n.nlmsg_seq = ++nl_route_seq;
+
+  entry = &nl_pending[(nl_pending_head + nl_pending_count) % NL_ROUTE_PENDING_MAX];
+  *entry = *p;
+  entry->seq = req.n.nlmsg_seq;
+  nl_pending_count++;
+  nl_pending_unsent++;
+
+  memcpy((char *)nl_batch + nl_batch_len, &req, req.n.nlmsg_len);
+  nl_batch_len += NLMSG_ALIGN(req.n.nlmsg_len);
+  return 0;
+}
+
+/* handle the kernel answer to a pending route request */
+static void
+olsr_netlink_route_result(struct olsr_nl_pending *p, int err)
+{
+  if (err == ENOBUFS || err == ENOMEM || err == EBUSY) {
+    if (p->retries < NL_ROUTE_MAX_RETRIES) {
+      /* transient error, try again with the next batch */
+      p->retries++;
+      if (olsr_netlink_queue_route(p)) {
+        olsr_netlink_route_failed(p, err);
+      }
+      return;
+    }
+  }
+
+  switch (p->stage) {
+    case NL_STAGE_ROUTE:
+      if (err == 0) {
+        return;
+      }
+
+      /* resolve "File exist" (17) propblems (on orig and autogen routes)*/
+      if (p->route.set && err == 17) {
+        /* a similar route going over another gateway may be present, which has to be deleted! */
+        olsr_syslog(OLSR_LOG_ERR, ". auto-deleting similar routes to resolve 'File exists' (17) while adding route!");
+        p->stage = NL_STAGE_DEL_SIMILAR;
+        break;
+      }
+
+      /* report success on "No such process" (3) */
+      if (!p->route.set && err == 3) {
+        /* another similar (but slightly different) route may be present at this point,
+         * if so this will get solved when adding new route to this destination */
+        olsr_syslog(OLSR_LOG_ERR, ". ignoring 'No such process' (3) while deleting route!");
+        return;
+      }
+
+      /* insert route to gateway on the fly if "Network unreachable" (128) on 2.4 kernels
+       * or on 2.6 kernel No such process (3) or Network unreachable (101) is reported in rtnetlink response
+       * do this only with flat metric, as using metric values inherited from
+       * a target behind the gateway is really strange, and could lead to multiple routes!
+       * anyways if invalid gateway ips may happen we are f*cked up!!
+       * but if not, these on the fly generated routes are no problem, and will only get used when needed */
+      if (!p->host_route && olsr_cnf->fib_metric == FIBM_FLAT
+          && (err == 128 || err == 101 || err == 3)) {
+        if (err == 128)  {
+          olsr_syslog(OLSR_LOG_ERR, ". autogenerating route to handle 'Network unreachable' (128) while adding route!");
+        }
+        else if (err == 101) {
+          olsr_syslog(OLSR_LOG_ERR, ". autogenerating route to handle 'Network unreachable' (101) while adding route!");
+        }
+        else {
+          olsr_syslog(OLSR_LOG_ERR, ". autogenerating route to handle 'No such process' (3) while adding route!");
+        }
+        p->stage = NL_STAGE_HOSTROUTE;
+        break;
+      }
+
+      olsr_netlink_route_failed(p, err);
+      return;
+
+    case NL_STAGE_DEL_SIMILAR:
+    case NL_STAGE_HOSTROUTE:
+      if (err == 0) {
+        /* create this route a second time if the repair was successful */
+        p->stage = NL_STAGE_FINAL;
+        break;
+      }
+      olsr_syslog(OLSR_LOG_ERR, ". failed (%d)", err);
+      olsr_netlink_route_failed(p, err);
+      return;
+
+    default:
+      olsr_syslog(OLSR_LOG_ERR, ". %s (%d)", err == 0 ? "successful" : "failed", err);
+      if (err) {
+        olsr_netlink_route_failed(p, err);
+      }
+      return;
+  }
+
+  /* queue the next stage */
+  p->retries = 0;
+  if (olsr_netlink_queue_route(p)) {
+    olsr_netlink_route_failed(p, errno);
+  }
+}
+
+/*
+ * Handle a request whose answer was lost. The kernel may or may not have
+ * applied it: an added route is invalidated in the RIB so the next update
+ * writes it again, a deletion (which has no RIB entry left) is sent again.
+ */
+static void
+olsr_netlink_route_lost(struct olsr_nl_pending *p)
+{
+  if (!p->route.set && p->stage == NL_STAGE_ROUTE && p->retries < NL_ROUTE_MAX_RETRIES) {
+    p->retries++;
+    if (olsr_netlink_queue_route(p) == 0) {
+      return;
+    }
+  }
+  olsr_netlink_route_failed(p, ENOBUFS);
+}
+
+/* match an acknowledgement to the oldest requests in flight */
+static void
+olsr_netlink_route_ack(uint32_t seq, int err)
+{
+  struct olsr_nl_pending p;
+
+  while (nl_pending_count > nl_pending_unsent) {
+    if ((int32_t)(seq - nl_pending[nl_pending_head].seq) < 0) {
+      /* answer to a request which has already been given up */
+      return;
+    }
+
+    /* remove the entry before handling it, the result might queue a new request */
+    p = nl_pending[nl_pending_head];
+    nl_pending_head = (nl_pending_head + 1) % NL_ROUTE_PENDING_MAX;
+    nl_pending_count--;
+
+    if (p.seq == seq) {
+      olsr_netlink_route_result(&p, err);
+      return;
+    }
+    OLSR_PRINTF(1, "Netlink route request %u was not acknowledged\n", p.seq);
+  }
+}
+
+static void
+olsr_netlink_route_read(int sock, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused)))
+{
+  uint32_t buffer[NL_ROUTE_BATCH_SIZE / sizeof(uint32_t)];
+  struct nlmsghdr *h;
+  struct nlmsgerr *l_err;
+  int len;
+
+  nl_route_reading = true;
+  while ((len = recv(sock, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+    for (h = (struct nlmsghdr *)ARM_NOWARN_ALIGN(buffer);
+         len >= (int)sizeof(struct nlmsghdr) && NLMSG_OK(h, (unsigned int)len);
+         h = MY_NLMSG_NEXT(h, len)) {
+      if (h->nlmsg_type != NLMSG_ERROR || h->nlmsg_len < NLMSG_LENGTH(sizeof(struct nlmsgerr))) {
+        OLSR_PRINTF(1, "Received unexpected netlink message type %u on route socket\n", h->nlmsg_type);
+        continue;
+      }
+
+      l_err = (struct nlmsgerr *)NLMSG_DATA(h);
+      olsr_netlink_route_ack(h->nlmsg_seq, -l_err->error);
+    }
+  }
+
+  if (len < 0 && errno == ENOBUFS) {
+    /* receive buffer overrun, the answers to the requests in flight are lost */
+    unsigned int lost = nl_pending_count - nl_pending_unsent;
+
+    olsr_syslog(OLSR_LOG_ERR, "Netlink route socket overrun, lost answers to %u route(s)", lost);
+    while (lost-- > 0) {
+      /* remove the entry before handling it, it might be queued again */
+      struct olsr_nl_pending p = nl_pending[nl_pending_head];
+
+      nl_pending_head = (nl_pending_head + 1) % NL_ROUTE_PENDING_MAX;
+      nl_pending_count--;
+      olsr_netlink_route_lost(&p);
+    }
+  }
+  else if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    OLSR_PRINTF(1, "netlink route socket error %u - %s\n", errno, strerror(errno));
+  }
+  nl_route_reading = false;
+
+  /* send the requests queued by error handling */
+  olsr_netlink_route_flush();
+}
+
+/**
+ * Create the rtnetlink socket of the asynchronous route writer
+ *
+ * @return 0 on success, -1 on error
+ */
+int
+olsr_netlink_route_init(void)
+{
+  struct sockaddr_nl addr;
+
+  nl_route_sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (nl_route_sock < 0) {
+    OLSR_PRINTF(1, "could not create rtnetlink route socket! %s (%d)\n", strerror(errno), errno);
+    return -1;
+  }
+
+  if (fcntl(nl_route_sock, F_SETFL, O_NONBLOCK)) {
+    olsr_syslog(OLSR_LOG_INFO, "rtnetlink route socket could not be set to nonblocking");
+  }
+
+#if defined SOL_NETLINK && defined NETLINK_CAP_ACK
+  {
+    /* do not copy the failed request into error answers */
+    int one = 1;
+    if (setsockopt(nl_route_sock, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one))) {
+      OLSR_PRINTF(1, "could not set NETLINK_CAP_ACK on rtnetlink route socket: %s\n", strerror(errno));
+    }
+  }
+#endif /* defined SOL_NETLINK && defined NETLINK_CAP_ACK */
+
+  memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+
+  if (bind(nl_route_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    OLSR_PRINTF(1, "could not bind rtnetlink route socket! %s (%d)\n", strerror(errno), errno);
+    close(nl_route_sock);
+    nl_route_sock = -1;
+    return -1;
+  }
+
+  add_olsr_socket(nl_route_sock, NULL, &olsr_netlink_route_read, NULL, SP_IMM_READ);
+  return 0;
+}
+
+/**
+ * Write the remaining route requests, collect their answers
+ * and close the socket of the asynchronous route writer
+ */
+void
+olsr_netlink_route_close(void)
+{
+  int i;
+
+  olsr_netlink_route_sync_abort();
+
+  if (nl_route_sock < 0) {
+    return;
+  }
+
+  /* the kernel processes requests synchronously, so the answers (and the repair
+   * steps they trigger) are available right after sending */
+  for (i = 0; i < 2 * NL_ROUTE_MAX_RETRIES + 2 && nl_pending_count > 0; i++) {
+    olsr_netlink_route_flush();
+    olsr_netlink_route_read(nl_route_sock, NULL, 0);
+  }
+
+  remove_olsr_socket(nl_route_sock, NULL, &olsr_netlink_route_read);
+  close(nl_route_sock);
+  nl_route_sock = -1;
+}
+
+/* calculate the kernel route of a RIB entry */
+static void
+olsr_netlink_rt_route(struct olsr_nl_pending *p, unsigned char af_family, const struct rt_entry *rt, bool set)
+{
   const struct rt_nexthop *nexthop;
-  union olsr_ip_addr *src;
-  bool hostRoute;
-  int err;
+
+  memset(p, 0, sizeof(*p));
+  p->stage = NL_STAGE_ROUTE;
+  p->route.family = af_family;
+  p->route.flags = RTNH_F_ONLINK;
+  p->route.scope = RT_SCOPE_UNIVERSE;
+  p->route.protocol = olsr_cnf->rt_proto;
+  p->route.set = set;
+  p->route.dst = rt->rt_dst;
 
   /* calculate metric */
   if (FIBM_FLAT == olsr_cnf->fib_metric) {
-    metric = olsr_cnf->fib_metric_default;
+    p->route.metric = olsr_cnf->fib_metric_default;
   }
   else {
-    metric = set ? rt->rt_best->rtp_metric.hops : rt->rt_metric.hops;
+    p->route.metric = set ? rt->rt_best->rtp_metric.hops : rt->rt_metric.hops;
   }
 
   if (olsr_cnf->smart_gw_active && is_prefix_inetgw(&rt->rt_dst)) {
     /* make space for the tunnel gateway route */
-    metric += 2;
+    p->route.metric += 2;
   }
 
   /* get table */
-  table = is_prefix_inetgw(&rt->rt_dst)
+  p->route.rttable = is_prefix_inetgw(&rt->rt_dst)
       ? olsr_cnf->rt_table_default : olsr_cnf->rt_table;
 
   /* get next hop */
@@ -531,81 +1070,367 @@ static int olsr_os_process_rt_entry(unsigned char af_family, const struct rt_ent
   else {
     nexthop = &rt->rt_nexthop;
   }
+  p->route.if_index = nexthop->iif_index;
 
   /* detect 1-hop hostroute */
-  hostRoute = rt->rt_dst.prefix_len == olsr_cnf->ipsize * 8
+  p->host_route = rt->rt_dst.prefix_len == olsr_cnf->ipsize * 8
       && ipequal(&nexthop->gateway, &rt->rt_dst.prefix);
+  if (!p->host_route) {
+    p->route.has_gw = true;
+    p->route.gw = nexthop->gateway;
+  }
 
   /* get src ip */
   if (olsr_cnf->use_src_ip_routes) {
-    src = &olsr_cnf->unicast_src_ip;
+    p->route.has_src = true;
+    p->route.src = olsr_cnf->unicast_src_ip;
   }
-  else {
-    src = NULL;
+}
+
+static int olsr_os_process_rt_entry(unsigned char af_family, const struct rt_entry *rt, bool set) {
+  struct olsr_nl_pending p;
+
+  olsr_netlink_rt_route(&p, af_family, rt, set);
+
+  /* queue route, the answer of the kernel is handled by olsr_netlink_route_result() */
+  return olsr_netlink_queue_route(&p);
+}
+
+/* compare a route of the kernel dump with the route calculated from the RIB */
+static bool
+olsr_netlink_same_route(const struct olsr_nl_route *kr, const struct olsr_nl_route *route)
+{
+  const union olsr_ip_addr *gw = NULL;
+  int metric = route->metric;
+
+  if (route->has_gw) {
+    gw = &route->gw;
+  }
+  else if (route->dst.prefix_len == 32) {
+    /* olsr_netlink_route_req() uses the destination as gateway */
+    gw = &route->dst.prefix;
+  }
+
+  if (metric == 0 && route->family == AF_INET6) {
+    /* kernel default for IPv6 routes without metric */
+    metric = 1024;
+  }
+
+  if (kr->rttable != route->rttable || kr->if_index != route->if_index || kr->metric != metric) {
+    return false;
+  }
+  if (gw == NULL) {
+    return !kr->has_gw;
+  }
+  return kr->has_gw && memcmp(&kr->gw, gw, olsr_cnf->ipsize) == 0;
+}
+
+/* parse a route of the kernel dump, returns false if it is not an olsrd route */
+static bool
+olsr_netlink_parse_route(struct nlmsghdr *h, struct olsr_nl_route *kr)
+{
+  struct rtmsg *rtm = (struct rtmsg *)NLMSG_DATA(h);
+  struct rtattr *rta;
+  int len;
+
+  if (h->nlmsg_len < NLMSG_LENGTH(sizeof(*rtm)) || rtm->rtm_family != olsr_cnf->ip_version
+      || rtm->rtm_protocol != olsr_cnf->rt_proto || rtm->rtm_type != RTN_UNICAST) {
+    return false;
+  }
+
+  memset(kr, 0, sizeof(*kr));
+  kr->family = rtm->rtm_family;
+  kr->scope = rtm->rtm_scope;
+  kr->flags = RTNH_F_ONLINK;
+  kr->protocol = rtm->rtm_protocol;
+  kr->rttable = rtm->rtm_table;
+  kr->dst.prefix_len = rtm->rtm_dst_len;
+
+  len = RTM_PAYLOAD(h);
+  for (rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    switch (rta->rta_type) {
+      case RTA_TABLE:
+        kr->rttable = *(uint32_t *)RTA_DATA(rta);
+        break;
+      case RTA_DST:
+        memcpy(&kr->dst.prefix, RTA_DATA(rta), olsr_cnf->ipsize);
+        break;
+      case RTA_GATEWAY:
+        kr->has_gw = true;
+        memcpy(&kr->gw, RTA_DATA(rta), olsr_cnf->ipsize);
+        break;
+      case RTA_OIF:
+        kr->if_index = *(int *)RTA_DATA(rta);
+        break;
+      case RTA_PRIORITY:
+        kr->metric = *(int *)RTA_DATA(rta);
+        break;
+      default:
+        break;
+    }
   }
 
-  /* create route */
-  err = olsr_new_netlink_route(af_family, table, RTNH_F_ONLINK, RT_SCOPE_UNIVERSE, nexthop->iif_index, metric, olsr_cnf->rt_proto,
-      src, hostRoute ? NULL : &nexthop->gateway, &rt->rt_dst, set, false, false);
+  /* only routes olsrd writes from the RIB, not gateway tunnel or NIIT routes */
+  return (kr->rttable == olsr_cnf->rt_table || kr->rttable == olsr_cnf->rt_table_default)
+      && if_ifwithindex(kr->if_index) != NULL;
+}
 
-  /* resolve "File exist" (17) propblems (on orig and autogen routes)*/
-  if (set && err == 17) {
-    /* a similar route going over another gateway may be present, which has to be deleted! */
-    olsr_syslog(OLSR_LOG_ERR, ". auto-deleting similar routes to resolve 'File exists' (17) while adding route!");
+/* diff a route of the kernel dump against the routing tree */
+static void
+olsr_netlink_sync_route(const struct olsr_nl_route *kr, bool purge)
+{
+  struct olsr_nl_pending p;
+  struct avl_node *node;
+  struct rt_entry *rt = NULL;
 
-    /* erase similar rule */
-    err = olsr_new_netlink_route(af_family, table, RTNH_F_ONLINK, RT_SCOPE_UNIVERSE, 0, 0, -1, NULL, NULL, &rt->rt_dst, false, true, false);
+  node = avl_find(&routingtree, &kr->dst);
+  if (node) {
+    rt = rt_tree2rt(node);
+  }
 
-    if (!err) {
-      /* create this rule a second time if delete worked*/
-      err = olsr_new_netlink_route(af_family, table, RTNH_F_ONLINK, RT_SCOPE_UNIVERSE, nexthop->iif_index, metric, olsr_cnf->rt_proto,
-          src, hostRoute ? NULL : &nexthop->gateway, &rt->rt_dst, set, false, false);
+  if (rt && rt->rt_best) {
+    olsr_netlink_rt_route(&p, olsr_cnf->ip_version, rt, true);
+    if (olsr_netlink_same_route(kr, &p.route)) {
+      /* route is already in the kernel, adopt it */
+      rt->rt_nexthop = rt->rt_best->rtp_nexthop;
+      rt->rt_metric = rt->rt_best->rtp_metric;
+      olsr_netlink_route_confirm(rt);
+      return;
     }
-    olsr_syslog(OLSR_LOG_ERR, ". %s (%d)", err == 0 ? "successful" : "failed", err);
-  }
-
-  /* report success on "No such process" (3) */
-  else if (!set && err == 3) {
-    /* another similar (but slightly different) route may be present at this point,
-     * if so this will get solved when adding new route to this destination */
-    olsr_syslog(OLSR_LOG_ERR, ". ignoring 'No such process' (3) while deleting route!");
-    err = 0;
-  }
-  /* insert route to gateway on the fly if "Network unreachable" (128) on 2.4 kernels
-   * or on 2.6 kernel No such process (3) or Network unreachable (101) is reported in rtnetlink response
-   * do this only with flat metric, as using metric values inherited from
-   * a target behind the gateway is really strange, and could lead to multiple routes!
-   * anyways if invalid gateway ips may happen we are f*cked up!!
-   * but if not, these on the fly generated routes are no problem, and will only get used when needed */
-  else if (!hostRoute && olsr_cnf->fib_metric == FIBM_FLAT
-      && (err == 128 || err == 101 || err == 3)) {
-    struct olsr_ip_prefix hostPrefix;
-
-    if (err == 128)  {
-      olsr_syslog(OLSR_LOG_ERR, ". autogenerating route to handle 'Network unreachable' (128) while adding route!");
+  }
+  else if (!purge) {
+    /* unknown destination, the RIB might not be complete yet */
+    return;
+  }
+
+  OLSR_PRINTF(2, "KERN: Removing stale route to %s\n", olsr_ip_prefix_to_string(&kr->dst));
+
+  memset(&p, 0, sizeof(p));
+  p.stage = NL_STAGE_ROUTE;
+  p.route = *kr;
+  p.route.set = false;
+  if (olsr_netlink_queue_route(&p)) {
+    olsr_netlink_route_error(&p.route, errno);
+  }
+}
+
+/*
+ * Reconciliation of the kernel FIB with the routing tree.
+ *
+ * The RTM_GETROUTE dump runs on a socket of its own, read by a handler in
+ * the scheduler like the answers of the route writer. The kernel fills in
+ * the next part of a dump while the previous one is read, so the handler
+ * reads only a few buffers per call and a large FIB does not hold up the
+ * processing of OLSR messages.
+ *
+ * RIB entries are only touched when the dump is complete: every entry the
+ * dump (or a route write while it ran) did not confirm is then invalidated.
+ * A failed or aborted dump leaves the RIB as it was.
+ */
+#define NL_SYNC_READ_BUDGET   8
+#define NL_SYNC_TIMEOUT       (30 * MSEC_PER_SEC)
+
+static int nl_sync_sock = -1;
+static uint32_t nl_sync_seq;
+static uint32_t nl_sync_round;
+static bool nl_sync_purge;
+static void (*nl_sync_done)(bool);
+static struct timer_entry *nl_sync_timer;
+
+static void olsr_netlink_sync_read(int sock, void *, unsigned int);
+
+/* close the dump socket, a running dump is discarded */
+static void
+olsr_netlink_sync_stop(void)
+{
+  if (nl_sync_sock < 0) {
+    return;
+  }
+
+  remove_olsr_socket(nl_sync_sock, NULL, &olsr_netlink_sync_read);
+  close(nl_sync_sock);
+  nl_sync_sock = -1;
+
+  if (nl_sync_timer) {
+    olsr_stop_timer(nl_sync_timer);
+    nl_sync_timer = NULL;
+  }
+}
+
+/* end the dump and report the result */
+static void
+olsr_netlink_sync_finish(bool success)
+{
+  void (*done)(bool) = nl_sync_done;
+  struct rt_entry *rt;
+
+  olsr_netlink_sync_stop();
+  nl_sync_done = NULL;
+
+  if (success) {
+    /* everything the dump did not confirm has to be written again */
+    OLSR_FOR_ALL_RT_ENTRIES(rt) {
+      if (rt->rt_fib_sync != nl_sync_round) {
+        rt->rt_nexthop.iif_index = -1;
+      }
+    } OLSR_FOR_ALL_RT_ENTRIES_END(rt)
+  }
+
+  /* send the deletions of stale routes */
+  olsr_netlink_route_flush();
+
+  if (done) {
+    done(success);
+  }
+}
+
+static void
+olsr_netlink_sync_timeout(void *context __attribute__ ((unused)))
+{
+  nl_sync_timer = NULL;
+  olsr_syslog(OLSR_LOG_ERR, "Timeout while reading netlink route dump");
+  olsr_netlink_sync_finish(false);
+}
+
+static void
+olsr_netlink_sync_read(int sock, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused)))
+{
+  uint32_t buffer[NL_ROUTE_BATCH_SIZE / sizeof(uint32_t)];
+  struct olsr_nl_route kr;
+  struct nlmsghdr *h;
+  int budget, len;
+
+  for (budget = NL_SYNC_READ_BUDGET; budget > 0; budget--) {
+    len = recv(sock, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (len < 0 && errno == EAGAIN) {
+      break;
     }
-    else if (err == 101) {
-      olsr_syslog(OLSR_LOG_ERR, ". autogenerating route to handle 'Network unreachable' (101) while adding route!");
+    if (len <= 0) {
+      olsr_syslog(OLSR_LOG_ERR, "Error while reading netlink route dump (%d: %s)", errno, strerror(errno));
+      olsr_netlink_sync_finish(false);
+      return;
     }
-    else {
-      olsr_syslog(OLSR_LOG_ERR, ". autogenerating route to handle 'No such process' (3) while adding route!");
+
+    for (h = (struct nlmsghdr *)ARM_NOWARN_ALIGN(buffer);
+         len >= (int)sizeof(struct nlmsghdr) && NLMSG_OK(h, (unsigned int)len);
+         h = MY_NLMSG_NEXT(h, len)) {
+      if (h->nlmsg_seq != nl_sync_seq) {
+        continue;
+      }
+      if (h->nlmsg_type == NLMSG_DONE) {
+        olsr_netlink_sync_finish(true);
+        return;
+      }
+      if (h->nlmsg_type == NLMSG_ERROR) {
+        olsr_syslog(OLSR_LOG_ERR, "Netlink route dump failed");
+        olsr_netlink_sync_finish(false);
+        return;
+      }
+      if (h->nlmsg_type == RTM_NEWROUTE && olsr_netlink_parse_route(h, &kr)) {
+        olsr_netlink_sync_route(&kr, nl_sync_purge);
+      }
     }
+  }
 
-    /* create hostroute */
-    hostPrefix.prefix = nexthop->gateway;
-    hostPrefix.prefix_len = olsr_cnf->ipsize * 8;
+  /* send the deletions of stale routes found so far */
+  olsr_netlink_route_flush();
+}
 
-    err = olsr_new_netlink_route(af_family, olsr_cnf->rt_table, RTNH_F_ONLINK, RT_SCOPE_UNIVERSE, nexthop->iif_index,
-        metric, olsr_cnf->rt_proto, src, NULL, &hostPrefix, true, false, false);
-    if (err == 0) {
-      /* create this rule a second time if hostrule generation was successful */
-      err = olsr_new_netlink_route(af_family, table, RTNH_F_ONLINK, RT_SCOPE_UNIVERSE, nexthop->iif_index, metric, olsr_cnf->rt_proto,
-          src, &nexthop->gateway, &rt->rt_dst, set, false, false);
-    }
-    olsr_syslog(OLSR_LOG_ERR, ". %s (%d)", err == 0 ? "successful" : "failed", err);
+/**
+ * Start the reconciliation of the kernel FIB with the routing tree.
+ *
+ * Dumps the routes olsrd owns (rt_proto in rt_table or rt_table_default
+ * over an OLSR interface). Kernel routes matching the RIB are adopted.
+ * Kernel routes to known destinations which do not match the RIB are
+ * deleted, with purge set also the routes to unknown destinations. When
+ * the dump is complete, all other RIB entries get an invalid nexthop so
+ * the next change run writes them, then done is called.
+ *
+ * A dump that is already running is not restarted, done is then not
+ * called for this request.
+ *
+ * @param purge delete kernel routes to destinations unknown to the RIB
+ * @param done called with the result when the dump has ended
+ * @return 0 if the dump runs, -1 if it could not be started
+ */
+int
+olsr_netlink_route_sync(bool purge, void (*done)(bool))
+{
+  struct {
+    struct nlmsghdr n;
+    struct rtmsg r;
+  } req;
+  struct sockaddr_nl addr;
+
+  if (nl_sync_sock >= 0) {
+    /* the running dump reconciles the FIB as well */
+    nl_sync_purge |= purge;
+    return 0;
   }
 
-  return err;
+  nl_sync_sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (nl_sync_sock < 0) {
+    olsr_syslog(OLSR_LOG_ERR, "Cannot create netlink route dump socket (%d: %s)", errno, strerror(errno));
+    return -1;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.nl_family = AF_NETLINK;
+
+  memset(&req, 0, sizeof(req));
+  req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+  req.n.nlmsg_type = RTM_GETROUTE;
+  req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.n.nlmsg_seq = nl_sync_seq = ++nl_route_seq;
+  req.r.rtm_family = olsr_cnf->ip_version;
+
+  if (bind(nl_sync_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0
+      || send(nl_sync_sock, &req, req.n.nlmsg_len, 0) < 0) {
+    olsr_syslog(OLSR_LOG_ERR, "Cannot request netlink route dump (%d: %s)", errno, strerror(errno));
+    close(nl_sync_sock);
+    nl_sync_sock = -1;
+    return -1;
+  }
+
+  nl_sync_round++;
+  nl_sync_purge = purge;
+  nl_sync_done = done;
+
+  add_olsr_socket(nl_sync_sock, NULL, &olsr_netlink_sync_read, NULL, SP_IMM_READ);
+  nl_sync_timer = olsr_start_timer(NL_SYNC_TIMEOUT, 0, OLSR_TIMER_ONESHOT, &olsr_netlink_sync_timeout, NULL, 0);
+  return 0;
+}
+
+/**
+ * @return true while a reconciliation of the kernel FIB is running
+ */
+bool
+olsr_netlink_route_syncing(void)
+{
+  return nl_sync_sock >= 0;
+}
+
+/**
+ * Stop a running reconciliation without touching the RIB and without
+ * calling its done function.
+ */
+void
+olsr_netlink_route_sync_abort(void)
+{
+  olsr_netlink_sync_stop();
+  nl_sync_done = NULL;
+}
+
+/**
+ * Mark a route entry as matching the kernel FIB, because its route has
+ * just been written. A running reconciliation then keeps it valid.
+ *
+ * @param rt the route entry
+ */
+void
+olsr_netlink_route_confirm(struct rt_entry *rt)
+{
+  rt->rt_fib_sync = nl_sync_round;
 }
 
 /**
@@ -49,6 +49,7 @@
 
 #ifdef __linux__
 #define __BSD_SOURCE 1
+#define _GNU_SOURCE 1
 
 #include "net_os.h"
 #include "ipcalc.h"
@@ -60,6 +61,7 @@
 #include <net/if.h>
 
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <sys/utsname.h>
 
 #include <fcntl.h>
@@ -681,6 +683,87 @@ olsr_recvfrom(int s, void *buf, size_t len, int flags, struct sockaddr * from, s
   return recvfrom(s, buf, len, flags, from, fromlen);
 }
 
+#ifdef OLSR_HAVE_RECVMMSG
+/**
+ * Wrapper for recvmmsg(2), never blocks
+ *
+ *@param s the socket to read from
+ *@param bufs array of count receive buffers
+ *@param buflen size of each receive buffer
+ *@param from array of count sender addresses (output)
+ *@param fromlen array of count sender address lengths (output)
+ *@param len array of count datagram lengths (output)
+ *@param count number of datagrams to read, at most OLSR_RECVMMSG_MAX
+ *
+ *@return number of datagrams read, -1 on error
+ */
+int
+olsr_recvmmsg(int s, char **bufs, size_t buflen, struct sockaddr_storage *from, socklen_t *fromlen, int *len, unsigned int count)
+{
+  struct mmsghdr msgs[OLSR_RECVMMSG_MAX];
+  struct iovec iov[OLSR_RECVMMSG_MAX];
+  unsigned int i;
+  int n;
+
+  if (count > OLSR_RECVMMSG_MAX) {
+    count = OLSR_RECVMMSG_MAX;
+  }
+
+  memset(msgs, 0, sizeof(msgs[0]) * count);
+  for (i = 0; i < count; i++) {
+    iov[i].iov_base = bufs[i];
+    iov[i].iov_len = buflen;
+    msgs[i].msg_hdr.msg_name = &from[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  n = recvmmsg(s, msgs, count, MSG_DONTWAIT, NULL);
+  for (i = 0; n > 0 && i < (unsigned int)n; i++) {
+    fromlen[i] = msgs[i].msg_hdr.msg_namelen;
+    len[i] = msgs[i].msg_len;
+  }
+  return n;
+}
+#endif /* OLSR_HAVE_RECVMMSG */
+
+#ifdef OLSR_HAVE_SENDMMSG
+/**
+ * Wrapper for sendmmsg(2)
+ *
+ *@param s the socket to send on
+ *@param iov array of count datagrams, each an array of iovecs
+ *@param iovlen array of count iovec array lengths
+ *@param to array of count destination addresses
+ *@param tolen array of count destination address lengths
+ *@param count number of datagrams, at most OLSR_SENDMMSG_MAX
+ *@param flags flags for sendmmsg(2)
+ *
+ *@return number of datagrams sent, -1 if the first one failed
+ */
+int
+olsr_sendmmsg(int s, struct iovec **iov, const int *iovlen, struct sockaddr **to, const socklen_t *tolen, unsigned int count, int flags)
+{
+  struct mmsghdr msgs[OLSR_SENDMMSG_MAX];
+  unsigned int i;
+
+  if (count > OLSR_SENDMMSG_MAX) {
+    count = OLSR_SENDMMSG_MAX;
+  }
+
+  memset(msgs, 0, sizeof(msgs[0]) * count);
+  for (i = 0; i < count; i++) {
+    msgs[i].msg_hdr.msg_name = to[i];
+    msgs[i].msg_hdr.msg_namelen = tolen[i];
+    msgs[i].msg_hdr.msg_iov = iov[i];
+    msgs[i].msg_hdr.msg_iovlen = iovlen[i];
+  }
+
+  return sendmmsg(s, msgs, count, flags);
+}
+#endif /* OLSR_HAVE_SENDMMSG */
+
 /**
  * Wrapper for select(2)
  */
@@ -44,6 +44,7 @@
  */
 
 #include "defs.h"
+#include "olsr.h"
 #include "neighbor_table.h"
 #include "two_hop_neighbor_table.h"
 #include "link_set.h"
@@ -51,125 +52,252 @@
 #include "scheduler.h"
 #include "lq_plugin.h"
 
+/* 2-hop neighbors whose MPR selection has to be re-evaluated */
+static struct list_node lq_mpr_dirty = { &lq_mpr_dirty, &lq_mpr_dirty };
+
+LISTNODE2STRUCT(dirty2nbr2, struct neighbor_2_entry, mpr_dirty);
+
+/**
+ * Queue a 2-hop neighbor for re-evaluation by the next MPR calculation,
+ * this must be called whenever a path to it appears or its cost changes.
+ * Everything else that affects the MPR set still sets changes_neighborhood
+ * and triggers a complete recalculation.
+ *
+ * @param neigh2 the 2-hop neighbor
+ */
 void
-olsr_calculate_lq_mpr(void)
+olsr_lq_mpr_touch(struct neighbor_2_entry *neigh2)
+{
+  if (olsr_cnf->lq_level == 0) {
+    /* the RFC algorithm is not incremental */
+    changes_neighborhood = true;
+    return;
+  }
+
+  if (!list_node_on_list(&neigh2->mpr_dirty)) {
+    list_add_before(&lq_mpr_dirty, &neigh2->mpr_dirty);
+  }
+  changes_two_hop = true;
+}
+
+/**
+ * Queue the 2-hop neighbor entry of a neighbor, if there is one,
+ * because the cost of the direct link to it has changed.
+ *
+ * @param neigh the neighbor, may be NULL
+ */
+void
+olsr_lq_mpr_touch_neighbor(struct neighbor_entry *neigh)
 {
   struct neighbor_2_entry *neigh2;
+
+  if (neigh == NULL || olsr_cnf->lq_level == 0) {
+    return;
+  }
+
+  neigh2 = olsr_lookup_two_hop_neighbor_table(&neigh->neighbor_main_addr);
+  if (neigh2 != NULL) {
+    olsr_lq_mpr_touch(neigh2);
+  }
+}
+
+/**
+ * Remove a 2-hop neighbor from the re-evaluation queue,
+ * must be called before it is freed.
+ *
+ * @param neigh2 the 2-hop neighbor
+ */
+void
+olsr_lq_mpr_dequeue(struct neighbor_2_entry *neigh2)
+{
+  if (list_node_on_list(&neigh2->mpr_dirty)) {
+    list_remove(&neigh2->mpr_dirty);
+  }
+}
+
+/*
+ * update the MPR status of a neighbor after its selection count
+ * has changed, returns true if the status flipped
+ */
+static bool
+olsr_lq_mpr_update(struct neighbor_entry *neigh)
+{
+  bool is_mpr = neigh->mpr_select_count > 0 || (neigh->status == SYM && neigh->willingness == WILL_ALWAYS);
+
+  if (is_mpr == neigh->is_mpr) {
+    return false;
+  }
+  neigh->is_mpr = is_mpr;
+  return true;
+}
+
+/*
+ * select the MPRs for a single 2-hop neighbor and update the
+ * selection counts of the neighbors involved, returns true if
+ * the MPR status of a neighbor changed
+ */
+static bool
+olsr_lq_mpr_select(struct neighbor_2_entry *neigh2)
+{
   struct neighbor_list_entry *walker;
-  int i, k;
   struct neighbor_entry *neigh;
   olsr_linkcost best, best_1hop;
   bool mpr_changes = false;
+  int k;
 
-  OLSR_FOR_ALL_NBR_ENTRIES(neigh) {
+  /* mark all 1-hop neighbours as not selected */
 
-    /* Memorize previous MPR status. */
+  for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
+    walker->neighbor->skip = false;
 
-    neigh->was_mpr = neigh->is_mpr;
+  best_1hop = LINK_COST_BROKEN;
 
-    /* Clear current MPR status. */
+  /* check whether this 2-hop neighbour is also a neighbour */
 
-    neigh->is_mpr = false;
+  neigh = olsr_lookup_neighbor_table(&neigh2->neighbor_2_addr);
 
-    /* In this pass we are only interested in WILL_ALWAYS neighbours */
+  /* if it's a neighbour and also symmetric, then examine
+     the link quality */
 
-    if (neigh->status == NOT_SYM || neigh->willingness != WILL_ALWAYS) {
-      continue;
-    }
+  if (neigh != NULL && neigh->status == SYM) {
+    /* if the direct link is better than the best route via
+     * an MPR, then prefer the direct link and do not select
+     * an MPR for this 2-hop neighbour */
 
-    neigh->is_mpr = true;
+    /* determine the link quality of the direct link */
 
-    if (neigh->is_mpr != neigh->was_mpr) {
-      mpr_changes = true;
-    }
+    struct link_entry *lnk = get_best_link_to_neighbor(&neigh->neighbor_main_addr);
+
+    if (!lnk)
+      goto update;
+
+    best_1hop = lnk->linkcost;
+
+    /* see wether we find a better route via an MPR */
+
+    for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
+      if (walker->path_linkcost < best_1hop)
+        break;
+
+    /* we've reached the end of the list, so we haven't found
+     * a better route via an MPR - so, skip MPR selection for
+     * this 1-hop neighbor */
 
+    if (walker == &neigh2->neighbor_2_nblist)
+      goto update;
   }
-  OLSR_FOR_ALL_NBR_ENTRIES_END(neigh);
 
-  for (i = 0; i < HASHSIZE; i++) {
-    /* loop through all 2-hop neighbours */
+  /* find the connecting 1-hop neighbours with the
+   * best total link qualities */
 
-    for (neigh2 = two_hop_neighbortable[i].next; neigh2 != &two_hop_neighbortable[i]; neigh2 = neigh2->next) {
-      best_1hop = LINK_COST_BROKEN;
+  for (k = 0; k < olsr_cnf->mpr_coverage; k++) {
+    /* look for the best 1-hop neighbour that we haven't
+     * yet selected */
 
-      /* check whether this 2-hop neighbour is also a neighbour */
+    neigh = NULL;
+    best = LINK_COST_BROKEN;
 
-      neigh = olsr_lookup_neighbor_table(&neigh2->neighbor_2_addr);
+    for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
+      if (walker->neighbor->status == SYM && !walker->neighbor->skip && walker->path_linkcost < best) {
+        neigh = walker->neighbor;
+        best = walker->path_linkcost;
+      }
 
-      /* if it's a neighbour and also symmetric, then examine
-         the link quality */
+    /* Found a 1-hop neighbor that we haven't previously selected.
+     * Use it as MPR only when the 2-hop path through it is better than
+     * any existing 1-hop path. */
+    if ((neigh != NULL) && (best < best_1hop)) {
+      neigh->skip = true;
+    }
 
-      if (neigh != NULL && neigh->status == SYM) {
-        /* if the direct link is better than the best route via
-         * an MPR, then prefer the direct link and do not select
-         * an MPR for this 2-hop neighbour */
+    /* no neighbour found => the requested MPR coverage cannot
+     * be satisfied => stop */
 
-        /* determine the link quality of the direct link */
+    else
+      break;
+  }
 
-        struct link_entry *lnk = get_best_link_to_neighbor(&neigh->neighbor_main_addr);
+update:
+  /* apply the difference to the previous selection */
 
-        if (!lnk)
-          continue;
+  for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next) {
+    if (walker->neighbor->skip == walker->mpr_selected) {
+      continue;
+    }
+
+    walker->mpr_selected = walker->neighbor->skip;
+    walker->neighbor->mpr_select_count += walker->mpr_selected ? 1 : -1;
 
-        best_1hop = lnk->linkcost;
+    if (olsr_lq_mpr_update(walker->neighbor)) {
+      mpr_changes = true;
+    }
+  }
+  return mpr_changes;
+}
 
-        /* see wether we find a better route via an MPR */
+void
+olsr_calculate_lq_mpr(void)
+{
+  struct neighbor_2_entry *neigh2;
+  struct neighbor_list_entry *walker;
+  struct neighbor_entry *neigh;
+  bool mpr_changes = false;
 
-        for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
-          if (walker->path_linkcost < best_1hop)
-            break;
+  if (!changes_neighborhood) {
+    /* only paths to some 2-hop neighbours have changed */
 
-        /* we've reached the end of the list, so we haven't found
-         * a better route via an MPR - so, skip MPR selection for
-         * this 1-hop neighbor */
+    while (!list_is_empty(&lq_mpr_dirty)) {
+      neigh2 = dirty2nbr2(lq_mpr_dirty.next);
+      list_remove(&neigh2->mpr_dirty);
 
-        if (walker == &neigh2->neighbor_2_nblist)
-          continue;
+      if (olsr_lq_mpr_select(neigh2)) {
+        mpr_changes = true;
       }
+    }
+  } else {
+    OLSR_FOR_ALL_NBR_ENTRIES(neigh) {
 
-      /* find the connecting 1-hop neighbours with the
-       * best total link qualities */
-
-      /* mark all 1-hop neighbours as not selected */
+      /* Memorize previous MPR status. */
 
-      for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
-        walker->neighbor->skip = false;
+      neigh->was_mpr = neigh->is_mpr;
 
-      for (k = 0; k < olsr_cnf->mpr_coverage; k++) {
-        /* look for the best 1-hop neighbour that we haven't
-         * yet selected */
+      /* Only WILL_ALWAYS neighbours are MPRs without being selected */
 
-        neigh = NULL;
-        best = LINK_COST_BROKEN;
+      neigh->mpr_select_count = 0;
+      neigh->is_mpr = neigh->status == SYM && neigh->willingness == WILL_ALWAYS;
+    }
+    OLSR_FOR_ALL_NBR_ENTRIES_END(neigh);
 
-        for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
-          if (walker->neighbor->status == SYM && !walker->neighbor->skip && walker->path_linkcost < best) {
-            neigh = walker->neighbor;
-            best = walker->path_linkcost;
-          }
+    /* forget all previous selections, everything is re-evaluated */
 
-        /* Found a 1-hop neighbor that we haven't previously selected.
-         * Use it as MPR only when the 2-hop path through it is better than
-         * any existing 1-hop path. */
-        if ((neigh != NULL) && (best < best_1hop)) {
-          neigh->is_mpr = true;
-          neigh->skip = true;
+    OLSR_FOR_ALL_NBR2_ENTRIES(neigh2) {
+      list_node_init(&neigh2->mpr_dirty);
+      for (walker = neigh2->neighbor_2_nblist.next; walker != &neigh2->neighbor_2_nblist; walker = walker->next)
+        walker->mpr_selected = false;
+    }
+    OLSR_FOR_ALL_NBR2_ENTRIES_END(neigh2);
+    list_head_init(&lq_mpr_dirty);
 
-          if (neigh->is_mpr != neigh->was_mpr)
-            mpr_changes = true;
-        }
+    /* loop through all 2-hop neighbours */
 
-        /* no neighbour found => the requested MPR coverage cannot
-         * be satisfied => stop */
+    OLSR_FOR_ALL_NBR2_ENTRIES(neigh2) {
+      olsr_lq_mpr_select(neigh2);
+    }
+    OLSR_FOR_ALL_NBR2_ENTRIES_END(neigh2);
 
-        else
-          break;
+    OLSR_FOR_ALL_NBR_ENTRIES(neigh) {
+      if (neigh->is_mpr != neigh->was_mpr) {
+        mpr_changes = true;
       }
     }
+    OLSR_FOR_ALL_NBR_ENTRIES_END(neigh);
   }
 
-  if (mpr_changes && olsr_cnf->tc_redundancy > 0)
-    signal_link_changes(true);
+  if (mpr_changes) {
+    olsr_bump_generation(OLSR_GEN_NEIGHBORS);
+    if (olsr_cnf->tc_redundancy > 0)
+      signal_link_changes(true);
+  }
 }
 
 /*
@@ -46,8 +46,17 @@
 #ifndef _OLSR_LQ_MPR
 #define _OLSR_LQ_MPR
 
+#include "neighbor_table.h"
+#include "two_hop_neighbor_table.h"
+
 void olsr_calculate_lq_mpr(void);
 
+void olsr_lq_mpr_touch(struct neighbor_2_entry *);
+
+void olsr_lq_mpr_touch_neighbor(struct neighbor_entry *);
+
+void olsr_lq_mpr_dequeue(struct neighbor_2_entry *);
+
 #endif /* _OLSR_LQ_MPR */
 
 /*
@@ -68,6 +68,10 @@ bool lq_tc_pending = false;
 static uint32_t msg_buffer_aligned[(MAXMESSAGESIZE - OLSR_HEADERSIZE) / sizeof(uint32_t) + 1];
 static unsigned char *const msg_buffer = (unsigned char *)msg_buffer_aligned;
 
+/* neighbors advertised in our LQ_TC messages, shared by all interfaces */
+static struct tc_mpr_addr *lq_tc_neigh = NULL;
+static bool lq_tc_neigh_valid = false;
+
 static struct lq_hello_neighbor *neigh_find(struct lq_hello_message *lq_hello, struct link_entry *walker) {
   struct lq_hello_neighbor *neigh;
 
@@ -179,47 +183,40 @@ destroy_lq_hello(struct lq_hello_message *lq_hello)
   lq_hello->neigh = NULL;
 }
 
-static void
-create_lq_tc(struct lq_tc_message *lq_tc, struct interface_olsr *outif)
+/**
+ * Forget the cached neighbor list of our LQ_TC messages. This must be
+ * called whenever the set of advertised neighbors or the cost of one of
+ * their links changes.
+ */
+void
+olsr_invalidate_lq_tc(void)
 {
-  struct link_entry *lnk;
-  struct neighbor_entry *walker;
-  struct tc_mpr_addr *neigh;
-  static int ttl_list[] = { 2, 8, 2, 16, 2, 8, 2, MAX_TTL };
-
-  // remember that we have generated an LQ TC message; this is
-  // checked in net_output()
-
-  lq_tc_pending = true;
-
-  // initialize the static fields
-
-  lq_tc->comm.type = LQ_TC_MESSAGE;
-  lq_tc->comm.vtime = me_to_reltime(outif->valtimes.tc);
-  lq_tc->comm.size = 0;
-
-  lq_tc->comm.orig = olsr_cnf->main_addr;
+  lq_tc_neigh_valid = false;
+}
 
-  if (olsr_cnf->lq_fish > 0) {
-    if (outif->ttl_index >= (int)(sizeof(ttl_list) / sizeof(ttl_list[0])))
-      outif->ttl_index = 0;
+static void
+free_lq_tc_neighbors(struct tc_mpr_addr *neigh)
+{
+  struct tc_mpr_addr *aux;
 
-    lq_tc->comm.ttl = (0 <= outif->ttl_index ? ttl_list[outif->ttl_index] : MAX_TTL);
-    outif->ttl_index++;
+  // loop through the queued neighbour entries and free them
 
-    OLSR_PRINTF(3, "Creating LQ TC with TTL %d.\n", lq_tc->comm.ttl);
+  for (; neigh != NULL; neigh = aux) {
+    aux = neigh->next;
+    olsr_free_tc_mpr_addr(neigh);
   }
+}
 
-  else
-    lq_tc->comm.ttl = MAX_TTL;
-
-  lq_tc->comm.hops = 0;
-
-  lq_tc->from = olsr_cnf->main_addr;
-
-  lq_tc->ansn = get_local_ansn();
-
-  lq_tc->neigh = NULL;
+/*
+ * build the sorted list of neighbors to advertise, it does not
+ * depend on the outgoing interface
+ */
+static struct tc_mpr_addr *
+build_lq_tc_neighbors(void)
+{
+  struct link_entry *lnk;
+  struct neighbor_entry *walker;
+  struct tc_mpr_addr *neigh, *head = NULL;
 
   OLSR_FOR_ALL_NBR_ENTRIES(walker) {
 
@@ -274,11 +271,11 @@ create_lq_tc(struct lq_tc_message *lq_tc, struct interface_olsr *outif)
 
     // TODO: ugly hack until neighbor table is ported to avl tree
 
-    if (lq_tc->neigh == NULL || avl_comp_default(&lq_tc->neigh->address, &neigh->address) > 0) {
-      neigh->next = lq_tc->neigh;
-      lq_tc->neigh = neigh;
+    if (head == NULL || avl_comp_default(&head->address, &neigh->address) > 0) {
+      neigh->next = head;
+      head = neigh;
     } else {
-      struct tc_mpr_addr *last = lq_tc->neigh, *n = last->next;
+      struct tc_mpr_addr *last = head, *n = last->next;
 
       while (n) {
         if (avl_comp_default(&n->address, &neigh->address) > 0) {
@@ -290,25 +287,59 @@ create_lq_tc(struct lq_tc_message *lq_tc, struct interface_olsr *outif)
       neigh->next = n;
       last->next = neigh;
     }
-
-    // neigh->next = lq_tc->neigh;
-    // lq_tc->neigh = neigh;
-
   }
   OLSR_FOR_ALL_NBR_ENTRIES_END(walker);
+
+  return head;
 }
 
 static void
-destroy_lq_tc(struct lq_tc_message *lq_tc)
+create_lq_tc(struct lq_tc_message *lq_tc, struct interface_olsr *outif)
 {
-  struct tc_mpr_addr *walker, *aux;
+  static int ttl_list[] = { 2, 8, 2, 16, 2, 8, 2, MAX_TTL };
 
-  // loop through the queued neighbour entries and free them
+  // remember that we have generated an LQ TC message; this is
+  // checked in net_output()
 
-  for (walker = lq_tc->neigh; walker != NULL; walker = aux) {
-    aux = walker->next;
-    free(walker);
+  lq_tc_pending = true;
+
+  // initialize the static fields
+
+  lq_tc->comm.type = LQ_TC_MESSAGE;
+  lq_tc->comm.vtime = me_to_reltime(outif->valtimes.tc);
+  lq_tc->comm.size = 0;
+
+  lq_tc->comm.orig = olsr_cnf->main_addr;
+
+  if (olsr_cnf->lq_fish > 0) {
+    if (outif->ttl_index >= (int)(sizeof(ttl_list) / sizeof(ttl_list[0])))
+      outif->ttl_index = 0;
+
+    lq_tc->comm.ttl = (0 <= outif->ttl_index ? ttl_list[outif->ttl_index] : MAX_TTL);
+    outif->ttl_index++;
+
+    OLSR_PRINTF(3, "Creating LQ TC with TTL %d.\n", lq_tc->comm.ttl);
+  }
+
+  else
+    lq_tc->comm.ttl = MAX_TTL;
+
+  lq_tc->comm.hops = 0;
+
+  lq_tc->from = olsr_cnf->main_addr;
+
+  lq_tc->ansn = get_local_ansn();
+
+  // the neighbor list is the same for all interfaces, only rebuild
+  // it if something we advertise has changed since the last TC
+
+  if (!lq_tc_neigh_valid) {
+    free_lq_tc_neighbors(lq_tc_neigh);
+    lq_tc_neigh = build_lq_tc_neighbors();
+    lq_tc_neigh_valid = true;
   }
+
+  lq_tc->neigh = lq_tc_neigh;
 }
 
 static int
@@ -714,9 +745,7 @@ olsr_output_lq_tc(void *para)
   } else if (!TIMED_OUT(get_empty_tc_timer())) {
     serialize_lq_tc(&lq_tc, outif);
   }
-  // destroy internal format
-
-  destroy_lq_tc(&lq_tc);
+  // the neighbor list stays cached for the next TC
 
   if (net_output_pending(outif)) {
     if (!outif->immediate_send_tc) {
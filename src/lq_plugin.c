@@ -50,6 +50,8 @@
 #include "packet.h"
 #include "olsr.h"
 #include "two_hop_neighbor_table.h"
+#include "lq_mpr.h"
+#include "olsr_cookie.h"
 #include "common/avl.h"
 
 #include "lq_plugin_default_float.h"
@@ -67,6 +69,9 @@
 struct avl_tree lq_handler_tree;
 struct lq_handler *active_lq_handler = NULL;
 
+/* tc_mpr_addr blocks are sized by the active handler */
+static struct olsr_cookie_info *tc_mpr_addr_mem_cookie = NULL;
+
 /**
  * case-insensitive string comparator for avl-trees
  * @param str1
@@ -98,6 +103,9 @@ activate_lq_handler(const char *name)
   OLSR_PRINTF(1, "Using '%s' algorithm for lq calculation.\n", name);
   active_lq_handler = node->handler;
   active_lq_handler->initialize();
+
+  tc_mpr_addr_mem_cookie = olsr_alloc_cookie("tc_mpr_addr", OLSR_COOKIE_TYPE_MEMORY);
+  olsr_cookie_set_memory_size(tc_mpr_addr_mem_cookie, sizeof(struct tc_mpr_addr) + active_lq_handler->tc_lq_size);
 }
 
 /**
@@ -244,8 +252,16 @@ olsr_deserialize_tc_lq_pair(const uint8_t ** curr, struct tc_edge_entry *edge)
 void
 olsr_update_packet_loss_worker(struct link_entry *entry, bool lost)
 {
+  olsr_linkcost cost = entry->linkcost;
+
   assert((const char *)entry + sizeof(*entry) >= (const char *)entry->linkquality);
   active_lq_handler->packet_loss_handler(entry, entry->linkquality, lost);
+  olsr_invalidate_best_link(entry->neighbor);
+  if (entry->linkcost != cost) {
+    olsr_invalidate_lq_tc();
+    olsr_lq_mpr_touch_neighbor(entry->neighbor);
+    olsr_bump_generation(OLSR_GEN_LINKS);
+  }
 }
 
 /**
@@ -261,6 +277,8 @@ olsr_update_packet_loss_worker(struct link_entry *entry, bool lost)
 void
 olsr_memorize_foreign_hello_lq(struct link_entry *local, struct hello_neighbor *foreign)
 {
+  olsr_linkcost cost = local->linkcost;
+
   assert((const char *)local + sizeof(*local) >= (const char *)local->linkquality);
   if (foreign) {
     assert((const char *)foreign + sizeof(*foreign) >= (const char *)foreign->linkquality);
@@ -268,6 +286,12 @@ olsr_memorize_foreign_hello_lq(struct link_entry *local, struct hello_neighbor *
   } else {
     active_lq_handler->memorize_foreign_hello(local->linkquality, NULL);
   }
+  olsr_invalidate_best_link(local->neighbor);
+  if (local->linkcost != cost) {
+    olsr_invalidate_lq_tc();
+    olsr_lq_mpr_touch_neighbor(local->neighbor);
+    olsr_bump_generation(OLSR_GEN_LINKS);
+  }
 }
 
 /**
@@ -397,6 +421,9 @@ olsr_copylq_link_entry_2_tc_edge_entry(struct tc_edge_entry *target, struct link
 /* clear the lq of a link set entry */
 void olsr_clear_hello_lq(struct link_entry *link) {
   active_lq_handler->clear_hello(link->linkquality);
+  olsr_invalidate_best_link(link->neighbor);
+  olsr_invalidate_lq_tc();
+  olsr_lq_mpr_touch_neighbor(link->neighbor);
 }
 
 /**
@@ -439,24 +466,37 @@ olsr_malloc_hello_neighbor(const char *id)
  * olsr_malloc_tc_mpr_addr
  *
  * this function allocates memory for an tc_mpr_addr inclusive
- * linkquality data.
+ * linkquality data. Free it with olsr_free_tc_mpr_addr().
  *
  * @param id string for memory debugging
  *
  * @return pointer to tc_mpr_addr
  */
 struct tc_mpr_addr *
-olsr_malloc_tc_mpr_addr(const char *id)
+olsr_malloc_tc_mpr_addr(const char *id __attribute__ ((unused)))
 {
   struct tc_mpr_addr *t;
 
-  t = olsr_malloc(sizeof(struct tc_mpr_addr) + active_lq_handler->tc_lq_size, id);
+  t = olsr_cookie_malloc(tc_mpr_addr_mem_cookie);
 
   assert((const char *)t + sizeof(*t) >= (const char *)t->linkquality);
   active_lq_handler->clear_tc(t->linkquality);
   return t;
 }
 
+/**
+ * olsr_free_tc_mpr_addr
+ *
+ * this function frees a tc_mpr_addr allocated by olsr_malloc_tc_mpr_addr().
+ *
+ * @param t pointer to tc_mpr_addr
+ */
+void
+olsr_free_tc_mpr_addr(struct tc_mpr_addr *t)
+{
+  olsr_cookie_free(tc_mpr_addr_mem_cookie, t);
+}
+
 /**
  * olsr_malloc_lq_hello_neighbor
  *
@@ -517,6 +557,10 @@ void olsr_relevant_linkcost_change(void) {
   changes_neighborhood = true;
   changes_topology = true;
 
+  /* link costs may have been updated without a per link notification */
+  olsr_invalidate_all_best_links();
+  olsr_bump_generation(OLSR_GEN_LINKS);
+
   /* XXX - we should check whether we actually announce this neighbour */
   signal_link_changes(true);
 }
@@ -141,6 +141,7 @@ void olsr_clear_tc_lq(struct tc_mpr_addr *target);
 
 struct hello_neighbor *olsr_malloc_hello_neighbor(const char *id);
 struct tc_mpr_addr *olsr_malloc_tc_mpr_addr(const char *id);
+void olsr_free_tc_mpr_addr(struct tc_mpr_addr *);
 struct lq_hello_neighbor *olsr_malloc_lq_hello_neighbor(const char *id);
 struct link_entry *olsr_malloc_link_entry(const char *id);
 
@@ -184,6 +184,7 @@ static void olsr_shutdown_messages(void) {
     }
     net_output(ifn);
   }
+  net_flush_output();
 }
 
 /**
@@ -319,6 +320,7 @@ static void olsr_shutdown(int signo __attribute__ ((unused)))
     olsr_os_policy_rule(olsr_cnf->ip_version,
         olsr_cnf->rt_table_default, olsr_cnf->rt_table_default_pri, NULL, false);
   }
+  olsr_netlink_route_close();
   close(olsr_cnf->rtnl_s);
   close (olsr_cnf->rt_monitor_socket);
 #endif /* __linux__ */
@@ -571,7 +573,13 @@ int main(int argc, char *argv[]) {
     olsr_syslog(OLSR_LOG_INFO, "rtnetlink could not be set to nonblocking");
   }
 
-  if ((olsr_cnf->rt_monitor_socket = rtnetlink_register_socket(RTMGRP_LINK)) < 0) {
+  if (olsr_netlink_route_init()) {
+    char buf2[1024];
+    snprintf(buf2, sizeof(buf2), "rtnetlink route socket: %s", strerror(errno));
+    olsr_exit(buf2, EXIT_FAILURE);
+  }
+
+  if ((olsr_cnf->rt_monitor_socket = rtnetlink_register_socket(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR)) < 0) {
     char buf2[1024];
     snprintf(buf2, sizeof(buf2), "rtmonitor socket: %s", strerror(errno));
     olsr_exit(buf2, EXIT_FAILURE);
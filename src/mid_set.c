@@ -58,8 +58,8 @@
 #include "net_olsr.h"
 #include "duplicate_handler.h"
 
-struct mid_entry mid_set[HASHSIZE];
-struct mid_address reverse_mid_set[HASHSIZE];
+struct olsr_hashtable mid_set;
+struct olsr_hashtable reverse_mid_set;
 
 struct mid_entry *mid_lookup_entry_bymain(const union olsr_ip_addr *adr);
 
@@ -70,29 +70,20 @@ struct mid_entry *mid_lookup_entry_bymain(const union olsr_ip_addr *adr);
 int
 olsr_init_mid_set(void)
 {
-  int idx;
-
   OLSR_PRINTF(5, "MID: init\n");
 
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    mid_set[idx].next = &mid_set[idx];
-    mid_set[idx].prev = &mid_set[idx];
-
-    reverse_mid_set[idx].next = &reverse_mid_set[idx];
-    reverse_mid_set[idx].prev = &reverse_mid_set[idx];
-  }
+  olsr_hashtable_init(&mid_set, struct mid_entry, main_addr, next, prev);
+  olsr_hashtable_init(&reverse_mid_set, struct mid_address, alias, next, prev);
 
   return 1;
 }
 
 void olsr_delete_all_mid_entries(void) {
-  int hash;
+  struct mid_entry *mid;
 
-  for (hash = 0; hash < HASHSIZE; hash++) {
-    while (mid_set[hash].next != &mid_set[hash]) {
-      olsr_delete_mid_entry(mid_set[hash].next);
-    }
-  }
+  OLSR_FOR_ALL_MID_ENTRIES(mid) {
+    olsr_delete_mid_entry(mid);
+  } OLSR_FOR_ALL_MID_ENTRIES_END(mid);
 }
 
 void olsr_cleanup_mid(union olsr_ip_addr *orig) {
@@ -157,17 +148,10 @@ insert_mid_tuple(union olsr_ip_addr *m_addr, struct mid_address *alias, olsr_rel
 {
   struct mid_entry *tmp;
   struct mid_address *tmp_adr;
-  uint32_t hash, alias_hash;
   union olsr_ip_addr *registered_m_addr;
 
-  hash = olsr_ip_hashing(m_addr);
-  alias_hash = olsr_ip_hashing(&alias->alias);
-
   /* Check for registered entry */
-  for (tmp = mid_set[hash].next; tmp != &mid_set[hash]; tmp = tmp->next) {
-    if (ipequal(&tmp->main_addr, m_addr))
-      break;
-  }
+  tmp = mid_lookup_entry_bymain(m_addr);
 
   /* Check if alias is already registered with m_addr */
   registered_m_addr = mid_lookup_main_addr(&alias->alias);
@@ -182,11 +166,11 @@ insert_mid_tuple(union olsr_ip_addr *m_addr, struct mid_address *alias, olsr_rel
   olsr_insert_routing_table(&alias->alias, olsr_cnf->maxplen, m_addr, OLSR_RT_ORIGIN_MID);
 
   /*If the address was registered */
-  if (tmp != &mid_set[hash]) {
+  if (tmp != NULL) {
     tmp_adr = tmp->aliases;
     tmp->aliases = alias;
     alias->main_entry = tmp;
-    QUEUE_ELEM(reverse_mid_set[alias_hash], alias);
+    olsr_hashtable_insert(&reverse_mid_set, alias);
     alias->next_alias = tmp_adr;
     olsr_set_mid_timer(tmp, vtime);
   } else {
@@ -196,13 +180,14 @@ insert_mid_tuple(union olsr_ip_addr *m_addr, struct mid_address *alias, olsr_rel
 
     tmp->aliases = alias;
     alias->main_entry = tmp;
-    QUEUE_ELEM(reverse_mid_set[alias_hash], alias);
+    olsr_hashtable_insert(&reverse_mid_set, alias);
     tmp->main_addr = *m_addr;
     olsr_set_mid_timer(tmp, vtime);
 
     /* Queue */
-    QUEUE_ELEM(mid_set[hash], tmp);
+    olsr_hashtable_insert(&mid_set, tmp);
   }
+  olsr_bump_generation(OLSR_GEN_MID);
 
   /*
    * Delete possible duplicate entries in 2 hop set
@@ -239,11 +224,12 @@ insert_mid_tuple(union olsr_ip_addr *m_addr, struct mid_address *alias, olsr_rel
       replace_neighbor_link_set(tmp_neigh, real_neigh);
 
       /* Dequeue */
-      DEQUEUE_ELEM(tmp_neigh);
+      olsr_hashtable_remove(&neighbortable, tmp_neigh);
       /* Delete */
       free(tmp_neigh);
 
       changes_neighborhood = true;
+      olsr_bump_generation(OLSR_GEN_NEIGHBORS);
     }
     tmp_adr = tmp_adr->next_alias;
   }
@@ -267,6 +253,7 @@ insert_mid_alias(union olsr_ip_addr *main_add, const union olsr_ip_addr *alias,
   int ne_ref_rp_count;
   struct ipaddr_str buf1, buf2;
   struct mid_address *adr;
+  bool changed = false;
   if (!olsr_validate_address(alias))
     return;
 
@@ -287,12 +274,14 @@ insert_mid_alias(union olsr_ip_addr *main_add, const union olsr_ip_addr *alias,
   if (ne_old != NULL) {
     OLSR_PRINTF(2, "Remote main address change detected. Mangling neighbortable to replace %s with %s.\n",
                 olsr_ip_to_string(&buf1, alias), olsr_ip_to_string(&buf2, main_add));
-    olsr_delete_neighbor_table(alias);
     ne_new = olsr_insert_neighbor_table(main_add);
     /* adjust pointers to neighbortable-entry in link_set */
     ne_ref_rp_count = replace_neighbor_link_set(ne_old, ne_new);
     if (ne_ref_rp_count > 0)
       OLSR_PRINTF(2, "Performed %d neighbortable-pointer replacements (%p -> %p) in link_set.\n", ne_ref_rp_count, ne_old, ne_new);
+    /* the old entry has no links left, drop it */
+    olsr_delete_neighbor_table(alias);
+    changed = true;
 
     me_old = mid_lookup_entry_bymain(alias);
     if (me_old) {
@@ -308,10 +297,17 @@ insert_mid_alias(union olsr_ip_addr *main_add, const union olsr_ip_addr *alias,
     }
   }
 
-  if (!insert_mid_tuple(main_add, adr, vtime)) {
+  if (insert_mid_tuple(main_add, adr, vtime)) {
+    changed = true;
+  } else {
     free(adr);
   }
 
+  /* a repeated announcement of a known alias changes nothing */
+  if (!changed) {
+    return;
+  }
+
   /*
    *Recalculate topology
    */
@@ -329,13 +325,12 @@ insert_mid_alias(union olsr_ip_addr *main_add, const union olsr_ip_addr *alias,
 union olsr_ip_addr *
 mid_lookup_main_addr(const union olsr_ip_addr *adr)
 {
-  uint32_t hash;
-  struct mid_address *tmp_list;
+  struct mid_address *head, *tmp_list;
 
-  hash = olsr_ip_hashing(adr);
+  head = olsr_hashtable_head(&reverse_mid_set, adr);
 
   /*Traverse MID list */
-  for (tmp_list = reverse_mid_set[hash].next; tmp_list != &reverse_mid_set[hash]; tmp_list = tmp_list->next) {
+  for (tmp_list = head->next; tmp_list != head; tmp_list = tmp_list->next) {
     if (ipequal(&tmp_list->alias, adr))
       return &tmp_list->main_entry->main_addr;
   }
@@ -352,13 +347,12 @@ mid_lookup_main_addr(const union olsr_ip_addr *adr)
 struct mid_entry *
 mid_lookup_entry_bymain(const union olsr_ip_addr *adr)
 {
-  struct mid_entry *tmp_list;
-  uint32_t hash;
+  struct mid_entry *head, *tmp_list;
 
-  hash = olsr_ip_hashing(adr);
+  head = olsr_hashtable_head(&mid_set, adr);
 
   /* Check all registered nodes... */
-  for (tmp_list = mid_set[hash].next; tmp_list != &mid_set[hash]; tmp_list = tmp_list->next) {
+  for (tmp_list = head->next; tmp_list != head; tmp_list = tmp_list->next) {
     if (ipequal(&tmp_list->main_addr, adr))
       return tmp_list;
   }
@@ -388,15 +382,14 @@ mid_lookup_aliases(const union olsr_ip_addr *adr)
 int
 olsr_update_mid_table(const union olsr_ip_addr *adr, olsr_reltime vtime)
 {
-  uint32_t hash;
   struct ipaddr_str buf;
-  struct mid_entry *tmp_list = mid_set;
+  struct mid_entry *head, *tmp_list;
 
   OLSR_PRINTF(3, "MID: update %s\n", olsr_ip_to_string(&buf, adr));
-  hash = olsr_ip_hashing(adr);
+  head = olsr_hashtable_head(&mid_set, adr);
 
   /* Check all registered nodes... */
-  for (tmp_list = mid_set[hash].next; tmp_list != &mid_set[hash]; tmp_list = tmp_list->next) {
+  for (tmp_list = head->next; tmp_list != head; tmp_list = tmp_list->next) {
     /*find match */
     if (ipequal(&tmp_list->main_addr, adr)) {
       olsr_set_mid_timer(tmp_list, vtime);
@@ -418,19 +411,13 @@ olsr_prune_aliases(struct mid_message *message)
   const union olsr_ip_addr *m_addr = &message->mid_origaddr;
   struct mid_alias * declared_aliases = message->mid_addr;
   struct mid_entry *entry;
-  uint32_t hash;
   struct mid_address *registered_aliases;
   struct mid_address *previous_alias;
   struct mid_alias *save_declared_aliases = declared_aliases;
 
-  hash = olsr_ip_hashing(m_addr);
-
   /* Check for registered entry */
-  for (entry = mid_set[hash].next; entry != &mid_set[hash]; entry = entry->next) {
-    if (ipequal(&entry->main_addr, m_addr))
-      break;
-  }
-  if (entry == &mid_set[hash]) {
+  entry = mid_lookup_entry_bymain(m_addr);
+  if (entry == NULL) {
     /* MID entry not found, nothing to prune here */
     return;
   }
@@ -469,7 +456,7 @@ olsr_prune_aliases(struct mid_message *message)
       }
 
       /* Remove from hash table */
-      DEQUEUE_ELEM(current_alias);
+      olsr_hashtable_remove(&reverse_mid_set, current_alias);
 
       /*
        * Delete the rt_path for the alias.
@@ -483,6 +470,7 @@ olsr_prune_aliases(struct mid_message *message)
        */
       changes_neighborhood = true;
       changes_topology = true;
+      olsr_bump_generation(OLSR_GEN_MID);
     } else {
       previous_alias = current_alias;
     }
@@ -504,7 +492,7 @@ olsr_delete_mid_entry(struct mid_entry *mid)
   while (aliases) {
     struct mid_address *tmp_aliases = aliases;
     aliases = aliases->next_alias;
-    DEQUEUE_ELEM(tmp_aliases);
+    olsr_hashtable_remove(&reverse_mid_set, tmp_aliases);
 
     /*
      * Delete the rt_path for the alias.
@@ -523,8 +511,10 @@ olsr_delete_mid_entry(struct mid_entry *mid)
   }
 
   /* Dequeue */
-  DEQUEUE_ELEM(mid);
+  olsr_hashtable_remove(&mid_set, mid);
   free(mid);
+
+  olsr_bump_generation(OLSR_GEN_MID);
 }
 
 /**
@@ -534,23 +524,20 @@ olsr_delete_mid_entry(struct mid_entry *mid)
 void
 olsr_print_mid_set(void)
 {
-  int idx;
+  struct mid_entry *tmp_list;
 
   OLSR_PRINTF(1, "\n--- %s ------------------------------------------------- MID\n\n", olsr_wallclock_string());
 
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct mid_entry *tmp_list = mid_set[idx].next;
-    /*Traverse MID list */
-    for (tmp_list = mid_set[idx].next; tmp_list != &mid_set[idx]; tmp_list = tmp_list->next) {
-      struct mid_address *tmp_addr;
-      struct ipaddr_str buf;
-      OLSR_PRINTF(1, "%s: ", olsr_ip_to_string(&buf, &tmp_list->main_addr));
-      for (tmp_addr = tmp_list->aliases; tmp_addr; tmp_addr = tmp_addr->next_alias) {
-        OLSR_PRINTF(1, " %s ", olsr_ip_to_string(&buf, &tmp_addr->alias));
-      }
-      OLSR_PRINTF(1, "\n");
+  /*Traverse MID list */
+  OLSR_FOR_ALL_MID_ENTRIES(tmp_list) {
+    struct mid_address *tmp_addr;
+    struct ipaddr_str buf;
+    OLSR_PRINTF(1, "%s: ", olsr_ip_to_string(&buf, &tmp_list->main_addr));
+    for (tmp_addr = tmp_list->aliases; tmp_addr; tmp_addr = tmp_addr->next_alias) {
+      OLSR_PRINTF(1, " %s ", olsr_ip_to_string(&buf, &tmp_addr->alias));
     }
-  }
+    OLSR_PRINTF(1, "\n");
+  } OLSR_FOR_ALL_MID_ENTRIES_END(tmp_list);
 }
 
 /**
@@ -75,8 +75,18 @@ struct mid_entry {
 
 #define OLSR_MID_JITTER 5       /* percent */
 
-extern struct mid_entry mid_set[HASHSIZE];
-extern struct mid_address reverse_mid_set[HASHSIZE];
+#define OLSR_FOR_ALL_MID_ENTRIES(mid) \
+{ \
+  uint32_t _idx; \
+  for (_idx = 0; _idx < olsr_hashtable_buckets(&mid_set); _idx++) { \
+    struct mid_entry *_head = olsr_hashtable_bucket(&mid_set, _idx), *_next; \
+    for(mid = _head->next, _next = mid->next; \
+        mid != _head; \
+        mid = _next, _next = mid->next)
+#define OLSR_FOR_ALL_MID_ENTRIES_END(mid) }}
+
+extern struct olsr_hashtable mid_set;
+extern struct olsr_hashtable reverse_mid_set;
 
 int olsr_init_mid_set(void);
 void olsr_delete_all_mid_entries(void);
@@ -64,7 +64,9 @@ static void olsr_clear_mprs(void);
 
 static void olsr_clear_two_hop_processed(void);
 
-static struct neighbor_entry *olsr_find_maximum_covered(int);
+static void olsr_fill_mpr_buckets(int);
+
+static struct neighbor_entry *olsr_find_maximum_covered(void);
 
 static uint16_t olsr_calculate_two_hop_neighbors(void);
 
@@ -72,69 +74,48 @@ static int olsr_check_mpr_changes(void);
 
 static int olsr_chosen_mpr(struct neighbor_entry *, uint16_t *);
 
-static struct neighbor_2_list_entry *olsr_find_2_hop_neighbors_with_1_link(int);
+static void olsr_choose_2_hop_neighbors_with_1_link(int, uint16_t *);
 
 /* End:
  * Prototypes for internal functions
  */
 
+/* MPR candidates of one willingness, bucketed by neighbor_2_nocov */
+static struct list_node *mpr_buckets = NULL;
+static int mpr_bucket_count = 0;
+static int mpr_bucket_max = 0;
+
+LISTNODE2STRUCT(bucket2nbr, struct neighbor_entry, mpr_bucket);
+
 /**
- *Find all 2 hop neighbors with 1 link
- *connecting them to us trough neighbors
- *with a given willingness.
+ *Choose all neighbors with a given willingness
+ *that are the only link to one of our 2 hop neighbors
  *
  *@param willingness the willigness of the neighbors
- *
- *@return a linked list of allocated neighbor_2_list_entry structures
+ *@param two_hop_covered_count the number of covered 2 hop neighbors
  */
-static struct neighbor_2_list_entry *
-olsr_find_2_hop_neighbors_with_1_link(int willingness)
+static void
+olsr_choose_2_hop_neighbors_with_1_link(int willingness, uint16_t * two_hop_covered_count)
 {
+  struct neighbor_entry *dup_neighbor, *one_hop_neighbor;
+  struct neighbor_2_entry *two_hop_neighbor;
 
-  uint8_t idx;
-  struct neighbor_2_list_entry *two_hop_list_tmp = NULL;
-  struct neighbor_2_list_entry *two_hop_list = NULL;
-  struct neighbor_entry *dup_neighbor;
-  struct neighbor_2_entry *two_hop_neighbor = NULL;
-
-  for (idx = 0; idx < HASHSIZE; idx++) {
-
-    for (two_hop_neighbor = two_hop_neighbortable[idx].next; two_hop_neighbor != &two_hop_neighbortable[idx];
-         two_hop_neighbor = two_hop_neighbor->next) {
-
-      //two_hop_neighbor->neighbor_2_state=0;
-      //two_hop_neighbor->mpr_covered_count = 0;
+  OLSR_FOR_ALL_NBR2_ENTRIES(two_hop_neighbor) {
 
-      dup_neighbor = olsr_lookup_neighbor_table(&two_hop_neighbor->neighbor_2_addr);
+    dup_neighbor = olsr_lookup_neighbor_table(&two_hop_neighbor->neighbor_2_addr);
 
-      if ((dup_neighbor != NULL) && (dup_neighbor->status != NOT_SYM)) {
-
-        //OLSR_PRINTF(1, "(1)Skipping 2h neighbor %s - already 1hop\n", olsr_ip_to_string(&buf, &two_hop_neighbor->neighbor_2_addr));
-
-        continue;
-      }
-
-      if (two_hop_neighbor->neighbor_2_pointer == 1) {
-        if ((two_hop_neighbor->neighbor_2_nblist.next->neighbor->willingness == willingness)
-            && (two_hop_neighbor->neighbor_2_nblist.next->neighbor->status == SYM)) {
-          two_hop_list_tmp = olsr_malloc(sizeof(struct neighbor_2_list_entry), "MPR two hop list");
-
-          //OLSR_PRINTF(1, "ONE LINK ADDING %s\n", olsr_ip_to_string(&buf, &two_hop_neighbor->neighbor_2_addr));
-
-          /* Only queue one way here */
-          two_hop_list_tmp->neighbor_2 = two_hop_neighbor;
+    if ((dup_neighbor != NULL) && (dup_neighbor->status != NOT_SYM)) {
+      continue;
+    }
 
-          two_hop_list_tmp->next = two_hop_list;
+    if (two_hop_neighbor->neighbor_2_pointer == 1) {
+      one_hop_neighbor = two_hop_neighbor->neighbor_2_nblist.next->neighbor;
 
-          two_hop_list = two_hop_list_tmp;
-        }
+      if ((one_hop_neighbor->willingness == willingness) && (one_hop_neighbor->status == SYM) && !one_hop_neighbor->is_mpr) {
+        olsr_chosen_mpr(one_hop_neighbor, two_hop_covered_count);
       }
-
     }
-
-  }
-
-  return (two_hop_list_tmp);
+  } OLSR_FOR_ALL_NBR2_ENTRIES_END(two_hop_neighbor);
 }
 
 /**
@@ -200,38 +181,76 @@ olsr_chosen_mpr(struct neighbor_entry *one_hop_neighbor, uint16_t * two_hop_cove
 }
 
 /**
- *Find the neighbor that covers the most 2 hop neighbors
- *with a given willingness
+ *Sort all MPR candidates with a given willingness into
+ *buckets by the number of 2 hop neighbors they cover
  *
- *@param willingness the willingness of the neighbor
- *
- *@return a pointer to the neighbor_entry struct
+ *@param willingness the willingness of the neighbors
  */
-static struct neighbor_entry *
-olsr_find_maximum_covered(int willingness)
+static void
+olsr_fill_mpr_buckets(int willingness)
 {
-  uint16_t maximum;
   struct neighbor_entry *a_neighbor;
-  struct neighbor_entry *mpr_candidate = NULL;
-
-  maximum = 0;
+  int i, maximum = 0;
 
   OLSR_FOR_ALL_NBR_ENTRIES(a_neighbor) {
+    if ((!a_neighbor->is_mpr) && (a_neighbor->willingness == willingness) && (maximum < a_neighbor->neighbor_2_nocov)) {
+      maximum = a_neighbor->neighbor_2_nocov;
+    }
+  }
+  OLSR_FOR_ALL_NBR_ENTRIES_END(a_neighbor);
 
-#if 0
-    printf("[%s] nocov: %d mpr: %d will: %d max: %d\n\n", olsr_ip_to_string(&buf, &a_neighbor->neighbor_main_addr),
-           a_neighbor->neighbor_2_nocov, a_neighbor->is_mpr, a_neighbor->willingness, maximum);
-#endif /* 0 */
+  if (maximum >= mpr_bucket_count) {
+    mpr_bucket_count = maximum + 1;
+    mpr_buckets = olsr_realloc(mpr_buckets, mpr_bucket_count * sizeof(*mpr_buckets), "MPR buckets");
+  }
 
-    if ((!a_neighbor->is_mpr) && (a_neighbor->willingness == willingness) && (maximum < a_neighbor->neighbor_2_nocov)) {
+  for (i = 0; i <= maximum; i++) {
+    list_head_init(&mpr_buckets[i]);
+  }
+  mpr_bucket_max = maximum;
 
-      maximum = a_neighbor->neighbor_2_nocov;
-      mpr_candidate = a_neighbor;
+  OLSR_FOR_ALL_NBR_ENTRIES(a_neighbor) {
+    if ((!a_neighbor->is_mpr) && (a_neighbor->willingness == willingness) && (a_neighbor->neighbor_2_nocov > 0)) {
+      list_add_before(&mpr_buckets[a_neighbor->neighbor_2_nocov], &a_neighbor->mpr_bucket);
     }
   }
   OLSR_FOR_ALL_NBR_ENTRIES_END(a_neighbor);
+}
+
+/**
+ *Find the neighbor that covers the most 2 hop neighbors
+ *among the candidates sorted by olsr_fill_mpr_buckets()
+ *
+ *@return a pointer to the neighbor_entry struct
+ */
+static struct neighbor_entry *
+olsr_find_maximum_covered(void)
+{
+  struct neighbor_entry *a_neighbor;
 
-  return mpr_candidate;
+  while (mpr_bucket_max > 0) {
+    if (list_is_empty(&mpr_buckets[mpr_bucket_max])) {
+      mpr_bucket_max--;
+      continue;
+    }
+
+    a_neighbor = bucket2nbr(mpr_buckets[mpr_bucket_max].next);
+    list_remove(&a_neighbor->mpr_bucket);
+
+    if (a_neighbor->is_mpr) {
+      continue;
+    }
+
+    /* the coverage only decreases, requeue entries that are out of date */
+    if (a_neighbor->neighbor_2_nocov < mpr_bucket_max) {
+      if (a_neighbor->neighbor_2_nocov > 0) {
+        list_add_before(&mpr_buckets[a_neighbor->neighbor_2_nocov], &a_neighbor->mpr_bucket);
+      }
+      continue;
+    }
+    return a_neighbor;
+  }
+  return NULL;
 }
 
 /**
@@ -296,15 +315,12 @@ olsr_check_mpr_changes(void)
 static void
 olsr_clear_two_hop_processed(void)
 {
-  int idx;
+  struct neighbor_2_entry *neighbor_2;
 
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct neighbor_2_entry *neighbor_2;
-    for (neighbor_2 = two_hop_neighbortable[idx].next; neighbor_2 != &two_hop_neighbortable[idx]; neighbor_2 = neighbor_2->next) {
-      /* Clear */
-      neighbor_2->processed = 0;
-    }
-  }
+  OLSR_FOR_ALL_NBR2_ENTRIES(neighbor_2) {
+    /* Clear */
+    neighbor_2->processed = 0;
+  } OLSR_FOR_ALL_NBR2_ENTRIES_END(neighbor_2);
 
 }
 
@@ -409,17 +425,8 @@ olsr_calculate_mpr(void)
 
   for (i = WILL_ALWAYS - 1; i > WILL_NEVER; i--) {
     struct neighbor_entry *mprs;
-    struct neighbor_2_list_entry *two_hop_list = olsr_find_2_hop_neighbors_with_1_link(i);
-
-    while (two_hop_list != NULL) {
-      struct neighbor_2_list_entry *tmp;
-      //printf("CHOSEN FROM 1 LINK\n");
-      if (!two_hop_list->neighbor_2->neighbor_2_nblist.next->neighbor->is_mpr)
-        olsr_chosen_mpr(two_hop_list->neighbor_2->neighbor_2_nblist.next->neighbor, &two_hop_covered_count);
-      tmp = two_hop_list;
-      two_hop_list = two_hop_list->next;;
-      free(tmp);
-    }
+
+    olsr_choose_2_hop_neighbors_with_1_link(i, &two_hop_covered_count);
 
     if (two_hop_covered_count >= two_hop_count) {
       i = WILL_NEVER;
@@ -427,7 +434,9 @@ olsr_calculate_mpr(void)
     }
     //printf("two hop covered count: %d\n", two_hop_covered_count);
 
-    while ((mprs = olsr_find_maximum_covered(i)) != NULL) {
+    olsr_fill_mpr_buckets(i);
+
+    while ((mprs = olsr_find_maximum_covered()) != NULL) {
       //printf("CHOSEN FROM MAXCOV\n");
       olsr_chosen_mpr(mprs, &two_hop_covered_count);
 
@@ -449,6 +458,7 @@ olsr_calculate_mpr(void)
 
   if (olsr_check_mpr_changes()) {
     OLSR_PRINTF(3, "CHANGES IN MPR SET\n");
+    olsr_bump_generation(OLSR_GEN_NEIGHBORS);
     if (olsr_cnf->tc_redundancy > 0)
       signal_link_changes(true);
   }
@@ -119,6 +119,7 @@ olsr_expire_mpr_sel_entry(void *context)
   /* Delete entry */
   free(mpr_sel);
   signal_link_changes(true);
+  olsr_bump_generation(OLSR_GEN_NEIGHBORS);
 }
 
 /**
@@ -212,6 +213,7 @@ olsr_update_mprs_set(const union olsr_ip_addr *addr, olsr_reltime vtime)
   if (mprs == NULL) {
     olsr_add_mpr_selector(addr, vtime);
     signal_link_changes(true);
+    olsr_bump_generation(OLSR_GEN_NEIGHBORS);
     return 1;
   }
   olsr_set_mpr_sel_timer(mprs, vtime);
@@ -53,19 +53,17 @@
 #include "scheduler.h"
 #include "link_set.h"
 #include "mpr_selector_set.h"
+#include "lq_mpr.h"
 #include "net_olsr.h"
+#include "lq_packet.h"
+#include "olsr_spf.h"
 
-struct neighbor_entry neighbortable[HASHSIZE];
+struct olsr_hashtable neighbortable;
 
 void
 olsr_init_neighbor_table(void)
 {
-  int i;
-
-  for (i = 0; i < HASHSIZE; i++) {
-    neighbortable[i].next = &neighbortable[i];
-    neighbortable[i].prev = &neighbortable[i];
-  }
+  olsr_hashtable_init(&neighbortable, struct neighbor_entry, neighbor_main_addr, next, prev);
 }
 
 /**
@@ -79,7 +77,8 @@ olsr_del_nbr2_list(struct neighbor_2_list_entry *nbr2_list)
   nbr2 = nbr2_list->neighbor_2;
 
   if (nbr2->neighbor_2_pointer < 1) {
-    DEQUEUE_ELEM(nbr2);
+    olsr_hashtable_remove(&two_hop_neighbortable, nbr2);
+    olsr_lq_mpr_dequeue(nbr2);
     free(nbr2);
   }
 
@@ -97,6 +96,7 @@ olsr_del_nbr2_list(struct neighbor_2_list_entry *nbr2_list)
   /* Set flags to recalculate the MPR set and the routing table */
   changes_neighborhood = true;
   changes_topology = true;
+  olsr_bump_generation(OLSR_GEN_NEIGHBORS);
 }
 
 /**
@@ -157,14 +157,16 @@ void
 olsr_update_neighbor_main_addr(struct neighbor_entry *entry, const union olsr_ip_addr *new_main_addr)
 {
   /*remove from old pos*/
-  DEQUEUE_ELEM(entry);
+  olsr_hashtable_remove(&neighbortable, entry);
 
   /*update main addr*/
   entry->neighbor_main_addr = *new_main_addr;
 
   /*insert it again*/
-  QUEUE_ELEM(neighbortable[olsr_ip_hashing(new_main_addr)], entry);
+  olsr_hashtable_insert(&neighbortable, entry);
 
+  /* the TC message advertises the main address */
+  olsr_invalidate_lq_tc();
 }
 
 /**
@@ -181,26 +183,13 @@ int
 olsr_delete_neighbor_table(const union olsr_ip_addr *neighbor_addr)
 {
   struct neighbor_2_list_entry *two_hop_list, *two_hop_to_delete;
-  uint32_t hash;
   struct neighbor_entry *entry;
 
-  //printf("inserting neighbor\n");
-
-  hash = olsr_ip_hashing(neighbor_addr);
-
-  entry = neighbortable[hash].next;
-
   /*
    * Find neighbor entry
    */
-  while (entry != &neighbortable[hash]) {
-    if (ipequal(&entry->neighbor_main_addr, neighbor_addr))
-      break;
-
-    entry = entry->next;
-  }
-
-  if (entry == &neighbortable[hash])
+  entry = olsr_lookup_neighbor_table_alias(neighbor_addr);
+  if (entry == NULL)
     return 0;
 
   two_hop_list = entry->neighbor_2_list.next;
@@ -215,13 +204,17 @@ olsr_delete_neighbor_table(const union olsr_ip_addr *neighbor_addr)
     olsr_del_nbr2_list(two_hop_to_delete);
   }
 
+  /* the SPF edge to this neighbor is keyed by its main address */
+  olsr_spf_drop_neighbor(&entry->neighbor_main_addr);
+
   /* Dequeue */
-  DEQUEUE_ELEM(entry);
+  olsr_hashtable_remove(&neighbortable, entry);
 
   free(entry);
 
   changes_neighborhood = true;
   signal_link_changes(true);
+  olsr_bump_generation(OLSR_GEN_NEIGHBORS);
   return 1;
 
 }
@@ -236,17 +229,12 @@ olsr_delete_neighbor_table(const union olsr_ip_addr *neighbor_addr)
 struct neighbor_entry *
 olsr_insert_neighbor_table(const union olsr_ip_addr *main_addr)
 {
-  uint32_t hash;
   struct neighbor_entry *new_neigh;
 
-  hash = olsr_ip_hashing(main_addr);
-
   /* Check if entry exists */
-
-  for (new_neigh = neighbortable[hash].next; new_neigh != &neighbortable[hash]; new_neigh = new_neigh->next) {
-    if (ipequal(&new_neigh->neighbor_main_addr, main_addr))
-      return new_neigh;
-  }
+  new_neigh = olsr_lookup_neighbor_table_alias(main_addr);
+  if (new_neigh != NULL)
+    return new_neigh;
 
   //printf("inserting neighbor\n");
 
@@ -260,12 +248,16 @@ olsr_insert_neighbor_table(const union olsr_ip_addr *main_addr)
   new_neigh->neighbor_2_list.next = &new_neigh->neighbor_2_list;
   new_neigh->neighbor_2_list.prev = &new_neigh->neighbor_2_list;
 
+  list_head_init(&new_neigh->link_list);
   new_neigh->linkcount = 0;
   new_neigh->is_mpr = false;
   new_neigh->was_mpr = false;
+  new_neigh->mpr_select_count = 0;
+  list_node_init(&new_neigh->mpr_bucket);
 
   /* Queue */
-  QUEUE_ELEM(neighbortable[hash], new_neigh);
+  olsr_hashtable_insert(&neighbortable, new_neigh);
+  olsr_bump_generation(OLSR_GEN_NEIGHBORS);
 
   return new_neigh;
 }
@@ -302,10 +294,10 @@ struct neighbor_entry *
 olsr_lookup_neighbor_table_alias(const union olsr_ip_addr *dst)
 {
   struct neighbor_entry *entry;
-  uint32_t hash = olsr_ip_hashing(dst);
+  struct neighbor_entry *head = olsr_hashtable_head(&neighbortable, dst);
 
   //printf("\nLookup %s\n", olsr_ip_to_string(&buf, dst));
-  for (entry = neighbortable[hash].next; entry != &neighbortable[hash]; entry = entry->next) {
+  for (entry = head->next; entry != head; entry = entry->next) {
     //printf("Checking %s\n", olsr_ip_to_string(&buf, &entry->neighbor_main_addr));
     if (ipequal(&entry->neighbor_main_addr, dst))
       return entry;
@@ -336,6 +328,8 @@ update_neighbor_status(struct neighbor_entry *entry, int lnk)
 
       changes_neighborhood = true;
       changes_topology = true;
+      olsr_invalidate_lq_tc();
+      olsr_bump_generation(OLSR_GEN_NEIGHBORS);
       if (olsr_cnf->tc_redundancy > 1)
         signal_link_changes(true);
     }
@@ -344,6 +338,8 @@ update_neighbor_status(struct neighbor_entry *entry, int lnk)
     if (entry->status == SYM) {
       changes_neighborhood = true;
       changes_topology = true;
+      olsr_invalidate_lq_tc();
+      olsr_bump_generation(OLSR_GEN_NEIGHBORS);
       if (olsr_cnf->tc_redundancy > 1)
         signal_link_changes(true);
     }
@@ -389,32 +385,29 @@ olsr_print_neighbor_table(void)
 {
   /* The whole function doesn't do anything else. */
   const int iplen = olsr_cnf->ip_version == AF_INET ? (INET_ADDRSTRLEN - 1) : (INET6_ADDRSTRLEN - 1);
-  int idx;
+  struct neighbor_entry *neigh;
 
   OLSR_PRINTF(1,
               "\n--- %s ------------------------------------------------ NEIGHBORS\n\n"
               "%*s\tHyst\tLQ\tETX\tSYM   MPR   MPRS  will\n", olsr_wallclock_string(),
               iplen, "IP address");
 
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    struct neighbor_entry *neigh;
-    for (neigh = neighbortable[idx].next; neigh != &neighbortable[idx]; neigh = neigh->next) {
-      struct link_entry *lnk = get_best_link_to_neighbor(&neigh->neighbor_main_addr);
-      if (lnk) {
-        struct ipaddr_str buf;
-        struct lqtextbuffer lqbuffer1, lqbuffer2;
-
-        OLSR_PRINTF(1, "%-*s\t%5.3f\t%s\t%s\t%s  %s  %s  %d\n", iplen, olsr_ip_to_string(&buf, &neigh->neighbor_main_addr),
-                    (double)lnk->L_link_quality,
-                    get_link_entry_text(lnk, '/', &lqbuffer1),
-                    get_linkcost_text(lnk->linkcost,false, &lqbuffer2),
-                    neigh->status == SYM ? "YES " : "NO  ",
-                    neigh->is_mpr ? "YES " : "NO  ",
-                    olsr_lookup_mprs_set(&neigh->neighbor_main_addr) == NULL ? "NO  " : "YES ",
-                    neigh->willingness);
-      }
+  OLSR_FOR_ALL_NBR_ENTRIES(neigh) {
+    struct link_entry *lnk = get_best_link_to_neighbor(&neigh->neighbor_main_addr);
+    if (lnk) {
+      struct ipaddr_str buf;
+      struct lqtextbuffer lqbuffer1, lqbuffer2;
+
+      OLSR_PRINTF(1, "%-*s\t%5.3f\t%s\t%s\t%s  %s  %s  %d\n", iplen, olsr_ip_to_string(&buf, &neigh->neighbor_main_addr),
+                  (double)lnk->L_link_quality,
+                  get_link_entry_text(lnk, '/', &lqbuffer1),
+                  get_linkcost_text(lnk->linkcost,false, &lqbuffer2),
+                  neigh->status == SYM ? "YES " : "NO  ",
+                  neigh->is_mpr ? "YES " : "NO  ",
+                  olsr_lookup_mprs_set(&neigh->neighbor_main_addr) == NULL ? "NO  " : "YES ",
+                  neigh->willingness);
     }
-  }
+  } OLSR_FOR_ALL_NBR_ENTRIES_END(neigh);
 }
 #endif /* NODEBUG */
 
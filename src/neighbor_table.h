@@ -49,6 +49,7 @@
 #include "olsr_types.h"
 #include "hashing.h"
 #include "two_hop_neighbor_table.h"
+#include "common/list.h"
 
 struct neighbor_2_list_entry {
   struct neighbor_entry *nbr2_nbr;     /* backpointer to owning nbr entry */
@@ -68,7 +69,12 @@ struct neighbor_entry {
   bool was_mpr;                        /* Used to detect changes in MPR */
   bool skip;
   int neighbor_2_nocov;
+  int mpr_select_count;                /* 2-hop neighbors that selected this neighbor as MPR, see lq_mpr.c */
+  struct list_node mpr_bucket;         /* coverage bucket during MPR selection, see mpr.c */
   int linkcount;
+  struct list_node link_list;          /* links to this neighbor, see link_set.c */
+  struct link_entry *best_link;        /* cached result of get_best_link_to_neighbor() */
+  uint32_t best_link_gen;              /* best_link is valid if this matches the link set generation */
   struct neighbor_2_list_entry neighbor_2_list;
   struct neighbor_entry *next;
   struct neighbor_entry *prev;
@@ -76,17 +82,18 @@ struct neighbor_entry {
 
 #define OLSR_FOR_ALL_NBR_ENTRIES(nbr) \
 { \
-  int _idx; \
-  for (_idx = 0; _idx < HASHSIZE; _idx++) { \
-    for(nbr = neighbortable[_idx].next; \
-        nbr != &neighbortable[_idx]; \
+  uint32_t _idx; \
+  for (_idx = 0; _idx < olsr_hashtable_buckets(&neighbortable); _idx++) { \
+    struct neighbor_entry *_head = olsr_hashtable_bucket(&neighbortable, _idx); \
+    for(nbr = _head->next; \
+        nbr != _head; \
         nbr = nbr->next)
 #define OLSR_FOR_ALL_NBR_ENTRIES_END(nbr) }}
 
 /*
  * The neighbor table
  */
-extern struct neighbor_entry neighbortable[HASHSIZE];
+extern struct olsr_hashtable neighbortable;
 
 void olsr_init_neighbor_table(void);
 
@@ -74,6 +74,51 @@ struct ptf {
 
 static struct ptf *ptf_list;
 
+/*
+ * Shared messages: a message that goes out on several interfaces (a
+ * forwarded message) is stored once, the output buffers and the queued
+ * packets of the interfaces reference it. Where the kernel can gather a
+ * datagram from several pieces (sendmmsg with iovecs) it is never copied.
+ */
+
+struct net_fragment {
+  unsigned int refcount;
+  uint16_t size;
+  uint8_t data[];
+};
+
+struct net_fragment_ref {
+  int offset;                          /* offset in the packet, counted in bytes of buff */
+  struct net_fragment *frag;
+};
+
+/* Transmit queue, flushed once per scheduler tick by net_flush_output() */
+
+#define NET_OUTQUEUE_SIZE 32
+
+struct net_outqueue_entry {
+  struct interface_olsr *ifp;          /* NULL if the entry has been sent */
+  union {
+    struct sockaddr_in v4;
+    struct sockaddr_in6 v6;
+  } dst;
+  socklen_t dstlen;
+  uint8_t *buff;                       /* the packet, without the frags */
+  int bufsize;
+  int len;
+  struct net_fragment_ref *frags;      /* taken over from the output buffer */
+  int frag_count;
+  int frag_size;
+#ifdef OLSR_HAVE_SENDMMSG
+  struct iovec *iov;                   /* buff and frags in packet order */
+  int iov_count;
+  int iov_size;
+#endif /* OLSR_HAVE_SENDMMSG */
+};
+
+static struct net_outqueue_entry outqueue[NET_OUTQUEUE_SIZE];
+static int outqueue_len;
+
 static struct deny_address_entry *deny_entries;
 
 static const char *const deny_ipv4_defaults[] = {
@@ -109,6 +154,53 @@ init_net(void)
   }
 }
 
+/**
+ * Store a message so that it can be added to the output buffers of
+ * several interfaces without copying it into each of them.
+ *
+ * @param data the message
+ * @param size the size of the message
+ *
+ * @return the fragment, with one reference for the caller
+ */
+struct net_fragment *
+net_fragment_new(const void *data, uint16_t size)
+{
+  struct net_fragment *frag = olsr_malloc(sizeof(*frag) + size, "net_fragment");
+
+  frag->refcount = 1;
+  frag->size = size;
+  memcpy(frag->data, data, size);
+
+  return frag;
+}
+
+/**
+ * Drop a reference to a fragment, it is freed with the last one.
+ *
+ * @param frag the fragment
+ */
+void
+net_fragment_put(struct net_fragment *frag)
+{
+  if (--frag->refcount == 0) {
+    free(frag);
+  }
+}
+
+/**
+ * Drop the fragment references of an array of them.
+ */
+static void
+net_fragment_put_all(struct net_fragment_ref *frags, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++) {
+    net_fragment_put(frags[i].frag);
+  }
+}
+
 /**
  * Create an outputbuffer for the given interface. This
  * function will allocate the needed storage according
@@ -140,6 +232,7 @@ net_add_buffer(struct interface_olsr *ifp)
 
   ifp->netbuf.pending = 0;
   ifp->netbuf.reserved = 0;
+  ifp->netbuf.local = 0;
 
   return 0;
 }
@@ -159,9 +252,16 @@ net_remove_buffer(struct interface_olsr *ifp)
   if (ifp->netbuf.pending)
     net_output(ifp);
 
+  /* the socket might be closed after this */
+  net_flush_output();
+
   free(ifp->netbuf.buff);
   ifp->netbuf.buff = NULL;
 
+  free(ifp->netbuf.frags);
+  ifp->netbuf.frags = NULL;
+  ifp->netbuf.frag_size = 0;
+
   return 0;
 }
 
@@ -222,12 +322,46 @@ net_outbuffer_push(struct interface_olsr *ifp, const void *data, const uint16_t
   if ((ifp->netbuf.pending + size) > ifp->netbuf.maxsize)
     return 0;
 
-  memcpy(&ifp->netbuf.buff[ifp->netbuf.pending + OLSR_HEADERSIZE], data, size);
+  memcpy(&ifp->netbuf.buff[ifp->netbuf.local + OLSR_HEADERSIZE], data, size);
+  ifp->netbuf.local += size;
   ifp->netbuf.pending += size;
 
   return size;
 }
 
+/**
+ * Add a shared message to a buffer. The buffer takes a reference
+ * to the fragment instead of copying it.
+ *
+ * @param ifp the interface corresponding to the buffer
+ * @param frag the fragment with the message
+ *
+ * @return 0 if there was not enough room in buffer or the
+ *  number of bytes added on success
+ */
+int
+net_outbuffer_push_fragment(struct interface_olsr *ifp, struct net_fragment *frag)
+{
+  struct net_fragment_ref *ref;
+
+  if ((ifp->netbuf.pending + frag->size) > ifp->netbuf.maxsize)
+    return 0;
+
+  if (ifp->netbuf.frag_count == ifp->netbuf.frag_size) {
+    ifp->netbuf.frag_size = ifp->netbuf.frag_size ? (ifp->netbuf.frag_size * 2) : 8;
+    ifp->netbuf.frags = olsr_realloc(ifp->netbuf.frags, ifp->netbuf.frag_size * sizeof(*ifp->netbuf.frags), "net_outbuffer_push_fragment");
+  }
+
+  ref = &ifp->netbuf.frags[ifp->netbuf.frag_count++];
+  ref->offset = ifp->netbuf.local + OLSR_HEADERSIZE;
+  ref->frag = frag;
+  frag->refcount++;
+
+  ifp->netbuf.pending += frag->size;
+
+  return frag->size;
+}
+
 /**
  * Add data to the reserved part of a buffer
  *
@@ -245,7 +379,8 @@ net_outbuffer_push_reserved(struct interface_olsr *ifp, const void *data, const
   if ((ifp->netbuf.pending + size) > (ifp->netbuf.maxsize + ifp->netbuf.reserved))
     return 0;
 
-  memcpy(&ifp->netbuf.buff[ifp->netbuf.pending + OLSR_HEADERSIZE], data, size);
+  memcpy(&ifp->netbuf.buff[ifp->netbuf.local + OLSR_HEADERSIZE], data, size);
+  ifp->netbuf.local += size;
   ifp->netbuf.pending += size;
 
   return size;
@@ -327,26 +462,31 @@ del_ptf(packet_transform_function f)
 }
 
 /**
- *Sends a packet on a given interface.
+ *Queues the pending packet of a given interface for transmission.
+ *The packet header is finalized and the packet transform functions
+ *are called, the datagram itself is sent by net_flush_output()
+ *at the end of the current scheduler tick.
  *
  *@param ifp the interface to send on.
  *
- *@return negative on error
+ *@return number of bytes queued
  */
 int
 net_output(struct interface_olsr *ifp)
 {
-  struct sockaddr_in *sin = NULL;
-  struct sockaddr_in6 *sin6 = NULL;
-  struct sockaddr_in dst;
-  struct sockaddr_in6 dst6;
+  struct net_outqueue_entry *entry;
   struct ptf *tmp_ptf_list;
   union olsr_packet *outmsg;
   int retval;
+  int i;
 
   if (!ifp->netbuf.pending)
     return 0;
 
+  if (outqueue_len == NET_OUTQUEUE_SIZE) {
+    net_flush_output();
+  }
+
   ifp->netbuf.pending += OLSR_HEADERSIZE;
 
   retval = ifp->netbuf.pending;
@@ -357,58 +497,107 @@ net_output(struct interface_olsr *ifp)
   /* Set the packetlength */
   outmsg->v4.olsr_packlen = htons(ifp->netbuf.pending);
 
+  entry = &outqueue[outqueue_len];
+  entry->ifp = ifp;
+
   if (olsr_cnf->ip_version == AF_INET) {
     /* IP version 4 */
-    sin = (struct sockaddr_in *)&ifp->int_broadaddr;
+    entry->dst.v4 = ifp->int_broadaddr;
+    entry->dstlen = sizeof(entry->dst.v4);
 
-    /* Copy sin */
-    dst = *sin;
-    sin = &dst;
-
-    if (sin->sin_port == 0)
-      sin->sin_port = htons(olsr_cnf->olsrport);
+    if (entry->dst.v4.sin_port == 0)
+      entry->dst.v4.sin_port = htons(olsr_cnf->olsrport);
   } else {
     /* IP version 6 */
-    sin6 = (struct sockaddr_in6 *)&ifp->int6_multaddr;
-    /* Copy sin */
-    dst6 = *sin6;
-    sin6 = &dst6;
+    entry->dst.v6 = ifp->int6_multaddr;
+    entry->dstlen = sizeof(entry->dst.v6);
   }
 
-  /*
-   *Call possible packet transform functions registered by plugins
-   */
-  for (tmp_ptf_list = ptf_list; tmp_ptf_list != NULL; tmp_ptf_list = tmp_ptf_list->next) {
-    tmp_ptf_list->function(ifp->netbuf.buff, &ifp->netbuf.pending);
+  /* the packet transform functions may grow the packet up to the buffer size */
+  if (entry->bufsize < ifp->netbuf.bufsize) {
+    entry->buff = olsr_realloc(entry->buff, ifp->netbuf.bufsize, "net_output");
+    entry->bufsize = ifp->netbuf.bufsize;
   }
 
-  if (olsr_cnf->ip_version == AF_INET) {
-    /* IP version 4 */
-    if (olsr_sendto(ifp->send_socket, ifp->netbuf.buff, ifp->netbuf.pending, MSG_DONTROUTE, (struct sockaddr *)sin, sizeof(*sin)) <
-        0) {
-      perror("sendto(v4)");
-#ifndef _WIN32
-      olsr_syslog(OLSR_LOG_ERR, "OLSR: sendto IPv4 '%s' on interface %s", strerror(errno), ifp->int_name);
-#endif /* _WIN32 */
-      retval = -1;
+#ifdef OLSR_HAVE_SENDMMSG
+  if (ifp->netbuf.frag_count && !ptf_list) {
+    struct net_fragment_ref *frags = entry->frags;
+    int frag_size = entry->frag_size;
+
+    /*
+     * copy only the local part of the datagram into the queue, the
+     * shared messages are handed over and gathered when sending
+     */
+    memcpy(entry->buff, ifp->netbuf.buff, ifp->netbuf.local + OLSR_HEADERSIZE);
+    entry->len = ifp->netbuf.local + OLSR_HEADERSIZE;
+
+    entry->frags = ifp->netbuf.frags;
+    entry->frag_size = ifp->netbuf.frag_size;
+    entry->frag_count = ifp->netbuf.frag_count;
+    ifp->netbuf.frags = frags;
+    ifp->netbuf.frag_size = frag_size;
+  } else
+#endif /* OLSR_HAVE_SENDMMSG */
+  {
+    /* copy the whole datagram into the queue, the buffer can be reused right away */
+    int offset = 0;
+    int len = 0;
+
+    for (i = 0; i < ifp->netbuf.frag_count; i++) {
+      struct net_fragment_ref *ref = &ifp->netbuf.frags[i];
+
+      memcpy(&entry->buff[len], &ifp->netbuf.buff[offset], ref->offset - offset);
+      len += ref->offset - offset;
+      offset = ref->offset;
+      memcpy(&entry->buff[len], ref->frag->data, ref->frag->size);
+      len += ref->frag->size;
     }
-  } else {
-    /* IP version 6 */
-    if (olsr_sendto(ifp->send_socket, ifp->netbuf.buff, ifp->netbuf.pending, MSG_DONTROUTE, (struct sockaddr *)sin6, sizeof(*sin6))
-        < 0) {
-      struct ipaddr_str buf;
-      perror("sendto(v6)");
-#ifndef _WIN32
-      olsr_syslog(OLSR_LOG_ERR, "OLSR: sendto IPv6 '%s' on interface %s", strerror(errno), ifp->int_name);
-#endif /* _WIN32 */
-      fprintf(stderr, "Socket: %d interface: %d\n", ifp->olsr_socket, ifp->if_index);
-      fprintf(stderr, "To: %s (size: %u)\n", ip6_to_string(&buf, &sin6->sin6_addr), (unsigned int)sizeof(*sin6));
-      fprintf(stderr, "Outputsize: %d\n", ifp->netbuf.pending);
-      retval = -1;
+    memcpy(&entry->buff[len], &ifp->netbuf.buff[offset], ifp->netbuf.local + OLSR_HEADERSIZE - offset);
+    entry->len = ifp->netbuf.pending;
+    entry->frag_count = 0;
+    net_fragment_put_all(ifp->netbuf.frags, ifp->netbuf.frag_count);
+
+    /*
+     *Call possible packet transform functions registered by plugins
+     */
+    for (tmp_ptf_list = ptf_list; tmp_ptf_list != NULL; tmp_ptf_list = tmp_ptf_list->next) {
+      tmp_ptf_list->function(entry->buff, &entry->len);
     }
   }
 
+#ifdef OLSR_HAVE_SENDMMSG
+  /* the pieces of the datagram, in packet order */
+  if (entry->iov_size < ((entry->frag_count * 2) + 1)) {
+    entry->iov_size = (entry->frag_count * 2) + 1;
+    entry->iov = olsr_realloc(entry->iov, entry->iov_size * sizeof(*entry->iov), "net_output");
+  }
+  {
+    int offset = 0;
+
+    entry->iov_count = 0;
+    for (i = 0; i < entry->frag_count; i++) {
+      struct net_fragment_ref *ref = &entry->frags[i];
+
+      if (ref->offset > offset) {
+        entry->iov[entry->iov_count].iov_base = &entry->buff[offset];
+        entry->iov[entry->iov_count++].iov_len = ref->offset - offset;
+        offset = ref->offset;
+      }
+      entry->iov[entry->iov_count].iov_base = ref->frag->data;
+      entry->iov[entry->iov_count++].iov_len = ref->frag->size;
+    }
+    if (entry->len > offset) {
+      entry->iov[entry->iov_count].iov_base = &entry->buff[offset];
+      entry->iov[entry->iov_count++].iov_len = entry->len - offset;
+    }
+  }
+#endif /* OLSR_HAVE_SENDMMSG */
+
+  outqueue_len++;
+
   ifp->netbuf.pending = 0;
+  ifp->netbuf.local = 0;
+  ifp->netbuf.frag_count = 0;
 
   /*
    * if we've just transmitted a TC message, let Dijkstra use the current
@@ -420,6 +609,108 @@ net_output(struct interface_olsr *ifp)
   return retval;
 }
 
+/**
+ *Report a failed transmission of a queued datagram
+ *
+ *@param entry the queue entry that could not be sent
+ */
+static void
+net_output_error(struct net_outqueue_entry *entry)
+{
+  struct interface_olsr *ifp = entry->ifp;
+
+  if (olsr_cnf->ip_version == AF_INET) {
+    /* IP version 4 */
+    perror("sendto(v4)");
+#ifndef _WIN32
+    olsr_syslog(OLSR_LOG_ERR, "OLSR: sendto IPv4 '%s' on interface %s", strerror(errno), ifp->int_name);
+#endif /* _WIN32 */
+  } else {
+    /* IP version 6 */
+    struct ipaddr_str buf;
+    perror("sendto(v6)");
+#ifndef _WIN32
+    olsr_syslog(OLSR_LOG_ERR, "OLSR: sendto IPv6 '%s' on interface %s", strerror(errno), ifp->int_name);
+#endif /* _WIN32 */
+    fprintf(stderr, "Socket: %d interface: %d\n", ifp->olsr_socket, ifp->if_index);
+    fprintf(stderr, "To: %s (size: %u)\n", ip6_to_string(&buf, &entry->dst.v6.sin6_addr), (unsigned int)entry->dstlen);
+    fprintf(stderr, "Outputsize: %d\n", ntohs(((union olsr_packet *)entry->buff)->v4.olsr_packlen));
+  }
+}
+
+/**
+ *Sends all datagrams queued by net_output(). Datagrams for the
+ *same socket are handed to the kernel together with sendmmsg()
+ *where available.
+ *
+ *@return number of datagrams that could not be sent
+ */
+int
+net_flush_output(void)
+{
+  int failed = 0;
+  int i;
+
+  for (i = 0; i < outqueue_len; i++) {
+#ifdef OLSR_HAVE_SENDMMSG
+    struct iovec *iov[OLSR_SENDMMSG_MAX];
+    int iovlen[OLSR_SENDMMSG_MAX];
+    struct sockaddr *to[OLSR_SENDMMSG_MAX];
+    socklen_t tolen[OLSR_SENDMMSG_MAX];
+    struct net_outqueue_entry *batch[OLSR_SENDMMSG_MAX];
+    int count, sent, j;
+#endif /* OLSR_HAVE_SENDMMSG */
+    struct net_outqueue_entry *entry = &outqueue[i];
+    int sock;
+
+    if (entry->ifp == NULL) {
+      /* already sent as part of an earlier batch */
+      continue;
+    }
+    sock = entry->ifp->send_socket;
+
+#ifdef OLSR_HAVE_SENDMMSG
+    /* collect the datagrams for this socket in queue order */
+    count = 0;
+    for (j = i; j < outqueue_len && count < OLSR_SENDMMSG_MAX; j++) {
+      if (outqueue[j].ifp != NULL && outqueue[j].ifp->send_socket == sock) {
+        batch[count] = &outqueue[j];
+        iov[count] = outqueue[j].iov;
+        iovlen[count] = outqueue[j].iov_count;
+        to[count] = (struct sockaddr *)&outqueue[j].dst;
+        tolen[count] = outqueue[j].dstlen;
+        count++;
+      }
+    }
+
+    for (j = 0; j < count; j += sent) {
+      sent = olsr_sendmmsg(sock, &iov[j], &iovlen[j], &to[j], &tolen[j], count - j, MSG_DONTROUTE);
+      if (sent <= 0) {
+        /* the first datagram failed, report and skip it */
+        net_output_error(batch[j]);
+        failed++;
+        sent = 1;
+      }
+    }
+
+    for (j = 0; j < count; j++) {
+      batch[j]->ifp = NULL;
+      net_fragment_put_all(batch[j]->frags, batch[j]->frag_count);
+      batch[j]->frag_count = 0;
+    }
+#else /* OLSR_HAVE_SENDMMSG */
+    if (olsr_sendto(sock, entry->buff, entry->len, MSG_DONTROUTE, (struct sockaddr *)&entry->dst, entry->dstlen) < 0) {
+      net_output_error(entry);
+      failed++;
+    }
+    entry->ifp = NULL;
+#endif /* OLSR_HAVE_SENDMMSG */
+  }
+
+  outqueue_len = 0;
+  return failed;
+}
+
 /*
  * Adds the given IP-address to the invalid list.
  */
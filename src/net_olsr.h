@@ -55,6 +55,8 @@
 
 typedef int (*packet_transform_function) (uint8_t *, int *);
 
+struct net_fragment;
+
 void init_net(void);
 
 int net_add_buffer(struct interface_olsr *);
@@ -71,8 +73,16 @@ int net_outbuffer_push(struct interface_olsr *, const void *, const uint16_t);
 
 int net_outbuffer_push_reserved(struct interface_olsr *, const void *, const uint16_t);
 
+struct net_fragment *net_fragment_new(const void *, uint16_t);
+
+void net_fragment_put(struct net_fragment *);
+
+int net_outbuffer_push_fragment(struct interface_olsr *, struct net_fragment *);
+
 int net_output(struct interface_olsr *);
 
+int net_flush_output(void);
+
 int net_sendroute(struct rt_entry *, struct sockaddr *);
 
 int add_ptf(packet_transform_function);
@@ -61,6 +61,22 @@ ssize_t olsr_sendto(int, const void *, size_t, int, const struct sockaddr *, soc
 
 ssize_t olsr_recvfrom(int, void *, size_t, int, struct sockaddr *, socklen_t *);
 
+#if defined(__linux__) && !defined(__ANDROID__)
+/* batched receive of up to OLSR_RECVMMSG_MAX datagrams with one syscall */
+#define OLSR_HAVE_RECVMMSG 1
+#define OLSR_RECVMMSG_MAX 16
+
+int olsr_recvmmsg(int, char **, size_t, struct sockaddr_storage *, socklen_t *, int *, unsigned int);
+
+/* batched transmit of up to OLSR_SENDMMSG_MAX datagrams with one syscall, each gathered from iovecs */
+#define OLSR_HAVE_SENDMMSG 1
+#define OLSR_SENDMMSG_MAX 16
+
+#include <sys/uio.h>
+
+int olsr_sendmmsg(int, struct iovec **, const int *, struct sockaddr **, const socklen_t *, unsigned int, int);
+#endif /* defined(__linux__) && !defined(__ANDROID__) */
+
 int olsr_select(int, fd_set *, fd_set *, fd_set *, struct timeval *);
 
 int bind_socket_to_device(int, char *);
@@ -71,6 +71,7 @@
 #include "gateway.h"
 #include "duplicate_handler.h"
 #include "olsr_random.h"
+#include "olsr_cookie.h"
 
 #include <stdarg.h>
 #include <signal.h>
@@ -78,9 +79,12 @@
 
 bool changes_topology;
 bool changes_neighborhood;
+bool changes_two_hop;
 bool changes_hna;
 bool changes_force;
 
+uint32_t olsr_generations[OLSR_GEN_COUNT];
+
 /*COLLECT startup sleeps caused by warnings*/
 
 #ifdef OLSR_COLLECT_STARTUP_SLEEP
@@ -187,7 +191,7 @@ olsr_process_changes(void)
   struct pcf *tmp_pc_list;
 
 #ifdef DEBUG
-  if (changes_neighborhood)
+  if (changes_neighborhood || changes_two_hop)
     OLSR_PRINTF(3, "CHANGES IN NEIGHBORHOOD\n");
   if (changes_topology)
     OLSR_PRINTF(3, "CHANGES IN TOPOLOGY\n");
@@ -195,7 +199,7 @@ olsr_process_changes(void)
     OLSR_PRINTF(3, "CHANGES IN HNA\n");
 #endif /* DEBUG */
 
-  if (!changes_neighborhood && !changes_topology && !changes_hna)
+  if (!changes_neighborhood && !changes_two_hop && !changes_topology && !changes_hna)
     return;
 
   if (olsr_cnf->debug_level > 0 && olsr_cnf->clear_screen && isatty(1)) {
@@ -203,7 +207,8 @@ olsr_process_changes(void)
     printf("       *** %s ***\n", olsrd_version);
   }
 
-  if (changes_neighborhood) {
+  /* changes_two_hop alone only requires an incremental MPR update */
+  if (changes_neighborhood || changes_two_hop) {
     if (olsr_cnf->lq_level < 1) {
       olsr_calculate_mpr();
     } else {
@@ -239,10 +244,11 @@ olsr_process_changes(void)
   }
 
   for (tmp_pc_list = pcf_list; tmp_pc_list != NULL; tmp_pc_list = tmp_pc_list->next) {
-    tmp_pc_list->function(changes_neighborhood, changes_topology, changes_hna);
+    tmp_pc_list->function(changes_neighborhood || changes_two_hop, changes_topology, changes_hna);
   }
 
   changes_neighborhood = false;
+  changes_two_hop = false;
   changes_topology = false;
   changes_hna = false;
   changes_force = false;
@@ -258,6 +264,7 @@ olsr_init_tables(void)
 {
   changes_topology = false;
   changes_neighborhood = false;
+  changes_two_hop = false;
   changes_hna = false;
 
   /* Set avl tree comparator */
@@ -322,6 +329,7 @@ olsr_forward_message(union olsr_message *m, struct interface_olsr *in_if, union
   struct neighbor_entry *neighbor;
   int msgsize;
   struct interface_olsr *ifn;
+  struct net_fragment *frag;
   bool is_ttl_1 = false;
 
   /*
@@ -378,6 +386,9 @@ olsr_forward_message(union olsr_message *m, struct interface_olsr *in_if, union
   /* Update packet data */
   msgsize = ntohs(m->v4.olsr_msgsize);
 
+  /* the message is the same on all interfaces: store it once and share it */
+  frag = net_fragment_new(m, msgsize);
+
   /* looping trough interfaces */
   for (ifn = ifnet; ifn; ifn = ifn->int_next) {
     /* do not retransmit out through a interface if it has mode == silent */
@@ -393,13 +404,13 @@ olsr_forward_message(union olsr_message *m, struct interface_olsr *in_if, union
       /*
        * Check if message is to big to be piggybacked
        */
-      if (net_outbuffer_push(ifn, m, msgsize) != msgsize) {
+      if (net_outbuffer_push_fragment(ifn, frag) != msgsize) {
         /* Send */
         net_output(ifn);
         /* Buffer message */
         set_buffer_timer(ifn);
 
-        if (net_outbuffer_push(ifn, m, msgsize) != msgsize) {
+        if (net_outbuffer_push_fragment(ifn, frag) != msgsize) {
           OLSR_PRINTF(1, "Received message to big to be forwarded in %s(%d bytes)!", ifn->int_name, msgsize);
           olsr_syslog(OLSR_LOG_ERR, "Received message to big to be forwarded on %s(%d bytes)!", ifn->int_name, msgsize);
         }
@@ -408,12 +419,14 @@ olsr_forward_message(union olsr_message *m, struct interface_olsr *in_if, union
       /* No forwarding pending */
       set_buffer_timer(ifn);
 
-      if (net_outbuffer_push(ifn, m, msgsize) != msgsize) {
+      if (net_outbuffer_push_fragment(ifn, frag) != msgsize) {
         OLSR_PRINTF(1, "Received message to big to be forwarded in %s(%d bytes)!", ifn->int_name, msgsize);
         olsr_syslog(OLSR_LOG_ERR, "Received message to big to be forwarded on %s(%d bytes)!", ifn->int_name, msgsize);
       }
     }
   }
+
+  net_fragment_put(frag);
   return 1;
 }
 
@@ -602,6 +615,11 @@ olsr_malloc(size_t size, const char *id)
    */
   ptr = calloc(1, size);
 
+  if (!ptr && olsr_cookie_shrink_all() > 0) {
+    /* try again after handing the unused slabs back */
+    ptr = calloc(1, size);
+  }
+
   if (!ptr) {
     char buf[1024];
     snprintf(buf, sizeof(buf), "%s: out of memory!: %s\n", id, strerror(errno));
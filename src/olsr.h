@@ -51,9 +51,32 @@
 
 extern bool changes_topology;
 extern bool changes_neighborhood;
+extern bool changes_two_hop;
 extern bool changes_hna;
 extern bool changes_force;
 
+/*
+ * Generation counters of the information repositories, bumped whenever
+ * their content changes (entries added or removed, costs or states
+ * changed; not on mere refreshes). Consumers that cache data derived
+ * from a repository compare them to detect changes. The routing table
+ * has its own counter: routingtree_version.
+ */
+enum olsr_generation_type {
+  OLSR_GEN_LINKS,
+  OLSR_GEN_NEIGHBORS,
+  OLSR_GEN_TOPOLOGY,
+  OLSR_GEN_HNA,
+  OLSR_GEN_MID,
+  OLSR_GEN_COUNT
+};
+
+extern uint32_t olsr_generations[OLSR_GEN_COUNT];
+
+static INLINE void olsr_bump_generation(enum olsr_generation_type type) {
+  olsr_generations[type]++;
+}
+
 extern union olsr_ip_addr all_zero;
 
 void get_argc_argv(int *argc, char **argv[]);
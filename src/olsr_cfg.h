@@ -64,6 +64,8 @@
 #define DEF_IP_VERSION       AF_INET
 #define DEF_POLLRATE         0.05
 #define DEF_NICCHGPOLLRT     2.5
+#define DEF_NICCHGPOLLRT_NL  30.0
+#define DEF_INPUT_BUDGET     32
 #define DEF_WILL_AUTO        false
 #define DEF_WILLINGNESS      3
 #define DEF_ALLOW_NO_INTS    true
@@ -138,6 +140,8 @@
 #define MIN_POLLRATE         0.01
 #define MAX_NICCHGPOLLRT     100.0
 #define MIN_NICCHGPOLLRT     1.0
+#define MAX_INPUT_BUDGET     1024
+#define MIN_INPUT_BUDGET     1
 #define MAX_DEBUGLVL         9
 #define MIN_DEBUGLVL         0
 #define MAX_TOS              252
@@ -308,6 +312,7 @@ struct olsrd_config {
   struct olsr_if *interfaces;
   float pollrate;
   float nic_chgs_pollrate;
+  unsigned int input_budget;
   bool clear_screen;
   uint8_t tc_redundancy;
   uint8_t mpr_coverage;
@@ -49,10 +49,16 @@
 #include "log.h"
 
 #include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
 
 /* Root directory of the cookies we have in the system */
 static struct olsr_cookie_info *cookies[COOKIE_ID_MAX] = { 0 };
 
+/* offset of the first block in a slab */
+#define COOKIE_SLAB_HDR_SIZE \
+  ((sizeof(struct olsr_cookie_slab) + COOKIE_CACHE_LINE - 1) & ~((size_t)COOKIE_CACHE_LINE - 1))
+
 /*
  * Allocate a cookie for the next available cookie id.
  */
@@ -89,22 +95,49 @@ olsr_alloc_cookie(const char *cookie_name, olsr_cookie_type cookie_type)
     ci->ci_name = strdup(cookie_name);
   }
 
-  /* Init the free list */
+  /* Init the slab lists */
   if (cookie_type == OLSR_COOKIE_TYPE_MEMORY) {
-    list_head_init(&ci->ci_free_list);
+    list_head_init(&ci->ci_slabs_partial);
+    list_head_init(&ci->ci_slabs_full);
+    list_head_init(&ci->ci_slabs_empty);
   }
 
   return ci;
 }
 
+/* INLINE to recast from cs_node back to the slab */
+LISTNODE2STRUCT(list2slab, struct olsr_cookie_slab, cs_node);
+
+/*
+ * Hand a slab back to the system.
+ */
+static void
+olsr_cookie_slab_release(struct olsr_cookie_info *ci, struct olsr_cookie_slab *slab)
+{
+  list_remove(&slab->cs_node);
+  ci->ci_free -= ci->ci_slab_blocks - slab->cs_used;
+  ci->ci_slabs--;
+  free(slab);
+}
+
+/*
+ * Free all slabs on a list at once.
+ */
+static void
+olsr_cookie_release_list(struct olsr_cookie_info *ci, struct list_node *head)
+{
+  while (!list_is_empty(head)) {
+    olsr_cookie_slab_release(ci, list2slab(head->next));
+  }
+}
+
 /*
  * Free a cookie that is no longer being used.
+ * All blocks of a memory cookie are freed, even if they are still in use.
  */
 void
 olsr_free_cookie(struct olsr_cookie_info *ci)
 {
-  struct list_node *memory_list;
-
   /* Mark the cookie as unused */
   cookies[ci->ci_id] = NULL;
 
@@ -113,18 +146,53 @@ olsr_free_cookie(struct olsr_cookie_info *ci)
     free(ci->ci_name);
   }
 
-  /* Flush all the memory on the free list */
+  /* Flush all the slabs */
   if (ci->ci_type == OLSR_COOKIE_TYPE_MEMORY) {
-    while (!list_is_empty(&ci->ci_free_list)) {
-      memory_list = ci->ci_free_list.next;
-      list_remove(memory_list);
-      free(memory_list);
-    }
+    olsr_cookie_release_list(ci, &ci->ci_slabs_partial);
+    olsr_cookie_release_list(ci, &ci->ci_slabs_full);
+    olsr_cookie_release_list(ci, &ci->ci_slabs_empty);
   }
 
   free(ci);
 }
 
+/*
+ * Release the unused slabs of a memory cookie.
+ * Returns the number of bytes handed back to the system.
+ */
+size_t
+olsr_cookie_shrink(struct olsr_cookie_info *ci)
+{
+  size_t released;
+
+  if (ci->ci_type != OLSR_COOKIE_TYPE_MEMORY) {
+    return 0;
+  }
+
+  released = ci->ci_slabs_empty_count * ci->ci_slab_size;
+  olsr_cookie_release_list(ci, &ci->ci_slabs_empty);
+  ci->ci_slabs_empty_count = 0;
+  return released;
+}
+
+/*
+ * Release the unused slabs of all cookies, used when
+ * we run short of memory.
+ */
+size_t
+olsr_cookie_shrink_all(void)
+{
+  size_t released = 0;
+  int ci_index;
+
+  for (ci_index = 1; ci_index < COOKIE_ID_MAX; ci_index++) {
+    if (cookies[ci_index]) {
+      released += olsr_cookie_shrink(cookies[ci_index]);
+    }
+  }
+  return released;
+}
+
 /*
  * Flush all cookies. This is really only called upon shutdown.
  */
@@ -145,18 +213,44 @@ olsr_delete_all_cookies(void)
 }
 
 /*
- * Set the size for fixed block allocations.
- * This is only allowed for memory cookies.
+ * Set the size for fixed block allocations and calculate the slab geometry.
+ * This is only allowed for memory cookies without allocated blocks.
+ *
+ * Blocks of at least a cache line are aligned to a cache line, smaller
+ * blocks to the next power of two, so no block straddles two cache lines.
  */
 void
 olsr_cookie_set_memory_size(struct olsr_cookie_info *ci, size_t size)
 {
+  size_t block, stride;
+
   if (!ci) {
     return;
   }
 
   assert(ci->ci_type == OLSR_COOKIE_TYPE_MEMORY);
+  assert(ci->ci_slabs == 0);
   ci->ci_size = size;
+
+  /* the free list pointer is stored in the block, the brand behind it */
+  block = (size < sizeof(void *) ? sizeof(void *) : size) + sizeof(struct olsr_cookie_mem_brand);
+
+  if (block >= COOKIE_CACHE_LINE) {
+    stride = (block + COOKIE_CACHE_LINE - 1) & ~((size_t)COOKIE_CACHE_LINE - 1);
+  } else {
+    stride = sizeof(void *);
+    while (stride < block) {
+      stride <<= 1;
+    }
+  }
+  ci->ci_stride = stride;
+
+  /* a power of two multiple of the page size, so slabs can be found by masking */
+  ci->ci_slab_size = (size_t)sysconf(_SC_PAGESIZE);
+  while ((ci->ci_slab_size - COOKIE_SLAB_HDR_SIZE) / stride < COOKIE_SLAB_MIN_BLOCKS) {
+    ci->ci_slab_size <<= 1;
+  }
+  ci->ci_slab_blocks = (ci->ci_slab_size - COOKIE_SLAB_HDR_SIZE) / stride;
 }
 
 /*
@@ -211,6 +305,61 @@ olsr_cookie_name(olsr_cookie_t cookie_id)
   return unknown;
 }
 
+/*
+ * Return the cookie for a cookie id, or NULL if the id is unused.
+ * Mostly used for exporting the cookie statistics.
+ */
+struct olsr_cookie_info *
+olsr_cookie_get(olsr_cookie_t cookie_id)
+{
+  if (olsr_cookie_valid(cookie_id)) {
+    return cookies[cookie_id];
+  }
+
+  return NULL;
+}
+
+/*
+ * Get a new slab from the system and put all its blocks on its free list.
+ */
+static struct olsr_cookie_slab *
+olsr_cookie_slab_alloc(struct olsr_cookie_info *ci)
+{
+  struct olsr_cookie_slab *slab;
+  unsigned char *block;
+  unsigned int i;
+  void *ptr;
+
+  if (posix_memalign(&ptr, ci->ci_slab_size, ci->ci_slab_size)) {
+
+    /* try again after releasing all unused slabs */
+    olsr_cookie_shrink_all();
+    if (posix_memalign(&ptr, ci->ci_slab_size, ci->ci_slab_size)) {
+      char buf[1024];
+      snprintf(buf, sizeof(buf), "%s: out of memory: %s", ci->ci_name, strerror(errno));
+      olsr_exit(buf, EXIT_FAILURE);
+    }
+  }
+
+  slab = ptr;
+  slab->cs_cookie = ci;
+  slab->cs_used = 0;
+  slab->cs_free = NULL;
+
+  /* chain the blocks, first block first */
+  block = (unsigned char *)slab + COOKIE_SLAB_HDR_SIZE + (ci->ci_slab_blocks - 1) * ci->ci_stride;
+  for (i = 0; i < ci->ci_slab_blocks; i++, block -= ci->ci_stride) {
+    *(void **)(void *)block = slab->cs_free;
+    slab->cs_free = block;
+  }
+
+  list_add_before(&ci->ci_slabs_partial, &slab->cs_node);
+  ci->ci_slabs++;
+  ci->ci_free += ci->ci_slab_blocks;
+
+  return slab;
+}
+
 /*
  * Allocate a fixed amount of memory based on a passed in cookie type.
  */
@@ -219,42 +368,37 @@ olsr_cookie_malloc(struct olsr_cookie_info *ci)
 {
   void *ptr;
   struct olsr_cookie_mem_brand *branding;
-  struct list_node *free_list_node;
+  struct olsr_cookie_slab *slab;
 
-#ifdef OLSR_COOKIE_DEBUG
-  bool reuse = false;
-#endif /* OLSR_COOKIE_DEBUG */
+  assert(ci->ci_stride);
 
   /*
-   * Check first if we have reusable memory.
+   * Fill up partially used slabs first, then reuse an empty slab
+   * before asking the system for a new one.
    */
-  if (!ci->ci_free_list_usage) {
-
-    /*
-     * No reusable memory block on the free_list.
-     */
-    ptr = calloc(1, ci->ci_size + sizeof(struct olsr_cookie_mem_brand));
-
-    if (!ptr) {
-      char buf[1024];
-      snprintf(buf, sizeof(buf), "%s: out of memory: %s", ci->ci_name, strerror(errno));
-      olsr_exit(buf, EXIT_FAILURE);
-    }
-    assert(ptr);
+  if (!list_is_empty(&ci->ci_slabs_partial)) {
+    slab = list2slab(ci->ci_slabs_partial.next);
+  } else if (!list_is_empty(&ci->ci_slabs_empty)) {
+    slab = list2slab(ci->ci_slabs_empty.next);
+    list_remove(&slab->cs_node);
+    list_add_before(&ci->ci_slabs_partial, &slab->cs_node);
+    ci->ci_slabs_empty_count--;
   } else {
+    slab = olsr_cookie_slab_alloc(ci);
+  }
 
-    /*
-     * There is a memory block on the free list.
-     * Carve it out of the list, and clean.
-     */
-    free_list_node = ci->ci_free_list.next;
-    list_remove(free_list_node);
-    ptr = (void *)free_list_node;
-    memset(ptr, 0, ci->ci_size);
-    ci->ci_free_list_usage--;
-#ifdef OLSR_COOKIE_DEBUG
-    reuse = true;
-#endif /* OLSR_COOKIE_DEBUG */
+  /*
+   * Carve the block out of the slab, and clean.
+   */
+  ptr = slab->cs_free;
+  slab->cs_free = *(void **)ptr;
+  slab->cs_used++;
+  ci->ci_free--;
+  memset(ptr, 0, ci->ci_size);
+
+  if (!slab->cs_free) {
+    list_remove(&slab->cs_node);
+    list_add_before(&ci->ci_slabs_full, &slab->cs_node);
   }
 
   /*
@@ -270,7 +414,7 @@ olsr_cookie_malloc(struct olsr_cookie_info *ci)
   olsr_cookie_usage_incr(ci->ci_id);
 
 #ifdef OLSR_COOKIE_DEBUG
-  OLSR_PRINTF(1, "MEMORY: alloc %s, %p, %u bytes%s\n", ci->ci_name, ptr, ci->ci_size, reuse ? ", reuse" : "");
+  OLSR_PRINTF(1, "MEMORY: alloc %s, %p, %lu bytes\n", ci->ci_name, ptr, (unsigned long)ci->ci_size);
 #endif /* OLSR_COOKIE_DEBUG */
 
   return ptr;
@@ -284,11 +428,7 @@ void
 olsr_cookie_free(struct olsr_cookie_info *ci, void *ptr)
 {
   struct olsr_cookie_mem_brand *branding;
-  struct list_node *free_list_node;
-
-#ifdef OLSR_COOKIE_DEBUG
-  bool reuse = false;
-#endif /* OLSR_COOKIE_DEBUG */
+  struct olsr_cookie_slab *slab;
 
   branding = (struct olsr_cookie_mem_brand *)ARM_NOWARN_ALIGN(((unsigned char *)ptr + ci->ci_size));
 
@@ -302,33 +442,41 @@ olsr_cookie_free(struct olsr_cookie_info *ci, void *ptr)
   /* Kill the brand */
   memset(branding, 0, sizeof(*branding));
 
-  /*
-   * Rather than freeing the memory right away, try to reuse at a later
-   * point. Keep at least ten percent of the active used blocks or at least
-   * ten blocks on the free list.
-   */
-  if ((ci->ci_free_list_usage < COOKIE_FREE_LIST_THRESHOLD) || (ci->ci_free_list_usage < ci->ci_usage / COOKIE_FREE_LIST_THRESHOLD)) {
+  /* slabs are aligned to their size */
+  slab = (struct olsr_cookie_slab *)(void *)((uintptr_t)ptr & ~((uintptr_t)ci->ci_slab_size - 1));
+  assert(slab->cs_cookie == ci);
 
-    free_list_node = (struct list_node *)ptr;
-    list_node_init(free_list_node);
-    list_add_before(&ci->ci_free_list, free_list_node);
-    ci->ci_free_list_usage++;
-#ifdef OLSR_COOKIE_DEBUG
-    reuse = true;
-#endif /* OLSR_COOKIE_DEBUG */
-  } else {
+  if (!slab->cs_free) {
+    /* slab was full */
+    list_remove(&slab->cs_node);
+    list_add_before(&ci->ci_slabs_partial, &slab->cs_node);
+  }
+
+  *(void **)ptr = slab->cs_free;
+  slab->cs_free = ptr;
+  slab->cs_used--;
+  ci->ci_free++;
+
+  if (!slab->cs_used) {
 
     /*
-     * No interest in reusing memory.
+     * Rather than freeing the slab right away, try to reuse it at a later
+     * point. Keep one empty slab, or up to ten percent of all slabs.
      */
-    free(ptr);
+    if (ci->ci_slabs_empty_count < 1 || ci->ci_slabs_empty_count < ci->ci_slabs / COOKIE_FREE_LIST_THRESHOLD) {
+      list_remove(&slab->cs_node);
+      list_add_before(&ci->ci_slabs_empty, &slab->cs_node);
+      ci->ci_slabs_empty_count++;
+    } else {
+      olsr_cookie_slab_release(ci, slab);
+    }
   }
 
   /* Stats keeping */
   olsr_cookie_usage_decr(ci->ci_id);
 
 #ifdef OLSR_COOKIE_DEBUG
-  OLSR_PRINTF(1, "MEMORY: free %s, %p, %u bytes%s\n", ci->ci_name, ptr, ci->ci_size, reuse ? ", reuse" : "");
+  OLSR_PRINTF(1, "MEMORY: free %s, %p, %lu bytes\n", ci->ci_name, ptr, (unsigned long)ci->ci_size);
 #endif /* OLSR_COOKIE_DEBUG */
 
 }
@@ -62,6 +62,10 @@ typedef enum olsr_cookie_type_ {
  * This is a cookie. A cookie is a tool aimed for olsrd developers.
  * It is used for tracking resource usage in the system and also
  * for locating memory corruption.
+ *
+ * Memory cookies are slab allocators: blocks are carved out of
+ * page sized slabs, which are handed back to the system once they
+ * are completely unused.
  */
 struct olsr_cookie_info {
   olsr_cookie_t ci_id;                 /* ID */
@@ -70,11 +74,36 @@ struct olsr_cookie_info {
   size_t ci_size;                      /* Fixed size for block allocations */
   unsigned int ci_usage;               /* Stats, resource usage */
   unsigned int ci_changes;             /* Stats, resource churn */
-  struct list_node ci_free_list;       /* List head for recyclable blocks */
-  unsigned int ci_free_list_usage;     /* Length of free list */
+  unsigned int ci_timer_walks;         /* Stats, timers touched by the timer wheel */
+  unsigned int ci_timer_fires;         /* Stats, timers fired */
+
+  /* slab geometry, set by olsr_cookie_set_memory_size() */
+  size_t ci_stride;                    /* Distance between blocks, incl. brand */
+  size_t ci_slab_size;                 /* Size and alignment of a slab */
+  unsigned int ci_slab_blocks;         /* Blocks per slab */
+
+  struct list_node ci_slabs_partial;   /* Slabs with used and free blocks */
+  struct list_node ci_slabs_full;      /* Slabs without free blocks */
+  struct list_node ci_slabs_empty;     /* Unused slabs kept for reuse */
+  unsigned int ci_slabs;               /* Stats, number of slabs */
+  unsigned int ci_slabs_empty_count;   /* Length of ci_slabs_empty */
+  unsigned int ci_free;                /* Stats, free blocks in all slabs */
 };
 
-#define COOKIE_FREE_LIST_THRESHOLD 10   /* Blocks / Percent  */
+#define COOKIE_FREE_LIST_THRESHOLD 10   /* Percent of the slabs kept when empty */
+#define COOKIE_SLAB_MIN_BLOCKS      8   /* Grow slabs beyond a page to hold this many blocks */
+#define COOKIE_CACHE_LINE          64   /* Blocks are placed so they do not straddle cache lines */
+
+/*
+ * Header at the start of every slab, the blocks follow
+ * at the next cache line.
+ */
+struct olsr_cookie_slab {
+  struct list_node cs_node;            /* On one of the slab lists of the cookie */
+  struct olsr_cookie_info *cs_cookie;  /* Owner */
+  void *cs_free;                       /* Singly linked list of free blocks */
+  unsigned int cs_used;                /* Blocks handed out */
+};
 
 /*
  * Small brand which gets appended on the end of every block allocation.
@@ -90,12 +119,15 @@ extern struct olsr_cookie_info *olsr_alloc_cookie(const char *, olsr_cookie_type
 extern void olsr_free_cookie(struct olsr_cookie_info *);
 extern void olsr_delete_all_cookies(void);
 extern char *olsr_cookie_name(olsr_cookie_t);
+extern struct olsr_cookie_info *olsr_cookie_get(olsr_cookie_t);
 extern void olsr_cookie_set_memory_size(struct olsr_cookie_info *, size_t);
 extern void olsr_cookie_usage_incr(olsr_cookie_t);
 extern void olsr_cookie_usage_decr(olsr_cookie_t);
 
 extern void *olsr_cookie_malloc(struct olsr_cookie_info *);
 extern void olsr_cookie_free(struct olsr_cookie_info *, void *);
+extern size_t olsr_cookie_shrink(struct olsr_cookie_info *);
+extern size_t olsr_cookie_shrink_all(void);
 
 #endif /* _OLSR_COOKIE_H */
 
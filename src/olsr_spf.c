@@ -47,9 +47,9 @@
  * Implementation of Dijkstras algorithm. Initially all nodes
  * are initialized to infinite cost. First we put ourselves
  * on the heap of reachable nodes. Our heap implementation
- * is based on an AVL tree which gives interesting performance
- * characteristics for the frequent operations of minimum key
- * extraction and re-keying. Next all neighbors of a node are
+ * is a pairing heap which gives constant time insertion and
+ * re-keying and logarithmic minimum key extraction, the two
+ * most frequent operations. Next all neighbors of a node are
  * explored and put on the heap if the cost of reaching them is
  * better than reaching the current candidate node.
  * The SPF calculation is terminated if there are no more nodes
@@ -68,6 +68,7 @@
 #include "hna_set.h"
 #include "common/list.h"
 #include "common/avl.h"
+#include "common/heap.h"
 #include "olsr_spf.h"
 #include "net_olsr.h"
 #include "lq_plugin.h"
@@ -79,8 +80,24 @@
 
 struct timer_entry *spf_backoff_timer = NULL;
 
+/* vertex pairs whose connecting edges changed since the last SPF run */
+static struct spf_change {
+  struct tc_entry *tc1;
+  struct tc_entry *tc2;
+} spf_changes[SPF_MAX_CHANGES];
+static int spf_change_count;
+
+/* true if the next SPF run cannot be incremental */
+static bool spf_full_needed = true;
+static uint32_t spf_next_full;
+
+#ifdef SPF_PROFILING
+/* candidate heap operations of the current SPF run */
+static unsigned int spf_heap_inserts, spf_heap_decreases, spf_heap_extracts;
+#endif /* SPF_PROFILING */
+
 /*
- * avl_comp_etx
+ * heap_comp_etx
  *
  * compare two etx metrics.
  * return 0 if there is an exact match and
@@ -89,7 +106,7 @@ struct timer_entry *spf_backoff_timer = NULL;
  * after compiler optimization.
  */
 static int
-avl_comp_etx(const void *etx1, const void *etx2)
+heap_comp_etx(const void *etx1, const void *etx2)
 {
   if (*(const olsr_linkcost *)etx1 < *(const olsr_linkcost *)etx2) {
     return -1;
@@ -103,46 +120,55 @@ avl_comp_etx(const void *etx1, const void *etx2)
 }
 
 /*
- * olsr_spf_add_cand_tree
+ * olsr_spf_add_cand_heap
  *
- * Key an existing vertex to a candidate tree.
+ * Key an existing vertex to a candidate heap.
  */
 static void
-olsr_spf_add_cand_tree(struct avl_tree *tree, struct tc_entry *tc)
+olsr_spf_add_cand_heap(struct heap *heap, struct tc_entry *tc)
 {
 #if !defined(NODEBUG) && defined(DEBUG)
   struct ipaddr_str buf;
   struct lqtextbuffer lqbuffer;
 #endif /* !defined(NODEBUG) && defined(DEBUG) */
-  tc->cand_tree_node.key = &tc->path_cost;
+  tc->cand_heap_node.key = &tc->path_cost;
 
 #ifdef DEBUG
   OLSR_PRINTF(2, "SPF: insert candidate %s, cost %s\n", olsr_ip_to_string(&buf, &tc->addr),
               get_linkcost_text(tc->path_cost, true, &lqbuffer));
 #endif /* DEBUG */
 
-  avl_insert(tree, &tc->cand_tree_node, AVL_DUP);
+#ifdef SPF_PROFILING
+  spf_heap_inserts++;
+#endif /* SPF_PROFILING */
+
+  heap_insert(heap, &tc->cand_heap_node);
 }
 
 /*
- * olsr_spf_del_cand_tree
+ * olsr_spf_rekey_cand_heap
  *
- * Unkey an existing vertex from a candidate tree.
+ * Move a vertex up in the candidate heap after its
+ * path cost has been lowered.
  */
 static void
-olsr_spf_del_cand_tree(struct avl_tree *tree, struct tc_entry *tc)
+olsr_spf_rekey_cand_heap(struct heap *heap, struct tc_entry *tc)
 {
-
-#ifdef DEBUG
-#ifndef NODEBUG
+#if !defined(NODEBUG) && defined(DEBUG)
   struct ipaddr_str buf;
   struct lqtextbuffer lqbuffer;
-#endif /* NODEBUG */
-  OLSR_PRINTF(2, "SPF: delete candidate %s, cost %s\n", olsr_ip_to_string(&buf, &tc->addr),
+#endif /* !defined(NODEBUG) && defined(DEBUG) */
+
+#ifdef DEBUG
+  OLSR_PRINTF(2, "SPF: rekey candidate %s, cost %s\n", olsr_ip_to_string(&buf, &tc->addr),
               get_linkcost_text(tc->path_cost, true, &lqbuffer));
 #endif /* DEBUG */
 
-  avl_delete(tree, &tc->cand_tree_node);
+#ifdef SPF_PROFILING
+  spf_heap_decreases++;
+#endif /* SPF_PROFILING */
+
+  heap_decrease_key(heap, &tc->cand_heap_node);
 }
 
 /*
@@ -172,27 +198,31 @@ olsr_spf_add_path_list(struct list_node *head, int *path_count, struct tc_entry
 /*
  * olsr_spf_extract_best
  *
- * return the node with the minimum pathcost.
+ * remove and return the node with the minimum pathcost.
  */
 static struct tc_entry *
-olsr_spf_extract_best(struct avl_tree *tree)
+olsr_spf_extract_best(struct heap *heap)
 {
-  struct avl_node *node = avl_walk_first(tree);
+#ifdef SPF_PROFILING
+  if (!heap_is_empty(heap)) {
+    spf_heap_extracts++;
+  }
+#endif /* SPF_PROFILING */
 
-  return (node ? cand_tree2tc(node) : NULL);
+  return cand_heap2tc(heap_extract_min(heap));
 }
 
 /*
- * olsr_spf_relax
+ * olsr_spf_relax_edge
  *
- * Explore all edges of a node and add the node
- * to the candidate tree if the if the aggregate
- * path cost is better.
+ * Check if the path through a vertex and one of its edges is
+ * better than the current path to the destination of the edge,
+ * and if so, put the destination on the candidate heap.
  */
 static void
-olsr_spf_relax(struct avl_tree *cand_tree, struct tc_entry *tc)
+olsr_spf_relax_edge(struct heap *cand_heap, struct tc_entry *tc, struct tc_edge_entry *tc_edge)
 {
-  struct avl_node *edge_node;
+  struct tc_entry *new_tc;
   olsr_linkcost new_cost;
 
 #ifdef DEBUG
@@ -200,79 +230,93 @@ olsr_spf_relax(struct avl_tree *cand_tree, struct tc_entry *tc)
   struct ipaddr_str buf, nbuf;
   struct lqtextbuffer lqbuffer;
 #endif /* NODEBUG */
-  OLSR_PRINTF(2, "SPF: exploring node %s, cost %s\n", olsr_ip_to_string(&buf, &tc->addr),
-              get_linkcost_text(tc->path_cost, true, &lqbuffer));
 #endif /* DEBUG */
 
   /*
-   * loop through all edges of this vertex.
+   * We are not interested in dead-end edges.
    */
-  for (edge_node = avl_walk_first(&tc->edge_tree); edge_node; edge_node = avl_walk_next(edge_node)) {
-
-    struct tc_entry *new_tc;
-    struct tc_edge_entry *tc_edge = edge_tree2tc_edge(edge_node);
-
-    /*
-     * We are not interested in dead-end edges.
-     */
-    if (!tc_edge->edge_inv) {
+  if (!tc_edge->edge_inv) {
 #ifdef DEBUG
-      OLSR_PRINTF(2, "SPF:   ignoring edge %s\n", olsr_ip_to_string(&buf, &tc_edge->T_dest_addr));
-      if (!tc_edge->edge_inv) {
-        OLSR_PRINTF(2, "SPF:     no inverse edge\n");
-      }
+    OLSR_PRINTF(2, "SPF:   ignoring edge %s\n", olsr_ip_to_string(&buf, &tc_edge->T_dest_addr));
+    OLSR_PRINTF(2, "SPF:     no inverse edge\n");
 #endif /* DEBUG */
-      continue;
-    }
+    return;
+  }
 
-    if (tc_edge->cost >= LINK_COST_BROKEN) {
+  if (tc_edge->cost >= LINK_COST_BROKEN) {
 #ifdef DEBUG
-      OLSR_PRINTF(2, "SPF:   ignore edge %s (broken)\n", olsr_ip_to_string(&buf, &tc_edge->T_dest_addr));
+    OLSR_PRINTF(2, "SPF:   ignore edge %s (broken)\n", olsr_ip_to_string(&buf, &tc_edge->T_dest_addr));
 #endif /* DEBUG */
-      continue;
-    }
-    /*
-     * total quality of the path through this vertex
-     * to the destination of this edge
-     */
-    new_cost = tc->path_cost + tc_edge->cost;
+    return;
+  }
+  /*
+   * total quality of the path through this vertex
+   * to the destination of this edge
+   */
+  new_cost = tc->path_cost + tc_edge->cost;
 
 #ifdef DEBUG
-    OLSR_PRINTF(2, "SPF:   exploring edge %s, cost %s\n", olsr_ip_to_string(&buf, &tc_edge->T_dest_addr),
-                get_linkcost_text(new_cost, true, &lqbuffer));
+  OLSR_PRINTF(2, "SPF:   exploring edge %s, cost %s\n", olsr_ip_to_string(&buf, &tc_edge->T_dest_addr),
+              get_linkcost_text(new_cost, true, &lqbuffer));
 #endif /* DEBUG */
 
-    /*
-     * if it's better than the current path quality of this edge's
-     * destination node, then we've found a better path to this node.
-     */
-    new_tc = tc_edge->edge_inv->tc;
+  /*
+   * if it's better than the current path quality of this edge's
+   * destination node, then we've found a better path to this node.
+   */
+  new_tc = tc_edge->edge_inv->tc;
 
-    if (new_cost < new_tc->path_cost) {
+  if (new_cost < new_tc->path_cost) {
 
-      /* if this node has been on the candidate tree delete it */
-      if (new_tc->path_cost < ROUTE_COST_BROKEN) {
-        olsr_spf_del_cand_tree(cand_tree, new_tc);
-      }
+    /* if this node is already on the candidate heap move it up, otherwise insert it */
+    new_tc->path_cost = new_cost;
+    if (heap_is_member(cand_heap, &new_tc->cand_heap_node)) {
+      olsr_spf_rekey_cand_heap(cand_heap, new_tc);
+    } else {
+      olsr_spf_add_cand_heap(cand_heap, new_tc);
+    }
 
-      /* re-insert on candidate tree with the better metric */
-      new_tc->path_cost = new_cost;
-      olsr_spf_add_cand_tree(cand_tree, new_tc);
+    /* pull-up the next-hop and bump the hop count */
+    new_tc->next_hop = tc == tc_myself ? new_tc->neigh_link : tc->next_hop;
+    new_tc->hops = tc->hops + 1;
+    new_tc->spf_parent = tc;
 
-      /* pull-up the next-hop and bump the hop count */
-      if (tc->next_hop) {
-        new_tc->next_hop = tc->next_hop;
-      }
-      new_tc->hops = tc->hops + 1;
+#ifdef DEBUG
+    OLSR_PRINTF(2, "SPF:   better path to %s, cost %s, via %s, hops %u\n", olsr_ip_to_string(&buf, &new_tc->addr),
+                get_linkcost_text(new_cost, true, &lqbuffer), new_tc->next_hop ? olsr_ip_to_string(&nbuf,
+                                                                                               &new_tc->next_hop->neighbor_iface_addr)
+                : "<none>", new_tc->hops);
+#endif /* DEBUG */
+
+  }
+}
+
+/*
+ * olsr_spf_relax
+ *
+ * Explore all edges of a node and add the node
+ * to the candidate heap if the if the aggregate
+ * path cost is better.
+ */
+static void
+olsr_spf_relax(struct heap *cand_heap, struct tc_entry *tc)
+{
+  struct avl_node *edge_node;
 
 #ifdef DEBUG
-      OLSR_PRINTF(2, "SPF:   better path to %s, cost %s, via %s, hops %u\n", olsr_ip_to_string(&buf, &new_tc->addr),
-                  get_linkcost_text(new_cost, true, &lqbuffer), tc->next_hop ? olsr_ip_to_string(&nbuf,
-                                                                                                 &tc->next_hop->neighbor_iface_addr)
-                  : "<none>", new_tc->hops);
+#ifndef NODEBUG
+  struct ipaddr_str buf;
+  struct lqtextbuffer lqbuffer;
+#endif /* NODEBUG */
+  OLSR_PRINTF(2, "SPF: exploring node %s, cost %s\n", olsr_ip_to_string(&buf, &tc->addr),
+              get_linkcost_text(tc->path_cost, true, &lqbuffer));
 #endif /* DEBUG */
 
-    }
+  /*
+   * loop through all edges of this vertex.
+   */
+  for (edge_node = avl_walk_first(&tc->edge_tree); edge_node; edge_node = avl_walk_next(edge_node)) {
+    olsr_spf_relax_edge(cand_heap, tc, edge_tree2tc_edge(edge_node));
   }
 }
 
@@ -281,33 +325,281 @@ olsr_spf_relax(struct avl_tree *cand_tree, struct tc_entry *tc)
  *
  * Run the Dijkstra algorithm.
  *
- * A node gets added to the candidate tree when one of its edges has
+ * A node gets added to the candidate heap when one of its edges has
  * an overall better root path cost than the node itself.
- * The node with the shortest metric gets moved from the candidate to
- * the path list every pass.
+ * The node with the shortest metric gets moved from the candidate heap
+ * to the path list every pass.
  * The SPF computation is completed when there are no more nodes
- * on the candidate tree.
+ * on the candidate heap.
  */
 static void
-olsr_spf_run_full(struct avl_tree *cand_tree, struct list_node *path_list, int *path_count)
+olsr_spf_run_full(struct heap *cand_heap, struct list_node *path_list, int *path_count)
 {
   struct tc_entry *tc;
 
   *path_count = 0;
 
-  while ((tc = olsr_spf_extract_best(cand_tree))) {
+  while ((tc = olsr_spf_extract_best(cand_heap))) {
 
-    olsr_spf_relax(cand_tree, tc);
+    olsr_spf_relax(cand_heap, tc);
 
     /*
-     * move the best path from the candidate tree
+     * move the best path from the candidate heap
      * to the path list.
      */
-    olsr_spf_del_cand_tree(cand_tree, tc);
     olsr_spf_add_path_list(path_list, path_count, tc);
   }
 }
 
+/*
+ * olsr_spf_edge_changed
+ *
+ * Record that an edge between two vertices was added, removed or
+ * changed its cost, so that the next SPF run can be incremental.
+ */
+void
+olsr_spf_edge_changed(struct tc_entry *tc1, struct tc_entry *tc2)
+{
+  if (spf_full_needed) {
+    return;
+  }
+
+  if (spf_change_count == SPF_MAX_CHANGES) {
+    olsr_spf_force_full();
+    return;
+  }
+
+  spf_changes[spf_change_count].tc1 = tc1;
+  spf_changes[spf_change_count].tc2 = tc2;
+  spf_change_count++;
+}
+
+/*
+ * olsr_spf_force_full
+ *
+ * Make the next SPF run a full one, e.g. because a vertex that
+ * might be referenced by the SPF results is removed.
+ */
+void
+olsr_spf_force_full(void)
+{
+  spf_full_needed = true;
+  spf_change_count = 0;
+}
+
+/*
+ * olsr_spf_drop_neighbor
+ *
+ * Flush our edge to a neighbor that goes away and forget the link
+ * that was used to reach it, so no SPF result keeps pointing to it.
+ */
+void
+olsr_spf_drop_neighbor(union olsr_ip_addr *main_addr)
+{
+  struct tc_edge_entry *tc_edge;
+  struct tc_entry *tc;
+
+  if (!tc_myself) {
+    return;
+  }
+
+  tc = olsr_lookup_tc_entry(main_addr);
+  tc_edge = olsr_lookup_tc_edge(tc_myself, main_addr);
+  if (tc_edge) {
+    olsr_delete_tc_edge_entry(tc_edge);
+  }
+  if (tc && tc->neigh_link) {
+    tc->neigh_link = NULL;
+    olsr_spf_edge_changed(tc_myself, tc);
+  }
+}
+
+/*
+ * olsr_spf_invalidate_subtree
+ *
+ * Reset a vertex and all vertices whose shortest path runs
+ * through it. The reset vertices are appended to the list.
+ */
+static void
+olsr_spf_invalidate_subtree(struct list_node *invalid_list, struct tc_entry *root)
+{
+  struct list_node *node;
+
+  if (root->path_cost == ROUTE_COST_BROKEN || root == tc_myself) {
+    /* not reachable before or already invalidated */
+    return;
+  }
+
+  root->path_cost = ROUTE_COST_BROKEN;
+  list_add_before(invalid_list, &root->path_list_node);
+
+  /* the list doubles as queue for a breadth first walk of the subtree */
+  for (node = &root->path_list_node; node != invalid_list; node = node->next) {
+    struct tc_entry *tc = pathlist2tc(node);
+    struct avl_node *edge_node;
+
+    for (edge_node = avl_walk_first(&tc->edge_tree); edge_node; edge_node = avl_walk_next(edge_node)) {
+      struct tc_edge_entry *tc_edge = edge_tree2tc_edge(edge_node);
+      struct tc_entry *child;
+
+      if (!tc_edge->edge_inv) {
+        continue;
+      }
+
+      child = tc_edge->edge_inv->tc;
+      if (child->spf_parent == tc && child->path_cost != ROUTE_COST_BROKEN) {
+        child->path_cost = ROUTE_COST_BROKEN;
+        list_add_before(invalid_list, &child->path_list_node);
+      }
+    }
+  }
+}
+
+/*
+ * olsr_spf_run_incremental
+ *
+ * Repair the results of the last SPF run after the recorded edge
+ * changes.
+ *
+ * Every vertex whose shortest path used a changed edge is reset
+ * together with its subtree. The reset vertices are then seeded
+ * with the best path through their (still valid) neighbors, and
+ * both ends of each changed edge are relaxed over it, which covers
+ * cost decreases and new edges. The normal Dijkstra loop then only
+ * propagates the vertices that got a new path cost.
+ */
+static void
+olsr_spf_run_incremental(struct heap *cand_heap)
+{
+  struct list_node invalid_list;
+  struct tc_entry *tc;
+  struct tc_edge_entry *tc_edge;
+  int i;
+
+  list_head_init(&invalid_list);
+
+  for (i = 0; i < spf_change_count; i++) {
+    struct tc_entry *tc1 = spf_changes[i].tc1;
+    struct tc_entry *tc2 = spf_changes[i].tc2;
+
+    if (tc2->spf_parent == tc1) {
+      olsr_spf_invalidate_subtree(&invalid_list, tc2);
+    }
+    if (tc1->spf_parent == tc2) {
+      olsr_spf_invalidate_subtree(&invalid_list, tc1);
+    }
+  }
+
+  /* find the best remaining path for the invalidated vertices */
+  while (!list_is_empty(&invalid_list)) {
+    struct avl_node *edge_node;
+
+    tc = pathlist2tc(invalid_list.next);
+    list_remove(&tc->path_list_node);
+
+    tc->next_hop = NULL;
+    tc->spf_parent = NULL;
+    tc->hops = 0;
+
+    for (edge_node = avl_walk_first(&tc->edge_tree); edge_node; edge_node = avl_walk_next(edge_node)) {
+      tc_edge = edge_tree2tc_edge(edge_node);
+
+      if (tc_edge->edge_inv && tc_edge->edge_inv->tc->path_cost != ROUTE_COST_BROKEN) {
+        olsr_spf_relax_edge(cand_heap, tc_edge->edge_inv->tc, tc_edge->edge_inv);
+      }
+    }
+  }
+
+  /* relax the changed edges in both directions */
+  for (i = 0; i < spf_change_count; i++) {
+    struct tc_entry *tc1 = spf_changes[i].tc1;
+    struct tc_entry *tc2 = spf_changes[i].tc2;
+
+    if (tc1->path_cost != ROUTE_COST_BROKEN && (tc_edge = olsr_lookup_tc_edge(tc1, &tc2->addr)) != NULL) {
+      olsr_spf_relax_edge(cand_heap, tc1, tc_edge);
+    }
+    if (tc2->path_cost != ROUTE_COST_BROKEN && (tc_edge = olsr_lookup_tc_edge(tc2, &tc1->addr)) != NULL) {
+      olsr_spf_relax_edge(cand_heap, tc2, tc_edge);
+    }
+  }
+
+  while ((tc = olsr_spf_extract_best(cand_heap))) {
+    olsr_spf_relax(cand_heap, tc);
+  }
+}
+
+/*
+ * olsr_spf_reset
+ *
+ * Initialize vertices in the lsdb for a full SPF run.
+ */
+static void
+olsr_spf_reset(void)
+{
+  struct tc_entry *tc;
+
+  OLSR_FOR_ALL_TC_ENTRIES(tc) {
+    tc->next_hop = NULL;
+    tc->spf_parent = NULL;
+    tc->path_cost = ROUTE_COST_BROKEN;
+    tc->hops = 0;
+  }
+  OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+}
+
+#ifdef SPF_CHECK_INCREMENTAL
+/*
+ * olsr_spf_check_incremental
+ *
+ * Compare the result of an incremental SPF run with a full run.
+ * The results of the full run are kept.
+ */
+static void
+olsr_spf_check_incremental(struct heap *cand_heap)
+{
+  struct list_node path_list;
+  struct tc_entry *tc;
+  olsr_linkcost *costs;
+  int count = 0, i = 0, errors = 0;
+
+  OLSR_FOR_ALL_TC_ENTRIES(tc) {
+    count++;
+  }
+  OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+
+  costs = olsr_malloc(sizeof(*costs) * (count + 1), "SPF check");
+  OLSR_FOR_ALL_TC_ENTRIES(tc) {
+    costs[i++] = tc->path_cost;
+  }
+  OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+
+  olsr_spf_reset();
+  tc_myself->path_cost = ZERO_ROUTE_COST;
+  olsr_spf_add_cand_heap(cand_heap, tc_myself);
+  list_head_init(&path_list);
+  olsr_spf_run_full(cand_heap, &path_list, &count);
+  while (!list_is_empty(&path_list)) {
+    list_remove(path_list.next);
+  }
+
+  i = 0;
+  OLSR_FOR_ALL_TC_ENTRIES(tc) {
+    if (costs[i++] != tc->path_cost) {
+      struct ipaddr_str buf;
+      struct lqtextbuffer lqbuffer1, lqbuffer2;
+
+      OLSR_PRINTF(1, "SPF: incremental run mismatch for %s: %s, full run %s\n", olsr_ip_to_string(&buf, &tc->addr),
+                  get_linkcost_text(costs[i - 1], true, &lqbuffer1), get_linkcost_text(tc->path_cost, true, &lqbuffer2));
+      errors++;
+    }
+  }
+  OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+
+  OLSR_PRINTF(1, "SPF: incremental run checked, %d mismatches\n", errors);
+  free(costs);
+}
+#endif /* SPF_CHECK_INCREMENTAL */
+
 /**
  * Callback for the SPF backoff timer.
  */
@@ -335,7 +627,7 @@ olsr_calculate_routing_table(bool force)
 #ifdef SPF_PROFILING
   struct timespec t1, t2, t3, t4, t5, spf_init, spf_run, route, kernel, total;
 #endif /* SPF_PROFILING */
-  struct avl_tree cand_tree;
+  struct heap cand_heap;
   struct avl_node *rtp_tree_node;
   struct list_node path_list;          /* head of the path_list */
   struct tc_entry *tc;
@@ -344,6 +636,7 @@ olsr_calculate_routing_table(bool force)
   struct neighbor_entry *neigh;
   struct link_entry *link;
   int path_count = 0;
+  bool full;
 
   /* We are done if our backoff timer is running */
   if (!force) {
@@ -357,25 +650,16 @@ olsr_calculate_routing_table(bool force)
 
 #ifdef SPF_PROFILING
   clock_gettime(CLOCK_MONOTONIC, &t1);
+  spf_heap_inserts = spf_heap_decreases = spf_heap_extracts = 0;
 #endif /* SPF_PROFILING */
 
   /*
-   * Prepare the candidate tree and result list.
+   * Prepare the candidate heap and result list.
    */
-  avl_init(&cand_tree, avl_comp_etx);
+  heap_init(&cand_heap, heap_comp_etx);
   list_head_init(&path_list);
   olsr_bump_routingtree_version();
 
-  /*
-   * Initialize vertices in the lsdb.
-   */
-  OLSR_FOR_ALL_TC_ENTRIES(tc) {
-    tc->next_hop = NULL;
-    tc->path_cost = ROUTE_COST_BROKEN;
-    tc->hops = 0;
-  }
-  OLSR_FOR_ALL_TC_ENTRIES_END(tc);
-
   /*
    * Check if there was a change in the main IP address.
    * Bail if there is no main IP address.
@@ -392,10 +676,17 @@ olsr_calculate_routing_table(bool force)
   }
 
   /*
-   * zero ourselves and add us to the candidate tree.
+   * flush edges to neighbours that are gone, e.g. after a change
+   * of their main address, before their links are referenced.
    */
-  tc_myself->path_cost = ZERO_ROUTE_COST;
-  olsr_spf_add_cand_tree(&cand_tree, tc_myself);
+  OLSR_FOR_ALL_TC_EDGE_ENTRIES(tc_myself, tc_edge) {
+    if (!olsr_lookup_neighbor_table(&tc_edge->T_dest_addr)) {
+      union olsr_ip_addr addr = tc_edge->T_dest_addr;
+
+      olsr_spf_drop_neighbor(&addr);
+    }
+  }
+  OLSR_FOR_ALL_TC_EDGE_ENTRIES_END(tc_myself, tc_edge);
 
   /*
    * add edges to and from our neighbours.
@@ -444,12 +735,19 @@ olsr_calculate_routing_table(bool force)
         olsr_calc_tc_edge_entry_etx(tc_edge);
       }
       if (tc_edge->edge_inv) {
-        tc_edge->edge_inv->tc->next_hop = link;
+        tc = tc_edge->edge_inv->tc;
+        if (tc->neigh_link != link) {
+          /* the next-hop of the whole subtree changes */
+          tc->neigh_link = link;
+          olsr_spf_edge_changed(tc_myself, tc);
+        }
       }
     }
   }
   OLSR_FOR_ALL_NBR_ENTRIES_END(neigh);
 
+  full = force || spf_full_needed || TIMED_OUT(spf_next_full);
+
 #ifdef SPF_PROFILING
   clock_gettime(CLOCK_MONOTONIC, &t2);
 #endif /* SPF_PROFILING */
@@ -457,7 +755,34 @@ olsr_calculate_routing_table(bool force)
   /*
    * Run the SPF calculation.
    */
-  olsr_spf_run_full(&cand_tree, &path_list, &path_count);
+  if (full) {
+    olsr_spf_reset();
+
+    /*
+     * zero ourselves and add us to the candidate heap.
+     */
+    tc_myself->path_cost = ZERO_ROUTE_COST;
+    olsr_spf_add_cand_heap(&cand_heap, tc_myself);
+
+    olsr_spf_run_full(&cand_heap, &path_list, &path_count);
+
+    spf_next_full = GET_TIMESTAMP(SPF_FULL_INTERVAL);
+  } else {
+    olsr_spf_run_incremental(&cand_heap);
+#ifdef SPF_CHECK_INCREMENTAL
+    olsr_spf_check_incremental(&cand_heap);
+#endif /* SPF_CHECK_INCREMENTAL */
+
+    /* all reachable vertices make up the path list */
+    OLSR_FOR_ALL_TC_ENTRIES(tc) {
+      if (tc->path_cost != ROUTE_COST_BROKEN) {
+        olsr_spf_add_path_list(&path_list, &path_count, tc);
+      }
+    }
+    OLSR_FOR_ALL_TC_ENTRIES_END(tc);
+  }
+  spf_full_needed = false;
+  spf_change_count = 0;
 
   OLSR_PRINTF(2, "\n--- %s ------------------------------------------------- DIJKSTRA\n\n", olsr_wallclock_string());
 
@@ -549,6 +874,11 @@ olsr_calculate_routing_table(bool force)
       (long int) spf_run.tv_nsec, //
       (long int) route.tv_nsec, //
       (long int) kernel.tv_nsec);
+  OLSR_PRINTF(1, "--- SPF-heap operations in %s run (insert/decrease/extract): %u, %u, %u\n", //
+      full ? "full" : "incremental", //
+      spf_heap_inserts, //
+      spf_heap_decreases, //
+      spf_heap_extracts);
 #endif /* SPF_PROFILING */
 }
 
@@ -46,8 +46,30 @@
 #ifndef _OLSR_SPF_H
 #define _OLSR_SPF_H
 
+struct tc_entry;
+union olsr_ip_addr;
+
+/*
+ * Changes of single edges are handled by an incremental SPF run,
+ * which only repairs the part of the shortest path tree they affect.
+ * A full run is done at least every SPF_FULL_INTERVAL milliseconds,
+ * when vertices are removed or after more than SPF_MAX_CHANGES
+ * edge changes.
+ *
+ * Define SPF_CHECK_INCREMENTAL to verify every incremental run
+ * against a full run.
+ */
+#define SPF_FULL_INTERVAL 60000
+#define SPF_MAX_CHANGES 64
+
 void olsr_calculate_routing_table(bool force);
 
+void olsr_spf_edge_changed(struct tc_entry *, struct tc_entry *);
+
+void olsr_spf_force_full(void);
+
+void olsr_spf_drop_neighbor(union olsr_ip_addr *);
+
 #endif /* _OLSR_SPF_H */
 
 /*
@@ -306,7 +306,7 @@ olsr_free_tc_packet(struct tc_message *message)
   while (mprs != NULL) {
     struct tc_mpr_addr *prev_mprs = mprs;
     mprs = mprs->next;
-    free(prev_mprs);
+    olsr_free_tc_mpr_addr(prev_mprs);
   }
 }
 
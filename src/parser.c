@@ -58,6 +58,12 @@
 #include "net_olsr.h"
 #include "duplicate_handler.h"
 
+#include <time.h>
+
+#ifdef __MACH__
+#include "mach/clock_gettime.h"
+#endif /* __MACH__ */
+
 #ifdef _WIN32
 #undef EWOULDBLOCK
 #define EWOULDBLOCK WSAEWOULDBLOCK
@@ -76,7 +82,14 @@ char *StrError(unsigned int ErrNo);
 
 unsigned int cpu_overload_exit = 0;
 
-struct parse_function_entry *parse_functions;
+/* parse functions registered for one message type, indexed by the type */
+static struct parse_function_entry *parse_functions[PARSER_TYPES];
+
+/* parse functions registered for all message types */
+static struct parse_function_entry *parse_functions_promiscuous;
+
+static struct parser_type_stats parser_stats[PARSER_TYPES];
+
 struct preprocessor_function_entry *preprocessor_functions;
 struct packetparser_function_entry *packetparser_functions;
 
@@ -103,11 +116,20 @@ olsr_destroy_parser(void) {
   struct parse_function_entry *pe, *pe_next;
   struct preprocessor_function_entry *ppe, *ppe_next;
   struct packetparser_function_entry *pae, *pae_next;
+  int type;
 
-  for (pe = parse_functions; pe; pe = pe_next) {
+  for (type = 0; type < PARSER_TYPES; type++) {
+    for (pe = parse_functions[type]; pe; pe = pe_next) {
+      pe_next = pe->next;
+      free (pe);
+    }
+    parse_functions[type] = NULL;
+  }
+  for (pe = parse_functions_promiscuous; pe; pe = pe_next) {
     pe_next = pe->next;
     free (pe);
   }
+  parse_functions_promiscuous = NULL;
   for (ppe = preprocessor_functions; ppe; ppe = ppe_next) {
     ppe_next = ppe->next;
     free (ppe);
@@ -118,21 +140,50 @@ olsr_destroy_parser(void) {
   }
 }
 
+/**
+ * Get the list of parse functions a message type is dispatched to.
+ *
+ * @param type the message type or PROMISCUOUS
+ * @return the head of the list, NULL if the type can never be received
+ */
+static struct parse_function_entry **
+parser_function_list(uint32_t type)
+{
+  if (type == PROMISCUOUS) {
+    return &parse_functions_promiscuous;
+  }
+  if (type >= PARSER_TYPES) {
+    return NULL;
+  }
+  return &parse_functions[type];
+}
+
 void
 olsr_parser_add_function(parse_function * function, uint32_t type)
 {
   struct parse_function_entry *new_entry;
+  struct parse_function_entry **list;
 
   OLSR_PRINTF(3, "Parser: registering event for type %d\n", type);
 
+  list = parser_function_list(type);
+  if (!list) {
+    OLSR_PRINTF(1, "Register parse function: invalid message type %u\n", type);
+    return;
+  }
+
   new_entry = olsr_malloc(sizeof(struct parse_function_entry), "Register parse function");
 
   new_entry->function = function;
   new_entry->type = type;
 
   /* Queue */
-  new_entry->next = parse_functions;
-  parse_functions = new_entry;
+  new_entry->next = *list;
+  *list = new_entry;
+
+  if (type != PROMISCUOUS) {
+    parser_stats[type].handlers++;
+  }
 
   OLSR_PRINTF(3, "Register parse function: Added function for type %d\n", type);
 
@@ -142,18 +193,27 @@ int
 olsr_parser_remove_function(parse_function * function, uint32_t type)
 {
   struct parse_function_entry *entry, *prev;
+  struct parse_function_entry **list;
 
-  entry = parse_functions;
+  list = parser_function_list(type);
+  if (!list) {
+    return 0;
+  }
+
+  entry = *list;
   prev = NULL;
 
   while (entry) {
-    if ((entry->function == function) && (entry->type == type)) {
-      if (entry == parse_functions) {
-        parse_functions = entry->next;
+    if (entry->function == function) {
+      if (entry == *list) {
+        *list = entry->next;
       } else {
         prev->next = entry->next;
       }
       free(entry);
+      if (type != PROMISCUOUS) {
+        parser_stats[type].handlers--;
+      }
       return 1;
     }
 
@@ -164,6 +224,18 @@ olsr_parser_remove_function(parse_function * function, uint32_t type)
   return 0;
 }
 
+/**
+ * Get the dispatch statistics of a message type.
+ *
+ * @param type the message type
+ * @return the statistics of the type
+ */
+const struct parser_type_stats *
+olsr_parser_get_stats(uint8_t type)
+{
+  return &parser_stats[type];
+}
+
 void
 olsr_preprocessor_add_function(preprocessor_function * function)
 {
@@ -273,6 +345,7 @@ parse_packet(struct olsr *olsr, int size, struct interface_olsr *in_if, union ol
   uint16_t seqno;
   struct parse_function_entry *entry;
   struct packetparser_function_entry *packetparser;
+  struct parser_type_stats *stats;
 
   count = size - ((char *)m - (char *)olsr);
 
@@ -388,16 +461,31 @@ parse_packet(struct olsr *olsr, int size, struct interface_olsr *in_if, union ol
       continue;
     }
 
-    entry = parse_functions;
-    while (entry) {
-      /* Should be the same for IPv4 and IPv6 */
+    /* Should be the same for IPv4 and IPv6 */
+    stats = &parser_stats[m->v4.olsr_msgtype];
+    stats->messages++;
+    stats->bytes += msgsize;
 
-      /* Promiscuous or exact match */
-      if ((entry->type == PROMISCUOUS) || (entry->type == m->v4.olsr_msgtype)) {
+    entry = parse_functions[m->v4.olsr_msgtype];
+    if (entry || parse_functions_promiscuous) {
+      struct timespec start, end;
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+
+      /* exact match */
+      for (; entry; entry = entry->next) {
+        if (!entry->function(m, in_if, from_addr))
+          forward = false;
+      }
+
+      /* promiscuous */
+      for (entry = parse_functions_promiscuous; entry; entry = entry->next) {
         if (!entry->function(m, in_if, from_addr))
           forward = false;
       }
-      entry = entry->next;
+
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      stats->handler_ns += (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + end.tv_nsec - start.tv_nsec;
     }
 
     if (forward) {
@@ -407,10 +495,89 @@ parse_packet(struct olsr *olsr, int size, struct interface_olsr *in_if, union ol
 }
 
 /**
- *Processing OLSR data from socket. Reading data, setting
- *wich interface received the message, Sends IPC(if used)
+ *Process a single datagram read from an OLSR socket. Sets
+ *which interface received the message, runs the preprocessors
  *and passes the packet on to parse_packet().
  *
+ *@param fd the filedescriptor the data was read from.
+ *@param packet the received data
+ *@param cc number of bytes received
+ *@param from the sender address
+ *@param fromlen the length of the sender address
+ */
+static void
+olsr_input_packet(int fd, char *packet, int cc, struct sockaddr_storage *from, socklen_t fromlen)
+{
+  struct interface_olsr *olsr_in_if;
+  union olsr_ip_addr from_addr;
+  struct preprocessor_function_entry *entry;
+  struct ipaddr_str buf;
+
+  if ((olsr_cnf->ip_version == AF_INET) && (fromlen != sizeof(struct sockaddr_in)))
+    return;
+  else if ((olsr_cnf->ip_version == AF_INET6) && (fromlen != sizeof(struct sockaddr_in6)))
+    return;
+
+  {
+    void * src;
+    void * dst;
+    size_t size;
+    if (olsr_cnf->ip_version == AF_INET) {
+      /* IPv4 sender address */
+      struct sockaddr_in * x = (struct sockaddr_in *) from;
+      src = &x->sin_addr;
+      dst = &from_addr.v4;
+      size = sizeof(from_addr.v4);
+    } else {
+      /* IPv6 sender address */
+      struct sockaddr_in6 * x = (struct sockaddr_in6 *) from;
+      src = &x->sin6_addr;
+      dst = &from_addr.v6;
+      size = sizeof(from_addr.v6);
+    }
+    memcpy(dst, src, size);
+  }
+
+#ifdef DEBUG
+  OLSR_PRINTF(5, "Received a packet from %s\n",
+      olsr_ip_to_string(&buf, &from_addr));
+#endif /* DEBUG */
+
+  /* are we talking to ourselves? */
+  if (if_ifwithaddr(&from_addr) != NULL)
+    return;
+
+  if ((olsr_in_if = if_ifwithsock(fd)) == NULL) {
+    OLSR_PRINTF(1, "Could not find input interface for message from %s size %d\n", olsr_ip_to_string(&buf, &from_addr), cc);
+    olsr_syslog(OLSR_LOG_ERR, "Could not find input interface for message from %s size %d\n", olsr_ip_to_string(&buf, &from_addr),
+                cc);
+    return;
+  }
+  // call preprocessors
+  entry = preprocessor_functions;
+
+  while (entry) {
+    packet = entry->function(packet, olsr_in_if, &from_addr, &cc);
+    // discard package ?
+    if (packet == NULL) {
+      return;
+    }
+    entry = entry->next;
+  }
+
+  /*
+   * from - sender
+   * packet - olsr data
+   * cc - bytes read
+   */
+  parse_packet((struct olsr *)packet, cc, olsr_in_if, &from_addr);
+}
+
+/**
+ *Processing OLSR data from socket. Reads up to InputBudget
+ *datagrams per wakeup (in batches with recvmmsg() where
+ *available) and hands each of them to olsr_input_packet().
+ *
  *@param fd the filedescriptor that data should be read from.
  *@param data unused
  *@param flags unused
@@ -418,98 +585,82 @@ parse_packet(struct olsr *olsr, int size, struct interface_olsr *in_if, union ol
 void
 olsr_input(int fd, void *data __attribute__ ((unused)), unsigned int flags __attribute__ ((unused)))
 {
-  struct interface_olsr *olsr_in_if;
-  union olsr_ip_addr from_addr;
-  struct preprocessor_function_entry *entry;
-  char *packet;
+#ifdef OLSR_HAVE_RECVMMSG
+  static uint32_t inbuf_batch[OLSR_RECVMMSG_MAX][MAXMESSAGESIZE/sizeof(uint32_t) + 1];
+  static struct sockaddr_storage from[OLSR_RECVMMSG_MAX];
+  static socklen_t fromlen[OLSR_RECVMMSG_MAX];
+  static int len[OLSR_RECVMMSG_MAX];
+  static char *bufs[OLSR_RECVMMSG_MAX];
+  unsigned int i;
+
+  if (bufs[0] == NULL) {
+    for (i = 0; i < OLSR_RECVMMSG_MAX; i++) {
+      bufs[i] = (char *)inbuf_batch[i];
+    }
+  }
+#endif /* OLSR_HAVE_RECVMMSG */
 
   cpu_overload_exit = 0;
 
   for (;;) {
-    struct ipaddr_str buf;
+#ifdef OLSR_HAVE_RECVMMSG
+    unsigned int count = olsr_cnf->input_budget - cpu_overload_exit;
+    int n;
+#else /* OLSR_HAVE_RECVMMSG */
     /* sockaddr_in6 is bigger than sockaddr !!!! */
     struct sockaddr_storage from;
     socklen_t fromlen;
     int cc;
+#endif /* OLSR_HAVE_RECVMMSG */
 
-    if (32 < ++cpu_overload_exit) {
+    if (cpu_overload_exit >= olsr_cnf->input_budget) {
       OLSR_PRINTF(1, "CPU overload detected, ending olsr_input() loop\n");
       break;
     }
 
-    fromlen = sizeof(struct sockaddr_storage);
-    cc = olsr_recvfrom(fd, inbuf, sizeof(inbuf_aligned), 0, (struct sockaddr *)&from, &fromlen);
+#ifdef OLSR_HAVE_RECVMMSG
+    if (count > OLSR_RECVMMSG_MAX) {
+      count = OLSR_RECVMMSG_MAX;
+    }
 
-    if (cc <= 0) {
-      if (cc < 0 && errno != EWOULDBLOCK) {
-        OLSR_PRINTF(1, "error recvfrom: %s", strerror(errno));
-#ifndef _WIN32
-        olsr_syslog(OLSR_LOG_ERR, "error recvfrom: %m");
-#endif /* _WIN32 */
+    n = olsr_recvmmsg(fd, bufs, sizeof(inbuf_batch[0]), from, fromlen, len, count);
+    if (n <= 0) {
+      if (n < 0 && errno != EWOULDBLOCK) {
+        OLSR_PRINTF(1, "error recvmmsg: %s", strerror(errno));
+        olsr_syslog(OLSR_LOG_ERR, "error recvmmsg: %m");
       }
       break;
     }
 
-    {
-      void * src;
-      void * dst;
-      size_t size;
-      if (olsr_cnf->ip_version == AF_INET) {
-        /* IPv4 sender address */
-        struct sockaddr_in * x = (struct sockaddr_in *) &from;
-        src = &x->sin_addr;
-        dst = &from_addr.v4;
-        size = sizeof(from_addr.v4);
-      } else {
-        /* IPv6 sender address */
-        struct sockaddr_in6 * x = (struct sockaddr_in6 *) &from;
-        src = &x->sin6_addr;
-        dst = &from_addr.v6;
-        size = sizeof(from_addr.v6);
+    cpu_overload_exit += n;
+    for (i = 0; i < (unsigned int)n; i++) {
+      if (len[i] > 0) {
+        olsr_input_packet(fd, bufs[i], len[i], &from[i], fromlen[i]);
       }
-      memcpy(dst, src, size);
     }
 
-#ifdef DEBUG
-    OLSR_PRINTF(5, "Received a packet from %s\n",
-        olsr_ip_to_string(&buf, &from_addr));
-#endif /* DEBUG */
-
-    if ((olsr_cnf->ip_version == AF_INET) && (fromlen != sizeof(struct sockaddr_in)))
-      break;
-    else if ((olsr_cnf->ip_version == AF_INET6) && (fromlen != sizeof(struct sockaddr_in6)))
+    if ((unsigned int)n < count) {
+      /* socket drained */
       break;
+    }
+#else /* OLSR_HAVE_RECVMMSG */
+    cpu_overload_exit++;
 
-    /* are we talking to ourselves? */
-    if (if_ifwithaddr(&from_addr) != NULL)
-      return;
+    fromlen = sizeof(struct sockaddr_storage);
+    cc = olsr_recvfrom(fd, inbuf, sizeof(inbuf_aligned), 0, (struct sockaddr *)&from, &fromlen);
 
-    if ((olsr_in_if = if_ifwithsock(fd)) == NULL) {
-      OLSR_PRINTF(1, "Could not find input interface for message from %s size %d\n", olsr_ip_to_string(&buf, &from_addr), cc);
-      olsr_syslog(OLSR_LOG_ERR, "Could not find input interface for message from %s size %d\n", olsr_ip_to_string(&buf, &from_addr),
-                  cc);
-      return;
-    }
-    // call preprocessors
-    entry = preprocessor_functions;
-    packet = &inbuf[0];
-
-    while (entry) {
-      packet = entry->function(packet, olsr_in_if, &from_addr, &cc);
-      // discard package ?
-      if (packet == NULL) {
-        return;
+    if (cc <= 0) {
+      if (cc < 0 && errno != EWOULDBLOCK) {
+        OLSR_PRINTF(1, "error recvfrom: %s", strerror(errno));
+#ifndef _WIN32
+        olsr_syslog(OLSR_LOG_ERR, "error recvfrom: %m");
+#endif /* _WIN32 */
       }
-      entry = entry->next;
+      break;
     }
 
-    /*
-     * &from - sender
-     * &inbuf.olsr
-     * cc - bytes read
-     */
-    parse_packet((struct olsr *)packet, cc, olsr_in_if, &from_addr);
-
+    olsr_input_packet(fd, inbuf, cc, &from, fromlen);
+#endif /* OLSR_HAVE_RECVMMSG */
   }
 }
 
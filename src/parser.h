@@ -60,6 +60,17 @@ struct parse_function_entry {
   struct parse_function_entry *next;
 };
 
+/* number of message types, the parse functions are kept in one list per type */
+#define PARSER_TYPES 256
+
+/* dispatch statistics of one message type */
+struct parser_type_stats {
+  uint32_t messages;                   /* messages passed to the parse functions */
+  uint64_t bytes;                      /* size of these messages */
+  uint64_t handler_ns;                 /* time spent in the parse functions, including the promiscuous ones */
+  uint32_t handlers;                   /* parse functions registered for the type */
+};
+
 typedef char *preprocessor_function(char *packet, struct interface_olsr *, union olsr_ip_addr *, int *length);
 
 struct preprocessor_function_entry {
@@ -86,6 +97,8 @@ void olsr_parser_add_function(parse_function, uint32_t);
 
 int olsr_parser_remove_function(parse_function, uint32_t);
 
+const struct parser_type_stats *olsr_parser_get_stats(uint8_t type);
+
 void olsr_preprocessor_add_function(preprocessor_function);
 
 int olsr_preprocessor_remove_function(preprocessor_function);
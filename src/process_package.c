@@ -51,6 +51,7 @@
 #include "two_hop_neighbor_table.h"
 #include "tc_set.h"
 #include "mpr_selector_set.h"
+#include "lq_mpr.h"
 #include "mid_set.h"
 #include "olsr.h"
 #include "parser.h"
@@ -134,11 +135,11 @@ process_message_neighbors(struct neighbor_entry *neighbor, const struct hello_me
               walker->path_linkcost = LINK_COST_BROKEN;
             }
           }
+          olsr_lq_mpr_touch(two_hop_neighbor);
         }
       } else {
         two_hop_neighbor = olsr_lookup_two_hop_neighbor_table(&message_neighbors->address);
         if (two_hop_neighbor == NULL) {
-          changes_neighborhood = true;
           changes_topology = true;
 
           two_hop_neighbor = olsr_malloc(sizeof(struct neighbor_2_entry), "Process HELLO");
@@ -154,14 +155,15 @@ process_message_neighbors(struct neighbor_entry *neighbor, const struct hello_me
           olsr_insert_two_hop_neighbor_table(two_hop_neighbor);
 
           linking_this_2_entries(neighbor, two_hop_neighbor, message->vtime);
+          olsr_lq_mpr_touch(two_hop_neighbor);
         } else {
           /*
              linking to this two_hop_neighbor entry
            */
-          changes_neighborhood = true;
           changes_topology = true;
 
           linking_this_2_entries(neighbor, two_hop_neighbor, message->vtime);
+          olsr_lq_mpr_touch(two_hop_neighbor);
         }
       }
     }
@@ -231,13 +233,17 @@ process_message_neighbors(struct neighbor_entry *neighbor, const struct hello_me
             // Only copy the link quality if it is better than what we have
             // for this 2-hop neighbor
             if (new_path_linkcost < walker->path_linkcost) {
+              /* the path cost is recalculated for every HELLO, only a different result is a change */
+              if (new_path_linkcost != walker->saved_path_linkcost) {
+                changes_topology = true;
+              }
+
               walker->second_hop_linkcost = new_second_hop_linkcost;
               walker->path_linkcost = new_path_linkcost;
 
               walker->saved_path_linkcost = new_path_linkcost;
 
-              changes_neighborhood = true;
-              changes_topology = true;
+              olsr_lq_mpr_touch(two_hop_neighbor);
             }
           }
         }
@@ -284,6 +290,8 @@ linking_this_2_entries(struct neighbor_entry *neighbor, struct neighbor_2_entry
 
   /*increment the pointer counter */
   two_hop_neighbor->neighbor_2_pointer++;
+
+  olsr_bump_generation(OLSR_GEN_NEIGHBORS);
 }
 
 /**
@@ -540,6 +548,7 @@ olsr_hello_tap(struct hello_message *message, struct interface_olsr *in_if, cons
     neighbor->willingness = message->willingness;
     changes_neighborhood = true;
     changes_topology = true;
+    olsr_bump_generation(OLSR_GEN_NEIGHBORS);
   }
 
   /* Don't register neighbors of neighbors that announces WILL_NEVER */
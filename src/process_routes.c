@@ -62,6 +62,21 @@ char *StrError(unsigned int ErrNo);
 
 static struct list_node chg_kernel_list;
 
+/* delay before routes the kernel did not accept are written again */
+#define KERNEL_RETRY_INTERVAL (1 * MSEC_PER_SEC)
+
+static struct timer_entry *kernel_retry_timer;
+
+#ifdef __linux__
+/* interval of the reconciliation of the kernel FIB with the RIB */
+#define FIB_SYNC_INTERVAL (60 * MSEC_PER_SEC)
+
+/* until the first periodic reconciliation, route changes adopt the routes found in the kernel */
+static bool fib_startup = true;
+
+static void olsr_sync_kernel_routes_timer(void *);
+#endif /* __linux__ */
+
 /**
  *
  * Calculate the kernel route flags.
@@ -105,6 +120,10 @@ olsr_init_export_route(void)
   olsr_addroute6_function = olsr_ioctl_add_route6;
   olsr_delroute_function = olsr_ioctl_del_route;
   olsr_delroute6_function = olsr_ioctl_del_route6;
+
+#ifdef __linux__
+  olsr_start_timer(FIB_SYNC_INTERVAL, 5, OLSR_TIMER_PERIODIC, &olsr_sync_kernel_routes_timer, NULL, 0);
+#endif /* __linux__ */
 }
 
 /**
@@ -120,6 +139,11 @@ olsr_delete_all_kernel_routes(void)
 {
   OLSR_PRINTF(1, "Deleting all routes...\n");
 
+#ifdef __linux__
+  /* do not hold the deletions back for a reconciliation */
+  olsr_netlink_route_sync_abort();
+#endif /* __linux__ */
+
   olsr_bump_routingtree_version();
   olsr_update_rib_routes();
   olsr_update_kernel_routes();
@@ -222,6 +246,9 @@ olsr_add_kernel_route(struct rt_entry *rt)
       rt->rt_metric = rt->rt_best->rtp_metric;
 
 #ifdef __linux__
+      /* a running reconciliation of the kernel FIB must not invalidate it again */
+      olsr_netlink_route_confirm(rt);
+
       /* call NIIT handler */
       if (olsr_cnf->use_niit) {
         olsr_niit_handle_route(rt, true);
@@ -279,6 +306,82 @@ olsr_chg_kernel_routes(struct list_node *head_node)
   }
 }
 
+#ifdef __linux__
+/**
+ * Check if the routes are written by the rtnetlink functions,
+ * which means the kernel FIB can be reconciled with the RIB.
+ */
+static bool
+olsr_fib_sync_usable(void)
+{
+  return !olsr_cnf->host_emul
+      && olsr_addroute_function == olsr_ioctl_add_route && olsr_addroute6_function == olsr_ioctl_add_route6
+      && olsr_delroute_function == olsr_ioctl_del_route && olsr_delroute6_function == olsr_ioctl_del_route6;
+}
+
+/**
+ * Write the difference between the kernel FIB and the RIB once the
+ * routes of the kernel have been read.
+ *
+ * @param success false if the kernel routes could not be read
+ */
+static void
+olsr_sync_kernel_routes_done(bool success)
+{
+  struct rt_entry *rt;
+
+  /* existing kernel routes are only adopted by the first dump */
+  fib_startup = false;
+
+  if (!success) {
+    /* no view of the kernel FIB, rewrite all routes */
+    OLSR_FOR_ALL_RT_ENTRIES(rt) {
+      olsr_enqueue_rt(&chg_kernel_list, rt);
+    } OLSR_FOR_ALL_RT_ENTRIES_END(rt)
+  }
+  else {
+    /* the change list now only needs the routes the kernel does not have */
+    OLSR_FOR_ALL_RT_ENTRIES(rt) {
+      if (rt->rt_best && (olsr_nh_change(&rt->rt_best->rtp_nexthop, &rt->rt_nexthop)
+          || (FIBM_CORRECT == olsr_cnf->fib_metric && olsr_hopcount_change(&rt->rt_best->rtp_metric, &rt->rt_metric)))) {
+        olsr_enqueue_rt(&chg_kernel_list, rt);
+      }
+      else if (list_node_on_list(&rt->rt_change_node)) {
+        list_remove(&rt->rt_change_node);
+      }
+    } OLSR_FOR_ALL_RT_ENTRIES_END(rt)
+  }
+
+  olsr_chg_kernel_routes(&chg_kernel_list);
+  olsr_netlink_route_flush();
+}
+
+/**
+ * Diff the routes in the kernel against the RIB and write only the
+ * difference, instead of blindly rewriting every route. The kernel
+ * routes are read in the background, the difference is written when
+ * they are complete.
+ *
+ * @param purge also delete kernel routes to destinations unknown to the RIB
+ */
+static void
+olsr_sync_kernel_routes(bool purge)
+{
+  if (olsr_netlink_route_sync(purge, &olsr_sync_kernel_routes_done)) {
+    olsr_sync_kernel_routes_done(false);
+  }
+}
+
+static void
+olsr_sync_kernel_routes_timer(void *context __attribute__ ((unused)))
+{
+  if (olsr_fib_sync_usable()) {
+    olsr_sync_kernel_routes(true);
+  }
+  fib_startup = false;
+}
+#endif /* __linux__ */
+
 /**
  * Check the version number of all route paths hanging off a route entry.
  * If a route does not match the current routing tree number, remove it
@@ -341,7 +444,7 @@ olsr_update_rib_routes(void)
   
       if (olsr_delete_kernel_route(rt) == 0) {
         /*only remove if deletion was successful*/
-        avl_delete(&routingtree, &rt->rt_tree_node);
+        olsr_unlink_rt_entry(rt);
         olsr_cookie_free(rt_mem_cookie, rt);
       }
 
@@ -397,7 +500,7 @@ olsr_delete_interface_routes(int if_index) {
     if (mightTrigger) {
       if (!rt->rt_path_tree.count) {
         /* oops, all routes are gone - flush the route head */
-        avl_delete(&routingtree, rt_tree_node);
+        olsr_unlink_rt_entry(rt);
 
         /* do not dequeue route because they are already gone */
       }
@@ -412,15 +515,62 @@ olsr_delete_interface_routes(int if_index) {
   }
 }
 
+static void
+olsr_retry_kernel_routes_timer(void *context __attribute__ ((unused)))
+{
+  struct rt_entry *rt;
+
+  kernel_retry_timer = NULL;
+
+  /* failed writes left the nexthop of their route invalidated */
+  OLSR_FOR_ALL_RT_ENTRIES(rt) {
+    if (rt->rt_best && olsr_nh_change(&rt->rt_best->rtp_nexthop, &rt->rt_nexthop)) {
+      olsr_enqueue_rt(&chg_kernel_list, rt);
+    }
+  } OLSR_FOR_ALL_RT_ENTRIES_END(rt)
+
+  olsr_update_kernel_routes();
+}
+
+/**
+ * Schedule another attempt for routes which could not be written to
+ * the kernel. They are not queued right away, as the failure may be
+ * reported while the change list is being written.
+ */
+void
+olsr_retry_kernel_routes(void)
+{
+  if (kernel_retry_timer == NULL) {
+    kernel_retry_timer = olsr_start_timer(KERNEL_RETRY_INTERVAL, 0, OLSR_TIMER_ONESHOT,
+        &olsr_retry_kernel_routes_timer, NULL, 0);
+  }
+}
+
 /**
  * Propagate the accumulated changes from the last rib update to the kernel.
  */
 void
 olsr_update_kernel_routes(void)
 {
+#ifdef __linux__
+  if (fib_startup && !list_is_empty(&chg_kernel_list) && olsr_fib_sync_usable()) {
+    /* adopt routes still in the kernel (e.g. after a crash) instead of rewriting them */
+    olsr_sync_kernel_routes(false);
+  }
+  if (fib_startup && olsr_netlink_route_syncing()) {
+    /* the changes are written when the kernel routes have been read */
+    return;
+  }
+#endif /* __linux__ */
+
   /* route changes */
   olsr_chg_kernel_routes(&chg_kernel_list);
 
+#ifdef __linux__
+  /* write the queued route requests to the kernel */
+  olsr_netlink_route_flush();
+#endif /* __linux__ */
+
 #if defined DEBUG && DEBUG
   olsr_print_routing_table(&routingtree);
 #endif /* defined DEBUG && DEBUG */
@@ -430,6 +580,14 @@ void
 olsr_force_kernelroutes_refresh(void) {
   struct rt_entry *rt;
 
+#ifdef __linux__
+  if (olsr_fib_sync_usable()) {
+    /* only write the difference between kernel and RIB */
+    olsr_sync_kernel_routes(true);
+    return;
+  }
+#endif /* __linux__ */
+
   /* enqueue all existing routes for a rewrite */
   OLSR_FOR_ALL_RT_ENTRIES(rt) {
     olsr_enqueue_rt(&chg_kernel_list, rt);
@@ -437,6 +595,10 @@ olsr_force_kernelroutes_refresh(void) {
 
   /* trigger kernel route refresh */
   olsr_chg_kernel_routes(&chg_kernel_list);
+
+#ifdef __linux__
+  olsr_netlink_route_flush();
+#endif /* __linux__ */
 }
 
 /*
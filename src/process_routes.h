@@ -63,6 +63,7 @@ void olsr_delete_all_kernel_routes(void);
 uint8_t olsr_rt_flags(const struct rt_entry *, int add);
 void olsr_delete_interface_routes(int if_index);
 void olsr_force_kernelroutes_refresh(void);
+void olsr_retry_kernel_routes(void);
 
 #endif /* _OLSR_PROCESS_RT */
 
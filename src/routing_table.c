@@ -74,6 +74,9 @@ static struct rt_path *current_inetgw = NULL;
 /* Root of our RIB */
 struct avl_tree routingtree;
 
+/* Longest prefix match index of the RIB, holds the same rt_entries */
+struct lpm_tree routingtree_lpm;
+
 /*
  * Keep a version number for detecting outdated elements
  * in the per rt_entry rt_path subtree.
@@ -174,6 +177,7 @@ olsr_init_routing_table(void)
 
   /* the routing tree */
   avl_init(&routingtree, avl_comp_prefix_default);
+  lpm_init(&routingtree_lpm, olsr_cnf->maxplen);
   routingtree_version = 0;
 
   /*
@@ -208,6 +212,36 @@ olsr_lookup_routing_table(const union olsr_ip_addr *dst)
   return rt_tree_node ? rt_tree2rt(rt_tree_node) : NULL;
 }
 
+/**
+ * Look up the most specific route entry for an address.
+ *
+ * @param dst the address
+ *
+ * @return a pointer to the rt_entry with the longest prefix
+ * covering the address, NULL when there is none
+ */
+struct rt_entry *
+olsr_lookup_best_route(const union olsr_ip_addr *dst)
+{
+  return lpm_match(&routingtree_lpm, dst);
+}
+
+/**
+ * Remove a route entry from the RIB. The entry itself is not freed.
+ */
+void
+olsr_unlink_rt_entry(struct rt_entry *rt)
+{
+  avl_delete(&routingtree, &rt->rt_tree_node);
+  if (list_node_on_list(&rt->rt_change_node)) {
+    /* the kernel change list may be held back while the FIB is reconciled */
+    list_remove(&rt->rt_change_node);
+  }
+  if (lpm_find(&routingtree_lpm, &rt->rt_dst.prefix, rt->rt_dst.prefix_len) == rt) {
+    lpm_delete(&routingtree_lpm, &rt->rt_dst.prefix, rt->rt_dst.prefix_len);
+  }
+}
+
 /**
  * Update gateway/interface/etx/hopcount and the version for a route path.
  */
@@ -250,6 +284,11 @@ olsr_alloc_rt_entry(struct olsr_ip_prefix *prefix)
   rt->rt_tree_node.key = &rt->rt_dst;
   avl_insert(&routingtree, &rt->rt_tree_node, AVL_DUP_NO);
 
+  /* without its trie node the route is still installed, only best route lookups miss it */
+  if (lpm_insert(&routingtree_lpm, &rt->rt_dst.prefix, rt->rt_dst.prefix_len, rt) < 0) {
+    OLSR_PRINTF(1, "RIB: cannot index %s for best route lookups\n", olsr_ip_prefix_to_string(&rt->rt_dst));
+  }
+
   /* init the originator subtree */
   avl_init(&rt->rt_path_tree, avl_comp_default);
 
@@ -563,6 +602,7 @@ olsr_insert_routing_table(union olsr_ip_addr *dst, int plen, union olsr_ip_addr
    */
   prefix.prefix = *dst;
   prefix.prefix_len = plen;
+  ip_prefix_normalize(&prefix);
 
   node = avl_find(&tc->prefix_tree, &prefix);
 
@@ -621,6 +661,7 @@ olsr_delete_routing_table(union olsr_ip_addr *dst, int plen, union olsr_ip_addr
    */
   prefix.prefix = *dst;
   prefix.prefix_len = plen;
+  ip_prefix_normalize(&prefix);
 
   node = avl_find(&tc->prefix_tree, &prefix);
 
@@ -56,6 +56,7 @@
 #include "olsr_cookie.h"
 #include "common/avl.h"
 #include "common/list.h"
+#include "common/lpm.h"
 
 #define NETMASK_HOST 0xffffffff
 #define NETMASK_DEFAULT 0x0
@@ -87,6 +88,7 @@ struct rt_entry {
   struct rt_metric rt_metric;          /* metric of FIB route */
   struct avl_tree rt_path_tree;
   struct list_node rt_change_node;     /* queue for kernel FIB add/chg/del */
+  uint32_t rt_fib_sync;                /* last kernel FIB reconciliation that confirmed the route */
 };
 
 AVLNODE2STRUCT(rt_tree2rt, struct rt_entry, rt_tree_node);
@@ -191,6 +193,7 @@ union olsr_kernel_route {
 };
 
 extern struct avl_tree routingtree;
+extern struct lpm_tree routingtree_lpm;
 extern unsigned int routingtree_version;
 extern struct olsr_cookie_info *rt_mem_cookie;
 
@@ -225,6 +228,8 @@ void olsr_update_rt_path(struct rt_path *, struct tc_entry *, struct link_entry
 void olsr_delete_rt_path(struct rt_path *);
 
 struct rt_entry *olsr_lookup_routing_table(const union olsr_ip_addr *);
+struct rt_entry *olsr_lookup_best_route(const union olsr_ip_addr *);
+void olsr_unlink_rt_entry(struct rt_entry *);
 
 #endif /* _OLSR_ROUTING_TABLE */
 
@@ -49,6 +49,7 @@
 #include "olsr.h"
 #include "olsr_cookie.h"
 #include "net_os.h"
+#include "net_olsr.h"
 #include "mpr_selector_set.h"
 #include "olsr_random.h"
 #include "common/avl.h"
@@ -59,6 +60,11 @@
 #include <assert.h>
 #include <time.h>
 
+#ifdef __linux__
+#define SCHEDULER_USE_EPOLL
+#include <sys/epoll.h>
+#endif /* __linux__ */
+
 #ifdef __MACH__
 #include "mach/clock_gettime.h"
 #endif
@@ -72,9 +78,13 @@ uint32_t now_times;                    /* relative time compared to startup (in
 struct timespec first_tv;              /* timevalue during startup */
 struct timespec last_tv;               /* timevalue used for last olsr_times() calculation */
 
-/* Hashed root of all timers */
-static struct list_node timer_wheel[TIMER_WHEEL_SLOTS];
-static uint32_t timer_last_run;        /* remember the last timeslot walk */
+/* Hashed root of all timers, one slot per millisecond */
+static struct list_node timer_wheel[TIMER_WHEEL_ROOT_SLOTS];
+
+/* Upper levels of the timer wheel, cascaded into the root level */
+static struct list_node timer_wheel_levels[TIMER_WHEEL_LEVELS][TIMER_WHEEL_LEVEL_SLOTS];
+
+static uint32_t timer_last_run;        /* the next timeslot to walk */
 
 /* Memory cookie for the block based memory manager */
 static struct olsr_cookie_info *timer_mem_cookie = NULL;
@@ -82,8 +92,28 @@ static struct olsr_cookie_info *timer_mem_cookie = NULL;
 /* Head of all OLSR used sockets */
 static struct list_node socket_head = { &socket_head, &socket_head };
 
+/*
+ * Sockets are polled in two sets: the pollrate set once per scheduler
+ * run and the immediate set while waiting for the next run.
+ */
+#define SOCKET_SET_PR  0
+#define SOCKET_SET_IMM 1
+#define SOCKET_SETS    2
+
+static const unsigned int socket_read_flag[SOCKET_SETS] = { SP_PR_READ, SP_IMM_READ };
+static const unsigned int socket_write_flag[SOCKET_SETS] = { SP_PR_WRITE, SP_IMM_WRITE };
+
+#ifdef SCHEDULER_USE_EPOLL
+/* number of events fetched per epoll_wait(2) call */
+#define SOCKET_EPOLL_EVENTS 64
+
+/* one epoll instance per socket set, registrations are done once */
+static int socket_epoll[SOCKET_SETS] = { -1, -1 };
+static unsigned int socket_epoll_count[SOCKET_SETS];
+#endif /* SCHEDULER_USE_EPOLL */
+
 /* Prototypes */
-static void walk_timers(uint32_t *);
+static void walk_timers(void);
 static void walk_timers_cleanup(void);
 static void poll_sockets(void);
 static uint32_t calc_jitter(unsigned int rel_time, uint8_t jitter_pct, unsigned int random_val);
@@ -216,6 +246,269 @@ olsr_isTimedOut(uint32_t s)
   return now_times - s <= (1u << 31);
 }
 
+static INLINE socket_handler_func
+socket_handler(const struct olsr_socket_entry *entry, int set)
+{
+  return set == SOCKET_SET_PR ? entry->process_pollrate : entry->process_immediate;
+}
+
+#ifdef SCHEDULER_USE_EPOLL
+/**
+ * Create the epoll instances on first use.
+ */
+static void
+socket_backend_init(void)
+{
+  int set;
+
+  for (set = 0; set < SOCKET_SETS; set++) {
+    if (socket_epoll[set] != -1) {
+      continue;
+    }
+    socket_epoll[set] = epoll_create1(EPOLL_CLOEXEC);
+    if (socket_epoll[set] == -1) {
+      olsr_exit("Could not create epoll instance for the scheduler", EXIT_FAILURE);
+    }
+  }
+}
+
+/**
+ * Calculate the epoll events a socket entry is interested in
+ * for one of the socket sets.
+ */
+static uint32_t
+socket_backend_events(const struct olsr_socket_entry *entry, int set)
+{
+  uint32_t events = 0;
+
+  if (socket_handler(entry, set) == NULL) {
+    return 0;
+  }
+  if ((entry->flags & socket_read_flag[set]) != 0) {
+    events |= EPOLLIN;
+  }
+  if ((entry->flags & socket_write_flag[set]) != 0) {
+    events |= EPOLLOUT;
+  }
+  return events;
+}
+
+/**
+ * Bring the epoll registrations of a socket entry in line with its
+ * handlers and flags. Sockets without any events are removed from
+ * the epoll instance to prevent wakeups on hangup/error conditions.
+ */
+static void
+socket_backend_update(struct olsr_socket_entry *entry)
+{
+  int set;
+
+  socket_backend_init();
+
+  for (set = 0; set < SOCKET_SETS; set++) {
+    struct epoll_event ev;
+    uint32_t events = socket_backend_events(entry, set);
+
+    if (events == entry->backend_events[set]) {
+      continue;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = entry;
+
+    if (events == 0) {
+      epoll_ctl(socket_epoll[set], EPOLL_CTL_DEL, entry->backend_fd[set], &ev);
+      if (entry->backend_fd[set] != entry->fd) {
+        close(entry->backend_fd[set]);
+      }
+      entry->backend_fd[set] = -1;
+      socket_epoll_count[set]--;
+    } else if (entry->backend_events[set] != 0) {
+      if (epoll_ctl(socket_epoll[set], EPOLL_CTL_MOD, entry->backend_fd[set], &ev) == -1) {
+        OLSR_PRINTF(1, "epoll_ctl(MOD) error on socket %d: %s\n", entry->fd, strerror(errno));
+        continue;
+      }
+    } else {
+      int result;
+
+      entry->backend_fd[set] = entry->fd;
+      result = epoll_ctl(socket_epoll[set], EPOLL_CTL_ADD, entry->backend_fd[set], &ev);
+      if (result == -1 && errno == EEXIST) {
+        /* another entry uses the same socket, register a duplicate of the descriptor */
+        entry->backend_fd[set] = dup(entry->fd);
+        result = entry->backend_fd[set] == -1 ? -1 : epoll_ctl(socket_epoll[set], EPOLL_CTL_ADD, entry->backend_fd[set], &ev);
+      }
+      if (result == -1) {
+        OLSR_PRINTF(1, "epoll_ctl(ADD) error on socket %d: %s\n", entry->fd, strerror(errno));
+        if (entry->backend_fd[set] != -1 && entry->backend_fd[set] != entry->fd) {
+          close(entry->backend_fd[set]);
+        }
+        entry->backend_fd[set] = -1;
+        continue;
+      }
+      socket_epoll_count[set]++;
+    }
+    entry->backend_events[set] = events;
+  }
+}
+
+/**
+ * Wait for events on one of the socket sets and call the handlers
+ * of the ready sockets.
+ *
+ *@param set SOCKET_SET_PR or SOCKET_SET_IMM
+ *@param timeout the time to wait in milliseconds
+ *@return the number of ready sockets, 0 on timeout, -1 on error
+ */
+static int
+dispatch_sockets(int set, int32_t timeout)
+{
+  struct epoll_event events[SOCKET_EPOLL_EVENTS];
+  int i, n, total = 0;
+
+  if (socket_epoll_count[set] == 0 && timeout <= 0) {
+    /* nothing registered and no time to wait, skip the syscall */
+    return 0;
+  }
+
+  socket_backend_init();
+
+  do {
+    do {
+      n = epoll_wait(socket_epoll[set], events, SOCKET_EPOLL_EVENTS, total == 0 && timeout > 0 ? timeout : 0);
+    } while (n == -1 && errno == EINTR);
+
+    if (n == -1) {              /* Did something go wrong? */
+      OLSR_PRINTF(1, "epoll_wait error: %s", strerror(errno));
+      return total > 0 ? total : -1;
+    }
+    if (n == 0) {
+      break;
+    }
+
+    /* Update time since this is much used by the parsing functions */
+    now_times = olsr_times();
+    for (i = 0; i < n; i++) {
+      struct olsr_socket_entry *entry = events[i].data.ptr;
+      socket_handler_func handler = socket_handler(entry, set);
+      unsigned int flags = 0;
+
+      if (handler == NULL) {
+        /* removed by one of the earlier handlers */
+        continue;
+      }
+      if ((events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+        flags |= entry->flags & socket_read_flag[set];
+      }
+      if ((events[i].events & (EPOLLOUT | EPOLLERR)) != 0) {
+        flags |= entry->flags & socket_write_flag[set];
+      }
+      if (flags != 0) {
+        handler(entry->fd, entry->data, flags);
+      }
+    }
+    total += n;
+
+    /* a full event array means there might be more ready sockets */
+  } while (n == SOCKET_EPOLL_EVENTS);
+
+  return total;
+}
+#else /* SCHEDULER_USE_EPOLL */
+static void
+socket_backend_update(struct olsr_socket_entry *entry __attribute__ ((unused)))
+{
+}
+
+/**
+ * Run select(2) on one of the socket sets and call the handlers
+ * of the ready sockets.
+ *
+ *@param set SOCKET_SET_PR or SOCKET_SET_IMM
+ *@param timeout the time to wait in milliseconds
+ *@return the number of ready sockets, 0 on timeout, -1 on error
+ */
+static int
+dispatch_sockets(int set, int32_t timeout)
+{
+  int n;
+  struct olsr_socket_entry *entry;
+  fd_set ibits, obits;
+  struct timeval tvp;
+  int hfd = 0;
+  bool readset = false, writeset = false;
+
+  FD_ZERO(&ibits);
+  FD_ZERO(&obits);
+
+  /* Adding file-descriptors to FD set */
+  OLSR_FOR_ALL_SOCKETS(entry) {
+    if (socket_handler(entry, set) == NULL) {
+      continue;
+    }
+    if ((entry->flags & socket_read_flag[set]) != 0) {
+      readset = true;
+      FD_SET((unsigned int)entry->fd, &ibits);  /* And we cast here since we get a warning on Win32 */
+    }
+    if ((entry->flags & socket_write_flag[set]) != 0) {
+      writeset = true;
+      FD_SET((unsigned int)entry->fd, &obits);  /* And we cast here since we get a warning on Win32 */
+    }
+    if ((entry->flags & (socket_read_flag[set] | socket_write_flag[set])) != 0 && entry->fd >= hfd) {
+      hfd = entry->fd + 1;
+    }
+  }
+  OLSR_FOR_ALL_SOCKETS_END(entry);
+
+  if (hfd == 0 && timeout <= 0) {
+    /* we are over the interval and we have no fd's. Skip the select() etc. */
+    return 0;
+  }
+
+  if (timeout < 0) {
+    timeout = 0;
+  }
+  tvp.tv_sec = timeout / MSEC_PER_SEC;
+  tvp.tv_usec = (timeout % MSEC_PER_SEC) * USEC_PER_MSEC;
+
+  /* Running select on the FD set */
+  do {
+    n = olsr_select(hfd, readset ? &ibits : NULL, writeset ? &obits : NULL, NULL, &tvp);
+  } while (n == -1 && errno == EINTR);
+
+  if (n == 0) {                 /* timeout! */
+    return 0;
+  }
+  if (n == -1) {                /* Did something go wrong? */
+    OLSR_PRINTF(1, "select error: %s", strerror(errno));
+    return -1;
+  }
+
+  /* Update time since this is much used by the parsing functions */
+  now_times = olsr_times();
+  OLSR_FOR_ALL_SOCKETS(entry) {
+    socket_handler_func handler = socket_handler(entry, set);
+    unsigned int flags;
+    if (handler == NULL) {
+      continue;
+    }
+    flags = 0;
+    if (FD_ISSET(entry->fd, &ibits)) {
+      flags |= socket_read_flag[set];
+    }
+    if (FD_ISSET(entry->fd, &obits)) {
+      flags |= socket_write_flag[set];
+    }
+    if (flags != 0) {
+      handler(entry->fd, entry->data, flags);
+    }
+  }
+  OLSR_FOR_ALL_SOCKETS_END(entry);
+  return n;
+}
+#endif /* SCHEDULER_USE_EPOLL */
+
 /**
  * Add a socket and handler to the socketset
  * beeing used in the main select(2) loop
@@ -245,10 +538,16 @@ add_olsr_socket(int fd, socket_handler_func pf_pr, socket_handler_func pf_imm, v
   new_entry->process_pollrate = pf_pr;
   new_entry->data = data;
   new_entry->flags = flags;
+  new_entry->backend_fd[SOCKET_SET_PR] = -1;
+  new_entry->backend_fd[SOCKET_SET_IMM] = -1;
+  new_entry->backend_events[SOCKET_SET_PR] = 0;
+  new_entry->backend_events[SOCKET_SET_IMM] = 0;
 
   /* Queue */
   list_node_init(&new_entry->socket_node);
   list_add_before(&socket_head, &new_entry->socket_node);
+
+  socket_backend_update(new_entry);
 }
 
 /**
@@ -277,6 +576,7 @@ remove_olsr_socket(int fd, socket_handler_func pf_pr, socket_handler_func pf_imm
       entry->process_immediate = NULL;
       entry->process_pollrate = NULL;
       entry->flags = 0;
+      socket_backend_update(entry);
       return 1;
     }
   }
@@ -292,6 +592,7 @@ enable_olsr_socket(int fd, socket_handler_func pf_pr, socket_handler_func pf_imm
   OLSR_FOR_ALL_SOCKETS(entry) {
     if (entry->fd == fd && entry->process_immediate == pf_imm && entry->process_pollrate == pf_pr) {
       entry->flags |= flags;
+      socket_backend_update(entry);
     }
   }
   OLSR_FOR_ALL_SOCKETS_END(entry);
@@ -305,6 +606,7 @@ disable_olsr_socket(int fd, socket_handler_func pf_pr, socket_handler_func pf_im
   OLSR_FOR_ALL_SOCKETS(entry) {
     if (entry->fd == fd && entry->process_immediate == pf_imm && entry->process_pollrate == pf_pr) {
       entry->flags &= ~flags;
+      socket_backend_update(entry);
     }
   }
   OLSR_FOR_ALL_SOCKETS_END(entry);
@@ -319,21 +621,32 @@ olsr_flush_sockets(void)
   struct olsr_socket_entry *entry;
 
   OLSR_FOR_ALL_SOCKETS(entry) {
+    entry->process_immediate = NULL;
+    entry->process_pollrate = NULL;
+    socket_backend_update(entry);
+
     close(entry->fd);
     list_remove(&entry->socket_node);
     free(entry);
   } OLSR_FOR_ALL_SOCKETS_END(entry);
+
+#ifdef SCHEDULER_USE_EPOLL
+  {
+    int set;
+
+    for (set = 0; set < SOCKET_SETS; set++) {
+      if (socket_epoll[set] != -1) {
+        close(socket_epoll[set]);
+        socket_epoll[set] = -1;
+      }
+    }
+  }
+#endif /* SCHEDULER_USE_EPOLL */
 }
 
 static void
 poll_sockets(void)
 {
-  int n;
-  struct olsr_socket_entry *entry;
-  fd_set ibits, obits;
-  struct timeval tvp = { 0, 0 };
-  int hfd = 0, fdsets = 0;
-
   /* If there are no registered sockets we
    * do not call select(2)
    */
@@ -341,67 +654,13 @@ poll_sockets(void)
     return;
   }
 
-  FD_ZERO(&ibits);
-  FD_ZERO(&obits);
-
-  /* Adding file-descriptors to FD set */
-  OLSR_FOR_ALL_SOCKETS(entry) {
-    if (entry->process_pollrate == NULL) {
-      continue;
-    }
-    if ((entry->flags & SP_PR_READ) != 0) {
-      fdsets |= SP_PR_READ;
-      FD_SET((unsigned int)entry->fd, &ibits);  /* And we cast here since we get a warning on Win32 */
-    }
-    if ((entry->flags & SP_PR_WRITE) != 0) {
-      fdsets |= SP_PR_WRITE;
-      FD_SET((unsigned int)entry->fd, &obits);  /* And we cast here since we get a warning on Win32 */
-    }
-    if ((entry->flags & (SP_PR_READ | SP_PR_WRITE)) != 0 && entry->fd >= hfd) {
-      hfd = entry->fd + 1;
-    }
-  }
-  OLSR_FOR_ALL_SOCKETS_END(entry);
-
-  /* Running select on the FD set */
-  do {
-    n = olsr_select(hfd, fdsets & SP_PR_READ ? &ibits : NULL, fdsets & SP_PR_WRITE ? &obits : NULL, NULL, &tvp);
-  } while (n == -1 && errno == EINTR);
-
-  if (n == 0) {
-    return;
-  }
-  if (n == -1) {                /* Did something go wrong? */
-    OLSR_PRINTF(1, "select error: %s", strerror(errno));
-    return;
-  }
-
-  /* Update time since this is much used by the parsing functions */
-  now_times = olsr_times();
-  OLSR_FOR_ALL_SOCKETS(entry) {
-    int flags;
-    if (entry->process_pollrate == NULL) {
-      continue;
-    }
-    flags = 0;
-    if (FD_ISSET(entry->fd, &ibits)) {
-      flags |= SP_PR_READ;
-    }
-    if (FD_ISSET(entry->fd, &obits)) {
-      flags |= SP_PR_WRITE;
-    }
-    if (flags != 0) {
-      entry->process_pollrate(entry->fd, entry->data, flags);
-    }
-  }
-  OLSR_FOR_ALL_SOCKETS_END(entry);
+  dispatch_sockets(SOCKET_SET_PR, 0);
 }
 
 static void
 handle_fds(uint32_t next_interval)
 {
   struct olsr_socket_entry *entry;
-  struct timeval tvp;
   int32_t remaining;
 
   /* calculate the first timeout */
@@ -414,76 +673,18 @@ handle_fds(uint32_t next_interval)
       /* If there are no registered sockets we do not call select(2) */
       return;
     }
-    tvp.tv_sec = 0;
-    tvp.tv_usec = 0;
-  } else {
-    /* we need an absolute time - milliseconds */
-    tvp.tv_sec = remaining / MSEC_PER_SEC;
-    tvp.tv_usec = (remaining % MSEC_PER_SEC) * USEC_PER_MSEC;
+    remaining = 0;
   }
 
   /* do at least one select */
   for (;;) {
-    fd_set ibits, obits;
-    int n, hfd = 0, fdsets = 0;
-    FD_ZERO(&ibits);
-    FD_ZERO(&obits);
-
-    /* Adding file-descriptors to FD set */
-    OLSR_FOR_ALL_SOCKETS(entry) {
-      if (entry->process_immediate == NULL) {
-        continue;
-      }
-      if ((entry->flags & SP_IMM_READ) != 0) {
-        fdsets |= SP_IMM_READ;
-        FD_SET((unsigned int)entry->fd, &ibits);        /* And we cast here since we get a warning on Win32 */
-      }
-      if ((entry->flags & SP_IMM_WRITE) != 0) {
-        fdsets |= SP_IMM_WRITE;
-        FD_SET((unsigned int)entry->fd, &obits);        /* And we cast here since we get a warning on Win32 */
-      }
-      if ((entry->flags & (SP_IMM_READ | SP_IMM_WRITE)) != 0 && entry->fd >= hfd) {
-        hfd = entry->fd + 1;
-      }
-    }
-    OLSR_FOR_ALL_SOCKETS_END(entry);
-
-    if (hfd == 0 && (long)remaining <= 0) {
-      /* we are over the interval and we have no fd's. Skip the select() etc. */
-      break;
-    }
-
-    do {
-      n = olsr_select(hfd, fdsets & SP_IMM_READ ? &ibits : NULL, fdsets & SP_IMM_WRITE ? &obits : NULL, NULL, &tvp);
-    } while (n == -1 && errno == EINTR);
-
-    if (n == 0) {               /* timeout! */
-      break;
-    }
-    if (n == -1) {              /* Did something go wrong? */
-      OLSR_PRINTF(1, "select error: %s", strerror(errno));
+    if (dispatch_sockets(SOCKET_SET_IMM, remaining) <= 0) {
+      /* timeout, error or nothing to wait for */
       break;
     }
 
-    /* Update time since this is much used by the parsing functions */
-    now_times = olsr_times();
-    OLSR_FOR_ALL_SOCKETS(entry) {
-      int flags;
-      if (entry->process_immediate == NULL) {
-        continue;
-      }
-      flags = 0;
-      if (FD_ISSET(entry->fd, &ibits)) {
-        flags |= SP_IMM_READ;
-      }
-      if (FD_ISSET(entry->fd, &obits)) {
-        flags |= SP_IMM_WRITE;
-      }
-      if (flags != 0) {
-        entry->process_immediate(entry->fd, entry->data, flags);
-      }
-    }
-    OLSR_FOR_ALL_SOCKETS_END(entry);
+    /* send what the socket handlers generated */
+    net_flush_output();
 
     /* calculate the next timeout */
     remaining = TIME_DUE(next_interval);
@@ -491,9 +692,6 @@ handle_fds(uint32_t next_interval)
       /* we are already over the interval */
       break;
     }
-    /* we need an absolute time - milliseconds */
-    tvp.tv_sec = remaining / MSEC_PER_SEC;
-    tvp.tv_usec = (remaining % MSEC_PER_SEC) * USEC_PER_MSEC;
   }
 
   OLSR_FOR_ALL_SOCKETS(entry) {
@@ -556,7 +754,7 @@ void olsr_scheduler(void)
     }
 
     /* Process timers */
-    walk_timers(&timer_last_run);
+    walk_timers();
     walk_timers_cleanup();
 
     if (state != RUNNING) {
@@ -577,6 +775,9 @@ void olsr_scheduler(void)
       link_changes = false;
     }
 
+    /* Send everything generated in this tick */
+    net_flush_output();
+
     if (state != RUNNING) {
       break;
     }
@@ -627,7 +828,7 @@ calc_jitter(unsigned int rel_time, uint8_t jitter_pct, unsigned int random_val)
 void
 olsr_init_timers(void)
 {
-  int idx;
+  unsigned int idx, level;
 
   OLSR_PRINTF(3, "Initializing scheduler.\n");
 
@@ -640,9 +841,14 @@ olsr_init_timers(void)
 
   avl_init(&timer_cleanup_tree, avl_comp_timer);
 
-  for (idx = 0; idx < TIMER_WHEEL_SLOTS; idx++) {
+  for (idx = 0; idx < TIMER_WHEEL_ROOT_SLOTS; idx++) {
     list_head_init(&timer_wheel[idx]);
   }
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    for (idx = 0; idx < TIMER_WHEEL_LEVEL_SLOTS; idx++) {
+      list_head_init(&timer_wheel_levels[level][idx]);
+    }
+  }
 
   /*
    * Reset the last timer run.
@@ -654,28 +860,105 @@ olsr_init_timers(void)
   olsr_cookie_set_memory_size(timer_mem_cookie, sizeof(struct timer_entry));
 }
 
+/**
+ * Get the timer wheel slot for an absolute time, relative to the next
+ * timeslot to walk. Expired times are put into the next timeslot.
+ *
+ * @param clock absolute time in milliseconds
+ * @return the timer wheel slot
+ */
+static struct list_node *
+timer_wheel_slot(uint32_t clock)
+{
+  uint32_t delta = clock - timer_last_run;
+  unsigned int level, shift;
+
+  if (delta > (1u << 31)) {
+    /* already expired */
+    return &timer_wheel[timer_last_run & TIMER_WHEEL_ROOT_MASK];
+  }
+  if (delta < TIMER_WHEEL_ROOT_SLOTS) {
+    return &timer_wheel[clock & TIMER_WHEEL_ROOT_MASK];
+  }
+
+  /* find the lowest level which spans the delta, the last level takes the rest */
+  shift = TIMER_WHEEL_ROOT_BITS;
+  for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+    if (delta < (1u << (shift + TIMER_WHEEL_LEVEL_BITS))) {
+      break;
+    }
+    shift += TIMER_WHEEL_LEVEL_BITS;
+  }
+  return &timer_wheel_levels[level][(clock >> shift) & TIMER_WHEEL_LEVEL_MASK];
+}
+
+/**
+ * Move all timers of the current slot of an upper timer wheel level
+ * down into the lower levels.
+ *
+ * @param level the upper level to cascade
+ * @param timers_walked counter for the number of touched timers
+ * @return the index of the cascaded slot
+ */
+static unsigned int
+cascade_timers(unsigned int level, unsigned int *timers_walked)
+{
+  struct list_node tmp_head_node;
+  unsigned int index =
+    (timer_last_run >> (TIMER_WHEEL_ROOT_BITS + level * TIMER_WHEEL_LEVEL_BITS)) & TIMER_WHEEL_LEVEL_MASK;
+
+  list_head_init(&tmp_head_node);
+  list_merge(&tmp_head_node, &timer_wheel_levels[level][index]);
+
+  while (!list_is_empty(&tmp_head_node)) {
+    struct list_node *const timer_node = tmp_head_node.next;
+    struct timer_entry *const timer = list2timer(timer_node);
+
+    /*
+     * Removed timers are requeued as well, they have to stay on a list
+     * until walk_timers_cleanup() frees them.
+     */
+    list_remove(timer_node);
+    list_add_before(timer_wheel_slot(timer->timer_clock), timer_node);
+
+    timer->timer_cookie->ci_timer_walks++;
+    (*timers_walked)++;
+  }
+  return index;
+}
+
 /**
  * Walk through the timer list and check if any timer is ready to fire.
  * Callback the provided function with the context pointer.
  */
 static void
-walk_timers(uint32_t * last_run)
+walk_timers(void)
 {
   unsigned int total_timers_walked = 0, total_timers_fired = 0;
   unsigned int wheel_slot_walks = 0;
 
   /*
-   * Check the required wheel slots since the last time a timer walk was invoked,
-   * or check *all* the wheel slots, whatever is less work.
-   * The latter is meant as a safety belt if the scheduler falls behind.
+   * Check all timeslots since the last time a timer walk was invoked.
+   * Only the root level slot of each timeslot has to be looked at,
+   * the upper levels are cascaded down every time the root level wraps.
    */
-  while ((*last_run <= now_times) && (wheel_slot_walks < TIMER_WHEEL_SLOTS)) {
+  while (TIMED_OUT(timer_last_run)) {
     struct list_node tmp_head_node;
     /* keep some statistics */
     unsigned int timers_walked = 0, timers_fired = 0;
+    unsigned int index = timer_last_run & TIMER_WHEEL_ROOT_MASK;
 
     /* Get the hash slot for this clocktick */
-    struct list_node *const timer_head_node = &timer_wheel[*last_run & TIMER_WHEEL_MASK];
+    struct list_node *const timer_head_node = &timer_wheel[index];
+
+    if (index == 0) {
+      unsigned int level = 0;
+
+      /* cascade the next level as long as the level below has wrapped */
+      while (level < TIMER_WHEEL_LEVELS && cascade_timers(level, &timers_walked) == 0) {
+        level++;
+      }
+    }
 
     /* Walk all entries hanging off this hash bucket. We treat this basically as a stack
      * so that we always know if and where the next element is.
@@ -693,6 +976,7 @@ walk_timers(uint32_t * last_run)
        */
       list_remove(timer_node);
       list_add_after(&tmp_head_node, timer_node);
+      timer->timer_cookie->ci_timer_walks++;
       timers_walked++;
 
       if (timer->timer_flags & OLSR_TIMER_REMOVED) {
@@ -705,7 +989,9 @@ walk_timers(uint32_t * last_run)
         OLSR_PRINTF(7, "TIMER: fire %s timer %p, ctx %p, "
                    "at clocktick %u (%s)\n",
                    timer->timer_cookie->ci_name,
-                   timer, timer->timer_cb_context, (unsigned int)*last_run, olsr_wallclock_string());
+                   timer, timer->timer_cb_context, (unsigned int)timer_last_run, olsr_wallclock_string());
+
+        timer->timer_cookie->ci_timer_fires++;
 
         /* This timer is expired, call into the provided callback function */
         timer->timer_cb(timer->timer_cb_context);
@@ -740,19 +1026,13 @@ walk_timers(uint32_t * last_run)
     total_timers_fired += timers_fired;
 
     /* Increment the time slot and wheel slot walk iteration */
-    (*last_run)++;
+    timer_last_run++;
     wheel_slot_walks++;
   }
 
-  OLSR_PRINTF(7, "TIMER: processed %4u/%d clockwheel slots, "
+  OLSR_PRINTF(7, "TIMER: processed %4u clockwheel slots, "
              "timers walked %4u/%u, timers fired %u\n",
-             wheel_slot_walks, TIMER_WHEEL_SLOTS, total_timers_walked, timer_mem_cookie->ci_usage, total_timers_fired);
-
-  /*
-   * If the scheduler has slipped and we have walked all wheel slots,
-   * reset the last timer run.
-   */
-  *last_run = now_times;
+             wheel_slot_walks, total_timers_walked, timer_mem_cookie->ci_usage, total_timers_fired);
 }
 
 static void walk_timers_cleanup(void) {
@@ -765,46 +1045,39 @@ static void walk_timers_cleanup(void) {
   } OLSR_FOR_ALL_TIMER_CLEANUP_END(slot)
 }
 
+/**
+ * Stop all timers hanging off a timer wheel slot.
+ */
+static void
+flush_timer_slot(struct list_node *timer_head_node)
+{
+  struct list_node *timer_node;
+
+  /* stopping only tags the timers, they stay on the list until the cleanup */
+  for (timer_node = timer_head_node->next; timer_node != timer_head_node; timer_node = timer_node->next) {
+    olsr_stop_timer(list2timer(timer_node));
+  }
+}
+
 /**
  * Stop and delete all timers.
  */
 void
 olsr_flush_timers(void)
 {
-  struct list_node *timer_head_node;
-  struct list_node tmp_head_node;
-  unsigned int wheel_slot = 0;
-
-  list_head_init(&tmp_head_node);
+  unsigned int wheel_slot, level;
 
   walk_timers_cleanup();
 
-  for (wheel_slot = 0; wheel_slot < TIMER_WHEEL_SLOTS; wheel_slot++) {
-    timer_head_node = &timer_wheel[wheel_slot & TIMER_WHEEL_MASK];
-
-    /* stop all entries hanging off this hash bucket. */
-    while (!list_is_empty(timer_head_node)) {
-      /* the top element */
-      struct list_node *const timer_node = timer_head_node->next;
-      struct timer_entry *const timer = list2timer(timer_node);
-
-      /*
-       * Dequeue and insert to a temporary list.
-       * We do this to avoid losing our walking context when
-       * multiple timers fire.
-       */
-      list_remove(timer_node);
-      list_add_after(&tmp_head_node, timer_node);
-
-      olsr_stop_timer(timer);
+  for (wheel_slot = 0; wheel_slot < TIMER_WHEEL_ROOT_SLOTS; wheel_slot++) {
+    flush_timer_slot(&timer_wheel[wheel_slot]);
+  }
+  for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    for (wheel_slot = 0; wheel_slot < TIMER_WHEEL_LEVEL_SLOTS; wheel_slot++) {
+      flush_timer_slot(&timer_wheel_levels[level][wheel_slot]);
     }
   }
 
-  /*
-   * Now merge the temporary list back to the old bucket.
-   */
-  list_merge(timer_head_node, &tmp_head_node);
-
   walk_timers_cleanup();
 }
 
@@ -936,7 +1209,7 @@ olsr_start_timer(unsigned int rel_time,
   /*
    * Now insert in the respective timer_wheel slot.
    */
-  list_add_before(&timer_wheel[timer->timer_clock & TIMER_WHEEL_MASK], &timer->timer_list);
+  list_add_before(timer_wheel_slot(timer->timer_clock), &timer->timer_list);
 
   OLSR_PRINTF(7, "TIMER: start %s timer %p firing in %s, ctx %p\n",
              ci->ci_name, timer, olsr_clock_string(timer->timer_clock), context);
@@ -1037,7 +1310,7 @@ olsr_change_timer(struct timer_entry *timer, unsigned int rel_time, uint8_t jitt
    * and reinsert into the new slot.
    */
   list_remove(&timer->timer_list);
-  list_add_before(&timer_wheel[timer->timer_clock & TIMER_WHEEL_MASK], &timer->timer_list);
+  list_add_before(timer_wheel_slot(timer->timer_clock), &timer->timer_list);
 
   OLSR_PRINTF(7, "TIMER: change %s timer %p, firing to %s, ctx %p\n",
              timer->timer_cookie->ci_name, timer, olsr_clock_string(timer->timer_clock), timer->timer_cb_context);
@@ -59,8 +59,18 @@
 #define NSEC_PER_USEC 1000
 #define USEC_PER_MSEC 1000
 
-#define TIMER_WHEEL_SLOTS 1024
-#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+/*
+ * The timer wheel is hierarchical. The root level has one slot per
+ * millisecond, each slot of the following levels spans all slots of
+ * the level below. 8 + 4 * 6 bits cover the full 32 bit clock.
+ */
+#define TIMER_WHEEL_ROOT_BITS 8
+#define TIMER_WHEEL_ROOT_SLOTS (1u << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_ROOT_MASK (TIMER_WHEEL_ROOT_SLOTS - 1)
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_LEVEL_SLOTS (1u << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_LEVEL_MASK (TIMER_WHEEL_LEVEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 4            /* number of levels above the root level */
 
 typedef void (*timer_cb_func) (void *); /* callback function */
 
@@ -68,6 +78,9 @@ typedef void (*timer_cb_func) (void *); /* callback function */
  * Our timer implementation is a based on individual timers arranged in
  * a double linked list hanging of hash containers called a timer wheel slot.
  * For every timer a timer_entry is created and attached to the timer wheel slot.
+ * Timers further in the future are kept in the coarse slots of the upper
+ * levels and are cascaded down towards the root level when their slot
+ * comes up, so a timer is only touched when it cascades or fires.
  * When the timer fires, the timer_cb function is called with the
  * context pointer.
  * The implementation supports periodic and oneshot timers.
@@ -144,6 +157,8 @@ struct olsr_socket_entry {
   void *data;
   unsigned int flags;
   struct list_node socket_node;
+  int backend_fd[2];                   /* descriptor registered with the poll backend (pollrate, immediate) */
+  uint32_t backend_events[2];          /* events registered with the poll backend (pollrate, immediate) */
 };
 
 LISTNODE2STRUCT(list2socket, struct olsr_socket_entry, socket_node);
@@ -167,6 +167,7 @@ olsr_add_tc_entry(union olsr_ip_addr *adr)
    */
   avl_insert(&tc_tree, &tc->vertex_node, AVL_DUP_NO);
   olsr_lock_tc_entry(tc);
+  olsr_bump_generation(OLSR_GEN_TOPOLOGY);
 
   /*
    * Initialize subtrees for edges and prefixes.
@@ -284,6 +285,9 @@ olsr_delete_tc_entry(struct tc_entry *tc)
   struct tc_edge_entry *tc_edge;
   struct rt_path *rtp;
 
+  /* the SPF keeps pointers to vertices, so start from scratch */
+  olsr_spf_force_full();
+
   /* delete gateway if available */
 #ifdef __linux__
   olsr_delete_gateway_entry(&tc->addr, FORCE_DELETE_GW_ENTRY, false);
@@ -310,6 +314,7 @@ olsr_delete_tc_entry(struct tc_entry *tc)
 
   avl_delete(&tc_tree, &tc->vertex_node);
   olsr_unlock_tc_entry(tc);
+  olsr_bump_generation(OLSR_GEN_TOPOLOGY);
 }
 
 /**
@@ -413,6 +418,8 @@ olsr_expire_tc_edge_gc(void *context)
 bool
 olsr_calc_tc_edge_entry_etx(struct tc_edge_entry *tc_edge)
 {
+  olsr_linkcost cost;
+
   /*
    * Some sanity check before recalculating the etx.
    */
@@ -420,7 +427,16 @@ olsr_calc_tc_edge_entry_etx(struct tc_edge_entry *tc_edge)
     return false;
   }
 
-  tc_edge->cost = olsr_calc_tc_cost(tc_edge);
+  cost = olsr_calc_tc_cost(tc_edge);
+  if (cost == tc_edge->cost) {
+    return false;
+  }
+
+  tc_edge->cost = cost;
+  olsr_bump_generation(OLSR_GEN_TOPOLOGY);
+  if (tc_edge->edge_inv) {
+    olsr_spf_edge_changed(tc_edge->tc, tc_edge->edge_inv->tc);
+  }
   return true;
 }
 
@@ -456,6 +472,7 @@ olsr_add_tc_edge_entry(struct tc_entry *tc, union olsr_ip_addr *addr, uint16_t a
    */
   avl_insert(&tc->edge_tree, &tc_edge->edge_node, AVL_DUP_NO);
   olsr_lock_tc_entry(tc);
+  olsr_bump_generation(OLSR_GEN_TOPOLOGY);
 
   /*
    * Connect backpointer.
@@ -484,6 +501,8 @@ olsr_add_tc_edge_entry(struct tc_entry *tc, union olsr_ip_addr *addr, uint16_t a
       tc_edge_inv->edge_inv = tc_edge;
       tc_edge->edge_inv = tc_edge_inv;
 
+      olsr_spf_edge_changed(tc, tc_neighbor);
+
     }
   }
 
@@ -517,6 +536,7 @@ olsr_delete_tc_edge_entry(struct tc_edge_entry *tc_edge)
   tc = tc_edge->tc;
   avl_delete(&tc->edge_tree, &tc_edge->edge_node);
   olsr_unlock_tc_entry(tc);
+  olsr_bump_generation(OLSR_GEN_TOPOLOGY);
 
   /*
    * Clear the backpointer of our inverse edge.
@@ -524,6 +544,8 @@ olsr_delete_tc_edge_entry(struct tc_edge_entry *tc_edge)
   tc_edge_inv = tc_edge->edge_inv;
   if (tc_edge_inv) {
     tc_edge_inv->edge_inv = NULL;
+
+    olsr_spf_edge_changed(tc, tc_edge_inv->tc);
   }
 
   olsr_cookie_free(tc_edge_mem_cookie, tc_edge);
@@ -49,6 +49,7 @@
 #include "defs.h"
 #include "packet.h"
 #include "common/avl.h"
+#include "common/heap.h"
 #include "common/list.h"
 #include "scheduler.h"
 
@@ -74,12 +75,14 @@ AVLNODE2STRUCT(edge_tree2tc_edge, struct tc_edge_entry, edge_node);
 struct tc_entry {
   struct avl_node vertex_node;         /* node keyed by ip address */
   union olsr_ip_addr addr;             /* vertex_node key */
-  struct avl_node cand_tree_node;      /* SPF candidate heap, node keyed by path_etx */
-  olsr_linkcost path_cost;             /* SPF calculated distance, cand_tree_node key */
+  struct heap_node cand_heap_node;     /* SPF candidate heap, node keyed by path_etx */
+  olsr_linkcost path_cost;             /* SPF calculated distance, cand_heap_node key */
   struct list_node path_list_node;     /* SPF result list */
   struct avl_tree edge_tree;           /* subtree for edges */
   struct avl_tree prefix_tree;         /* subtree for prefixes */
   struct link_entry *next_hop;         /* SPF calculated link to the 1st hop neighbor */
+  struct link_entry *neigh_link;       /* best link to this vertex if it is a 1-hop neighbor */
+  struct tc_entry *spf_parent;         /* SPF calculated predecessor on the path */
   struct timer_entry *edge_gc_timer;   /* used for edge garbage collection */
   struct timer_entry *validity_timer;  /* tc validity time */
   uint32_t refcount;                   /* reference counter */
@@ -103,7 +106,7 @@ struct tc_entry {
 #define OLSR_TC_VTIME_JITTER 5          /* percent */
 
 AVLNODE2STRUCT(vertex_tree2tc, struct tc_entry, vertex_node);
-AVLNODE2STRUCT(cand_tree2tc, struct tc_entry, cand_tree_node);
+HEAPNODE2STRUCT(cand_heap2tc, struct tc_entry, cand_heap_node);
 LISTNODE2STRUCT(pathlist2tc, struct tc_entry, path_list_node);
 
 /*
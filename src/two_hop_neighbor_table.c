@@ -50,8 +50,9 @@
 #include "neighbor_table.h"
 #include "net_olsr.h"
 #include "scheduler.h"
+#include "lq_mpr.h"
 
-struct neighbor_2_entry two_hop_neighbortable[HASHSIZE];
+struct olsr_hashtable two_hop_neighbortable;
 
 /**
  *Initialize 2 hop neighbor table
@@ -59,11 +60,7 @@ struct neighbor_2_entry two_hop_neighbortable[HASHSIZE];
 void
 olsr_init_two_hop_table(void)
 {
-  int idx;
-  for (idx = 0; idx < HASHSIZE; idx++) {
-    two_hop_neighbortable[idx].next = &two_hop_neighbortable[idx];
-    two_hop_neighbortable[idx].prev = &two_hop_neighbortable[idx];
-  }
+  olsr_hashtable_init(&two_hop_neighbortable, struct neighbor_2_entry, neighbor_2_addr, next, prev);
 }
 
 /**
@@ -122,7 +119,8 @@ olsr_delete_two_hop_neighbor_table(struct neighbor_2_entry *two_hop_neighbor)
   }
 
   /* dequeue */
-  DEQUEUE_ELEM(two_hop_neighbor);
+  olsr_hashtable_remove(&two_hop_neighbortable, two_hop_neighbor);
+  olsr_lq_mpr_dequeue(two_hop_neighbor);
   free(two_hop_neighbor);
 }
 
@@ -136,10 +134,8 @@ olsr_delete_two_hop_neighbor_table(struct neighbor_2_entry *two_hop_neighbor)
 void
 olsr_insert_two_hop_neighbor_table(struct neighbor_2_entry *two_hop_neighbor)
 {
-  uint32_t hash = olsr_ip_hashing(&two_hop_neighbor->neighbor_2_addr);
-
   /* Queue */
-  QUEUE_ELEM(two_hop_neighbortable[hash], two_hop_neighbor);
+  olsr_hashtable_insert(&two_hop_neighbortable, two_hop_neighbor);
 }
 
 /**
@@ -155,10 +151,10 @@ olsr_lookup_two_hop_neighbor_table(const union olsr_ip_addr *dest)
 {
 
   struct neighbor_2_entry *neighbor_2;
-  uint32_t hash = olsr_ip_hashing(dest);
+  struct neighbor_2_entry *head = olsr_hashtable_head(&two_hop_neighbortable, dest);
 
   /* printf("LOOKING FOR %s\n", olsr_ip_to_string(&buf, dest)); */
-  for (neighbor_2 = two_hop_neighbortable[hash].next; neighbor_2 != &two_hop_neighbortable[hash]; neighbor_2 = neighbor_2->next) {
+  for (neighbor_2 = head->next; neighbor_2 != head; neighbor_2 = neighbor_2->next) {
     struct mid_address *adr;
 
     /* printf("Checking %s\n", olsr_ip_to_string(&buf, dest)); */
@@ -190,12 +186,12 @@ struct neighbor_2_entry *
 olsr_lookup_two_hop_neighbor_table_mid(const union olsr_ip_addr *dest)
 {
   struct neighbor_2_entry *neighbor_2;
-  uint32_t hash;
+  struct neighbor_2_entry *head;
 
   /* printf("LOOKING FOR %s\n", olsr_ip_to_string(&buf, dest)); */
-  hash = olsr_ip_hashing(dest);
+  head = olsr_hashtable_head(&two_hop_neighbortable, dest);
 
-  for (neighbor_2 = two_hop_neighbortable[hash].next; neighbor_2 != &two_hop_neighbortable[hash]; neighbor_2 = neighbor_2->next) {
+  for (neighbor_2 = head->next; neighbor_2 != head; neighbor_2 = neighbor_2->next) {
     if (ipequal(&neighbor_2->neighbor_2_addr, dest))
       return neighbor_2;
   }
@@ -213,32 +209,29 @@ void
 olsr_print_two_hop_neighbor_table(void)
 {
   /* The whole function makes no sense without it. */
-  int i;
+  struct neighbor_2_entry *neigh2;
   const int ipwidth = olsr_cnf->ip_version == AF_INET ? (INET_ADDRSTRLEN - 1) : (INET6_ADDRSTRLEN - 1);
 
   OLSR_PRINTF(1, "\n--- %s ----------------------- TWO-HOP NEIGHBORS\n\n" "IP addr (2-hop)  IP addr (1-hop)  Total cost\n",
               olsr_wallclock_string());
 
-  for (i = 0; i < HASHSIZE; i++) {
-    struct neighbor_2_entry *neigh2;
-    for (neigh2 = two_hop_neighbortable[i].next; neigh2 != &two_hop_neighbortable[i]; neigh2 = neigh2->next) {
-      struct neighbor_list_entry *entry;
-      bool first = true;
-
-      for (entry = neigh2->neighbor_2_nblist.next; entry != &neigh2->neighbor_2_nblist; entry = entry->next) {
-        struct ipaddr_str buf;
-        struct lqtextbuffer lqbuffer;
-        if (first) {
-          OLSR_PRINTF(1, "%-*s  ", ipwidth, olsr_ip_to_string(&buf, &neigh2->neighbor_2_addr));
-          first = false;
-        } else {
-          OLSR_PRINTF(1, "                 ");
-        }
-        OLSR_PRINTF(1, "%-*s  %s\n", ipwidth, olsr_ip_to_string(&buf, &entry->neighbor->neighbor_main_addr),
-                    get_linkcost_text(entry->path_linkcost, false, &lqbuffer));
+  OLSR_FOR_ALL_NBR2_ENTRIES(neigh2) {
+    struct neighbor_list_entry *entry;
+    bool first = true;
+
+    for (entry = neigh2->neighbor_2_nblist.next; entry != &neigh2->neighbor_2_nblist; entry = entry->next) {
+      struct ipaddr_str buf;
+      struct lqtextbuffer lqbuffer;
+      if (first) {
+        OLSR_PRINTF(1, "%-*s  ", ipwidth, olsr_ip_to_string(&buf, &neigh2->neighbor_2_addr));
+        first = false;
+      } else {
+        OLSR_PRINTF(1, "                 ");
       }
+      OLSR_PRINTF(1, "%-*s  %s\n", ipwidth, olsr_ip_to_string(&buf, &entry->neighbor->neighbor_main_addr),
+                  get_linkcost_text(entry->path_linkcost, false, &lqbuffer));
     }
-  }
+  } OLSR_FOR_ALL_NBR2_ENTRIES_END(neigh2);
 }
 #endif /* NODEBUG */
 
@@ -50,6 +50,7 @@
 #include "hashing.h"
 #include "lq_plugin.h"
 #include "olsr_types.h"
+#include "common/list.h"
 
 #define	NB2S_COVERED 	0x1     /* node has been covered by a MPR */
 
@@ -58,6 +59,7 @@ struct neighbor_list_entry {
   olsr_linkcost second_hop_linkcost;
   olsr_linkcost path_linkcost;
   olsr_linkcost saved_path_linkcost;
+  bool mpr_selected;                   /* neighbor is an MPR for this 2-hop neighbor, see lq_mpr.c */
   struct neighbor_list_entry *next;
   struct neighbor_list_entry *prev;
 };
@@ -68,11 +70,22 @@ struct neighbor_2_entry {
   uint8_t processed;                   /*used in mpr calculation */
   int16_t neighbor_2_pointer;          /* Neighbor count */
   struct neighbor_list_entry neighbor_2_nblist;
+  struct list_node mpr_dirty;          /* queued for MPR re-evaluation, see lq_mpr.c */
   struct neighbor_2_entry *prev;
   struct neighbor_2_entry *next;
 };
 
-extern struct neighbor_2_entry two_hop_neighbortable[HASHSIZE];
+#define OLSR_FOR_ALL_NBR2_ENTRIES(nbr2) \
+{ \
+  uint32_t _idx; \
+  for (_idx = 0; _idx < olsr_hashtable_buckets(&two_hop_neighbortable); _idx++) { \
+    struct neighbor_2_entry *_head = olsr_hashtable_bucket(&two_hop_neighbortable, _idx); \
+    for(nbr2 = _head->next; \
+        nbr2 != _head; \
+        nbr2 = nbr2->next)
+#define OLSR_FOR_ALL_NBR2_ENTRIES_END(nbr2) }}
+
+extern struct olsr_hashtable two_hop_neighbortable;
 
 void olsr_init_two_hop_table(void);
 